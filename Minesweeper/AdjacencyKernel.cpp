@@ -0,0 +1,256 @@
+#include "AdjacencyKernel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// Spreads the 8 bits of a byte to the low bits of 8 nibbles, bit i going to bit 4 * i.
+	constexpr std::array<std::uint32_t, 256> SPREAD_TABLE{ []()
+	{
+		std::array<std::uint32_t, 256> table{};
+
+		for (std::uint32_t value{ 0 }; value < 256; ++value)
+		{
+			for (std::uint32_t bit{ 0 }; bit < 8; ++bit)
+			{
+				table[value] |= ((value >> bit) & 1) << (bit * 4);
+			}
+		}
+
+		return table;
+	}() };
+
+	// Turns the four bitplanes of the counts of a row into its packed 4 bit counts.
+	void PackCounts(const std::uint64_t aPlanes[4], std::uint8_t* pPacked)
+	{
+		for (std::uint32_t byte{ 0 }; byte < 8; ++byte)
+		{
+			const std::uint32_t shift{ byte * 8 };
+			const std::uint32_t nibbles{ SPREAD_TABLE[(aPlanes[0] >> shift) & 0xFF] |
+				(SPREAD_TABLE[(aPlanes[1] >> shift) & 0xFF] << 1) |
+				(SPREAD_TABLE[(aPlanes[2] >> shift) & 0xFF] << 2) |
+				(SPREAD_TABLE[(aPlanes[3] >> shift) & 0xFF] << 3) };
+
+			// Tile 2i is the low nibble of byte i, which matches storing the nibbles little endian.
+			const std::uint8_t aBytes[4]{ static_cast<std::uint8_t>(nibbles), static_cast<std::uint8_t>(nibbles >> 8),
+				static_cast<std::uint8_t>(nibbles >> 16), static_cast<std::uint8_t>(nibbles >> 24) };
+			std::memcpy(pPacked + byte * 4, aBytes, 4);
+		}
+	}
+
+	// Bitwise operations on LANES rows at once, one row per 64 bit lane.
+	struct ScalarRows
+	{
+		using Type = std::uint64_t;
+		static constexpr std::uint32_t LANES{ 1 };
+
+		static Type Load(const std::uint64_t* p) { return *p; }
+		static void Store(std::uint64_t* p, Type v) { *p = v; }
+		static Type Broadcast(std::uint64_t value) { return value; }
+		static Type And(Type a, Type b) { return a & b; }
+		static Type AndNot(Type a, Type b) { return ~a & b; }
+		static Type Or(Type a, Type b) { return a | b; }
+		static Type Xor(Type a, Type b) { return a ^ b; }
+	};
+
+#if defined(_M_X64) || defined(_M_IX86)
+	struct Sse2Rows
+	{
+		using Type = __m128i;
+		static constexpr std::uint32_t LANES{ 2 };
+
+		static Type Load(const std::uint64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		static void Store(std::uint64_t* p, Type v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static Type Broadcast(std::uint64_t value) { return _mm_set1_epi64x(static_cast<long long>(value)); }
+		static Type And(Type a, Type b) { return _mm_and_si128(a, b); }
+		static Type AndNot(Type a, Type b) { return _mm_andnot_si128(a, b); }
+		static Type Or(Type a, Type b) { return _mm_or_si128(a, b); }
+		static Type Xor(Type a, Type b) { return _mm_xor_si128(a, b); }
+	};
+
+	struct Avx2Rows
+	{
+		using Type = __m256i;
+		static constexpr std::uint32_t LANES{ 4 };
+
+		static Type Load(const std::uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static void Store(std::uint64_t* p, Type v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static Type Broadcast(std::uint64_t value) { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+		static Type And(Type a, Type b) { return _mm256_and_si256(a, b); }
+		static Type AndNot(Type a, Type b) { return _mm256_andnot_si256(a, b); }
+		static Type Or(Type a, Type b) { return _mm256_or_si256(a, b); }
+		static Type Xor(Type a, Type b) { return _mm256_xor_si256(a, b); }
+	};
+
+	// Returns if the CPU has AVX2 and the OS saves the YMM registers on a context switch.
+	bool HasAvx2()
+	{
+		static const bool bAvx2{ []()
+		{
+			int info[4]{};
+			__cpuid(info, 0);
+
+			if (info[0] < 7)
+			{
+				return false;
+			}
+
+			__cpuid(info, 1);
+			const bool bOsSavesYmm{ (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6 };
+
+			__cpuidex(info, 7, 0);
+			return bOsSavesYmm && (info[1] & (1 << 5)) != 0;
+		}() };
+
+		return bAvx2;
+	}
+#endif
+
+	/*
+	*	Counts the rows from row on, LANES at a time, and returns
+	*	the first row left over for a narrower kernel.
+	*/
+	template <class ROWS>
+	std::uint32_t CountRows(const std::uint64_t* pWest, const std::uint64_t* pMid, const std::uint64_t* pEast,
+		std::uint32_t row, std::uint32_t cRows, std::uint64_t columnMask, std::uint8_t (*pCounts)[AdjacencyKernel::ROW_BYTES])
+	{
+		using Type = typename ROWS::Type;
+
+		// Adds three bits of the same weight into a sum bit and a carry bit of twice the weight.
+		auto fullAdd = [](Type a, Type b, Type c, Type& carry)
+		{
+			const Type partial{ ROWS::Xor(a, b) };
+			carry = ROWS::Or(ROWS::And(a, b), ROWS::And(c, partial));
+			return ROWS::Xor(partial, c);
+		};
+
+		auto halfAdd = [](Type a, Type b, Type& carry)
+		{
+			carry = ROWS::And(a, b);
+			return ROWS::Xor(a, b);
+		};
+
+		const Type mask{ ROWS::Broadcast(columnMask) };
+
+		for (; row + ROWS::LANES <= cRows; row += ROWS::LANES)
+		{
+			// Row i of the inputs is the row above output row i, i + 1 the row itself and i + 2 the row below.
+			Type aCarries[4]{};
+			const Type sumAbove{ fullAdd(ROWS::Load(pWest + row), ROWS::Load(pMid + row), ROWS::Load(pEast + row), aCarries[0]) };
+			const Type sumBelow{ fullAdd(ROWS::Load(pWest + row + 2), ROWS::Load(pMid + row + 2), ROWS::Load(pEast + row + 2), aCarries[1]) };
+			const Type sumSides{ halfAdd(ROWS::Load(pWest + row + 1), ROWS::Load(pEast + row + 1), aCarries[2]) };
+			const Type ones{ fullAdd(sumAbove, sumBelow, sumSides, aCarries[3]) };
+
+			Type twosCarry{};
+			Type foursCarry{};
+			const Type twosPartial{ fullAdd(aCarries[0], aCarries[1], aCarries[2], twosCarry) };
+			const Type twos{ halfAdd(twosPartial, aCarries[3], foursCarry) };
+
+			Type eights{};
+			const Type fours{ halfAdd(twosCarry, foursCarry, eights) };
+
+			const Type counted{ ROWS::AndNot(ROWS::Load(pMid + row + 1), mask) };
+			std::uint64_t aPlanes[4][ROWS::LANES]{};
+			ROWS::Store(aPlanes[0], ROWS::And(ones, counted));
+			ROWS::Store(aPlanes[1], ROWS::And(twos, counted));
+			ROWS::Store(aPlanes[2], ROWS::And(fours, counted));
+			ROWS::Store(aPlanes[3], ROWS::And(eights, counted));
+
+			for (std::uint32_t lane{ 0 }; lane < ROWS::LANES; ++lane)
+			{
+				const std::uint64_t aLanePlanes[4]{ aPlanes[0][lane], aPlanes[1][lane], aPlanes[2][lane], aPlanes[3][lane] };
+				PackCounts(aLanePlanes, pCounts[row + lane]);
+			}
+		}
+
+		return row;
+	}
+}
+
+AdjacencyKernel::Kernel AdjacencyKernel::GetBestKernel()
+{
+#if defined(_M_X64) || defined(_M_IX86)
+	return HasAvx2() ? Kernel::AVX2 : Kernel::SSE2;
+#else
+	return Kernel::SCALAR;
+#endif
+}
+
+bool AdjacencyKernel::IsSupported(Kernel kernel)
+{
+	return kernel <= GetBestKernel();
+}
+
+void AdjacencyKernel::CountAdjacentMines(const std::uint64_t* pWest, const std::uint64_t* pMid, const std::uint64_t* pEast,
+	std::uint32_t cRows, std::uint64_t columnMask, std::uint8_t (*pCounts)[ROW_BYTES], Kernel kernel)
+{
+	std::uint32_t row{ 0 };
+
+#if defined(_M_X64) || defined(_M_IX86)
+	if (kernel == Kernel::AVX2)
+	{
+		row = CountRows<Avx2Rows>(pWest, pMid, pEast, row, cRows, columnMask, pCounts);
+	}
+
+	if (kernel != Kernel::SCALAR)
+	{
+		row = CountRows<Sse2Rows>(pWest, pMid, pEast, row, cRows, columnMask, pCounts);
+	}
+#else
+	static_cast<void>(kernel);
+#endif
+
+	CountRows<ScalarRows>(pWest, pMid, pEast, row, cRows, columnMask, pCounts);
+}
+
+/*
+*	Gathers the mine rows of the chunk and the columns next
+*	to it in the chunks to its left and right, counts them
+*	and stores the counts row by row.
+*/
+void AdjacencyKernel::CountChunk(TileBoard& board, std::uint32_t chunkX, std::uint32_t chunkY, Kernel kernel)
+{
+	constexpr std::uint32_t CHUNK_SHIFT{ TileBoard::CHUNK_SHIFT };
+	constexpr std::uint32_t CHUNK_MASK{ TileBoard::CHUNK_MASK };
+	constexpr std::uint32_t CHUNK_SIZE{ TileBoard::CHUNK_SIZE };
+
+	const std::uint32_t yBegin{ chunkY << CHUNK_SHIFT };
+	const std::uint32_t cRows{ std::min(CHUNK_SIZE, board.GetHeight() - yBegin) };
+	const std::uint32_t cColumns{ std::min(CHUNK_SIZE, board.GetWidth() - (chunkX << CHUNK_SHIFT)) };
+	const std::uint64_t columnMask{ cColumns == CHUNK_SIZE ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << cColumns) - 1 };
+
+	std::uint64_t aWest[CHUNK_SIZE + 2]{};
+	std::uint64_t aMid[CHUNK_SIZE + 2]{};
+	std::uint64_t aEast[CHUNK_SIZE + 2]{};
+
+	for (std::uint32_t i{ 0 }; i < cRows + 2; ++i)
+	{
+		// Row y - 1 wraps around to a huge value for the first row and is left empty, like rows below the board.
+		const std::uint32_t y{ yBegin + i - 1 };
+
+		if (y < board.GetHeight())
+		{
+			const std::uint64_t left{ board.GetMineRow(chunkX - 1, y >> CHUNK_SHIFT, y & CHUNK_MASK) >> CHUNK_MASK };
+			const std::uint64_t right{ board.GetMineRow(chunkX + 1, y >> CHUNK_SHIFT, y & CHUNK_MASK) & 1 };
+
+			aMid[i] = board.GetMineRow(chunkX, y >> CHUNK_SHIFT, y & CHUNK_MASK);
+			aWest[i] = (aMid[i] << 1) | left;
+			aEast[i] = (aMid[i] >> 1) | (right << CHUNK_MASK);
+		}
+	}
+
+	std::uint8_t aCounts[CHUNK_SIZE][ROW_BYTES];
+	CountAdjacentMines(aWest, aMid, aEast, cRows, columnMask, aCounts, kernel);
+
+	for (std::uint32_t row{ 0 }; row < cRows; ++row)
+	{
+		board.SetAdjacentCountRow(chunkX, chunkY, row, aCounts[row]);
+	}
+}
\ No newline at end of file
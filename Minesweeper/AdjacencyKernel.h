@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+#include "TileBoard.h"
+
+/*
+*	Computes the adjacent mine counts of a chunk a whole row
+*	of 64 tiles at a time. The eight neighbors of every tile
+*	of a row are eight shifted mine rows, which are added
+*	bit-sliced with carry-save adders into four bitplanes
+*	holding the bits of the counts. Rows are processed four
+*	at a time with AVX2 when the CPU supports it, two at a
+*	time with SSE2 otherwise.
+*
+*	The inputs hold, for the rows from one above the first
+*	row to one below the last (cRows + 2 rows):
+*		- pMid: the mine row itself
+*		- pWest: the mines one column to the left of each tile
+*		- pEast: the mines one column to the right of each tile
+*	and the counts are written as the packed rows of
+*	TileBoard's count plane. Mines and tiles outside of
+*	columnMask get a count of 0.
+*
+*	A kernel can also be picked explicitly, e.g. to compare
+*	them with each other. Rows left over by a wider kernel
+*	are counted by the narrower ones.
+*/
+namespace AdjacencyKernel
+{
+	constexpr std::uint32_t ROW_BYTES{ TileBoard::CHUNK_SIZE / 2 };
+
+	// The kernels, from the narrowest to the widest.
+	enum class Kernel
+	{
+		SCALAR,
+		SSE2,
+		AVX2,
+	};
+
+	Kernel GetBestKernel();									// Returns the widest kernel the CPU supports.
+	bool IsSupported(Kernel kernel);
+
+	void CountAdjacentMines(const std::uint64_t* pWest, const std::uint64_t* pMid, const std::uint64_t* pEast,
+		std::uint32_t cRows, std::uint64_t columnMask, std::uint8_t (*pCounts)[ROW_BYTES], Kernel kernel = GetBestKernel());
+
+	// Counts the adjacent mines of every tile of the chunk at (chunkX, chunkY) into the count plane of board.
+	void CountChunk(TileBoard& board, std::uint32_t chunkX, std::uint32_t chunkY, Kernel kernel = GetBestKernel());
+}
\ No newline at end of file
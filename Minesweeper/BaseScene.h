@@ -1,12 +1,21 @@
 #pragma once
 #include <cassert>
+#include <cwchar>
+#include <typeinfo>
+#include <unordered_map>
 
 #include <atlbase.h>
-#include <d2d1.h>
+#include <d2d1_1.h>
 #include <dwrite.h>
 #include <wincodec.h>
 #include <Windows.h>
 
+#include "colors.h"
+#include "FrameScheduler.h"
+#include "FrameTimes.h"
+#include "GraphicsDevice.h"
+#include "Tracing.h"
+
 #pragma comment(lib, "d2d1")
 #pragma comment(lib, "dwrite")
 
@@ -18,10 +27,42 @@ protected:
 
 	// D2D Resources
 	CComPtr<ID2D1Factory>           m_pFactory;
-	CComPtr<ID2D1HwndRenderTarget>  m_pRenderTarget;
+	CComPtr<ID2D1RenderTarget>      m_pRenderTarget;
 	CComPtr<IWICImagingFactory>     m_pWICFactory;
 	CComPtr<IDWriteFactory>			m_pDWriteFactory;
 
+private:
+	// Render target of the RenderBackend::HWND_RENDER_TARGET backend, m_pRenderTarget is the same object.
+	CComPtr<ID2D1HwndRenderTarget>  m_pHwndRenderTarget;
+
+	/*
+	*	Resources of the RenderBackend::FLIP_SWAP_CHAIN backend.
+	*	Scenes draw into the canvas through the device context,
+	*	which is m_pRenderTarget, and every frame the canvas is
+	*	copied to the back buffer and presented. Flip model back
+	*	buffers are discarded on present, the canvas keeps the
+	*	last frame so scenes can still redraw only what changed.
+	*/
+	CComPtr<ID2D1DeviceContext>     m_pDeviceContext;
+	CComPtr<IDXGISwapChain1>        m_pSwapChain;
+	CComPtr<ID2D1Bitmap1>           m_pCanvas;
+	CComPtr<ID2D1Bitmap1>           m_pBackBuffer;
+	HANDLE m_hFrameLatencyWaitable{ nullptr };
+
+	// Brushes of the render target, keyed by their RGBA color. Kept until the render target is released.
+	std::unordered_map<unsigned int, CComPtr<ID2D1SolidColorBrush>> m_brushCache{};
+
+	// Set while RenderScene runs, see TrackResourceCreation.
+	BOOL m_bRendering{ FALSE };
+
+	// Set once the scene showed its first frame, which is reported as a Startup event.
+	BOOL m_bPresented{ FALSE };
+
+	// Durations of the last frames, from BeginDraw until the frame was presented.
+	FrameTimes m_frameTimes{};
+
+	static inline UINT s_cRenderPathCreations{ 0 };
+
 protected:
 
 	// Derived class must implement these methods.
@@ -44,8 +85,23 @@ protected:
 
 			D2D1_SIZE_U size{ D2D1::SizeU(rc.right, rc.bottom) };
 
-			hr = m_pFactory->CreateHwndRenderTarget(D2D1::RenderTargetProperties(),
-				D2D1::HwndRenderTargetProperties(m_hOwnerWnd, size), &m_pRenderTarget);
+			if (GraphicsDevice::Instance().GetBackend() == RenderBackend::FLIP_SWAP_CHAIN)
+			{
+				hr = CreateSwapChainTarget(size);
+			}
+			else
+			{
+				// Retaining the contents lets scenes redraw only the parts that changed. Presents don't
+				// wait for vsync since the FrameScheduler already limits frames to one per refresh.
+				hr = m_pFactory->CreateHwndRenderTarget(D2D1::RenderTargetProperties(),
+					D2D1::HwndRenderTargetProperties(m_hOwnerWnd, size,
+						D2D1_PRESENT_OPTIONS_RETAIN_CONTENTS | D2D1_PRESENT_OPTIONS_IMMEDIATELY), &m_pHwndRenderTarget);
+
+				if (SUCCEEDED(hr))
+				{
+					m_pRenderTarget = m_pHwndRenderTarget;
+				}
+			}
 
 			if (SUCCEEDED(hr))
 			{
@@ -59,13 +115,65 @@ protected:
 		return hr;
 	}
 
+	/*
+	*	Returns the solid color brush of color, given in the RGBA
+	*	format of colors.h. Each color is only ever created once
+	*	per render target, asking again returns the same brush.
+	*/
+	HRESULT GetSolidColorBrush(unsigned int color, ID2D1SolidColorBrush** ppBrush)
+	{
+		auto it{ m_brushCache.find(color) };
+
+		if (it == m_brushCache.end())
+		{
+			CComPtr<ID2D1SolidColorBrush> pBrush{ nullptr };
+
+			TrackResourceCreation(L"brush");
+			HRESULT hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(color)), &pBrush);
+
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+
+			it = m_brushCache.emplace(color, pBrush).first;
+		}
+
+		return it->second.CopyTo(ppBrush);
+	}
+
+	/*
+	*	Must be called before a scene creates a D2D object that
+	*	is not cached. There should be no such creations while a
+	*	frame is drawn, they are counted and, in debug builds,
+	*	reported to the debugger.
+	*/
+	void TrackResourceCreation(LPCWSTR pszResource)
+	{
+		if (m_bRendering)
+		{
+			++s_cRenderPathCreations;
+
+#ifdef _DEBUG
+			WCHAR szMessage[128];
+			swprintf_s(szMessage, L"D2D %s created while rendering (%u so far)\n", pszResource, s_cRenderPathCreations);
+			OutputDebugString(szMessage);
+#endif
+		}
+	}
+
 	HRESULT LoadImageFromFile(LPCWSTR uri, UINT destinationWidth, UINT destinationHeight, ID2D1Bitmap** ppBitmap,
 		WICBitmapInterpolationMode scalingMode = WICBitmapInterpolationModeLinear)
 	{
 		CComPtr<IWICBitmapDecoder> pDecoder{ nullptr };
 
-		HRESULT hr = m_pWICFactory->CreateDecoderFromFilename(uri, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad,
-			&pDecoder);
+		HRESULT hr = CreateWICFactory();
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pWICFactory->CreateDecoderFromFilename(uri, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad,
+				&pDecoder);
+		}
 
 		if (SUCCEEDED(hr))
 		{
@@ -78,16 +186,68 @@ protected:
 	HRESULT LoadImageFromResource(UINT resourceID, LPCTSTR typeID, UINT destinationWidth, UINT destinationHeight,
 		ID2D1Bitmap** ppBitmap, WICBitmapInterpolationMode scalingMode = WICBitmapInterpolationModeLinear)
 	{
-		CComPtr<IWICStream> pIWICStream{ nullptr };
 		CComPtr<IWICBitmapDecoder> pDecoder{ nullptr };
 
+		HRESULT hr = CreateDecoderFromResource(resourceID, typeID, &pDecoder);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = LoadImageFromDecoder(pDecoder, destinationWidth, destinationHeight, ppBitmap, scalingMode);
+		}
+
+		return hr;
+	}
+
+	/*
+	*	Decodes and scales an image resource into a WIC bitmap
+	*	once. It needs no render target, so a scene can do this
+	*	with its device independent resources and only upload
+	*	the pixels with CreateBitmapFromWicBitmap every time the
+	*	device is created.
+	*/
+	HRESULT DecodeImageFromResource(UINT resourceID, LPCTSTR typeID, UINT destinationWidth, UINT destinationHeight,
+		IWICBitmap** ppBitmap, WICBitmapInterpolationMode scalingMode = WICBitmapInterpolationModeLinear)
+	{
+		CComPtr<IWICBitmapDecoder> pDecoder{ nullptr };
+		CComPtr<IWICBitmapSource> pSource{ nullptr };
+
+		HRESULT hr = CreateDecoderFromResource(resourceID, typeID, &pDecoder);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = CreateScaledSource(pDecoder, destinationWidth, destinationHeight, &pSource, scalingMode);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pWICFactory->CreateBitmapFromSource(pSource, WICBitmapCacheOnLoad, ppBitmap);
+		}
+
+		return hr;
+	}
+
+private:
+	HRESULT CreateWICFactory()
+	{
+		return m_pWICFactory ? S_OK : m_pWICFactory.CoCreateInstance(CLSID_WICImagingFactory);
+	}
+
+	HRESULT CreateDecoderFromResource(UINT resourceID, LPCTSTR typeID, IWICBitmapDecoder** ppDecoder)
+	{
+		CComPtr<IWICStream> pIWICStream{ nullptr };
+
 		HRSRC hImageRes{ nullptr };
 		HGLOBAL hImageResData{ nullptr };
 		void* pImageFile{ nullptr };
 		DWORD imageFileSize = 0;
 
-		hImageRes = FindResource(nullptr, MAKEINTRESOURCE(resourceID), typeID);
-		HRESULT hr = (hImageRes ? S_OK : E_FAIL);
+		HRESULT hr = CreateWICFactory();
+
+		if (SUCCEEDED(hr))
+		{
+			hImageRes = FindResource(nullptr, MAKEINTRESOURCE(resourceID), typeID);
+			hr = (hImageRes ? S_OK : E_FAIL);
+		}
 
 		if (SUCCEEDED(hr))
 		{
@@ -118,23 +278,32 @@ protected:
 
 		if (SUCCEEDED(hr))
 		{
-			hr = m_pWICFactory->CreateDecoderFromStream(pIWICStream, nullptr, WICDecodeMetadataCacheOnLoad, &pDecoder);
+			hr = m_pWICFactory->CreateDecoderFromStream(pIWICStream, nullptr, WICDecodeMetadataCacheOnLoad, ppDecoder);
 		}
 
+		return hr;
+	}
+
+	HRESULT LoadImageFromDecoder(IWICBitmapDecoder* pDecoder, UINT destinationWidth, UINT destinationHeight,
+		ID2D1Bitmap** ppBitmap, WICBitmapInterpolationMode scalingMode)
+	{
+		CComPtr<IWICBitmapSource> pSource{ nullptr };
+
+		HRESULT hr = CreateScaledSource(pDecoder, destinationWidth, destinationHeight, &pSource, scalingMode);
+
 		if (SUCCEEDED(hr))
 		{
-			hr = LoadImageFromDecoder(pDecoder, destinationWidth, destinationHeight, ppBitmap, scalingMode);
+			hr = m_pRenderTarget->CreateBitmapFromWicBitmap(pSource, nullptr, ppBitmap);
 		}
 
 		return hr;
 	}
 
-private:
-	HRESULT LoadImageFromDecoder(IWICBitmapDecoder* pDecoder, UINT destinationWidth, UINT destinationHeight,
-		ID2D1Bitmap** ppBitmap, WICBitmapInterpolationMode scalingMode)
+	// Returns the first frame of pDecoder in the pixel format of D2D bitmaps, scaled to the destination size.
+	HRESULT CreateScaledSource(IWICBitmapDecoder* pDecoder, UINT destinationWidth, UINT destinationHeight,
+		IWICBitmapSource** ppSource, WICBitmapInterpolationMode scalingMode)
 	{
 		CComPtr<IWICBitmapFrameDecode> pSource{ nullptr };
-		CComPtr<IWICStream> pStream{ nullptr };
 		CComPtr<IWICFormatConverter> pConverter{ nullptr };
 		CComPtr<IWICBitmapScaler> pScaler{ nullptr };
 
@@ -158,30 +327,171 @@ private:
 
 		if (SUCCEEDED(hr))
 		{
-			hr = pScaler->Initialize(pConverter, destinationWidth, destinationHeight, WICBitmapInterpolationModeLinear);
+			hr = pScaler->Initialize(pConverter, destinationWidth, destinationHeight, scalingMode);
 		}
 
 		if (SUCCEEDED(hr))
 		{
-			hr = m_pRenderTarget->CreateBitmapFromWicBitmap(pScaler, nullptr, ppBitmap);
+			hr = pScaler.QueryInterface(ppSource);
 		}
 
 		return hr;
 	}
 
+	HRESULT CreateSwapChainTarget(D2D1_SIZE_U size)
+	{
+		GraphicsDevice& device{ GraphicsDevice::Instance() };
+
+		HRESULT hr = device.CreateDeviceContext(&m_pDeviceContext);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = device.CreateSwapChain(m_hOwnerWnd, size.width, size.height, &m_pSwapChain);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			CComPtr<IDXGISwapChain2> pSwapChain2{ nullptr };
+
+			if (SUCCEEDED(m_pSwapChain.QueryInterface(&pSwapChain2)))
+			{
+				m_hFrameLatencyWaitable = pSwapChain2->GetFrameLatencyWaitableObject();
+			}
+
+			hr = CreateSwapChainBitmaps(size);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			m_pRenderTarget = m_pDeviceContext;
+		}
+		else
+		{
+			ReleaseSwapChainTarget();
+		}
+
+		return hr;
+	}
+
+	/*
+	*	Wraps the back buffer of the swap chain and creates a
+	*	canvas of the same size as the target of the device
+	*	context. The canvas uses the system DPI like a window
+	*	render target would, unless the scene changed its DPI.
+	*/
+	HRESULT CreateSwapChainBitmaps(D2D1_SIZE_U size)
+	{
+		CComPtr<IDXGISurface> pSurface{ nullptr };
+		FLOAT dpiX{ static_cast<FLOAT>(GetDpiForSystem()) };
+		FLOAT dpiY{ dpiX };
+
+		if (m_pRenderTarget)
+		{
+			m_pDeviceContext->GetDpi(&dpiX, &dpiY);
+		}
+
+		const D2D1_PIXEL_FORMAT pixelFormat{ D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE) };
+
+		HRESULT hr = m_pSwapChain->GetBuffer(0, __uuidof(IDXGISurface), reinterpret_cast<void**>(&pSurface));
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pDeviceContext->CreateBitmapFromDxgiSurface(pSurface, D2D1::BitmapProperties1(
+				D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW, pixelFormat, dpiX, dpiY), &m_pBackBuffer);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pDeviceContext->CreateBitmap(D2D1::SizeU(max(size.width, 1u), max(size.height, 1u)), nullptr, 0,
+				D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET, pixelFormat, dpiX, dpiY), &m_pCanvas);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			m_pDeviceContext->SetTarget(m_pCanvas);
+		}
+
+		return hr;
+	}
+
+	// Copies the canvas to the back buffer and presents it.
+	HRESULT PresentSwapChain()
+	{
+		HRESULT hr = m_pBackBuffer->CopyFromBitmap(nullptr, m_pCanvas, nullptr);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pSwapChain->Present(0, 0);
+		}
+
+		if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+		{
+			GraphicsDevice::Instance().HandleDeviceLost();
+			hr = D2DERR_RECREATE_TARGET;
+		}
+
+		return hr;
+	}
+
+	void ReleaseSwapChainTarget()
+	{
+		if (m_pDeviceContext)
+		{
+			m_pDeviceContext->SetTarget(nullptr);
+		}
+
+		if (m_hFrameLatencyWaitable)
+		{
+			CloseHandle(m_hFrameLatencyWaitable);
+			m_hFrameLatencyWaitable = nullptr;
+		}
+
+		m_pCanvas.Release();
+		m_pBackBuffer.Release();
+		m_pSwapChain.Release();
+		m_pDeviceContext.Release();
+	}
+
+	// Releases the render target of either backend along with every device resource.
+	void DiscardGraphicsResources()
+	{
+		DiscardDeviceDependentResources();
+		m_brushCache.clear();
+		ReleaseSwapChainTarget();
+		m_pHwndRenderTarget.Release();
+		m_pRenderTarget.Release();
+	}
+
 public:
 	BaseScene() {}
-	virtual ~BaseScene() {}
+	virtual ~BaseScene()
+	{
+		FrameScheduler::Instance().CancelFrame(this);
+		ReleaseSwapChainTarget();
+	}
 
 	HRESULT Initialize(HWND hWnd)
 	{
 		m_hOwnerWnd = hWnd;
 
-		HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pFactory);
+		HRESULT hr = S_OK;
 
-		if (SUCCEEDED(hr))
+		/*
+		*	Every scene shares one D2D factory, which the flip model
+		*	backend needs anyway as resources of one device can only
+		*	be used with geometry of the factory that created the
+		*	device. Without ID2D1Factory1 (Windows 7 without the
+		*	platform update) window render targets still work from
+		*	a factory of each scene's own. The WIC factory is only
+		*	created once a scene loads an image.
+		*/
+		CComPtr<ID2D1Factory1> pFactory{ nullptr };
+		hr = GraphicsDevice::Instance().GetFactory(&pFactory);
+		m_pFactory = pFactory;
+
+		if (FAILED(hr) && GraphicsDevice::Instance().GetBackend() == RenderBackend::HWND_RENDER_TARGET)
 		{
-			hr = m_pWICFactory.CoCreateInstance(CLSID_WICImagingFactory);
+			hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pFactory);
 		}
 
 		if (SUCCEEDED(hr))
@@ -197,8 +507,44 @@ public:
 		return hr;
 	}
 
+	/*
+	*	Initializes the scene to draw into a WIC bitmap instead
+	*	of a window, e.g. to benchmark it without showing it.
+	*	Render then draws into the bitmap, which the scene keeps
+	*	using until it is cleaned up.
+	*/
+	HRESULT InitializeOffscreen(IWICBitmap* pBitmap)
+	{
+		HRESULT hr = Initialize(nullptr);
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pFactory->CreateWicBitmapRenderTarget(pBitmap, D2D1::RenderTargetProperties(), &m_pRenderTarget);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			hr = CreateDeviceDependentResources();
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			CalculateLayout();
+		}
+
+		return hr;
+	}
+
+	/*
+	*	Draws a frame of the scene and writes a Render event of
+	*	how long recording, executing and presenting it took, see
+	*	Tracing.h.
+	*/
 	void Render()
 	{
+		const DWORD messageTime{ FrameScheduler::Instance().GetFrameMessageTime() };
+		FrameScheduler::Instance().CancelFrame(this);
+
 		HRESULT hr = CreateGraphicsResources();
 		if (FAILED(hr))
 		{
@@ -207,25 +553,99 @@ public:
 
 		assert(m_pRenderTarget != nullptr);
 
+		// Blocks until the swap chain can take a frame, normally it already can.
+		if (m_hFrameLatencyWaitable)
+		{
+			WaitForSingleObjectEx(m_hFrameLatencyWaitable, 100, TRUE);
+		}
+
+		Tracing::Stopwatch stopwatch{};
 		m_pRenderTarget->BeginDraw();
 
+		m_bRendering = TRUE;
 		RenderScene();
+		m_bRendering = FALSE;
 
+		const LONGLONG recordMicroseconds{ stopwatch.Restart() };
 		hr = m_pRenderTarget->EndDraw();
+		const LONGLONG endDrawMicroseconds{ stopwatch.Restart() };
+
+		if (SUCCEEDED(hr) && m_pSwapChain)
+		{
+			hr = PresentSwapChain();
+		}
+
+		if (SUCCEEDED(hr) && !m_bPresented)
+		{
+			m_bPresented = TRUE;
+			Tracing::MarkStartupPhase("FirstFrame", typeid(*this).name());
+		}
+
+		const LONGLONG presentMicroseconds{ stopwatch.GetElapsed() };
+		m_frameTimes.Add((recordMicroseconds + endDrawMicroseconds + presentMicroseconds) / 1000.f);
+
+		TraceLoggingWrite(g_hMinesweeperTraceProvider, "Render",
+			TraceLoggingString(typeid(*this).name(), "Scene"),
+			TraceLoggingInt64(recordMicroseconds, "RecordMicroseconds"),
+			TraceLoggingInt64(endDrawMicroseconds, "EndDrawMicroseconds"),
+			TraceLoggingInt64(presentMicroseconds, "PresentMicroseconds"),
+			TraceLoggingHResult(hr, "Result"),
+			TraceLoggingUInt32(messageTime, "MessageTime"),
+			TraceLoggingUInt32(Tracing::GetMessageAge(messageTime), "InputLatencyMilliseconds"));
+
 		if (hr == D2DERR_RECREATE_TARGET)
 		{
-			DiscardDeviceDependentResources();
-			m_pRenderTarget.Release();
+			TraceLoggingWrite(g_hMinesweeperTraceProvider, "RenderTargetLost",
+				TraceLoggingString(typeid(*this).name(), "Scene"),
+				TraceLoggingUInt32(messageTime, "MessageTime"));
+
+			DiscardGraphicsResources();
 		}
 	}
 
+	/*
+	*	Schedules the scene to be rendered with the next frame.
+	*	Any number of requests before then results in a single
+	*	render.
+	*/
+	void RequestRender()
+	{
+		FrameScheduler::Instance().RequestFrame(this);
+	}
+
 	HRESULT Resize(int x, int y)
 	{
 		HRESULT hr = S_OK;
 		if (m_pRenderTarget)
 		{
 			D2D1_SIZE_U size{ D2D1::SizeU(x, y) };
-			hr = m_pRenderTarget->Resize(size);
+
+			if (m_pSwapChain)
+			{
+				// The swap chain can only resize once nothing references its buffers.
+				m_pDeviceContext->SetTarget(nullptr);
+				m_pCanvas.Release();
+				m_pBackBuffer.Release();
+
+				hr = m_pSwapChain->ResizeBuffers(0, max(size.width, 1u), max(size.height, 1u), DXGI_FORMAT_UNKNOWN,
+					DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT);
+
+				if (SUCCEEDED(hr))
+				{
+					hr = CreateSwapChainBitmaps(size);
+				}
+
+				if (FAILED(hr))
+				{
+					DiscardGraphicsResources();
+					return hr;
+				}
+			}
+			else
+			{
+				hr = m_pHwndRenderTarget->Resize(size);
+			}
+
 			if (SUCCEEDED(hr))
 			{
 				CalculateLayout();
@@ -236,7 +656,20 @@ public:
 
 	void CleanUp()
 	{
+		FrameScheduler::Instance().CancelFrame(this);
 		DiscardDeviceDependentResources();
 		DiscardDeviceIndependentResources();
+		m_brushCache.clear();
+	}
+
+	const FrameTimes& GetFrameTimes() const
+	{
+		return m_frameTimes;
+	}
+
+	// Returns the number of D2D objects any scene created while drawing a frame.
+	static UINT GetRenderPathCreationCount()
+	{
+		return s_cRenderPathCreations;
 	}
 };
\ No newline at end of file
@@ -1,252 +1,112 @@
+#pragma once
 #include <atlbase.h>
 #include <d2d1.h>
 #include <windef.h>
 
 namespace BorderHelper
 {
-	HRESULT DrawBorder(const RECT& boundingBox, const FLOAT strokeSize, ID2D1Factory* pFactory, ID2D1RenderTarget* pRenderTarget,
-		ID2D1Brush* pLeftEdgeBrush, ID2D1Brush* pTopEdgeBrush, ID2D1Brush* pRightEdgeBrush, ID2D1Brush* pBottomEdgeBrush)
+	/*
+	*	The four beveled edges drawn around a bounding box. The
+	*	geometry only depends on the box and the stroke size, so
+	*	it is built once and kept until either changes.
+	*/
+	class BorderGeometry
 	{
-		// Create resources needed for making border geometry.
-		CComPtr<ID2D1GeometrySink> pSink{ nullptr };
-		HRESULT hr = S_OK;
-		const FLOAT rLeftF{ static_cast<FLOAT>(boundingBox.left) };
-		const FLOAT rTopF{ static_cast<FLOAT>(boundingBox.top) };
-		const FLOAT rRightF{ static_cast<FLOAT>(boundingBox.right) };
-		const FLOAT rBottomF{ static_cast<FLOAT>(boundingBox.bottom) };
-
-		CComPtr<ID2D1PathGeometry> pEdgeTriangleA{ nullptr };
-		D2D1_RECT_F edgeRectangle{};
-		CComPtr<ID2D1PathGeometry> pEdgeTriangleB{ nullptr };
-
-		// We start by drawing the left border
-		if (SUCCEEDED(hr))
+	public:
+		// Returns if the geometry has to be built again to draw a border around boundingBox.
+		BOOL NeedsUpdate(const RECT& boundingBox, const FLOAT strokeSize) const
 		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleA);
+			return !m_apEdges[0] || !EqualRect(&boundingBox, &m_boundingBox) || strokeSize != m_strokeSize;
 		}
 
-		if (SUCCEEDED(hr))
+		HRESULT Update(const RECT& boundingBox, const FLOAT strokeSize, ID2D1Factory* pFactory)
 		{
-			hr = pEdgeTriangleA->Open(&pSink);
-
-			if (SUCCEEDED(hr))
+			if (!NeedsUpdate(boundingBox, strokeSize))
 			{
-				pSink->BeginFigure(D2D1::Point2F(rLeftF, rTopF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rTopF - strokeSize));
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rTopF));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				return S_OK;
 			}
 
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			edgeRectangle = D2D1::RectF(rLeftF - strokeSize, rTopF, rLeftF, rBottomF);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleB);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleB->Open(&pSink);
-
-			if (SUCCEEDED(hr))
-			{
-				pSink->BeginFigure(D2D1::Point2F(rLeftF, rBottomF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rBottomF + strokeSize));
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rBottomF));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
-			}
-
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			pRenderTarget->FillGeometry(pEdgeTriangleA, pLeftEdgeBrush);
-			pRenderTarget->FillRectangle(edgeRectangle, pLeftEdgeBrush);
-			pRenderTarget->FillGeometry(pEdgeTriangleB, pLeftEdgeBrush);
-			pEdgeTriangleA.Release();
-			pEdgeTriangleB.Release();
-		}
-
-		// Now we draw the top border
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleA);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleA->Open(&pSink);
+			const FLOAT rLeftF{ static_cast<FLOAT>(boundingBox.left) };
+			const FLOAT rTopF{ static_cast<FLOAT>(boundingBox.top) };
+			const FLOAT rRightF{ static_cast<FLOAT>(boundingBox.right) };
+			const FLOAT rBottomF{ static_cast<FLOAT>(boundingBox.bottom) };
 
-			if (SUCCEEDED(hr))
+			// Each edge is a trapezoid whose mitered corners meet the neighboring edges.
+			const D2D1_POINT_2F aEdgePoints[4][4]
 			{
-				pSink->BeginFigure(D2D1::Point2F(rRightF, rTopF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rTopF - strokeSize));
-				pSink->AddLine(D2D1::Point2F(rRightF, rTopF - strokeSize));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
-			}
-
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			edgeRectangle = D2D1::RectF(rLeftF, rTopF - strokeSize, rRightF, rBottomF);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleB);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleB->Open(&pSink);
-
-			if (SUCCEEDED(hr))
+				// Left
+				{ D2D1::Point2F(rLeftF, rTopF), D2D1::Point2F(rLeftF - strokeSize, rTopF - strokeSize),
+					D2D1::Point2F(rLeftF - strokeSize, rBottomF + strokeSize), D2D1::Point2F(rLeftF, rBottomF) },
+				// Top
+				{ D2D1::Point2F(rLeftF, rTopF), D2D1::Point2F(rLeftF - strokeSize, rTopF - strokeSize),
+					D2D1::Point2F(rRightF + strokeSize, rTopF - strokeSize), D2D1::Point2F(rRightF, rTopF) },
+				// Right
+				{ D2D1::Point2F(rRightF, rTopF), D2D1::Point2F(rRightF + strokeSize, rTopF - strokeSize),
+					D2D1::Point2F(rRightF + strokeSize, rBottomF + strokeSize), D2D1::Point2F(rRightF, rBottomF) },
+				// Bottom
+				{ D2D1::Point2F(rLeftF, rBottomF), D2D1::Point2F(rLeftF - strokeSize, rBottomF + strokeSize),
+					D2D1::Point2F(rRightF + strokeSize, rBottomF + strokeSize), D2D1::Point2F(rRightF, rBottomF) },
+			};
+
+			HRESULT hr = S_OK;
+
+			for (int edge{ 0 }; edge < 4 && SUCCEEDED(hr); ++edge)
 			{
-				pSink->BeginFigure(D2D1::Point2F(rLeftF, rTopF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rTopF - strokeSize));
-				pSink->AddLine(D2D1::Point2F(rLeftF, rTopF - strokeSize));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				CComPtr<ID2D1GeometrySink> pSink{ nullptr };
+
+				m_apEdges[edge].Release();
+				hr = pFactory->CreatePathGeometry(&m_apEdges[edge]);
+
+				if (SUCCEEDED(hr))
+				{
+					hr = m_apEdges[edge]->Open(&pSink);
+				}
+
+				if (SUCCEEDED(hr))
+				{
+					pSink->BeginFigure(aEdgePoints[edge][0], D2D1_FIGURE_BEGIN_FILLED);
+					pSink->AddLines(&aEdgePoints[edge][1], 3);
+					pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+					hr = pSink->Close();
+				}
 			}
 
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			pRenderTarget->FillGeometry(pEdgeTriangleA, pTopEdgeBrush);
-			pRenderTarget->FillRectangle(edgeRectangle, pTopEdgeBrush);
-			pRenderTarget->FillGeometry(pEdgeTriangleB, pTopEdgeBrush);
-			pEdgeTriangleA.Release();
-			pEdgeTriangleB.Release();
-		}
-
-		// Next we draw the right border
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleA);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleA->Open(&pSink);
-
 			if (SUCCEEDED(hr))
 			{
-				pSink->BeginFigure(D2D1::Point2F(rRightF, rBottomF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rBottomF + strokeSize));
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rBottomF));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				m_boundingBox = boundingBox;
+				m_strokeSize = strokeSize;
 			}
-
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			edgeRectangle = D2D1::RectF(rRightF, rTopF, rRightF + strokeSize, rBottomF);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleB);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleB->Open(&pSink);
-
-			if (SUCCEEDED(hr))
+			else
 			{
-				pSink->BeginFigure(D2D1::Point2F(rRightF, rTopF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rTopF - strokeSize));
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rTopF));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				Release();
 			}
 
-			pSink.Release();
+			return hr;
 		}
 
-		if (SUCCEEDED(hr))
+		void Draw(ID2D1RenderTarget* pRenderTarget, ID2D1Brush* pLeftEdgeBrush, ID2D1Brush* pTopEdgeBrush,
+			ID2D1Brush* pRightEdgeBrush, ID2D1Brush* pBottomEdgeBrush) const
 		{
-			pRenderTarget->FillGeometry(pEdgeTriangleA, pRightEdgeBrush);
-			pRenderTarget->FillRectangle(edgeRectangle, pRightEdgeBrush);
-			pRenderTarget->FillGeometry(pEdgeTriangleB, pRightEdgeBrush);
-			pEdgeTriangleA.Release();
-			pEdgeTriangleB.Release();
-		}
-
-		// Finally we draw the bottom border
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleA);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleA->Open(&pSink);
-
-			if (SUCCEEDED(hr))
+			if (m_apEdges[0])
 			{
-				pSink->BeginFigure(D2D1::Point2F(rLeftF, rBottomF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rLeftF - strokeSize, rBottomF + strokeSize));
-				pSink->AddLine(D2D1::Point2F(rLeftF, rBottomF + strokeSize));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				pRenderTarget->FillGeometry(m_apEdges[0], pLeftEdgeBrush);
+				pRenderTarget->FillGeometry(m_apEdges[1], pTopEdgeBrush);
+				pRenderTarget->FillGeometry(m_apEdges[2], pRightEdgeBrush);
+				pRenderTarget->FillGeometry(m_apEdges[3], pBottomEdgeBrush);
 			}
-
-			pSink.Release();
 		}
 
-		if (SUCCEEDED(hr))
+		void Release()
 		{
-			edgeRectangle = D2D1::RectF(rLeftF, rBottomF, rRightF, rBottomF + strokeSize);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pFactory->CreatePathGeometry(&pEdgeTriangleB);
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			hr = pEdgeTriangleB->Open(&pSink);
-
-			if (SUCCEEDED(hr))
+			for (CComPtr<ID2D1PathGeometry>& pEdge : m_apEdges)
 			{
-				pSink->BeginFigure(D2D1::Point2F(rRightF, rBottomF), D2D1_FIGURE_BEGIN_FILLED);
-				pSink->AddLine(D2D1::Point2F(rRightF + strokeSize, rBottomF + strokeSize));
-				pSink->AddLine(D2D1::Point2F(rRightF, rBottomF + strokeSize));
-				pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-				pSink->Close();
+				pEdge.Release();
 			}
-
-			pSink.Release();
-		}
-
-		if (SUCCEEDED(hr))
-		{
-			pRenderTarget->FillGeometry(pEdgeTriangleA, pBottomEdgeBrush);
-			pRenderTarget->FillRectangle(edgeRectangle, pBottomEdgeBrush);
-			pRenderTarget->FillGeometry(pEdgeTriangleB, pBottomEdgeBrush);
-			pEdgeTriangleA.Release();
-			pEdgeTriangleB.Release();
 		}
 
-		return hr;
-	}
+	private:
+		RECT m_boundingBox{};
+		FLOAT m_strokeSize{ 0 };
+		CComPtr<ID2D1PathGeometry> m_apEdges[4]{};
+	};
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "BorderScene.h"
 
-#include "BorderHelper.h"
 #include "colors.h"
 #include "GameWindow.h"
 
@@ -20,26 +19,27 @@ HRESULT BorderScene::CreateDeviceIndependentResources()
 
 void BorderScene::DiscardDeviceIndependentResources()
 {
-
+	m_minefieldBorder.Release();
+	m_infoBarBorder.Release();
 }
 
 HRESULT BorderScene::CreateDeviceDependentResources()
 {
-	HRESULT	hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLightest)), &m_pTileEdgeLightestColorBrush);
+	HRESULT	hr = GetSolidColorBrush(colors::tileEdgeLightest, &m_pTileEdgeLightestColorBrush);
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLight)), &m_pTileEdgeLightColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeLight, &m_pTileEdgeLightColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDark)), &m_pTileEdgeDarkColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDark, &m_pTileEdgeDarkColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDarkest)), &m_pTileEdgeDarkestColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDarkest, &m_pTileEdgeDarkestColorBrush);
 	}
 
 	return hr;
@@ -53,20 +53,38 @@ void BorderScene::DiscardDeviceDependentResources()
 	m_pTileEdgeDarkestColorBrush.Release();
 }
 
+/*
+*	Builds the border geometry around the minefield and the
+*	info bar. The game window calls this whenever it moves
+*	either of them, so frames only draw prebuilt geometry.
+*/
 void BorderScene::CalculateLayout()
 {
+	const FLOAT strokeSize{ static_cast<FLOAT>(m_pGame->GetTileSize() / 16) };
 
+	m_minefieldBorder.Update(m_pGame->MinefieldBoundingBox(), strokeSize, m_pFactory);
+	m_infoBarBorder.Update(m_pGame->InfoBarBoundingBox(), strokeSize, m_pFactory);
 }
 
 void BorderScene::RenderScene()
 {
+	const FLOAT strokeSize{ static_cast<FLOAT>(m_pGame->GetTileSize() / 16) };
+	const RECT minefieldBoundingBox{ m_pGame->MinefieldBoundingBox() };
+	const RECT infoBarBoundingBox{ m_pGame->InfoBarBoundingBox() };
+
+	// Only happens if the layout changed without CalculateLayout being called.
+	if (m_minefieldBorder.NeedsUpdate(minefieldBoundingBox, strokeSize) || m_infoBarBorder.NeedsUpdate(infoBarBoundingBox, strokeSize))
+	{
+		TrackResourceCreation(L"border geometry");
+		m_minefieldBorder.Update(minefieldBoundingBox, strokeSize, m_pFactory);
+		m_infoBarBorder.Update(infoBarBoundingBox, strokeSize, m_pFactory);
+	}
+
 	m_pRenderTarget->Clear(D2D1::ColorF(RGBA(colors::tileBackground)));
 
-	BorderHelper::DrawBorder(m_pGame->MinefieldBoundingBox(), static_cast<FLOAT>(m_pGame->GetTileSize() / 16),
-		m_pFactory, m_pRenderTarget, m_pTileEdgeDarkColorBrush, m_pTileEdgeDarkestColorBrush,
+	m_minefieldBorder.Draw(m_pRenderTarget, m_pTileEdgeDarkColorBrush, m_pTileEdgeDarkestColorBrush,
 		m_pTileEdgeLightColorBrush, m_pTileEdgeLightestColorBrush);
 
-	BorderHelper::DrawBorder(m_pGame->InfoBarBoundingBox(), static_cast<FLOAT>(m_pGame->GetTileSize() / 16),
-		m_pFactory, m_pRenderTarget, m_pTileEdgeDarkColorBrush, m_pTileEdgeDarkestColorBrush,
+	m_infoBarBorder.Draw(m_pRenderTarget, m_pTileEdgeDarkColorBrush, m_pTileEdgeDarkestColorBrush,
 		m_pTileEdgeLightColorBrush, m_pTileEdgeLightestColorBrush);
 }
\ No newline at end of file
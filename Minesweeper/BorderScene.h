@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseScene.h"
+#include "BorderHelper.h"
 
 class GameWindow;
 
@@ -23,5 +24,8 @@ private:
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeLightColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeDarkColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeDarkestColorBrush{ nullptr };
+
+    BorderHelper::BorderGeometry m_minefieldBorder{};
+    BorderHelper::BorderGeometry m_infoBarBorder{};
 };
 
@@ -1,7 +1,5 @@
 #include "CounterScene.h"
 
-#include <string>
-
 #include "colors.h"
 #include "constants.h"
 
@@ -218,11 +216,11 @@ void CounterScene::DiscardDeviceIndependentResources()
 
 HRESULT CounterScene::CreateDeviceDependentResources()
 {
-	HRESULT	hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::digitLEDOff)), &m_pDigitLEDOffColorBrush);
+	HRESULT	hr = GetSolidColorBrush(colors::digitLEDOff, &m_pDigitLEDOffColorBrush);
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::digitLEDOn)), &m_pDigitLEDOnColorBrush);
+		hr = GetSolidColorBrush(colors::digitLEDOn, &m_pDigitLEDOnColorBrush);
 	}
 
 	return hr;
@@ -232,86 +230,150 @@ void CounterScene::DiscardDeviceDependentResources()
 {
 	m_pDigitLEDOffColorBrush.Release();
 	m_pDigitLEDOnColorBrush.Release();
+	m_pDigitAtlas.Release();
+	m_fAtlasHeight = 0;
 }
 
-void CounterScene::CalculateLayout() {}
+// The digits are as high as the counter, so they are drawn again whenever its height changes.
+void CounterScene::CalculateLayout()
+{
+	const FLOAT height{ m_pRenderTarget->GetSize().height };
 
+	if (height != m_fAtlasHeight)
+	{
+		BuildDigitAtlas(height);
+	}
+}
+
+/*
+*	Copies every digit from the atlas, falling back to
+*	filling the LEDs of each digit if it couldn't be built.
+*/
 void CounterScene::RenderScene()
 {
 	m_pRenderTarget->Clear(D2D1::ColorF(RGBA(colors::counterBackground)));
-	const D2D1_SIZE_F fSize{ m_pRenderTarget->GetSize() };
-
-	const D2D1_MATRIX_3X2_F scaleMatrix{ D2D1::Matrix3x2F::Scale(fSize.height, fSize.height) };
-	const D2D1_MATRIX_3X2_F translationMatrix{ D2D1::Matrix3x2F::Translation(fSize.height / 2, 0) };
-	D2D1_MATRIX_3X2_F currentTransformMatrix = scaleMatrix;
+	const FLOAT height{ m_pRenderTarget->GetSize().height };
 
-	for (int digit{ 0 }; digit < constants::COUNTER_SIZE; ++digit)
+	for (UINT position{ 0 }; position < constants::COUNTER_SIZE; ++position)
 	{
-		m_pRenderTarget->SetTransform(currentTransformMatrix);
+		const FLOAT left{ position * height / 2 };
 
-		for (int index{ 0 }; index < m_aDigitLEDs.size(); ++index)
+		if (m_pDigitAtlas)
+		{
+			const D2D1_RECT_F source{ AtlasRect(m_aDigits[position]) };
+			m_pRenderTarget->DrawBitmap(m_pDigitAtlas, D2D1::RectF(left, 0, left + source.right - source.left, height), 1.f,
+				D2D1_BITMAP_INTERPOLATION_MODE_LINEAR, source);
+		}
+		else
 		{
-			if (m_aDigitStates[digit] & 1 << index)
-			{
-				m_pRenderTarget->FillGeometry(m_aDigitLEDs[index], m_pDigitLEDOnColorBrush);
-			}
-			else
-			{
-				m_pRenderTarget->FillGeometry(m_aDigitLEDs[index], m_pDigitLEDOffColorBrush);
-			}
+			DrawDigit(m_pRenderTarget, m_aDigits[position], D2D1::Matrix3x2F::Scale(height, height) *
+				D2D1::Matrix3x2F::Translation(left, 0));
 		}
+	}
+}
 
-		currentTransformMatrix = currentTransformMatrix * translationMatrix;
+/*
+*	Works out the digits of count without formatting it, so
+*	the timer can be updated without allocating: digits are
+*	right aligned with leading zeros, a negative count starts
+*	with a minus and a count with more digits than the
+*	counter has is shown as all nines.
+*/
+void CounterScene::SetCounter(INT32 count)
+{
+	const UINT firstDigit{ count < 0 ? 1u : 0u };
+	UINT magnitude{ count < 0 ? 0u - static_cast<UINT>(count) : static_cast<UINT>(count) };
+	UINT limit{ 1 };
+
+	for (UINT position{ firstDigit }; position < constants::COUNTER_SIZE; ++position)
+	{
+		limit *= 10;
 	}
 
-	m_pRenderTarget->SetTransform(D2D1::IdentityMatrix());
+	const BOOL bOverflow{ magnitude >= limit };
+
+	for (UINT position{ constants::COUNTER_SIZE }; position-- > firstDigit;)
+	{
+		m_aDigits[position] = bOverflow ? 9 : magnitude % 10;
+		magnitude /= 10;
+	}
+
+	if (firstDigit)
+	{
+		m_aDigits[0] = DIGIT_MINUS;
+	}
 }
 
-void CounterScene::SetCounter(INT32 count)
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+/*
+*	Draws every digit once into a bitmap of DIGIT_COUNT cells,
+*	each height / 2 wide and separated by a gutter of one DIP
+*	of background, so that showing a new count only copies a
+*	few rectangles instead of filling seven geometries for
+*	every digit.
+*/
+HRESULT CounterScene::BuildDigitAtlas(FLOAT height)
 {
-	// Convert int to string for easier processing.
-	std::string countString{ std::to_string(count) };
-
-	/*
-	*	Initialize all digits to zero. Note that a 'digit' in
-	*	the array m_aDigitStates is a bit string 0b6543210
-	*	where the bit 'x' being on implies digit LED 'x' is on
-	*/
-	m_aDigitStates.fill(constants::DIGIT_STATES[0]);
-
-	/*
-	*	We check for a negative sign at position 0 in the
-	*	string. If one exists we set the first digit to '-'
-	*	and set the starting index to process the actual
-	*	number to 1 instead of the default value of 0
-	*/
-	int startingIndex{ 0 };
-	if (countString[0] == '-')
+	CComPtr<ID2D1BitmapRenderTarget> pAtlasRenderTarget{ nullptr };
+
+	m_pDigitAtlas.Release();
+	m_fAtlasHeight = 0;
+
+	HRESULT hr = (height >= 1) ? S_OK : E_INVALIDARG;
+
+	if (SUCCEEDED(hr))
 	{
-		m_aDigitStates[0] = constants::DIGIT_STATES[10];
-		startingIndex = 1;
+		m_fAtlasHeight = height;
+		hr = m_pRenderTarget->CreateCompatibleRenderTarget(D2D1::SizeF(AtlasRect(DIGIT_COUNT - 1).right + 1, height),
+			&pAtlasRenderTarget);
 	}
 
-	/*
-	*	If the length of the string is greater than the number
-	*	of displayable digits, then we must set all the
-	*	remaining digits to be 9. Otherwise we set the digit
-	*	at  sizeDifference + i to the digit at i in our	number
-	*/
-	if (countString.size() > m_aDigitStates.size())
+	if (SUCCEEDED(hr))
 	{
-		for (int index{ startingIndex }; index < m_aDigitStates.size(); ++index)
+		pAtlasRenderTarget->BeginDraw();
+		pAtlasRenderTarget->Clear(D2D1::ColorF(RGBA(colors::counterBackground)));
+
+		for (UINT digit{ 0 }; digit < DIGIT_COUNT; ++digit)
 		{
-			m_aDigitStates[index] = constants::DIGIT_STATES[9];
+			DrawDigit(pAtlasRenderTarget, digit, D2D1::Matrix3x2F::Scale(height, height) *
+				D2D1::Matrix3x2F::Translation(AtlasRect(digit).left, 0));
 		}
+
+		hr = pAtlasRenderTarget->EndDraw();
 	}
-	else
+
+	if (SUCCEEDED(hr))
 	{
-		size_t sizeDifference = m_aDigitStates.size() - countString.size();
+		hr = pAtlasRenderTarget->GetBitmap(&m_pDigitAtlas);
+	}
 
-		for (int index{ startingIndex }; index < countString.size(); ++index)
-		{
-			m_aDigitStates[sizeDifference + index] = constants::DIGIT_STATES[countString[index] - '0'];
-		}
+	return hr;
+}
+
+// Fills the LEDs of digit, an index into constants::DIGIT_STATES, drawn through transform.
+void CounterScene::DrawDigit(ID2D1RenderTarget* pTarget, UINT digit, const D2D1_MATRIX_3X2_F& transform)
+{
+	pTarget->SetTransform(transform);
+
+	for (UINT index{ 0 }; index < m_aDigitLEDs.size(); ++index)
+	{
+		const BOOL bOn{ (constants::DIGIT_STATES[digit] & 1 << index) != 0 };
+		pTarget->FillGeometry(m_aDigitLEDs[index], bOn ? m_pDigitLEDOnColorBrush : m_pDigitLEDOffColorBrush);
 	}
+
+	pTarget->SetTransform(D2D1::IdentityMatrix());
+}
+
+// Returns the DIPs of the atlas holding digit.
+D2D1_RECT_F CounterScene::AtlasRect(UINT digit) const
+{
+	const FLOAT width{ m_fAtlasHeight / 2 };
+	const FLOAT left{ 1 + digit * (width + 1) };
+
+	return D2D1::RectF(left, 0, left + width, m_fAtlasHeight);
 }
\ No newline at end of file
@@ -23,11 +23,22 @@ public:
     void SetCounter(INT32 count);
 
 private:
-    std::array<UINT, constants::COUNTER_SIZE> m_aDigitStates{};
+    // Index into constants::DIGIT_STATES of every digit shown, 0 to 9 or DIGIT_MINUS.
+    static constexpr UINT DIGIT_MINUS{ 10 };
+    static constexpr UINT DIGIT_COUNT{ 11 };
+    std::array<UINT, constants::COUNTER_SIZE> m_aDigits{};
     std::array<CComPtr<ID2D1PathGeometry>, 7> m_aDigitLEDs{};
 
     CComPtr<ID2D1SolidColorBrush> m_pBackgroundColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pDigitLEDOffColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pDigitLEDOnColorBrush{ nullptr };
+
+    // Every digit pre-rendered at the height of the counter, see BuildDigitAtlas.
+    CComPtr<ID2D1Bitmap> m_pDigitAtlas{ nullptr };
+    FLOAT m_fAtlasHeight{ 0 };
+
+    HRESULT BuildDigitAtlas(FLOAT height);
+    void    DrawDigit(ID2D1RenderTarget* pTarget, UINT digit, const D2D1_MATRIX_3X2_F& transform);
+    D2D1_RECT_F AtlasRect(UINT digit) const;
 };
 
@@ -68,5 +68,5 @@ LRESULT CounterWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 void CounterWindow::SetCounter(INT32 count)
 {
 	m_scene.SetCounter(count);
-	m_scene.Render();
+	m_scene.RequestRender();
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+#include <dwmapi.h>
+
+#include "BaseScene.h"
+
+#pragma comment(lib, "dwmapi")
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+FrameScheduler& FrameScheduler::Instance()
+{
+	static FrameScheduler scheduler{};
+	return scheduler;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	if (m_hFrameTimer)
+	{
+		CloseHandle(m_hFrameTimer);
+	}
+}
+
+/*
+*	Asks for a scene to be presented with the next frame.
+*	Requesting a scene that is already pending does nothing.
+*/
+void FrameScheduler::RequestFrame(BaseScene* pScene)
+{
+	// The message loop doesn't run while windows are moved or sized, so render right away.
+	if (m_bModalLoop)
+	{
+		pScene->Render();
+		return;
+	}
+
+	if (m_apPendingScenes.empty())
+	{
+		m_requestMessageTime = GetMessageTime();
+	}
+
+	if (std::find(m_apPendingScenes.begin(), m_apPendingScenes.end(), pScene) == m_apPendingScenes.end())
+	{
+		m_apPendingScenes.push_back(pScene);
+	}
+
+	if (!m_bTimerArmed)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		ArmTimer(now.QuadPart);
+	}
+}
+
+// Removes a scene from the next frame, e.g. because it was already drawn by WM_PAINT.
+void FrameScheduler::CancelFrame(BaseScene* pScene)
+{
+	m_apPendingScenes.erase(std::remove(m_apPendingScenes.begin(), m_apPendingScenes.end(), pScene),
+		m_apPendingScenes.end());
+}
+
+BOOL FrameScheduler::HasPendingFrames() const
+{
+	return !m_apPendingScenes.empty();
+}
+
+/*
+*	Presents every pending scene if the display has refreshed
+*	since the last frame. Called by the message loop once the
+*	message queue is empty, so all queued input has already
+*	been applied to the scenes.
+*/
+void FrameScheduler::PresentIfDue()
+{
+	if (m_apPendingScenes.empty())
+	{
+		return;
+	}
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	if (now.QuadPart < m_qpcNextFrame)
+	{
+		// Woken early by a message or by timer rounding, wait for the rest of the interval.
+		ArmTimer(now.QuadPart);
+		return;
+	}
+
+	PresentPending();
+	m_qpcNextFrame = NextVBlank(now.QuadPart);
+	m_bTimerArmed = FALSE;
+}
+
+/*
+*	Presents every pending scene right away. Used when a modal
+*	loop (a dialog box or menu) runs instead of the message
+*	loop and the pending scenes would otherwise never be drawn.
+*/
+void FrameScheduler::PresentPending()
+{
+	// Rendering a scene removes it from the list, so present from a copy.
+	const std::vector<BaseScene*> apScenes{ m_apPendingScenes };
+	m_apPendingScenes.clear();
+	m_presentMessageTime = m_requestMessageTime;
+	m_bPresenting = TRUE;
+
+	for (BaseScene* pScene : apScenes)
+	{
+		pScene->Render();
+	}
+
+	m_bPresenting = FALSE;
+}
+
+/*
+*	Set while the user moves or sizes the game window. The
+*	system runs its own message loop until they are done, so
+*	requested frames are rendered immediately instead.
+*/
+void FrameScheduler::SetModalLoop(BOOL bModal)
+{
+	m_bModalLoop = bModal;
+
+	if (m_bModalLoop)
+	{
+		PresentPending();
+	}
+}
+
+/*
+*	Handle the message loop should wait on together with the
+*	message queue. It is signaled when pending scenes are due
+*	to be presented.
+*/
+HANDLE FrameScheduler::GetWaitHandle() const
+{
+	return m_hFrameTimer;
+}
+
+/*
+*	Returns the GetMessageTime of the message a frame being
+*	rendered originates from: the first message that asked
+*	for the frame, or the message being handled if a scene is
+*	rendered right away, e.g. by WM_PAINT.
+*/
+DWORD FrameScheduler::GetFrameMessageTime() const
+{
+	return m_bPresenting ? m_presentMessageTime : GetMessageTime();
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+FrameScheduler::FrameScheduler()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_qpcFrequency = frequency.QuadPart;
+
+	// High resolution timers are only available on Windows 10 1803 and later.
+	m_hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!m_hFrameTimer)
+	{
+		m_hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}
+}
+
+/*
+*	Returns the performance counter value of the first vblank
+*	after now, using the composition timing reported by DWM.
+*	Falls back to a 60 Hz refresh if DWM has no timing info.
+*/
+LONGLONG FrameScheduler::NextVBlank(LONGLONG now) const
+{
+	DWM_TIMING_INFO timingInfo{};
+	timingInfo.cbSize = sizeof(timingInfo);
+
+	LONGLONG vBlank{ now };
+	LONGLONG period{ m_qpcFrequency / 60 };
+
+	if (SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &timingInfo)) && timingInfo.qpcRefreshPeriod > 0)
+	{
+		vBlank = static_cast<LONGLONG>(timingInfo.qpcVBlank);
+		period = static_cast<LONGLONG>(timingInfo.qpcRefreshPeriod);
+	}
+
+	if (vBlank <= now)
+	{
+		vBlank += ((now - vBlank) / period + 1) * period;
+	}
+
+	return vBlank;
+}
+
+// Makes the wait handle signal once the next frame is due.
+void FrameScheduler::ArmTimer(LONGLONG now)
+{
+	if (!m_hFrameTimer)
+	{
+		return;
+	}
+
+	// Relative due times are negative and measured in 100 ns units.
+	const LONGLONG remaining{ max(m_qpcNextFrame - now, 0) };
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -((remaining * 10000000 + m_qpcFrequency - 1) / m_qpcFrequency);
+
+	m_bTimerArmed = SetWaitableTimer(m_hFrameTimer, &dueTime, 0, nullptr, nullptr, FALSE);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+#include <Windows.h>
+
+class BaseScene;
+
+/*
+*	Coalesces render requests from every scene in the program.
+*	Input handlers only ask for a scene to be redrawn, the
+*	message loop then presents all of the requested scenes
+*	together at most once per display refresh, no matter how
+*	many messages arrived in between.
+*/
+class FrameScheduler
+{
+public:
+	static FrameScheduler& Instance();
+
+	~FrameScheduler();
+
+	void	RequestFrame(BaseScene* pScene);
+	void	CancelFrame(BaseScene* pScene);
+	BOOL	HasPendingFrames() const;
+	void	PresentIfDue();
+	void	PresentPending();
+	void	SetModalLoop(BOOL bModal);
+	HANDLE	GetWaitHandle() const;
+	DWORD	GetFrameMessageTime() const;
+
+private:
+	FrameScheduler();
+	FrameScheduler(const FrameScheduler&) = delete;
+	FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+	LONGLONG	NextVBlank(LONGLONG now) const;
+	void		ArmTimer(LONGLONG now);
+
+	std::vector<BaseScene*> m_apPendingScenes{};
+	HANDLE m_hFrameTimer{ nullptr };
+	LONGLONG m_qpcFrequency{ 0 };
+	LONGLONG m_qpcNextFrame{ 0 };
+	BOOL m_bTimerArmed{ FALSE };
+	BOOL m_bModalLoop{ FALSE };
+	DWORD m_requestMessageTime{ 0 };				// Message time of the first request of the next frame.
+	DWORD m_presentMessageTime{ 0 };				// Message time of the first request of the frame presented.
+	BOOL m_bPresenting{ FALSE };
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+/*
+*	The durations of the last frames of a scene, in
+*	milliseconds, for showing their percentiles. Old frames
+*	are overwritten once COUNT frames were added.
+*/
+class FrameTimes
+{
+public:
+	static constexpr std::size_t COUNT{ 240 };
+
+	void Add(float milliseconds)
+	{
+		m_aTimes[m_next] = milliseconds;
+		m_next = (m_next + 1) % COUNT;
+		m_cTimes = std::min(m_cTimes + 1, COUNT);
+	}
+
+	std::size_t GetCount() const { return m_cTimes; }
+
+	// Returns the time percentile of the frames took at most, e.g. 0.99 for p99, or 0 without frames.
+	float GetPercentile(float percentile) const
+	{
+		if (m_cTimes == 0)
+		{
+			return 0;
+		}
+
+		std::array<float, COUNT> aSorted{ m_aTimes };
+		const std::size_t rank{ std::min(static_cast<std::size_t>(percentile * m_cTimes), m_cTimes - 1) };
+
+		std::nth_element(aSorted.begin(), aSorted.begin() + rank, aSorted.begin() + m_cTimes);
+		return aSorted[rank];
+	}
+
+private:
+	std::array<float, COUNT> m_aTimes{};
+	std::size_t m_next{ 0 };
+	std::size_t m_cTimes{ 0 };
+};
\ No newline at end of file
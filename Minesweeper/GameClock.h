@@ -0,0 +1,73 @@
+#pragma once
+#include <Windows.h>
+
+/*
+*	Measures how long a game has been played with the
+*	performance counter. The time is read from the counter
+*	whenever it is asked for instead of being counted up by a
+*	timer, so it doesn't drift however late the display gets
+*	updated and results are exact to the millisecond.
+*/
+class GameClock
+{
+public:
+	GameClock()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		m_qpcFrequency = frequency.QuadPart;
+	}
+
+	void Start()
+	{
+		if (!m_bRunning)
+		{
+			m_qpcStart = Now();
+			m_bRunning = TRUE;
+		}
+	}
+
+	void Stop()
+	{
+		if (m_bRunning)
+		{
+			m_elapsedTicks += Now() - m_qpcStart;
+			m_bRunning = FALSE;
+		}
+	}
+
+	// Stops the clock at 0.
+	void Reset()
+	{
+		m_bRunning = FALSE;
+		m_elapsedTicks = 0;
+	}
+
+	// Sets the time played so far, e.g. of a game continued from a save, without starting or stopping the clock.
+	void SetElapsedMilliseconds(LONGLONG milliseconds)
+	{
+		m_elapsedTicks = milliseconds * m_qpcFrequency / 1000;
+		m_qpcStart = Now();
+	}
+
+	LONGLONG GetElapsedMilliseconds() const
+	{
+		const LONGLONG ticks{ m_elapsedTicks + (m_bRunning ? Now() - m_qpcStart : 0) };
+		return ticks * 1000 / m_qpcFrequency;
+	}
+
+	BOOL IsRunning() const { return m_bRunning; }
+
+private:
+	LONGLONG m_qpcFrequency{ 1 };
+	LONGLONG m_qpcStart{ 0 };				// Counter value the clock was last started at.
+	LONGLONG m_elapsedTicks{ 0 };			// Counter ticks played before the last start.
+	BOOL m_bRunning{ FALSE };
+
+	static LONGLONG Now()
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		return now.QuadPart;
+	}
+};
\ No newline at end of file
@@ -85,18 +85,38 @@ void GameInfoBarWindow::SetFlagCounter(INT32 count)
 
 void GameInfoBarWindow::StartTimer() 
 {
-	m_bTimerRunning = TRUE;
+	m_clock.Start();
+	ScheduleTimerUpdate();
 }
 
 void GameInfoBarWindow::StopTimer() 
 {
-	m_bTimerRunning = FALSE; 
+	m_clock.Stop();
+	UpdateTimerCounter();
 }
 
 void GameInfoBarWindow::ResetTimer()
 {
-	m_iElapsedTime = 0;
-	m_timerCounter.SetCounter(0);
+	m_clock.Reset();
+	UpdateTimerCounter();
+}
+
+// Returns the whole seconds played, as the timer shows them.
+INT32 GameInfoBarWindow::GetElapsedTime() const
+{
+	return static_cast<INT32>(m_clock.GetElapsedMilliseconds() / 1000);
+}
+
+LONGLONG GameInfoBarWindow::GetElapsedMilliseconds() const
+{
+	return m_clock.GetElapsedMilliseconds();
+}
+
+void GameInfoBarWindow::SetElapsedMilliseconds(LONGLONG milliseconds)
+{
+	m_clock.SetElapsedMilliseconds(milliseconds);
+	UpdateTimerCounter();
+	ScheduleTimerUpdate();
 }
 
 void GameInfoBarWindow::ToggleDebug()
@@ -114,6 +134,45 @@ void GameInfoBarWindow::SetCurrentTileContent(TileContent content)
 	m_smile.SetCurrentTileContent(content);
 }
 
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+void GameInfoBarWindow::UpdateTimerCounter()
+{
+	m_timerCounter.SetCounter(GetElapsedTime());
+}
+
+/*
+*	Arms the waitable timer for the moment the seconds of the
+*	clock tick over, so the display follows the clock rather
+*	than counting ticks of its own. Unlike WM_TIMER the
+*	message it results in is posted, which neither gets
+*	coalesced nor waits behind every other message.
+*/
+void GameInfoBarWindow::ScheduleTimerUpdate()
+{
+	if (!m_hTimerDue || !m_clock.IsRunning())
+	{
+		return;
+	}
+
+	// Relative due times are negative and measured in 100 ns units.
+	const LONGLONG remaining{ 1000 - m_clock.GetElapsedMilliseconds() % 1000 };
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -remaining * 10000;
+
+	SetWaitableTimer(m_hTimerDue, &dueTime, 0, nullptr, nullptr, FALSE);
+}
+
+// Runs on a thread pool thread when the timer is due.
+VOID CALLBACK GameInfoBarWindow::OnTimerDue(PVOID pContext, BOOLEAN)
+{
+	PostMessage(static_cast<GameInfoBarWindow*>(pContext)->Window(), WM_TIMER_DUE, 0, 0);
+}
+
 /*
 *	============================
 *	===== Window Procedure =====
@@ -150,7 +209,8 @@ LRESULT GameInfoBarWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam
 			return -1;
 		}
 
-		if (m_pTimer = SetTimer(m_hWnd, 1, 1000, nullptr); !m_pTimer)
+		m_hTimerDue = CreateWaitableTimer(nullptr, FALSE, nullptr);
+		if (!m_hTimerDue || !RegisterWaitForSingleObject(&m_hTimerWait, m_hTimerDue, OnTimerDue, this, INFINITE, WT_EXECUTEDEFAULT))
 		{
 			return -1;
 		}
@@ -158,7 +218,17 @@ LRESULT GameInfoBarWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam
 	return 0;
 
 	case WM_DESTROY:
-		KillTimer(m_hWnd, m_pTimer);
+		// Waits for a callback that is running, nothing is posted to the window afterwards.
+		if (m_hTimerWait)
+		{
+			UnregisterWaitEx(m_hTimerWait, INVALID_HANDLE_VALUE);
+			m_hTimerWait = nullptr;
+		}
+		if (m_hTimerDue)
+		{
+			CloseHandle(m_hTimerDue);
+			m_hTimerDue = nullptr;
+		}
 		PostQuitMessage(0);
 		return 0;
 
@@ -179,11 +249,9 @@ LRESULT GameInfoBarWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam
 	}
 	return 0;
 
-	case WM_TIMER:
-		if (m_bTimerRunning)
-		{
-			m_timerCounter.SetCounter(++m_iElapsedTime);
-		}
+	case WM_TIMER_DUE:
+		UpdateTimerCounter();
+		ScheduleTimerUpdate();
 		return 0;
 
 	case WM_SIZE:
@@ -7,6 +7,7 @@
 
 #include "colors.h"
 #include "enums.h"
+#include "GameClock.h"
 
 class GameWindow;
 
@@ -24,6 +25,9 @@ public:
 	void StartTimer();
 	void StopTimer();
 	void ResetTimer();
+	INT32 GetElapsedTime() const;
+	LONGLONG GetElapsedMilliseconds() const;
+	void SetElapsedMilliseconds(LONGLONG milliseconds);
 	void ToggleDebug();
 	void SetSmileState(SmileState state);
 	void SetCurrentTileContent(TileContent content);
@@ -31,14 +35,21 @@ public:
 private:
 	std::unique_ptr<WCHAR[]> m_lpszClassName{ nullptr };
 	GameWindow* m_pGameWindow{ nullptr };
-	UINT_PTR m_pTimer{};
-	BOOL m_bTimerRunning{};
 	BOOL m_bFirstDraw{ TRUE };
-	INT32 m_iElapsedTime{};
+	GameClock m_clock{};
+	HANDLE m_hTimerDue{ nullptr };					// Waitable timer signaled when the shown seconds change.
+	HANDLE m_hTimerWait{ nullptr };					// Thread pool wait posting WM_TIMER_DUE for it.
 	CounterWindow m_flagCounter{};
 	CounterWindow m_timerCounter{};
 	SmileWindow m_smile{};
 
+	// Posted to the window from the thread pool, see ScheduleTimerUpdate.
+	static constexpr UINT WM_TIMER_DUE{ WM_APP };
+
+	void UpdateTimerCounter();
+	void ScheduleTimerUpdate();
+	static VOID CALLBACK OnTimerDue(PVOID pContext, BOOLEAN bTimedOut);
+
 public:
 	LPCTSTR ClassName() const
 	{
@@ -61,20 +61,25 @@ INT_PTR CALLBACK GameOptionsDialog::HandleMessage(UINT uMsg, WPARAM wParam, LPAR
 			CheckDlgButton(m_hDlg, IDC_CHECK_QMARKS, BST_CHECKED);
 		}
 
+		if (m_bNoGuessingEnabled)
+		{
+			CheckDlgButton(m_hDlg, IDC_CHECK_NOGUESS, BST_CHECKED);
+		}
+
 		InitDifficultyList();
 		SendDlgItemMessage(m_hDlg, IDC_DROPLIST_GAME_DIFFICULTY, CB_SETCURSEL, m_uCurrentDifficultyIndex, 0);
 
 		std::wstring szTemp{ std::to_wstring(m_uCurrentWidth) };
 		SendDlgItemMessage(m_hDlg, IDC_EDIT_WIDTH, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(szTemp.data()));
-		SendDlgItemMessage(m_hDlg, IDC_EDIT_WIDTH, EM_SETLIMITTEXT, 2, 0);
+		SendDlgItemMessage(m_hDlg, IDC_EDIT_WIDTH, EM_SETLIMITTEXT, constants::MAX_FIELD_DIMENSION_DIGITS, 0);
 
 		szTemp = std::to_wstring(m_uCurrentHeight);
 		SendDlgItemMessage(m_hDlg, IDC_EDIT_HEIGHT, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(szTemp.data()));
-		SendDlgItemMessage(m_hDlg, IDC_EDIT_HEIGHT, EM_SETLIMITTEXT, 2, 0);
+		SendDlgItemMessage(m_hDlg, IDC_EDIT_HEIGHT, EM_SETLIMITTEXT, constants::MAX_FIELD_DIMENSION_DIGITS, 0);
 
 		szTemp = std::to_wstring(m_uCurrentMines);
 		SendDlgItemMessage(m_hDlg, IDC_EDIT_MINES, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(szTemp.data()));
-		SendDlgItemMessage(m_hDlg, IDC_EDIT_MINES, EM_SETLIMITTEXT, 4, 0);
+		SendDlgItemMessage(m_hDlg, IDC_EDIT_MINES, EM_SETLIMITTEXT, constants::MAX_MINES_DIGITS, 0);
 
 		if (m_uCurrentDifficultyIndex == 3)
 		{
@@ -98,11 +103,18 @@ INT_PTR CALLBACK GameOptionsDialog::HandleMessage(UINT uMsg, WPARAM wParam, LPAR
 				m_pGameWindow->ToggleQuestionMarkUsage();
 			}
 
+			if (UINT noGuessChecked{ IsDlgButtonChecked(m_hDlg, IDC_CHECK_NOGUESS) };
+				m_bNoGuessingEnabled != noGuessChecked)
+			{
+				m_bNoGuessingEnabled = noGuessChecked;
+				m_pGameWindow->SetNoGuessing(m_bNoGuessingEnabled);
+			}
+
 			m_uCurrentDifficultyIndex = SendDlgItemMessage(m_hDlg, IDC_DROPLIST_GAME_DIFFICULTY, CB_GETCURSEL, 0, 0);
 
-			WCHAR szTemp[5]{};
+			WCHAR szTemp[constants::MAX_MINES_DIGITS + 1]{};
 
-			SendDlgItemMessage(m_hDlg, IDC_EDIT_WIDTH, WM_GETTEXT, 5, reinterpret_cast<LPARAM>(szTemp));
+			SendDlgItemMessage(m_hDlg, IDC_EDIT_WIDTH, WM_GETTEXT, sizeof(szTemp) / sizeof(WCHAR), reinterpret_cast<LPARAM>(szTemp));
 			m_uCurrentWidth = static_cast<UINT>(std::stoul(szTemp));
 
 			if (m_uCurrentWidth > constants::MAX_FIELD_DIMENSION)
@@ -114,7 +126,7 @@ INT_PTR CALLBACK GameOptionsDialog::HandleMessage(UINT uMsg, WPARAM wParam, LPAR
 				m_uCurrentWidth = 7;
 			}
 
-			SendDlgItemMessage(m_hDlg, IDC_EDIT_HEIGHT, WM_GETTEXT, 5, reinterpret_cast<LPARAM>(szTemp));
+			SendDlgItemMessage(m_hDlg, IDC_EDIT_HEIGHT, WM_GETTEXT, sizeof(szTemp) / sizeof(WCHAR), reinterpret_cast<LPARAM>(szTemp));
 			m_uCurrentHeight = static_cast<UINT>(std::stoul(szTemp));
 
 			if (m_uCurrentHeight > constants::MAX_FIELD_DIMENSION)
@@ -126,7 +138,7 @@ INT_PTR CALLBACK GameOptionsDialog::HandleMessage(UINT uMsg, WPARAM wParam, LPAR
 				m_uCurrentHeight = 1;
 			}
 
-			SendDlgItemMessage(m_hDlg, IDC_EDIT_MINES, WM_GETTEXT, 5, reinterpret_cast<LPARAM>(szTemp));
+			SendDlgItemMessage(m_hDlg, IDC_EDIT_MINES, WM_GETTEXT, sizeof(szTemp) / sizeof(WCHAR), reinterpret_cast<LPARAM>(szTemp));
 			m_uCurrentMines = static_cast<UINT>(std::stoul(szTemp));
 
 			if (m_uCurrentWidth * m_uCurrentHeight <= m_uCurrentMines)
@@ -15,6 +15,7 @@ public:
 private:
 	GameWindow* m_pGameWindow{ nullptr };
 	BOOL m_bQuestionMarksEnabled{ FALSE };
+	BOOL m_bNoGuessingEnabled{ FALSE };
 	LRESULT m_uCurrentDifficultyIndex{ 0 };
 	UINT m_uCurrentWidth{ constants::BEGINNER_WIDTH };
 	UINT m_uCurrentHeight{ constants::BEGINNER_HEIGHT };
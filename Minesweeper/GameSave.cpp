@@ -0,0 +1,211 @@
+#include "GameSave.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "constants.h"
+#include "MinefieldEngine.h"
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+// Saves the game of engine to szPath, replacing the file. Returns FALSE if the file could not be written.
+BOOL GameSave::Save(LPCWSTR szPath, const MinefieldEngine& engine, LONGLONG elapsedMilliseconds)
+{
+	const TileBoard& board{ engine.GetBoard() };
+	const MinefieldEngine::GameState state{ engine.GetGameState() };
+	std::vector<ChunkEntry> aEntries(board.GetChunkCount());
+	std::uint64_t cBytes{ sizeof(Header) + aEntries.size() * sizeof(ChunkEntry) };
+
+	for (std::uint32_t chunk{ 0 }; chunk < board.GetChunkCount(); ++chunk)
+	{
+		const TileBoard::ChunkPlanes planes{ board.GetChunkPlanes(chunk) };
+		ChunkEntry& entry{ aEntries[chunk] };
+
+		entry.planes = static_cast<std::uint8_t>((planes.pMines ? PLANE_MINES : 0) | (planes.pCounts ? PLANE_COUNTS : 0) |
+			(planes.pStates ? PLANE_STATES : 0) | (planes.pMarks ? PLANE_MARKS : 0));
+		entry.uniformState = static_cast<std::uint8_t>(planes.uniformState);
+		entry.cRevealed = planes.cRevealed;
+		entry.offset = cBytes;
+		cBytes += GetPlanesSize(entry.planes);
+	}
+
+	const HANDLE hFile{ CreateFile(szPath, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	const HANDLE hMapping{ CreateFileMapping(hFile, nullptr, PAGE_READWRITE, static_cast<DWORD>(cBytes >> 32), static_cast<DWORD>(cBytes), nullptr) };
+	std::uint8_t* pView{ hMapping ? static_cast<std::uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, 0)) : nullptr };
+
+	if (pView)
+	{
+		const Header header{ MAGIC, FORMAT_VERSION, state.width, state.height, state.cMines, state.cRevealedTiles, state.cFlaggedTiles,
+			(state.bGameLost ? FLAG_GAME_LOST : 0) | (state.bQuestionMarksEnabled ? FLAG_QUESTION_MARKS : 0) | (state.bMinesPlaced ? FLAG_MINES_PLACED : 0),
+			state.gameSeed, static_cast<std::uint64_t>(elapsedMilliseconds), board.GetChunkCount() };
+
+		std::memcpy(pView, &header, sizeof(Header));
+		std::memcpy(pView + sizeof(Header), aEntries.data(), aEntries.size() * sizeof(ChunkEntry));
+
+		for (std::uint32_t chunk{ 0 }; chunk < board.GetChunkCount(); ++chunk)
+		{
+			const TileBoard::ChunkPlanes planes{ board.GetChunkPlanes(chunk) };
+			std::uint8_t* pNext{ pView + aEntries[chunk].offset };
+
+			const auto copy{ [&pNext](const void* pPlane, std::size_t cPlaneBytes)
+			{
+				if (pPlane)
+				{
+					std::memcpy(pNext, pPlane, cPlaneBytes);
+					pNext += cPlaneBytes;
+				}
+			} };
+
+			copy(planes.pMines, TileBoard::MINE_PLANE_BYTES);
+			copy(planes.pCounts, TileBoard::COUNT_PLANE_BYTES);
+			copy(planes.pStates, TileBoard::STATE_PLANE_BYTES);
+			copy(planes.pMarks, TileBoard::MARK_PLANE_BYTES);
+		}
+
+		UnmapViewOfFile(pView);
+	}
+
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+	}
+
+	CloseHandle(hFile);
+
+	if (!pView)
+	{
+		DeleteFile(szPath);
+	}
+
+	return pView != nullptr;
+}
+
+/*
+*	Continues the game saved in szPath on engine and returns
+*	the milliseconds it had been played for in elapsedMilliseconds.
+*	Returns FALSE, leaving engine as it is, if the file can't
+*	be mapped or is not a valid save.
+*/
+BOOL GameSave::Load(LPCWSTR szPath, MinefieldEngine& engine, LONGLONG& elapsedMilliseconds)
+{
+	const HANDLE hFile{ CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize{};
+	const HANDLE hMapping{ GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(Header)) ?
+		CreateFileMapping(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr };
+	void* pView{ hMapping ? MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0) : nullptr };
+
+	// The view keeps the file mapped on its own.
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+	}
+
+	CloseHandle(hFile);
+
+	if (!pView)
+	{
+		return FALSE;
+	}
+
+	const std::shared_ptr<void> pStorage{ pView, [](void* pMappedView) { UnmapViewOfFile(pMappedView); } };
+	std::uint8_t* pBytes{ static_cast<std::uint8_t*>(pView) };
+	const std::uint64_t cBytes{ static_cast<std::uint64_t>(fileSize.QuadPart) };
+	Header header{};
+	std::memcpy(&header, pBytes, sizeof(Header));
+
+	if (header.magic != MAGIC || header.version != FORMAT_VERSION || header.width == 0 || header.height == 0 ||
+		header.width > constants::MAX_FIELD_DIMENSION || header.height > constants::MAX_FIELD_DIMENSION)
+	{
+		return FALSE;
+	}
+
+	TileBoard board{ header.width, header.height };
+	const std::uint64_t dataOffset{ sizeof(Header) + static_cast<std::uint64_t>(board.GetChunkCount()) * sizeof(ChunkEntry) };
+
+	if (header.cChunks != board.GetChunkCount() || dataOffset > cBytes || header.cRevealedTiles > board.GetSize() ||
+		header.cFlaggedTiles > board.GetSize())
+	{
+		return FALSE;
+	}
+
+	for (std::uint32_t chunk{ 0 }; chunk < board.GetChunkCount(); ++chunk)
+	{
+		ChunkEntry entry{};
+		std::memcpy(&entry, pBytes + sizeof(Header) + chunk * sizeof(ChunkEntry), sizeof(ChunkEntry));
+
+		// The planes must lie inside the file, aligned for the 64 bit rows of the mine plane.
+		if ((entry.planes & ~(PLANE_MINES | PLANE_COUNTS | PLANE_STATES | PLANE_MARKS)) ||
+			entry.uniformState > static_cast<std::uint8_t>(TileState::REVEALED) || entry.cRevealed > TileBoard::CHUNK_TILES ||
+			entry.offset < dataOffset || entry.offset % alignof(std::uint64_t) != 0 || entry.offset > cBytes ||
+			GetPlanesSize(entry.planes) > cBytes - entry.offset)
+		{
+			return FALSE;
+		}
+
+		TileBoard::ChunkPlanes planes{};
+		std::uint8_t* pNext{ pBytes + entry.offset };
+
+		const auto take{ [&pNext, &entry](std::uint8_t plane, std::size_t cPlaneBytes)
+		{
+			std::uint8_t* pPlane{ (entry.planes & plane) ? pNext : nullptr };
+			pNext += pPlane ? cPlaneBytes : 0;
+			return pPlane;
+		} };
+
+		planes.pMines = reinterpret_cast<std::uint64_t*>(take(PLANE_MINES, TileBoard::MINE_PLANE_BYTES));
+		planes.pCounts = take(PLANE_COUNTS, TileBoard::COUNT_PLANE_BYTES);
+		planes.pStates = take(PLANE_STATES, TileBoard::STATE_PLANE_BYTES);
+		planes.pMarks = take(PLANE_MARKS, TileBoard::MARK_PLANE_BYTES);
+		planes.uniformState = static_cast<TileState>(entry.uniformState);
+		planes.cRevealed = entry.cRevealed;
+		board.AdoptChunkPlanes(chunk, planes);
+	}
+
+	board.SetStorage(pStorage);
+
+	MinefieldEngine::GameState state{};
+	state.width = header.width;
+	state.height = header.height;
+	state.cMines = header.cMines;
+	state.cRevealedTiles = header.cRevealedTiles;
+	state.cFlaggedTiles = header.cFlaggedTiles;
+	state.gameSeed = header.gameSeed;
+	state.bGameLost = (header.flags & FLAG_GAME_LOST) != 0;
+	state.bQuestionMarksEnabled = (header.flags & FLAG_QUESTION_MARKS) != 0;
+	state.bMinesPlaced = (header.flags & FLAG_MINES_PLACED) != 0;
+
+	engine.RestoreGame(state, std::move(board));
+	elapsedMilliseconds = static_cast<LONGLONG>(header.elapsedMilliseconds);
+
+	return TRUE;
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+// Returns the bytes the planes of a chunk entry take in the file.
+std::size_t GameSave::GetPlanesSize(std::uint8_t planes)
+{
+	return ((planes & PLANE_MINES) ? TileBoard::MINE_PLANE_BYTES : 0) + ((planes & PLANE_COUNTS) ? TileBoard::COUNT_PLANE_BYTES : 0) +
+		((planes & PLANE_STATES) ? TileBoard::STATE_PLANE_BYTES : 0) + ((planes & PLANE_MARKS) ? TileBoard::MARK_PLANE_BYTES : 0);
+}
\ No newline at end of file
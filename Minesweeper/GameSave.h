@@ -0,0 +1,73 @@
+#pragma once
+#include <Windows.h>
+
+#include <cstdint>
+
+#include "TileBoard.h"
+
+class MinefieldEngine;
+
+/*
+*	Saves games into files holding the planes of the board
+*	the way the TileBoard lays them out in memory:
+*		Header
+*		ChunkEntry of every chunk, in chunk order
+*		the planes of every chunk, in chunk order
+*	A plane the chunk has not allocated takes no space, so
+*	hidden regions without mines, and revealed regions that
+*	dropped their state and mark planes, cost nothing but
+*	their chunk entry.
+*
+*	Saving copies the planes into a mapped view of the file.
+*	Loading maps a copy-on-write view of the file and points
+*	the chunks at their planes inside of it, so a save loads
+*	in the time it takes to check the chunk entries, however
+*	large the board is. A chunk's planes are paged in once
+*	it is accessed, e.g. when it scrolls into view, and the
+*	file is left unchanged by the game played on from it.
+*/
+class GameSave
+{
+public:
+	static BOOL Save(LPCWSTR szPath, const MinefieldEngine& engine, LONGLONG elapsedMilliseconds);
+	static BOOL Load(LPCWSTR szPath, MinefieldEngine& engine, LONGLONG& elapsedMilliseconds);
+
+private:
+	static constexpr std::uint32_t MAGIC{ 0x5653534D };				// "MSSV" in little endian.
+	static constexpr std::uint32_t FORMAT_VERSION{ 2 };
+	static constexpr std::uint32_t FLAG_GAME_LOST{ 1 << 0 };
+	static constexpr std::uint32_t FLAG_QUESTION_MARKS{ 1 << 1 };
+	static constexpr std::uint32_t FLAG_MINES_PLACED{ 1 << 2 };
+
+	// Bits of ChunkEntry::planes, the planes of a chunk are stored in this order.
+	static constexpr std::uint8_t PLANE_MINES{ 1 << 0 };
+	static constexpr std::uint8_t PLANE_COUNTS{ 1 << 1 };
+	static constexpr std::uint8_t PLANE_STATES{ 1 << 2 };
+	static constexpr std::uint8_t PLANE_MARKS{ 1 << 3 };
+
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t cMines;
+		std::uint32_t cRevealedTiles;
+		std::uint32_t cFlaggedTiles;
+		std::uint32_t flags;
+		std::uint64_t gameSeed;
+		std::uint64_t elapsedMilliseconds;
+		std::uint32_t cChunks;
+	};
+
+	struct ChunkEntry
+	{
+		std::uint8_t planes;
+		std::uint8_t uniformState;									// State of every tile without a state plane.
+		std::uint16_t reserved;
+		std::uint32_t cRevealed;
+		std::uint64_t offset;										// Of the first plane from the start of the file.
+	};
+
+	static std::size_t GetPlanesSize(std::uint8_t planes);
+};
\ No newline at end of file
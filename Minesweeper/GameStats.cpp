@@ -0,0 +1,195 @@
+#include "GameStats.h"
+
+#include <ShlObj.h>
+
+#include <algorithm>
+#include <cstring>
+
+#pragma comment(lib, "ole32")
+#pragma comment(lib, "shell32")
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+/*
+*	Appends record to the statistics file, creating it if
+*	there is none. A record left incomplete by an earlier
+*	write is overwritten, so the records stay aligned.
+*/
+BOOL GameStats::Add(const Record& record)
+{
+	if (m_bLoaded)
+	{
+		Accumulate(record);
+	}
+
+	const std::wstring szPath{ GetPath(TRUE) };
+	const HANDLE hFile{ szPath.empty() ? INVALID_HANDLE_VALUE :
+		CreateFile(szPath.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize{};
+	BOOL bWritten{ GetFileSizeEx(hFile, &fileSize) };
+
+	if (bWritten)
+	{
+		const LONGLONG cRecordBytes{ fileSize.QuadPart - static_cast<LONGLONG>(sizeof(Header)) };
+		std::uint8_t aBytes[sizeof(Header) + sizeof(Record)]{};
+		DWORD cBytes{ 0 };
+		LARGE_INTEGER end{};
+
+		if (cRecordBytes < 0)
+		{
+			const Header header{ MAGIC, FORMAT_VERSION };
+			std::memcpy(aBytes, &header, sizeof(Header));
+			cBytes += sizeof(Header);
+		}
+		else
+		{
+			end.QuadPart = sizeof(Header) + cRecordBytes - cRecordBytes % static_cast<LONGLONG>(sizeof(Record));
+		}
+
+		std::memcpy(aBytes + cBytes, &record, sizeof(Record));
+		cBytes += sizeof(Record);
+
+		DWORD cWritten{ 0 };
+		bWritten = SetFilePointerEx(hFile, end, nullptr, FILE_BEGIN) && WriteFile(hFile, aBytes, cBytes, &cWritten, nullptr) &&
+			cWritten == cBytes && SetEndOfFile(hFile);
+	}
+
+	CloseHandle(hFile);
+
+	return bWritten;
+}
+
+const std::vector<GameStats::Summary>& GameStats::GetSummaries()
+{
+	if (!m_bLoaded)
+	{
+		Load();
+	}
+
+	return m_aSummaries;
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+// Returns the path of the statistics file, or an empty string if there is no local application data folder.
+std::wstring GameStats::GetPath(BOOL bCreateFolder)
+{
+	PWSTR pszAppData{ nullptr };
+	std::wstring szPath{};
+
+	if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_DEFAULT, nullptr, &pszAppData)))
+	{
+		szPath = std::wstring{ pszAppData } + L"\\Minesweeper";
+
+		if (bCreateFolder)
+		{
+			CreateDirectory(szPath.c_str(), nullptr);
+		}
+
+		szPath += L"\\Statistics.bin";
+	}
+
+	CoTaskMemFree(pszAppData);
+
+	return szPath;
+}
+
+// Reads every record of the statistics file in one read and sums them up, a missing or invalid file has no games.
+void GameStats::Load()
+{
+	m_bLoaded = TRUE;
+	m_aSummaries.clear();
+
+	const std::wstring szPath{ GetPath(FALSE) };
+	const HANDLE hFile{ szPath.empty() ? INVALID_HANDLE_VALUE :
+		CreateFile(szPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER fileSize{};
+	std::vector<std::uint8_t> aBytes{};
+	DWORD cRead{ 0 };
+
+	if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(Header)) && fileSize.QuadPart <= MAXDWORD)
+	{
+		aBytes.resize(static_cast<std::size_t>(fileSize.QuadPart));
+
+		if (!ReadFile(hFile, aBytes.data(), static_cast<DWORD>(aBytes.size()), &cRead, nullptr))
+		{
+			cRead = 0;
+		}
+	}
+
+	CloseHandle(hFile);
+
+	Header header{};
+
+	if (cRead < sizeof(Header))
+	{
+		return;
+	}
+
+	std::memcpy(&header, aBytes.data(), sizeof(Header));
+
+	if (header.magic != MAGIC || header.version != FORMAT_VERSION)
+	{
+		return;
+	}
+
+	for (std::size_t offset{ sizeof(Header) }; offset + sizeof(Record) <= cRead; offset += sizeof(Record))
+	{
+		Record record{};
+		std::memcpy(&record, aBytes.data() + offset, sizeof(Record));
+		Accumulate(record);
+	}
+}
+
+// Adds record to the summary of its board size. There are only a few sizes, so they are searched in order.
+void GameStats::Accumulate(const Record& record)
+{
+	auto summary{ std::find_if(m_aSummaries.begin(), m_aSummaries.end(), [&record](const Summary& other)
+	{
+		return other.width == record.width && other.height == record.height && other.cMines == record.cMines;
+	}) };
+
+	if (summary == m_aSummaries.end())
+	{
+		Summary newSummary{};
+		newSummary.width = record.width;
+		newSummary.height = record.height;
+		newSummary.cMines = record.cMines;
+		summary = m_aSummaries.insert(m_aSummaries.end(), newSummary);
+	}
+
+	++summary->cGames;
+
+	if (record.flags & FLAG_WON)
+	{
+		++summary->cWon;
+		summary->bestMilliseconds = std::min(summary->bestMilliseconds, record.milliseconds);
+
+		if (record.threeBV != 0)
+		{
+			summary->threeBV += record.threeBV;
+			summary->milliseconds += record.milliseconds;
+			summary->cClicks += static_cast<std::uint64_t>(record.cEffectiveClicks) + record.cWastedClicks;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include <Windows.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+*	Keeps the results of finished games in a file in the
+*	local application data folder:
+*		Header
+*		Record of every game, in the order they ended
+*	Records have a fixed size, so a game is added by
+*	appending 32 bytes and all of them are read at once.
+*	The file is read the first time the summaries are asked
+*	for, games added afterwards are summed up as they are
+*	appended, so showing the statistics of many thousands of
+*	games never waits on more than one read.
+*/
+class GameStats
+{
+public:
+	static constexpr std::uint32_t FLAG_WON{ 1 << 0 };
+	static constexpr std::uint32_t FLAG_NO_GUESSING{ 1 << 1 };
+
+	// The result of one game.
+	struct Record
+	{
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t cMines;
+		std::uint32_t flags;
+		std::uint32_t threeBV;										// 0 if the 3BV of the board is not known.
+		std::uint32_t milliseconds;
+		std::uint32_t cEffectiveClicks;								// Clicks that changed the board.
+		std::uint32_t cWastedClicks;								// Clicks that changed nothing.
+	};
+
+	// The games played on one board size.
+	struct Summary
+	{
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+		std::uint32_t cMines{ 0 };
+		std::uint32_t cGames{ 0 };
+		std::uint32_t cWon{ 0 };
+		std::uint32_t bestMilliseconds{ UINT32_MAX };				// Of the fastest won game.
+		// Sums over the won games whose 3BV is known, for their 3BV per second and efficiency.
+		std::uint64_t threeBV{ 0 };
+		std::uint64_t milliseconds{ 0 };
+		std::uint64_t cClicks{ 0 };
+	};
+
+	BOOL Add(const Record& record);									// Appends record to the file, returns FALSE if it can't.
+	const std::vector<Summary>& GetSummaries();						// Returns a summary per board size, in the order first played.
+
+private:
+	static constexpr std::uint32_t MAGIC{ 0x5453534D };				// "MSST" in little endian.
+	static constexpr std::uint32_t FORMAT_VERSION{ 1 };
+
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+	};
+
+	BOOL m_bLoaded{ FALSE };
+	std::vector<Summary> m_aSummaries{};
+
+	static std::wstring GetPath(BOOL bCreateFolder);
+	void Load();
+	void Accumulate(const Record& record);
+};
\ No newline at end of file
@@ -1,6 +1,17 @@
 #include "GameWindow.h"
 
+#include <commdlg.h>
+
 #include "constants.h"
+#include "FrameScheduler.h"
+
+#pragma comment(lib, "comdlg32")
+
+namespace
+{
+	constexpr WCHAR REPLAY_FILTER[]{ L"Minesweeper Replays (*.msreplay)\0*.msreplay\0All Files (*.*)\0*.*\0" };
+	constexpr WCHAR GAME_FILTER[]{ L"Saved Minesweeper Games (*.mssave)\0*.mssave\0All Files (*.*)\0*.*\0" };
+}
 
 /*
 *	==========================
@@ -20,6 +31,11 @@ void GameWindow::ToggleQuestionMarkUsage()
 	m_field.ToggleQuestionMarkUsage();
 }
 
+void GameWindow::SetNoGuessing(BOOL bNoGuessing)
+{
+	m_field.SetNoGuessing(bNoGuessing);
+}
+
 void GameWindow::ResetGame()
 {
 	m_field.ResetGame();
@@ -29,12 +45,7 @@ void GameWindow::ResizeMinefield(UINT width, UINT height, UINT cMines)
 {
 	if (m_field.Resize(width, height, cMines))
 	{
-		RECT rc{ MinefieldBoundingBox() };
-		MoveWindow(m_field.Window(), rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), TRUE);
-		rc = InfoBarBoundingBox();
-		MoveWindow(m_infobar.Window(), rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), TRUE);
-		GetClientRect(m_hWnd, &rc);
-		InvalidateRect(m_hWnd, &rc, TRUE);
+		UpdateLayout();
 	}
 }
 
@@ -58,6 +69,21 @@ void GameWindow::ResetTimer()
 	m_infobar.ResetTimer(); 
 }
 
+INT32 GameWindow::GetElapsedTime() const
+{
+	return m_infobar.GetElapsedTime();
+}
+
+LONGLONG GameWindow::GetElapsedMilliseconds() const
+{
+	return m_infobar.GetElapsedMilliseconds();
+}
+
+GameStats& GameWindow::GetStats()
+{
+	return m_stats;
+}
+
 void GameWindow::SetSmileState(SmileState state)
 {
 	m_infobar.SetSmileState(state);
@@ -80,8 +106,9 @@ RECT GameWindow::MinefieldBoundingBox()
 	RECT rc{};
 	GetClientRect(m_hWnd, &rc);
 
-	LONG width = static_cast<LONG>(m_field.GetMinefieldWidth() * m_dTileSize);
-	LONG height = static_cast<LONG>(m_field.GetMinefieldHeight() * m_dTileSize);
+	// Fields too large to fit at the minimum tile size are shown through the minefield's scrollable view.
+	LONG width = static_cast<LONG>(min(m_field.GetMinefieldWidth() * m_dTileSize, rc.right - 0.5 * m_dTileSize));
+	LONG height = static_cast<LONG>(min(m_field.GetMinefieldHeight() * m_dTileSize, rc.bottom - 2.5 * m_dTileSize));
 
 	rc.left = (rc.right - width) / 2;
 	rc.right = rc.left + width;
@@ -117,6 +144,154 @@ void GameWindow::UpdateTileSize()
 	LONG width{ static_cast<LONG>(m_field.GetMinefieldWidth()) };
 	LONG height{ static_cast<LONG>(m_field.GetMinefieldHeight()) };
 	m_dTileSize = min(static_cast<DOUBLE>(rc.right) / (0.5 + width), static_cast<DOUBLE>(rc.bottom) / (2.5 + height));
+	m_dTileSize = max(m_dTileSize, constants::MIN_LAYOUT_TILE_SIZE);
+}
+
+// Fits the minefield and info bar to the size of the minefield.
+void GameWindow::UpdateLayout()
+{
+	MoveChildWindows();
+	m_border.CalculateLayout();
+	RECT rc;
+	GetClientRect(m_hWnd, &rc);
+	InvalidateRect(m_hWnd, &rc, TRUE);
+}
+
+/*
+*	Moves the minefield and info bar to their bounding boxes
+*	with a single deferred window position change, so during
+*	a live resize the window is repainted once per size step
+*	rather than once per child.
+*/
+void GameWindow::MoveChildWindows()
+{
+	const RECT rcField{ MinefieldBoundingBox() };
+	const RECT rcInfoBar{ InfoBarBoundingBox() };
+	HDWP hdwp{ BeginDeferWindowPos(2) };
+
+	if (hdwp)
+	{
+		hdwp = DeferWindowPos(hdwp, m_field.Window(), nullptr, rcField.left, rcField.top, rcField.right - rcField.left,
+			rcField.bottom - rcField.top, SWP_NOZORDER | SWP_NOACTIVATE);
+	}
+
+	if (hdwp)
+	{
+		hdwp = DeferWindowPos(hdwp, m_infobar.Window(), nullptr, rcInfoBar.left, rcInfoBar.top, rcInfoBar.right - rcInfoBar.left,
+			rcInfoBar.bottom - rcInfoBar.top, SWP_NOZORDER | SWP_NOACTIVATE);
+	}
+
+	if (!hdwp || !EndDeferWindowPos(hdwp))
+	{
+		MoveWindow(m_field.Window(), rcField.left, rcField.top, (rcField.right - rcField.left), (rcField.bottom - rcField.top), TRUE);
+		MoveWindow(m_infobar.Window(), rcInfoBar.left, rcInfoBar.top, (rcInfoBar.right - rcInfoBar.left),
+			(rcInfoBar.bottom - rcInfoBar.top), TRUE);
+	}
+}
+
+// Asks for a file and saves the recording of the current game to it.
+void GameWindow::SaveReplay()
+{
+	WCHAR szFile[MAX_PATH]{};
+	OPENFILENAME ofn{};
+	ofn.lStructSize = sizeof(OPENFILENAME);
+	ofn.hwndOwner = m_hWnd;
+	ofn.lpstrFilter = REPLAY_FILTER;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = MAX_PATH;
+	ofn.lpstrDefExt = L"msreplay";
+	ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+
+	if (m_field.GetReplay().GetWidth() == 0)
+	{
+		MessageBox(m_hWnd, L"A game continued from a save, or with moves undone, has no replay.", L"Save Replay", MB_OK | MB_ICONINFORMATION);
+	}
+	else if (GetSaveFileName(&ofn) && !m_field.GetReplay().Save(szFile))
+	{
+		MessageBox(m_hWnd, L"The replay could not be saved.", L"Save Replay", MB_OK | MB_ICONERROR);
+	}
+}
+
+/*
+*	Asks for a replay file and plays it back, resizing the
+*	minefield to the board of the replay first.
+*/
+void GameWindow::OpenReplay()
+{
+	WCHAR szFile[MAX_PATH]{};
+	OPENFILENAME ofn{};
+	ofn.lStructSize = sizeof(OPENFILENAME);
+	ofn.hwndOwner = m_hWnd;
+	ofn.lpstrFilter = REPLAY_FILTER;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = MAX_PATH;
+	ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+
+	if (!GetOpenFileName(&ofn))
+	{
+		return;
+	}
+
+	Replay replay{};
+
+	static_assert(Replay::MAX_DIMENSION == constants::MAX_FIELD_DIMENSION);
+
+	if (!replay.Load(szFile))
+	{
+		MessageBox(m_hWnd, L"The file is not a replay this version can play.", L"Open Replay", MB_OK | MB_ICONERROR);
+		return;
+	}
+
+	ResizeMinefield(replay.GetWidth(), replay.GetHeight(), replay.GetMineCount());
+	m_field.PlayReplay(replay);
+}
+
+// Asks for a file and saves the current game to it, so it can be continued later.
+void GameWindow::SaveGame()
+{
+	WCHAR szFile[MAX_PATH]{};
+	OPENFILENAME ofn{};
+	ofn.lStructSize = sizeof(OPENFILENAME);
+	ofn.hwndOwner = m_hWnd;
+	ofn.lpstrFilter = GAME_FILTER;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = MAX_PATH;
+	ofn.lpstrDefExt = L"mssave";
+	ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+
+	if (GetSaveFileName(&ofn) && !m_field.SaveGame(szFile, m_infobar.GetElapsedMilliseconds()))
+	{
+		MessageBox(m_hWnd, L"The game could not be saved.", L"Save Game", MB_OK | MB_ICONERROR);
+	}
+}
+
+// Asks for a saved game and continues it on a minefield of its size.
+void GameWindow::OpenGame()
+{
+	WCHAR szFile[MAX_PATH]{};
+	OPENFILENAME ofn{};
+	ofn.lStructSize = sizeof(OPENFILENAME);
+	ofn.hwndOwner = m_hWnd;
+	ofn.lpstrFilter = GAME_FILTER;
+	ofn.lpstrFile = szFile;
+	ofn.nMaxFile = MAX_PATH;
+	ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+
+	if (!GetOpenFileName(&ofn))
+	{
+		return;
+	}
+
+	LONGLONG elapsedMilliseconds{ 0 };
+
+	if (!m_field.LoadGame(szFile, elapsedMilliseconds))
+	{
+		MessageBox(m_hWnd, L"The file is not a game this version can continue.", L"Open Game", MB_OK | MB_ICONERROR);
+		return;
+	}
+
+	m_infobar.SetElapsedMilliseconds(elapsedMilliseconds);
+	UpdateLayout();
 }
 
 /*
@@ -137,7 +312,7 @@ LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 		}
 
 		RECT rc{ MinefieldBoundingBox() };
-		if (!m_field.Create(L"Minefield", WS_CHILD | WS_VISIBLE, 0, rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), m_hWnd, 0))
+		if (!m_field.Create(L"Minefield", WS_CHILD | WS_VISIBLE | WS_HSCROLL | WS_VSCROLL, 0, rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), m_hWnd, 0))
 		{
 			return -1;
 		}
@@ -156,6 +331,22 @@ LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	{
 		switch (LOWORD(wParam))
 		{
+		case ID_FILE_OPENREPLAY:
+			OpenReplay();
+			break;
+
+		case ID_FILE_SAVEREPLAY:
+			SaveReplay();
+			break;
+
+		case ID_FILE_OPENGAME:
+			OpenGame();
+			break;
+
+		case ID_FILE_SAVEGAME:
+			SaveGame();
+			break;
+
 		case ID_FILE_EXIT:
 			DestroyWindow(m_hWnd);
 			break;
@@ -190,6 +381,49 @@ LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 		}
 		break;
 
+		case ID_GAME_UNDO:
+			m_field.Undo();
+			break;
+
+		case ID_GAME_REDO:
+			m_field.Redo();
+			break;
+
+		case ID_GAME_HINT:
+			m_field.ShowHint();
+			break;
+
+		case ID_GAME_SPECTATORS:
+		{
+			const BOOL bHost{ !m_field.IsHostingSpectators() };
+
+			if (m_field.HostSpectators(bHost))
+			{
+				CheckMenuItem(GetMenu(m_hWnd), ID_GAME_SPECTATORS, bHost ? MF_CHECKED : MF_UNCHECKED);
+			}
+			else
+			{
+				MessageBox(m_hWnd, L"Spectators could not be hosted, the port may be in use.", L"Host Spectators", MB_OK | MB_ICONERROR);
+			}
+		}
+		break;
+
+		case ID_GAME_PROBABILITIES:
+			CheckMenuItem(GetMenu(m_hWnd), ID_GAME_PROBABILITIES, m_field.ToggleMineProbabilities() ? MF_CHECKED : MF_UNCHECKED);
+			break;
+
+		case ID_GAME_FRAMETIMES:
+			CheckMenuItem(GetMenu(m_hWnd), ID_GAME_FRAMETIMES, m_field.ToggleFrameTimes() ? MF_CHECKED : MF_UNCHECKED);
+			break;
+
+		case ID_GAME_PRECISEMOUSE:
+			CheckMenuItem(GetMenu(m_hWnd), ID_GAME_PRECISEMOUSE, m_field.TogglePreciseMouse() ? MF_CHECKED : MF_UNCHECKED);
+			break;
+
+		case ID_GAME_STATISTICS:
+			m_statsDialog.OpenDialog(m_hWnd);
+			break;
+
 		case ID_GAME_OPTIONS:
 			m_gameOptionsDialog.OpenDialog(m_hWnd);
 			break;
@@ -235,10 +469,8 @@ LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 		int x = (int)(short)LOWORD(lParam);
 		int y = (int)(short)HIWORD(lParam);
 		m_border.Resize(x, y);
-		RECT rc{ MinefieldBoundingBox() };
-		MoveWindow(m_field.Window(), rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), TRUE);
-		rc = InfoBarBoundingBox();
-		MoveWindow(m_infobar.Window(), rc.left, rc.top, (rc.right - rc.left), (rc.bottom - rc.top), TRUE);
+		MoveChildWindows();
+		RECT rc;
 		GetClientRect(m_hWnd, &rc);
 		InvalidateRect(m_hWnd, &rc, TRUE);
 	}
@@ -247,6 +479,24 @@ LRESULT GameWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	case WM_ERASEBKGND:
 		return 1;
 
+	case WM_MOUSEWHEEL:
+		[[fallthrough]];
+	case WM_MOUSEHWHEEL:
+		// The wheel message goes to the focused window, the minefield is the only child that uses it.
+		return SendMessage(m_field.Window(), uMsg, wParam, lParam);
+
+	case WM_ENTERIDLE:
+		FrameScheduler::Instance().PresentPending();
+		return 0;
+
+	case WM_ENTERSIZEMOVE:
+		FrameScheduler::Instance().SetModalLoop(TRUE);
+		return 0;
+
+	case WM_EXITSIZEMOVE:
+		FrameScheduler::Instance().SetModalLoop(FALSE);
+		return 0;
+
 	default:
 		return DefWindowProc(m_hWnd, uMsg, wParam, lParam);
 	}
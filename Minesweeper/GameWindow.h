@@ -3,11 +3,13 @@
 #include "MinefieldWindow.h"
 #include "GameInfoBarWindow.h"
 #include "GameOptionsDialog.h"
+#include "StatsDialog.h"
 #include "BorderScene.h"
 
 #include <memory>
 
 #include "enums.h"
+#include "GameStats.h"
 
 class GameWindow : public BaseWindow<GameWindow>
 {
@@ -15,12 +17,16 @@ public:
 	GameWindow(UINT width, UINT height, UINT cMines);
 
 	void ToggleQuestionMarkUsage();
+	void SetNoGuessing(BOOL bNoGuessing);
 	void ResetGame();
 	void ResizeMinefield(UINT width, UINT height, UINT cMines);
 	void SetFlagCounter(INT32 count);
 	void StartTimer();
 	void StopTimer();
 	void ResetTimer();
+	INT32 GetElapsedTime() const;
+	LONGLONG GetElapsedMilliseconds() const;
+	GameStats& GetStats();
 	void SetSmileState(SmileState state);
 	void SetCurrentTileContents(TileContent content);
 
@@ -33,11 +39,19 @@ private:
 	MinefieldWindow m_field;
 	GameInfoBarWindow m_infobar{};
 	GameOptionsDialog m_gameOptionsDialog{};
+	GameStats m_stats{};
+	StatsDialog m_statsDialog{};
 	BorderScene m_border{};
 	DOUBLE m_dTileSize{};
 	BOOL m_bFirstDraw{ TRUE };
 
 	void UpdateTileSize();
+	void UpdateLayout();
+	void MoveChildWindows();
+	void SaveReplay();
+	void OpenReplay();
+	void SaveGame();
+	void OpenGame();
 
 public:
 	// Returns Window class name to satisfy BaseWindow
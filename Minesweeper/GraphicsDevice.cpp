@@ -0,0 +1,221 @@
+#include "GraphicsDevice.h"
+
+#pragma comment(lib, "d3d11")
+#pragma comment(lib, "dxgi")
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+GraphicsDevice& GraphicsDevice::Instance()
+{
+	static GraphicsDevice device{};
+	return device;
+}
+
+void GraphicsDevice::SetBackend(RenderBackend backend)
+{
+	m_backend = backend;
+}
+
+RenderBackend GraphicsDevice::GetBackend() const
+{
+	return m_backend;
+}
+
+// Lets the minefield draw its tiles with TileShaderRenderer, only the flip model backend supports it.
+void GraphicsDevice::SetTileShaderEnabled(BOOL bEnabled)
+{
+	m_bTileShaderEnabled = bEnabled;
+}
+
+BOOL GraphicsDevice::IsTileShaderEnabled() const
+{
+	return m_bTileShaderEnabled && m_backend == RenderBackend::FLIP_SWAP_CHAIN;
+}
+
+// Returns the D2D factory every scene of the flip model backend shares.
+HRESULT GraphicsDevice::GetFactory(ID2D1Factory1** ppFactory)
+{
+	HRESULT hr = S_OK;
+
+	if (!m_pFactory)
+	{
+		hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pFactory);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pFactory.CopyTo(ppFactory);
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsDevice::GetD3DDevice(ID3D11Device** ppDevice)
+{
+	HRESULT hr = CreateDevice();
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pD3DDevice.CopyTo(ppDevice);
+	}
+
+	return hr;
+}
+
+HRESULT GraphicsDevice::CreateDeviceContext(ID2D1DeviceContext** ppDeviceContext)
+{
+	HRESULT hr = CreateDevice();
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pD2DDevice->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, ppDeviceContext);
+	}
+
+	return hr;
+}
+
+/*
+*	Creates a flip model swap chain for hWnd. Its frame
+*	latency is limited to one frame and it can be waited on
+*	with GetFrameLatencyWaitableObject before drawing, so a
+*	frame always shows the latest input. FLIP_DISCARD needs
+*	Windows 10, on Windows 8 FLIP_SEQUENTIAL is used instead.
+*/
+HRESULT GraphicsDevice::CreateSwapChain(HWND hWnd, UINT width, UINT height, IDXGISwapChain1** ppSwapChain)
+{
+	HRESULT hr = CreateDevice();
+
+	DXGI_SWAP_CHAIN_DESC1 desc{};
+	desc.Width = max(width, 1u);
+	desc.Height = max(height, 1u);
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	desc.BufferCount = 2;
+	desc.Scaling = DXGI_SCALING_NONE;
+	desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+	desc.AlphaMode = DXGI_ALPHA_MODE_IGNORE;
+	desc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDXGIFactory->CreateSwapChainForHwnd(m_pD3DDevice, hWnd, &desc, nullptr, nullptr, ppSwapChain);
+
+		if (FAILED(hr))
+		{
+			desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+			hr = m_pDXGIFactory->CreateSwapChainForHwnd(m_pD3DDevice, hWnd, &desc, nullptr, nullptr, ppSwapChain);
+		}
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		CComPtr<IDXGISwapChain2> pSwapChain2{ nullptr };
+
+		if (SUCCEEDED((*ppSwapChain)->QueryInterface(&pSwapChain2)))
+		{
+			pSwapChain2->SetMaximumFrameLatency(1);
+		}
+
+		m_pDXGIFactory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER);
+	}
+
+	return hr;
+}
+
+/*
+*	Drops the shared device after a scene found it removed.
+*	Every scene loses its render target through its own
+*	EndDraw or Present, the next one to draw creates a new
+*	device.
+*/
+void GraphicsDevice::HandleDeviceLost()
+{
+	if (m_pD3DDevice && FAILED(m_pD3DDevice->GetDeviceRemovedReason()))
+	{
+		m_pD2DDevice.Release();
+		m_pDXGIFactory.Release();
+		m_pD3DDevice.Release();
+	}
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+HRESULT GraphicsDevice::CreateDevice()
+{
+	if (m_pD2DDevice)
+	{
+		return S_OK;
+	}
+
+	CComPtr<IDXGIDevice1> pDXGIDevice{ nullptr };
+	CComPtr<IDXGIAdapter> pAdapter{ nullptr };
+	CComPtr<ID2D1Factory1> pFactory{ nullptr };
+
+	UINT flags{ D3D11_CREATE_DEVICE_BGRA_SUPPORT };
+
+#ifdef _DEBUG
+	flags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags, nullptr, 0, D3D11_SDK_VERSION,
+		&m_pD3DDevice, nullptr, nullptr);
+
+#ifdef _DEBUG
+	// The debug layer is only there when the graphics tools are installed.
+	if (FAILED(hr))
+	{
+		flags &= ~D3D11_CREATE_DEVICE_DEBUG;
+		hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags, nullptr, 0, D3D11_SDK_VERSION,
+			&m_pD3DDevice, nullptr, nullptr);
+	}
+#endif
+
+	if (FAILED(hr))
+	{
+		hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, flags, nullptr, 0, D3D11_SDK_VERSION,
+			&m_pD3DDevice, nullptr, nullptr);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pD3DDevice.QueryInterface(&pDXGIDevice);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pDXGIDevice->GetAdapter(&pAdapter);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pAdapter->GetParent(__uuidof(IDXGIFactory2), reinterpret_cast<void**>(&m_pDXGIFactory));
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = GetFactory(&pFactory);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pFactory->CreateDevice(pDXGIDevice, &m_pD2DDevice);
+	}
+
+	if (FAILED(hr))
+	{
+		m_pD2DDevice.Release();
+		m_pDXGIFactory.Release();
+		m_pD3DDevice.Release();
+	}
+
+	return hr;
+}
\ No newline at end of file
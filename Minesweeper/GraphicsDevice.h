@@ -0,0 +1,50 @@
+#pragma once
+#include <atlbase.h>
+#include <d2d1_1.h>
+#include <d3d11.h>
+#include <dxgi1_3.h>
+#include <Windows.h>
+
+#include "enums.h"
+
+/*
+*	Owns the graphics objects shared by every scene of the
+*	flip model backend: one D2D factory, one D3D11 device and
+*	the D2D device on top of it. Scenes create their device
+*	contexts and swap chains from here so that their bitmaps,
+*	brushes and geometry all live on the same GPU device.
+*
+*	The backend is picked once at startup, before any scene
+*	is initialized.
+*/
+class GraphicsDevice
+{
+public:
+	static GraphicsDevice& Instance();
+
+	void			SetBackend(RenderBackend backend);
+	RenderBackend	GetBackend() const;
+	void			SetTileShaderEnabled(BOOL bEnabled);
+	BOOL			IsTileShaderEnabled() const;
+
+	HRESULT	GetFactory(ID2D1Factory1** ppFactory);
+	HRESULT	GetD3DDevice(ID3D11Device** ppDevice);
+	HRESULT	CreateDeviceContext(ID2D1DeviceContext** ppDeviceContext);
+	HRESULT	CreateSwapChain(HWND hWnd, UINT width, UINT height, IDXGISwapChain1** ppSwapChain);
+	void	HandleDeviceLost();
+
+private:
+	GraphicsDevice() {}
+	GraphicsDevice(const GraphicsDevice&) = delete;
+	GraphicsDevice& operator=(const GraphicsDevice&) = delete;
+
+	HRESULT	CreateDevice();
+
+	RenderBackend m_backend{ RenderBackend::HWND_RENDER_TARGET };
+	BOOL m_bTileShaderEnabled{ FALSE };
+
+	CComPtr<ID2D1Factory1> m_pFactory{ nullptr };
+	CComPtr<ID3D11Device> m_pD3DDevice{ nullptr };
+	CComPtr<IDXGIFactory2> m_pDXGIFactory{ nullptr };
+	CComPtr<ID2D1Device> m_pD2DDevice{ nullptr };
+};
\ No newline at end of file
@@ -0,0 +1,729 @@
+#include "MineSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "TileNeighborhood.h"
+
+namespace
+{
+	// Walk of every mine assignment of a component that satisfies its constraints.
+	struct Enumeration
+	{
+		struct LocalConstraint
+		{
+			std::uint32_t cNeeded{ 0 };						// Mines still to place on the constraint's tiles.
+			std::uint32_t cOpen{ 0 };						// Tiles of the constraint not assigned yet.
+		};
+
+		std::vector<LocalConstraint> aConstraints{};
+		std::vector<std::uint32_t> aOrder{};				// Local tiles in the order they are assigned.
+		std::vector<std::uint32_t> aTileConstraints{};		// Constraints of each local tile, 8 slots per tile.
+		std::vector<std::uint8_t> aTileConstraintCounts{};
+		std::vector<std::uint32_t> aMineStack{};			// Local tiles assigned a mine.
+		std::vector<double>* pWeights{ nullptr };
+		std::vector<double>* pTileWeights{ nullptr };
+		std::uint64_t cStepsLeft{ 0 };
+
+		// Returns false if it ran out of steps.
+		bool Assign(std::uint32_t depth)
+		{
+			if (cStepsLeft-- == 0)
+			{
+				return false;
+			}
+
+			if (depth == aOrder.size())
+			{
+				const std::size_t cTiles{ aOrder.size() };
+				const std::size_t cMines{ aMineStack.size() };
+
+				(*pWeights)[cMines] += 1;
+
+				for (const std::uint32_t tile : aMineStack)
+				{
+					(*pTileWeights)[cMines * cTiles + tile] += 1;
+				}
+
+				return true;
+			}
+
+			const std::uint32_t tile{ aOrder[depth] };
+			const std::uint32_t* pConstraints{ &aTileConstraints[tile * 8] };
+			const std::uint32_t cConstraints{ aTileConstraintCounts[tile] };
+
+			for (std::uint32_t bMine{ 0 }; bMine <= 1; ++bMine)
+			{
+				bool bValid{ true };
+
+				for (std::uint32_t i{ 0 }; i < cConstraints && bValid; ++i)
+				{
+					const LocalConstraint& constraint{ aConstraints[pConstraints[i]] };
+					bValid = bMine ? constraint.cNeeded > 0 : constraint.cOpen > constraint.cNeeded;
+				}
+
+				if (!bValid)
+				{
+					continue;
+				}
+
+				for (std::uint32_t i{ 0 }; i < cConstraints; ++i)
+				{
+					--aConstraints[pConstraints[i]].cOpen;
+					aConstraints[pConstraints[i]].cNeeded -= bMine;
+				}
+
+				if (bMine)
+				{
+					aMineStack.push_back(tile);
+				}
+
+				const bool bFinished{ Assign(depth + 1) };
+
+				if (bMine)
+				{
+					aMineStack.pop_back();
+				}
+
+				for (std::uint32_t i{ 0 }; i < cConstraints; ++i)
+				{
+					++aConstraints[pConstraints[i]].cOpen;
+					aConstraints[pConstraints[i]].cNeeded += bMine;
+				}
+
+				if (!bFinished)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+	// Returns log(n choose k).
+	double LogChoose(std::uint32_t n, std::uint32_t k)
+	{
+		return std::lgamma(n + 1.) - std::lgamma(k + 1.) - std::lgamma(n - k + 1.);
+	}
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+// Forgets everything about the previous board, the storage is kept for the next one.
+void MineSolver::Reset(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	const std::size_t cTiles{ static_cast<std::size_t>(width) * height };
+
+	m_width = width;
+	m_height = height;
+	m_cMines = cMines;
+	m_cKnownMines = 0;
+	m_cUnknown = static_cast<std::uint32_t>(cTiles);
+	m_pNeighbors = GetPresetNeighbors(width, height);
+	m_aKnowledge.assign(cTiles, Knowledge::UNKNOWN);
+	m_aCounts.assign(cTiles, 0);
+	m_aFrontier.clear();
+	m_aConstraints.clear();
+	m_aConstraintIndex.assign(cTiles, UINT32_MAX);
+	m_aDeduced.assign(cTiles, 0);
+	m_aParents.assign(cTiles, UINT32_MAX);
+	m_componentCache.clear();
+}
+
+void MineSolver::SetRevealed(std::uint32_t tile, std::uint32_t cAdjacentMines)
+{
+	if (m_aKnowledge[tile] == Knowledge::UNKNOWN)
+	{
+		m_aKnowledge[tile] = Knowledge::SAFE;
+		m_aCounts[tile] = static_cast<std::uint8_t>(cAdjacentMines);
+		m_aFrontier.push_back(tile);
+		--m_cUnknown;
+	}
+}
+
+void MineSolver::SetMine(std::uint32_t tile)
+{
+	if (m_aKnowledge[tile] == Knowledge::UNKNOWN)
+	{
+		m_aKnowledge[tile] = Knowledge::MINE;
+		++m_cKnownMines;
+		--m_cUnknown;
+	}
+}
+
+bool MineSolver::IsUnknown(std::uint32_t tile) const
+{
+	return m_aKnowledge[tile] == Knowledge::UNKNOWN;
+}
+
+std::uint32_t MineSolver::GetUnknownCount() const
+{
+	return m_cUnknown;
+}
+
+// Deduces tiles with the cheapest rule that finds any.
+bool MineSolver::Deduce(std::vector<std::uint32_t>& aSafeTiles, std::vector<std::uint32_t>& aMines)
+{
+	const std::size_t cSafeBefore{ aSafeTiles.size() };
+	const std::size_t cMinesBefore{ aMines.size() };
+
+	BuildConstraints();
+
+	// A constraint whose tiles are all safe or all mines.
+	for (const Constraint& constraint : m_aConstraints)
+	{
+		if (constraint.cMines == 0 || constraint.cMines == constraint.cTiles)
+		{
+			for (std::uint32_t i{ 0 }; i < constraint.cTiles; ++i)
+			{
+				AddDeduction(constraint.aTiles[i], constraint.cMines != 0, aSafeTiles, aMines);
+			}
+		}
+	}
+
+	// Constraints sharing tiles are at most two tiles apart, so only those are compared.
+	if (aSafeTiles.size() == cSafeBefore && aMines.size() == cMinesBefore)
+	{
+		for (std::size_t index{ 0 }; index < m_aConstraints.size(); ++index)
+		{
+			const Constraint& subset{ m_aConstraints[index] };
+			const std::uint32_t center{ m_aFrontier[index] };
+
+			for (const std::uint32_t other : TileNeighborhood(center % m_width, center / m_width, 2, m_width, m_height))
+			{
+				const std::uint32_t otherIndex{ m_aConstraintIndex[other] };
+
+				if (otherIndex == UINT32_MAX || other == center)
+				{
+					continue;
+				}
+
+				const Constraint& superset{ m_aConstraints[otherIndex] };
+
+				if (superset.cTiles <= subset.cTiles || superset.cMines < subset.cMines ||
+					!std::includes(superset.aTiles, superset.aTiles + superset.cTiles, subset.aTiles, subset.aTiles + subset.cTiles))
+				{
+					continue;
+				}
+
+				const std::uint32_t cRestMines{ superset.cMines - subset.cMines };
+				const std::uint32_t cRestTiles{ superset.cTiles - subset.cTiles };
+
+				if (cRestMines == 0 || cRestMines == cRestTiles)
+				{
+					for (std::uint32_t i{ 0 }; i < superset.cTiles; ++i)
+					{
+						if (!std::binary_search(subset.aTiles, subset.aTiles + subset.cTiles, superset.aTiles[i]))
+						{
+							AddDeduction(superset.aTiles[i], cRestMines != 0, aSafeTiles, aMines);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Once every mine is known the remaining tiles are safe, and the other way around.
+	if (aSafeTiles.size() == cSafeBefore && aMines.size() == cMinesBefore && m_cUnknown > 0 &&
+		(m_cKnownMines == m_cMines || m_cMines - m_cKnownMines == m_cUnknown))
+	{
+		const bool bMines{ m_cKnownMines != m_cMines };
+
+		for (std::uint32_t tile{ 0 }; tile < m_aKnowledge.size(); ++tile)
+		{
+			if (m_aKnowledge[tile] == Knowledge::UNKNOWN)
+			{
+				AddDeduction(tile, bMines, aSafeTiles, aMines);
+			}
+		}
+	}
+
+	ClearConstraints();
+
+	for (std::size_t i{ cSafeBefore }; i < aSafeTiles.size(); ++i)
+	{
+		m_aDeduced[aSafeTiles[i]] = 0;
+	}
+
+	for (std::size_t i{ cMinesBefore }; i < aMines.size(); ++i)
+	{
+		m_aDeduced[aMines[i]] = 0;
+	}
+
+	return aSafeTiles.size() != cSafeBefore || aMines.size() != cMinesBefore;
+}
+
+/*
+*	Fills in the chance of every tile being a mine given what
+*	is known, counting every mine layout that fits the
+*	numbers as equally likely. Revealed tiles get 0, known
+*	mines 1.
+*
+*	The layouts of separate frontier components are counted
+*	on their own, by number of mines, and only combined
+*	through the number of mines left for the tiles that
+*	touch no number. A component's counts only depend on its
+*	tiles and constraints, so they are cached by those and a
+*	move only recounts the components it changed. A
+*	component too large to count in MAX_ENUMERATION_STEPS is
+*	treated like the tiles touching no number.
+*/
+void MineSolver::GetMineProbabilities(std::vector<float>& aProbabilities)
+{
+	if (m_componentCache.size() > MAX_CACHED_COMPONENTS)
+	{
+		m_componentCache.clear();
+	}
+
+	aProbabilities.assign(m_aKnowledge.size(), 0.f);
+	BuildConstraints();
+	FindComponents();
+
+	// apCounts holds the counts of the exact components, in the order of m_aComponents.
+	std::vector<const ComponentCounts*> apComponentCounts{};
+	std::vector<const ComponentCounts*> apCounts{};
+	std::uint32_t cOtherTiles{ m_cUnknown };
+	std::size_t cMaxFrontierMines{ 0 };
+
+	for (const Component& component : m_aComponents)
+	{
+		const ComponentCounts& counts{ GetComponentCounts(component) };
+		apComponentCounts.push_back(&counts);
+
+		if (counts.bExact)
+		{
+			apCounts.push_back(&counts);
+			cOtherTiles -= static_cast<std::uint32_t>(component.aTiles.size());
+			cMaxFrontierMines += counts.aWeights.size() - 1;
+		}
+	}
+
+	// Weight of s mines in the exact components by the number of ways to place the rest on the other tiles.
+	const std::uint32_t cMinesLeft{ m_cMines > m_cKnownMines ? m_cMines - m_cKnownMines : 0 };
+	std::vector<double> aRestWeights(cMaxFrontierMines + 1, 0.);
+	double maxLogWeight{ -INFINITY };
+
+	for (std::size_t s{ 0 }; s < aRestWeights.size() && s <= cMinesLeft; ++s)
+	{
+		if (cMinesLeft - s <= cOtherTiles)
+		{
+			maxLogWeight = std::max(maxLogWeight, LogChoose(cOtherTiles, static_cast<std::uint32_t>(cMinesLeft - s)));
+		}
+	}
+
+	for (std::size_t s{ 0 }; s < aRestWeights.size() && s <= cMinesLeft; ++s)
+	{
+		if (cMinesLeft - s <= cOtherTiles)
+		{
+			aRestWeights[s] = std::exp(LogChoose(cOtherTiles, static_cast<std::uint32_t>(cMinesLeft - s)) - maxLogWeight);
+		}
+	}
+
+	// aPrefixes[c] is the weight of each number of mines in the components before c, scaled to a maximum of 1.
+	std::vector<std::vector<double>> aPrefixes(apCounts.size() + 1);
+	aPrefixes[0].assign(1, 1.);
+
+	for (std::size_t c{ 0 }; c < apCounts.size(); ++c)
+	{
+		const std::vector<double>& aWeights{ apCounts[c]->aWeights };
+		std::vector<double>& aNext{ aPrefixes[c + 1] };
+		aNext.assign(aPrefixes[c].size() + aWeights.size() - 1, 0.);
+
+		for (std::size_t a{ 0 }; a < aPrefixes[c].size(); ++a)
+		{
+			for (std::size_t k{ 0 }; k < aWeights.size(); ++k)
+			{
+				aNext[a + k] += aPrefixes[c][a] * aWeights[k];
+			}
+		}
+
+		const double maxWeight{ *std::max_element(aNext.begin(), aNext.end()) };
+
+		for (double& weight : aNext)
+		{
+			weight = maxWeight > 0 ? weight / maxWeight : 0;
+		}
+	}
+
+	// Walks back through the components, aSuffix being the weight of each number of mines before them.
+	std::vector<double> aSuffix{ aRestWeights };
+	std::vector<double> aComponentWeights{};
+	std::vector<double> aNextSuffix{};
+	std::size_t cComponent{ apCounts.size() };
+
+	for (std::size_t index{ m_aComponents.size() }; index-- > 0;)
+	{
+		const Component& component{ m_aComponents[index] };
+		const ComponentCounts& counts{ *apComponentCounts[index] };
+
+		if (!counts.bExact)
+		{
+			continue;
+		}
+
+		const std::vector<double>& aPrefix{ aPrefixes[--cComponent] };
+		const std::size_t cComponentTiles{ component.aTiles.size() };
+		aComponentWeights.assign(counts.aWeights.size(), 0.);
+		double total{ 0 };
+
+		for (std::size_t k{ 0 }; k < counts.aWeights.size(); ++k)
+		{
+			for (std::size_t a{ 0 }; a < aPrefix.size() && a + k < aSuffix.size(); ++a)
+			{
+				aComponentWeights[k] += aPrefix[a] * aSuffix[a + k];
+			}
+
+			total += counts.aWeights[k] * aComponentWeights[k];
+		}
+
+		for (std::size_t i{ 0 }; i < cComponentTiles; ++i)
+		{
+			double weight{ 0 };
+
+			for (std::size_t k{ 0 }; k < counts.aWeights.size(); ++k)
+			{
+				weight += counts.aTileWeights[k * cComponentTiles + i] * aComponentWeights[k];
+			}
+
+			aProbabilities[component.aTiles[i]] = total > 0 ? static_cast<float>(weight / total) : 0.f;
+		}
+
+		aNextSuffix.assign(aSuffix.size(), 0.);
+
+		for (std::size_t m{ 0 }; m < aSuffix.size(); ++m)
+		{
+			for (std::size_t k{ 0 }; k < counts.aWeights.size() && m + k < aSuffix.size(); ++k)
+			{
+				aNextSuffix[m] += counts.aWeights[k] * aSuffix[m + k];
+			}
+		}
+
+		const double maxWeight{ *std::max_element(aNextSuffix.begin(), aNextSuffix.end()) };
+
+		for (double& weight : aNextSuffix)
+		{
+			weight = maxWeight > 0 ? weight / maxWeight : 0;
+		}
+
+		std::swap(aSuffix, aNextSuffix);
+	}
+
+	// The other tiles share the mines the components leave over.
+	double otherMines{ 0 };
+	double otherTotal{ 0 };
+
+	for (std::size_t s{ 0 }; s < aPrefixes.back().size() && s < aRestWeights.size() && s <= cMinesLeft; ++s)
+	{
+		otherMines += aPrefixes.back()[s] * aRestWeights[s] * (cMinesLeft - s);
+		otherTotal += aPrefixes.back()[s] * aRestWeights[s];
+	}
+
+	const float otherProbability{ cOtherTiles > 0 && otherTotal > 0 ? static_cast<float>(otherMines / otherTotal / cOtherTiles) : 0.f };
+
+	for (std::uint32_t tile{ 0 }; tile < m_aKnowledge.size(); ++tile)
+	{
+		if (m_aKnowledge[tile] == Knowledge::MINE)
+		{
+			aProbabilities[tile] = 1.f;
+		}
+		else if (m_aKnowledge[tile] == Knowledge::UNKNOWN && m_aParents[tile] == UINT32_MAX)
+		{
+			aProbabilities[tile] = otherProbability;
+		}
+	}
+
+	for (std::size_t index{ 0 }; index < m_aComponents.size(); ++index)
+	{
+		const Component& component{ m_aComponents[index] };
+
+		if (!apComponentCounts[index]->bExact)
+		{
+			for (const std::uint32_t tile : component.aTiles)
+			{
+				aProbabilities[tile] = otherProbability;
+			}
+		}
+
+		for (const std::uint32_t tile : component.aTiles)
+		{
+			m_aParents[tile] = UINT32_MAX;
+		}
+	}
+
+	ClearConstraints();
+}
+
+/*
+*	Finds the unknown tile least likely to be a mine and
+*	returns if it is certainly safe. Tiles the deduction
+*	rules prove safe are found without counting layouts.
+*	tile is UINT32_MAX if no tile is unknown.
+*/
+bool MineSolver::GetHint(std::uint32_t& tile)
+{
+	std::vector<std::uint32_t> aSafeTiles{};
+	std::vector<std::uint32_t> aMines{};
+	tile = UINT32_MAX;
+
+	if (Deduce(aSafeTiles, aMines) && !aSafeTiles.empty())
+	{
+		tile = aSafeTiles.front();
+		return true;
+	}
+
+	std::vector<float> aProbabilities{};
+	GetMineProbabilities(aProbabilities);
+
+	for (std::uint32_t candidate{ 0 }; candidate < m_aKnowledge.size(); ++candidate)
+	{
+		if (m_aKnowledge[candidate] == Knowledge::UNKNOWN &&
+			(tile == UINT32_MAX || aProbabilities[candidate] < aProbabilities[tile]))
+		{
+			tile = candidate;
+		}
+	}
+
+	return tile != UINT32_MAX && aProbabilities[tile] == 0.f;
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+std::size_t MineSolver::KeyHash::operator()(const std::vector<std::uint32_t>& key) const
+{
+	std::size_t hash{ key.size() };
+
+	for (const std::uint32_t value : key)
+	{
+		hash ^= value + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+	}
+
+	return hash;
+}
+
+/*
+*	Builds the constraint of every frontier tile. The
+*	frontier is compacted on the way, dropping revealed tiles
+*	whose neighbors are all known since they can't tell
+*	anything anymore.
+*/
+void MineSolver::BuildConstraints()
+{
+	m_aConstraints.clear();
+	std::size_t cFrontier{ 0 };
+
+	for (const std::uint32_t tile : m_aFrontier)
+	{
+		Constraint constraint{};
+
+		if (BuildConstraint(tile, constraint))
+		{
+			m_aFrontier[cFrontier++] = tile;
+			m_aConstraintIndex[tile] = static_cast<std::uint32_t>(m_aConstraints.size());
+			m_aConstraints.push_back(constraint);
+		}
+	}
+
+	m_aFrontier.resize(cFrontier);
+}
+
+void MineSolver::ClearConstraints()
+{
+	for (const std::uint32_t tile : m_aFrontier)
+	{
+		m_aConstraintIndex[tile] = UINT32_MAX;
+	}
+}
+
+/*
+*	Splits the constraints into components whose tiles are
+*	linked by sharing constraints, with a union-find over the
+*	unknown tiles. m_aParents is left set for the tiles of a
+*	component until the caller clears it.
+*/
+void MineSolver::FindComponents()
+{
+	auto findRoot = [&](std::uint32_t tile)
+	{
+		while (m_aParents[tile] != tile)
+		{
+			m_aParents[tile] = m_aParents[m_aParents[tile]];
+			tile = m_aParents[tile];
+		}
+
+		return tile;
+	};
+
+	for (const Constraint& constraint : m_aConstraints)
+	{
+		for (std::uint32_t i{ 0 }; i < constraint.cTiles; ++i)
+		{
+			if (m_aParents[constraint.aTiles[i]] == UINT32_MAX)
+			{
+				m_aParents[constraint.aTiles[i]] = constraint.aTiles[i];
+			}
+
+			m_aParents[findRoot(constraint.aTiles[i])] = findRoot(constraint.aTiles[0]);
+		}
+	}
+
+	m_aComponents.clear();
+
+	for (std::uint32_t index{ 0 }; index < m_aConstraints.size(); ++index)
+	{
+		const Constraint& constraint{ m_aConstraints[index] };
+		const std::uint32_t root{ findRoot(constraint.aTiles[0]) };
+
+		// The constraint index of the root tile, which is unknown and so has none, is reused to find its component.
+		if (m_aConstraintIndex[root] == UINT32_MAX)
+		{
+			m_aConstraintIndex[root] = static_cast<std::uint32_t>(m_aComponents.size());
+			m_aComponents.emplace_back();
+		}
+
+		Component& component{ m_aComponents[m_aConstraintIndex[root]] };
+		component.aConstraints.push_back(index);
+		component.aTiles.insert(component.aTiles.end(), constraint.aTiles, constraint.aTiles + constraint.cTiles);
+	}
+
+	for (Component& component : m_aComponents)
+	{
+		m_aConstraintIndex[findRoot(component.aTiles.front())] = UINT32_MAX;
+		std::sort(component.aTiles.begin(), component.aTiles.end());
+		component.aTiles.erase(std::unique(component.aTiles.begin(), component.aTiles.end()), component.aTiles.end());
+	}
+}
+
+/*
+*	Returns the number of mine layouts of a component by its
+*	number of mines, and of those the layouts with a mine on
+*	each of its tiles, counting them if they aren't cached.
+*/
+const MineSolver::ComponentCounts& MineSolver::GetComponentCounts(const Component& component)
+{
+	// The tiles of a constraint are the component's tiles around it, so its tile and mines identify it.
+	std::vector<std::uint32_t> key{ component.aTiles };
+	key.push_back(UINT32_MAX);
+
+	for (const std::uint32_t index : component.aConstraints)
+	{
+		key.push_back(m_aFrontier[index]);
+		key.push_back(m_aConstraints[index].cMines);
+	}
+
+	auto cached{ m_componentCache.find(key) };
+
+	if (cached != m_componentCache.end())
+	{
+		return cached->second;
+	}
+
+	const std::size_t cTiles{ component.aTiles.size() };
+	ComponentCounts& counts{ m_componentCache[std::move(key)] };
+
+	if (cTiles > MAX_COMPONENT_TILES)
+	{
+		return counts;
+	}
+
+	counts.aWeights.assign(cTiles + 1, 0.);
+	counts.aTileWeights.assign((cTiles + 1) * cTiles, 0.);
+
+	auto localTile = [&](std::uint32_t tile)
+	{
+		return static_cast<std::uint32_t>(std::lower_bound(component.aTiles.begin(), component.aTiles.end(), tile) -
+			component.aTiles.begin());
+	};
+
+	Enumeration enumeration{};
+	enumeration.aTileConstraints.assign(cTiles * 8, 0);
+	enumeration.aTileConstraintCounts.assign(cTiles, 0);
+	enumeration.pWeights = &counts.aWeights;
+	enumeration.pTileWeights = &counts.aTileWeights;
+	enumeration.cStepsLeft = MAX_ENUMERATION_STEPS;
+
+	for (std::uint32_t local{ 0 }; local < component.aConstraints.size(); ++local)
+	{
+		const Constraint& constraint{ m_aConstraints[component.aConstraints[local]] };
+		enumeration.aConstraints.push_back({ constraint.cMines, constraint.cTiles });
+
+		for (std::uint32_t i{ 0 }; i < constraint.cTiles; ++i)
+		{
+			const std::uint32_t tile{ localTile(constraint.aTiles[i]) };
+			enumeration.aTileConstraints[tile * 8 + enumeration.aTileConstraintCounts[tile]++] = local;
+		}
+	}
+
+	// Tiles are assigned constraint by constraint, so constraints are decided early and fail fast.
+	std::vector<std::uint8_t> aOrdered(cTiles, 0);
+
+	for (const std::uint32_t index : component.aConstraints)
+	{
+		const Constraint& constraint{ m_aConstraints[index] };
+
+		for (std::uint32_t i{ 0 }; i < constraint.cTiles; ++i)
+		{
+			const std::uint32_t tile{ localTile(constraint.aTiles[i]) };
+
+			if (!aOrdered[tile])
+			{
+				aOrdered[tile] = 1;
+				enumeration.aOrder.push_back(tile);
+			}
+		}
+	}
+
+	counts.bExact = enumeration.Assign(0);
+
+	// Drops the mine counts no layout has, so combining components doesn't walk them.
+	std::size_t cCounts{ counts.aWeights.size() };
+
+	while (cCounts > 1 && counts.aWeights[cCounts - 1] == 0)
+	{
+		--cCounts;
+	}
+
+	counts.aWeights.resize(cCounts);
+	counts.aTileWeights.resize(cCounts * cTiles);
+
+	return counts;
+}
+
+// Fills in the constraint of a revealed tile, returns false if none of its neighbors are unknown.
+bool MineSolver::BuildConstraint(std::uint32_t tile, Constraint& constraint) const
+{
+	std::uint32_t cKnownMines{ 0 };
+
+	ForEachNeighbor(m_pNeighbors, tile, m_width, m_height, [&](std::uint32_t neighbor)
+	{
+		if (m_aKnowledge[neighbor] == Knowledge::UNKNOWN)
+		{
+			constraint.aTiles[constraint.cTiles++] = neighbor;
+		}
+		else if (m_aKnowledge[neighbor] == Knowledge::MINE)
+		{
+			++cKnownMines;
+		}
+	});
+
+	constraint.cMines = m_aCounts[tile] >= cKnownMines ? m_aCounts[tile] - cKnownMines : 0;
+	return constraint.cTiles > 0;
+}
+
+void MineSolver::AddDeduction(std::uint32_t tile, bool bMine, std::vector<std::uint32_t>& aSafeTiles,
+	std::vector<std::uint32_t>& aMines)
+{
+	if (!m_aDeduced[tile])
+	{
+		m_aDeduced[tile] = 1;
+		(bMine ? aMines : aSafeTiles).push_back(tile);
+	}
+}
\ No newline at end of file
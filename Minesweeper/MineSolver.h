@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "PresetBoard.h"
+
+/*
+*	Deduces which hidden tiles are safe and which are mines
+*	from what a player knows: the numbers of revealed tiles,
+*	known mines and the total number of mines. It never
+*	looks at the actual mine positions, so a board it solves
+*	from the first click can be solved without guessing.
+*
+*	Revealed tiles with hidden neighbors form the frontier,
+*	each giving a constraint "cMines of these tiles are
+*	mines". Deduce applies, cheapest first:
+*		- single constraints that are all safe or all mines
+*		- pairs of nearby constraints where one's tiles are a
+*		  subset of the other's, the tiles left over then
+*		  hold the difference of their mines
+*		- the global mine count
+*
+*	It is updated incrementally as tiles become known, so one
+*	solver can follow a whole game. Beyond deductions it
+*	gives the chance of each tile being a mine, for hints
+*	and the probability overlay.
+*/
+class MineSolver
+{
+public:
+	// Boards a game keeps a solver for, larger ones would slow every move down.
+	static constexpr std::uint32_t MAX_TILES{ 256 * 256 };
+
+	void Reset(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+
+	void SetRevealed(std::uint32_t tile, std::uint32_t cAdjacentMines);	// The tile is safe and shows cAdjacentMines.
+	void SetMine(std::uint32_t tile);									// The tile is known to be a mine.
+
+	bool IsUnknown(std::uint32_t tile) const;
+	std::uint32_t GetUnknownCount() const;
+
+	// Appends newly deduced tiles, returns if any were found.
+	bool Deduce(std::vector<std::uint32_t>& aSafeTiles, std::vector<std::uint32_t>& aMines);
+
+	void GetMineProbabilities(std::vector<float>& aProbabilities);
+	bool GetHint(std::uint32_t& tile);		// Finds the tile least likely to be a mine, returns if it is safe.
+
+private:
+	enum class Knowledge : std::uint8_t
+	{
+		UNKNOWN,
+		SAFE,
+		MINE,
+	};
+
+	// cMines of the unknown tiles around a revealed tile are mines, the tiles are sorted.
+	struct Constraint
+	{
+		std::uint32_t aTiles[8]{};
+		std::uint32_t cTiles{ 0 };
+		std::uint32_t cMines{ 0 };
+	};
+
+	// Tiles linked by shared constraints, which are counted together.
+	struct Component
+	{
+		std::vector<std::uint32_t> aTiles{};				// Sorted.
+		std::vector<std::uint32_t> aConstraints{};			// Indices into m_aConstraints.
+	};
+
+	// Mine layouts of a component, aTileWeights holding for k mines and tile i the layouts with a mine on i at [k * tiles + i].
+	struct ComponentCounts
+	{
+		std::vector<double> aWeights{};
+		std::vector<double> aTileWeights{};
+		bool bExact{ false };								// False if counting ran out of steps.
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const std::vector<std::uint32_t>& key) const;
+	};
+
+	static constexpr std::uint64_t MAX_ENUMERATION_STEPS{ 1 << 18 };	// Keeps the overlay interactive on hard components.
+	static constexpr std::uint32_t MAX_COMPONENT_TILES{ 256 };
+	static constexpr std::size_t MAX_CACHED_COMPONENTS{ 1024 };
+
+	std::uint32_t m_width{ 0 };
+	std::uint32_t m_height{ 0 };
+	std::uint32_t m_cMines{ 0 };
+	std::uint32_t m_cKnownMines{ 0 };
+	std::uint32_t m_cUnknown{ 0 };
+	const TileNeighbors* m_pNeighbors{ nullptr };		// Neighbor table of a preset board, nullptr for other sizes.
+	std::vector<Knowledge> m_aKnowledge{};
+	std::vector<std::uint8_t> m_aCounts{};				// Number shown by each revealed tile.
+	std::vector<std::uint32_t> m_aFrontier{};			// Revealed tiles that may still have unknown neighbors.
+	std::vector<Constraint> m_aConstraints{};			// Constraint of each frontier tile while deducing.
+	std::vector<std::uint32_t> m_aConstraintIndex{};	// Index into m_aConstraints of every tile, or UINT32_MAX.
+	std::vector<std::uint8_t> m_aDeduced{};				// Set for tiles already in this Deduce's results.
+	std::vector<std::uint32_t> m_aParents{};			// Union-find parent of every frontier tile, or UINT32_MAX.
+	std::vector<Component> m_aComponents{};
+	std::unordered_map<std::vector<std::uint32_t>, ComponentCounts, KeyHash> m_componentCache{};
+
+	void BuildConstraints();
+	void ClearConstraints();
+	void FindComponents();
+	const ComponentCounts& GetComponentCounts(const Component& component);
+	bool BuildConstraint(std::uint32_t tile, Constraint& constraint) const;
+	void AddDeduction(std::uint32_t tile, bool bMine, std::vector<std::uint32_t>& aSafeTiles, std::vector<std::uint32_t>& aMines);
+};
\ No newline at end of file
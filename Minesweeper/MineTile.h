@@ -1,48 +1,49 @@
 #pragma once
-#include <atlbase.h>
-#include <d2d1.h>
-#include <windef.h>
+#include <cstdint>
 
 #include "enums.h"
-
+#include "TileBoard.h"
+
+/*
+*	A thin view of a single tile stored in a TileBoard. The
+*	view holds no tile data itself, every getter and setter
+*	reads or writes the packed planes of the board. It keeps
+*	the position of the tile, so reading it finds the chunk
+*	of the tile without dividing by the width of the board.
+*/
 class MineTile
 {
 public:
-	MineTile() :
-		m_tileState{ TileState::HIDDEN },
-		m_tileContent{ TileContent::EMPTY },
-		m_tileMark{ TileMark::NONE },
-		m_drawRect{ D2D1::RectF(0,0,0,0) } {}
-
-	TileState GetTileState() const { return m_tileState; }
-	void SetTileState(TileState state) { m_tileState = state; }
-
-	TileContent GetTileContent() const { return m_tileContent; }
-	void SetTileContent(TileContent content) { m_tileContent = content; }
+	MineTile(TileBoard& board, std::uint32_t x, std::uint32_t y) : m_pBoard{ &board }, m_index{ x + y * board.GetWidth() }, m_x{ x }, m_y{ y } {}
+	MineTile(TileBoard& board, std::uint32_t index) : MineTile(board, index % board.GetWidth(), index / board.GetWidth()) {}
 
-	TileMark GetTileMark() const { return m_tileMark; }
-	void SetTileMark(TileMark mark) { m_tileMark = mark; }
+	TileState GetTileState() const { return m_pBoard->GetState(m_x, m_y); }
+	void SetTileState(TileState state) { m_pBoard->SetState(m_x, m_y, state); }
 
-	const D2D1_RECT_F& GetDrawRect() const { return m_drawRect; }
-
-	void SetDrawRect(D2D1_RECT_F drawRect)
+	TileContent GetTileContent() const
 	{
-		m_drawRect = drawRect;
+		return m_pBoard->IsMine(m_x, m_y) ? TileContent::MINE : static_cast<TileContent>(m_pBoard->GetAdjacentCount(m_x, m_y));
 	}
 
-	void SetDrawRect(float left, float top, float nWidth, float nHeight)
+	void SetTileContent(TileContent content)
 	{
-		m_drawRect = D2D1::RectF(left, top, left + nWidth, top + nHeight);
+		if (content == TileContent::MINE)
+		{
+			m_pBoard->SetMine(m_index, true);
+		}
+		else
+		{
+			m_pBoard->SetMine(m_index, false);
+			m_pBoard->SetAdjacentCount(m_index, static_cast<std::uint32_t>(content));
+		}
 	}
 
-private:
-	TileState m_tileState{ TileState::HIDDEN };
-	TileContent m_tileContent{ TileContent::EMPTY };
-	TileMark m_tileMark{ TileMark::NONE };
+	TileMark GetTileMark() const { return m_pBoard->GetMark(m_x, m_y); }
+	void SetTileMark(TileMark mark) { m_pBoard->SetMark(m_index, mark); }
 
-	/*
-	*	Stores rectangle that contains the tile position in
-	*	the Minefield window for drawing purposes
-	*/
-	D2D1_RECT_F m_drawRect{ D2D1::RectF(0,0,0,0) };
+private:
+	TileBoard* m_pBoard{ nullptr };
+	std::uint32_t m_index{ 0 };
+	std::uint32_t m_x{ 0 };
+	std::uint32_t m_y{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,1336 @@
+#include "MinefieldEngine.h"
+#include "AdjacencyKernel.h"
+
+#include <algorithm>
+#include <bitset>
+#include <vector>
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+/*
+*	Constructs a minefield with a given width, height, and
+*	number of mines. Also by default we set question mark
+*	usage as disabled.
+*/
+MinefieldEngine::MinefieldEngine(std::uint32_t width, std::uint32_t height, std::uint32_t cMines) :
+	m_width{ width }, m_height{ height }, m_cTiles{ width * height }, m_cMines{ cMines }, m_cRevealedTiles{ 0 },
+	m_cFlaggedTiles{ 0 }, m_bGameLost{ false }, m_bQuestionMarksEnabled{ false }, m_rng{}
+{
+	if (m_cMines > m_cTiles)
+	{
+		m_cMines = m_cTiles;
+	}
+
+	m_gameSeed = m_rng.Next();
+	m_bMinesPlaced = false;
+	m_board.Reset(m_width, m_height);
+	MarkAllDirty();
+}
+
+std::uint32_t MinefieldEngine::GetWidth() const
+{
+	return m_width;
+}
+
+std::uint32_t MinefieldEngine::GetHeight() const
+{
+	return m_height;
+}
+
+std::uint32_t MinefieldEngine::GetSize() const
+{
+	return m_cTiles;
+}
+
+std::uint32_t MinefieldEngine::GetMineCount() const
+{
+	return m_cMines;
+}
+
+std::uint32_t MinefieldEngine::GetRevealedCount() const
+{
+	return m_cRevealedTiles;
+}
+
+std::uint32_t MinefieldEngine::GetFlaggedCount() const
+{
+	return m_cFlaggedTiles;
+}
+
+bool MinefieldEngine::IsGameLost() const
+{
+	return m_bGameLost;
+}
+
+/*
+*	Returns whether the minesweeper game has been won.
+*	In particular, a game is won if:
+*	a) the game is not currently lost
+*	b) we have clicked a tile, and
+*	c) all tiles not containing a mine are clicked.
+*
+*	Normally condition (b) would be writted as
+*	m_cTiles - m_cMines <= m_cRevealedTiles,
+*	but since each variable is unsigned we move m_cMines to
+*	the other side of the inequality.
+*/
+bool MinefieldEngine::IsGameWon() const
+{
+	return !m_bGameLost && ((m_cTiles <= m_cMines + m_cRevealedTiles) && (m_cRevealedTiles > 0));
+}
+
+bool MinefieldEngine::IsGameActive() const
+{
+	return !(IsGameLost() || IsGameWon());
+}
+
+bool MinefieldEngine::IsGameStarted() const
+{
+	return m_cRevealedTiles > 0;
+}
+
+// Stays true when the first reveal is undone, the game goes on with the same mines.
+bool MinefieldEngine::AreMinesPlaced() const
+{
+	return m_bMinesPlaced;
+}
+
+bool MinefieldEngine::AreQuestionMarksEnabled() const
+{
+	return m_bQuestionMarksEnabled;
+}
+
+std::uint64_t MinefieldEngine::GetGameSeed() const
+{
+	return m_gameSeed;
+}
+
+// The 3BV is counted along with the numbers, it is not known for games continued from a save or too large boards.
+std::uint32_t MinefieldEngine::GetThreeBV() const
+{
+	return m_bMinesPlaced ? m_threeBV : 0;
+}
+
+/*
+*	Sets the seed the mines of the current game are drawn
+*	from, e.g. to replay a board. Has no effect once the
+*	mines have been generated or placed, even before the
+*	first tile is revealed, so the seed always belongs to
+*	the board.
+*/
+void MinefieldEngine::SetGameSeed(std::uint64_t seed)
+{
+	if (!m_bMinesPlaced)
+	{
+		m_gameSeed = seed;
+	}
+}
+
+bool MinefieldEngine::Resize(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	if (m_width != width || m_height != height || m_cMines != cMines)
+	{
+		m_width = width;
+		m_height = height;
+		m_cTiles = m_width * m_height;
+		m_cMines = cMines;
+
+		if (m_cMines > m_cTiles)
+		{
+			m_cMines = m_cTiles;
+		}
+
+		ResetGame();
+
+		return true;
+	}
+
+	return false;
+}
+
+/*
+*	Starts a new game on a board of the same size. The board
+*	and the dirty set keep their storage, so games played
+*	back to back don't allocate anything.
+*/
+void MinefieldEngine::ResetGame()
+{
+	m_bGameLost = false;
+	m_cRevealedTiles = 0;
+	m_cFlaggedTiles = 0;
+	m_gameSeed = m_rng.Next();
+	m_bMinesPlaced = false;
+	m_threeBV = 0;
+	m_board.Reset(m_width, m_height);
+	m_aRevealedSpans.clear();
+	ClearHistory();
+	MarkAllDirty();
+}
+
+/*
+*	Toggles whether or not question mark usage is enabled
+*	or disabled. Disabling it removes the question marks,
+*	only the tiles with a mark are looked at.
+*/
+void MinefieldEngine::ToggleQuestionMarkUsage()
+{
+	m_bQuestionMarksEnabled = !m_bQuestionMarksEnabled;
+
+	if (!m_bQuestionMarksEnabled)
+	{
+		m_board.ForEachMarkedTile([this](std::uint32_t tile, TileMark mark)
+		{
+			if (mark == TileMark::QUESTION_MARK)
+			{
+				SetTileMark(tile, TileMark::NONE);
+			}
+		});
+	}
+}
+
+MinefieldEngine::GameState MinefieldEngine::GetGameState() const
+{
+	return { m_width, m_height, m_cMines, m_cRevealedTiles, m_cFlaggedTiles, m_gameSeed, m_bGameLost, m_bQuestionMarksEnabled, m_bMinesPlaced };
+}
+
+/*
+*	Continues the game described by state on board, which
+*	must be state.width x state.height and hold the tiles the
+*	game had, e.g. from a saved game. The whole board is
+*	marked dirty, its tiles are read once they are drawn.
+*/
+void MinefieldEngine::RestoreGame(const GameState& state, TileBoard&& board)
+{
+	m_width = state.width;
+	m_height = state.height;
+	m_cTiles = m_width * m_height;
+	m_cMines = std::min(state.cMines, m_cTiles);
+	m_cRevealedTiles = state.cRevealedTiles;
+	m_cFlaggedTiles = state.cFlaggedTiles;
+	m_gameSeed = state.gameSeed;
+	m_bGameLost = state.bGameLost;
+	m_bQuestionMarksEnabled = state.bQuestionMarksEnabled;
+	m_bMinesPlaced = state.bMinesPlaced;
+	m_threeBV = 0;
+	m_board = std::move(board);
+	m_aRevealedSpans.clear();
+	ClearHistory();
+	MarkAllDirty();
+}
+
+void MinefieldEngine::ReleaseBoardStorage()
+{
+	m_board.ReleaseStorage();
+}
+
+/*
+*	Sets how many bytes the moves kept for undo and redo may
+*	take. Once they take more the oldest moves are dropped.
+*	A budget of 0, the default, records no moves at all, so
+*	headless players don't pay for copying chunks.
+*/
+void MinefieldEngine::SetHistoryBudget(std::size_t cBytes)
+{
+	m_historyBudget = cBytes;
+
+	if (m_historyBudget == 0)
+	{
+		ClearHistory();
+	}
+	else
+	{
+		TrimHistory();
+	}
+}
+
+std::size_t MinefieldEngine::GetHistorySize() const
+{
+	return m_cHistoryBytes;
+}
+
+bool MinefieldEngine::CanUndo() const
+{
+	return !m_aUndoHistory.empty();
+}
+
+bool MinefieldEngine::CanRedo() const
+{
+	return !m_aRedoHistory.empty();
+}
+
+/*
+*	Puts the chunks the last move changed back the way they
+*	were before it, which takes time in the number of chunks
+*	the move changed, not in the size of the board.
+*/
+bool MinefieldEngine::Undo()
+{
+	if (m_aUndoHistory.empty())
+	{
+		return false;
+	}
+
+	ReplayHistory(m_aUndoHistory, m_aRedoHistory);
+	return true;
+}
+
+bool MinefieldEngine::Redo()
+{
+	if (m_aRedoHistory.empty())
+	{
+		return false;
+	}
+
+	ReplayHistory(m_aRedoHistory, m_aUndoHistory);
+	return true;
+}
+
+// Provides access to Mine tile at index in tile array.
+MineTile MinefieldEngine::operator()(std::uint32_t index)
+{
+	return MineTile(m_board, index);
+}
+
+// Provides access to Mine tile at position (x,y) in minefield.
+MineTile MinefieldEngine::operator()(std::uint32_t x, std::uint32_t y)
+{
+	return MineTile(m_board, x, y);
+}
+
+/*
+*	The returned view is const so none of its setters can be
+*	used, which makes removing the constness of the board safe.
+*/
+const MineTile MinefieldEngine::operator()(std::uint32_t index) const
+{
+	return MineTile(const_cast<TileBoard&>(m_board), index);
+}
+
+const MineTile MinefieldEngine::operator()(std::uint32_t x, std::uint32_t y) const
+{
+	return MineTile(const_cast<TileBoard&>(m_board), x, y);
+}
+
+const TileBoard& MinefieldEngine::GetBoard() const
+{
+	return m_board;
+}
+
+std::shared_ptr<const TileBoard> MinefieldEngine::ShareBoard()
+{
+	return m_board.Share();
+}
+
+const std::vector<std::uint32_t>& MinefieldEngine::GetDirtyTiles() const
+{
+	return m_aDirtyTiles;
+}
+
+const std::vector<TileSpan>& MinefieldEngine::GetRevealedSpans() const
+{
+	return m_aRevealedSpans;
+}
+
+bool MinefieldEngine::IsRedrawAllPending() const
+{
+	return m_bRedrawAll;
+}
+
+void MinefieldEngine::ClearDirtyTiles()
+{
+	for (const std::uint32_t tile : m_aDirtyTiles)
+	{
+		m_aDirtyPlane[tile >> 6] &= ~(std::uint64_t{ 1 } << (tile & 63));
+	}
+
+	m_aDirtyTiles.clear();
+	m_aRevealedSpans.clear();
+	m_bRedrawAll = false;
+}
+
+/*
+*	Generate the Mine positions given that the the first
+*	clicked tile is at positon (x,y) in the minefield grid.
+*
+*	The candidates are the tiles outside of the excluded
+*	square around (x,y), numbered in row-major order. Mines
+*	are drawn from them with Floyd's algorithm, which picks a
+*	uniformly random set with exactly one draw per mine and
+*	uses the mine bitplane as its set of drawn tiles, so
+*	placing the mines takes O(mines) time and no memory
+*	besides the bitplane. The draws only depend on the game
+*	seed, so a board is reproduced by its seed and first click.
+*	Has no effect once the mines have been placed, which they
+*	stay when the first reveal is undone.
+*/
+void MinefieldEngine::GenerateMines(std::uint32_t x, std::uint32_t y)
+{
+	if (m_bMinesPlaced)
+	{
+		return;
+	}
+
+	const std::uint32_t radius{ m_cTiles - m_cMines < 9 ? 0u : 1u };
+	const TileNeighborhood excludedTiles{ GetTileGrid(x, y, radius) };
+	const std::uint32_t cCandidates{ m_cTiles - excludedTiles.size() };
+	const std::uint32_t cMinesToPlace{ std::min(m_cMines, cCandidates) };
+
+	// Returns the tile of a candidate's number by skipping the excluded tiles, which are sorted, before it.
+	auto getCandidateTile = [&](std::uint32_t candidate)
+	{
+		std::uint32_t tile{ candidate };
+
+		for (const std::uint32_t excludedTile : excludedTiles)
+		{
+			if (excludedTile <= tile)
+			{
+				++tile;
+			}
+		}
+
+		return tile;
+	};
+
+	RNG rng{ m_gameSeed };
+
+	for (std::uint32_t candidate{ cCandidates - cMinesToPlace }; candidate < cCandidates; ++candidate)
+	{
+		const std::uint32_t tile{ getCandidateTile(rng.GetInt<std::uint32_t>(0, candidate)) };
+		m_board.SetMine(m_board.IsMine(tile) ? getCandidateTile(candidate) : tile, true);
+	}
+
+	m_bMinesPlaced = true;
+	GenerateNumbers();
+}
+
+/*
+*	Places the mines of the game at the given tiles instead
+*	of generating them on the first click, e.g. for a board
+*	that was checked to be solvable from where the player
+*	clicks. Has no effect once the mines have been placed.
+*/
+void MinefieldEngine::PlaceMines(const std::vector<std::uint32_t>& aMineTiles)
+{
+	if (m_bMinesPlaced)
+	{
+		return;
+	}
+
+	for (const std::uint32_t tile : aMineTiles)
+	{
+		m_board.SetMine(tile, true);
+	}
+
+	m_bMinesPlaced = true;
+	GenerateNumbers();
+}
+
+/*
+*	Given a minefield with filled in mines, generates the
+*	numbers that each tile should have. The board is walked
+*	chunk by chunk, the AdjacencyKernel counting with the
+*	mine rows of the chunk and its neighbors. Chunks with no
+*	mines in or around them are skipped, so their count planes are never
+*	allocated. Boards up to MAX_THREE_BV_TILES then have
+*	their 3BV counted.
+*/
+void MinefieldEngine::GenerateNumbers()
+{
+	for (std::uint32_t chunkY{ 0 }; chunkY < m_board.GetChunkRows(); ++chunkY)
+	{
+		for (std::uint32_t chunkX{ 0 }; chunkX < m_board.GetChunkColumns(); ++chunkX)
+		{
+			bool bMinesNearby{ false };
+
+			for (const std::uint32_t chunk : TileNeighborhood(chunkX, chunkY, 1, m_board.GetChunkColumns(), m_board.GetChunkRows()))
+			{
+				bMinesNearby = bMinesNearby || m_board.HasMines(chunk % m_board.GetChunkColumns(), chunk / m_board.GetChunkColumns());
+			}
+
+			if (bMinesNearby)
+			{
+				AdjacencyKernel::CountChunk(m_board, chunkX, chunkY);
+			}
+		}
+	}
+
+	m_threeBV = 0;
+
+	if (m_cTiles <= MAX_THREE_BV_TILES)
+	{
+		CountThreeBV();
+	}
+}
+
+/*
+*	Handles a player revealing the tile at (x,y). The mines
+*	are generated around the first revealed tile so that
+*	the first click of a game is always safe.
+*/
+void MinefieldEngine::RevealTile(std::uint32_t x, std::uint32_t y)
+{
+	const std::uint32_t cRevealedTiles{ m_cRevealedTiles };
+	BeginMove();
+
+	if (!m_bMinesPlaced)
+	{
+		GenerateMines(x, y);
+	}
+
+	SetTileRevealed(x, y);
+	EndMove(m_cRevealedTiles != cRevealedTiles);
+}
+
+/*
+*	Sets the Tile at (x,y) as revealed. If it has no adjacent
+*	mines, the empty region around it is revealed as well,
+*	together with the numbers bordering that region.
+*/
+void MinefieldEngine::SetTileRevealed(std::uint32_t x, std::uint32_t y)
+{
+	if (CanReveal(x, y))
+	{
+		const std::size_t firstSpan{ m_aRevealedSpans.size() };
+
+		if (IsFloodable(x, y) && m_cTiles >= PARALLEL_FLOOD_MIN_TILES && ThreadPool::Shared().GetThreadCount() > 1)
+		{
+			ParallelFloodReveal(x, y);
+		}
+		else if (IsFloodable(x, y))
+		{
+			FloodReveal(x, y);
+		}
+		else
+		{
+			RevealSpan(y, x, x + 1);
+			m_bGameLost = m_bGameLost || m_board.IsMine(x, y);
+		}
+
+		MarkSpansDirty(firstSpan);
+
+		// Ending the game changes how every hidden tile is drawn.
+		if (!IsGameActive())
+		{
+			MarkAllDirty();
+		}
+	}
+}
+
+/*
+*	Cycles the mark of the hidden tile at (x,y) between
+*	none, flag and (if enabled) question mark.
+*/
+void MinefieldEngine::CycleTileMark(std::uint32_t x, std::uint32_t y)
+{
+	const std::uint32_t index{ x + y * m_width };
+
+	if (m_board.GetState(index) == TileState::HIDDEN)
+	{
+		BeginMove();
+
+		switch (m_board.GetMark(index))
+		{
+		case TileMark::NONE:
+			++m_cFlaggedTiles;
+			SetTileMark(index, TileMark::FLAG);
+			break;
+		case TileMark::FLAG:
+			--m_cFlaggedTiles;
+			if (m_bQuestionMarksEnabled)
+			{
+				SetTileMark(index, TileMark::QUESTION_MARK);
+			}
+			else
+			{
+				SetTileMark(index, TileMark::NONE);
+			}
+			break;
+		case TileMark::QUESTION_MARK:
+			SetTileMark(index, TileMark::NONE);
+			break;
+		}
+
+		EndMove(true);
+	}
+}
+
+// Shows the hidden, unflagged tiles around (x,y) as being pressed down.
+void MinefieldEngine::PressTiles(std::uint32_t x, std::uint32_t y, std::uint32_t radius)
+{
+	for (std::uint32_t tile : GetTileGrid(x, y, radius))
+	{
+		if (m_board.GetState(tile) == TileState::HIDDEN && m_board.GetMark(tile) != TileMark::FLAG)
+		{
+			SetTileState(tile, TileState::CLICKED);
+		}
+	}
+}
+
+// Returns the pressed tiles around (x,y) to being hidden.
+void MinefieldEngine::ReleaseTiles(std::uint32_t x, std::uint32_t y, std::uint32_t radius)
+{
+	for (std::uint32_t tile : GetTileGrid(x, y, radius))
+	{
+		if (m_board.GetState(tile) == TileState::CLICKED)
+		{
+			SetTileState(tile, TileState::HIDDEN);
+		}
+	}
+}
+
+/*
+*	Handles the process of updating tiles when mouse moves
+*	from (oldX, oldY) to (newX, newY) on the field. radius
+*	sets the radius of tiles to update.
+*/
+void MinefieldEngine::MovePos(std::uint32_t oldX, std::uint32_t oldY, std::uint32_t newX, std::uint32_t newY,
+	std::uint32_t radius)
+{
+	ReleaseTiles(oldX, oldY, radius);
+	PressTiles(newX, newY, radius);
+}
+
+// Handles beginning to chord at a position (x,y) on the minefield.
+void MinefieldEngine::BeginChord(std::uint32_t x, std::uint32_t y)
+{
+	PressTiles(x, y, 1);
+}
+
+/*
+*	Handles the end of a chording move. Reveals tiles if the
+*	number of the tiles matches the number of surrounding flags
+*	when chord ends by lifting mouse button. Returns whether
+*	the chord revealed the surrounding tiles.
+*/
+bool MinefieldEngine::EndChord(std::uint32_t x, std::uint32_t y)
+{
+	if (m_board.GetState(x, y) == TileState::REVEALED)
+	{
+		std::uint32_t cFlags{ 0 };
+
+		for (std::uint32_t tile : GetTileGrid(x, y, 1))
+		{
+			if (m_board.GetMark(tile) == TileMark::FLAG)
+			{
+				++cFlags;
+			}
+		}
+
+		if (cFlags == GetNumberAdjacentMines(x, y))
+		{
+			const std::uint32_t cRevealedTiles{ m_cRevealedTiles };
+			BeginMove();
+
+			for (std::uint32_t tile : GetTileGrid(x, y, 1))
+			{
+				SetTileRevealed(tile % m_width, tile / m_width);
+			}
+
+			EndMove(m_cRevealedTiles != cRevealedTiles);
+			return true;
+		}
+	}
+
+	ReleaseTiles(x, y, 1);
+
+	return false;
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+/*
+*	Returns the number of mines that are adjacent to the
+*	that are adjacent to the tile at position (x,y)
+*/
+std::uint32_t MinefieldEngine::GetNumberAdjacentMines(std::uint32_t x, std::uint32_t y) const
+{
+	std::uint32_t cAdjacentMines{ 0 };
+
+	for (const auto tile : GetTileGrid(x, y, 1))
+	{
+		if (m_board.IsMine(tile))
+		{
+			++cAdjacentMines;
+		}
+	}
+
+	return cAdjacentMines;
+}
+
+/*
+*	Counts the 3BV of the board, the fewest clicks solving
+*	it: one for every opening, a region of connected tiles
+*	without adjacent mines that a click reveals along with
+*	its border, and one for every numbered tile bordering no
+*	opening. The board is read once, row by row. The tiles
+*	without adjacent mines of a row form runs, which are
+*	joined by a union-find with the runs of the row above
+*	that they touch, diagonally too. Bitmasks of those tiles
+*	in three rows tell which numbered tiles of the middle
+*	row border an opening. Takes O(tiles) time and
+*	O(width + runs) memory, which is kept for the next board.
+*/
+void MinefieldEngine::CountThreeBV()
+{
+	const std::size_t cWords{ (static_cast<std::size_t>(m_width) + 63) / 64 };
+	std::uint32_t cOpenings{ 0 };
+	std::uint32_t cLoneNumbers{ 0 };
+
+	m_aOpeningParents.clear();
+	m_aZeroRuns.clear();
+	m_aZeroRows.assign(3 * cWords, 0);
+	m_aNumberRows.assign(2 * cWords, 0);
+
+	const auto findRoot{ [this](std::uint32_t node)
+	{
+		while (m_aOpeningParents[node] != node)
+		{
+			m_aOpeningParents[node] = m_aOpeningParents[m_aOpeningParents[node]];
+			node = m_aOpeningParents[node];
+		}
+
+		return node;
+	} };
+
+	// Row y is kept in the slots y % 3 of the zero rows and y % 2 of the number rows, the row above row 0 stays empty.
+	for (std::uint32_t y{ 0 }; y <= m_height; ++y)
+	{
+		std::uint64_t* pZeros{ &m_aZeroRows[(y % 3) * cWords] };
+		std::uint64_t* pNumbers{ &m_aNumberRows[(y % 2) * cWords] };
+		std::fill(pZeros, pZeros + cWords, 0);
+		std::fill(pNumbers, pNumbers + cWords, 0);
+
+		const std::size_t cRunsAbove{ m_aZeroRuns.size() };
+		std::size_t runAbove{ 0 };
+
+		for (std::uint32_t x{ 0 }; y < m_height && x < m_width;)
+		{
+			if (m_board.IsMine(x, y))
+			{
+				++x;
+			}
+			else if (m_board.GetAdjacentCount(x, y) != 0)
+			{
+				pNumbers[x >> 6] |= std::uint64_t{ 1 } << (x & 63);
+				++x;
+			}
+			else
+			{
+				const std::uint32_t xBegin{ x };
+
+				for (; x < m_width && !m_board.IsMine(x, y) && m_board.GetAdjacentCount(x, y) == 0; ++x)
+				{
+					pZeros[x >> 6] |= std::uint64_t{ 1 } << (x & 63);
+				}
+
+				const std::uint32_t opening{ static_cast<std::uint32_t>(m_aOpeningParents.size()) };
+				m_aOpeningParents.push_back(opening);
+				++cOpenings;
+
+				// Runs of the row above touch this one if they overlap [xBegin - 1, x], the new run stays the root of its opening.
+				while (runAbove < cRunsAbove && m_aZeroRuns[runAbove].xEnd < xBegin)
+				{
+					++runAbove;
+				}
+
+				for (std::size_t run{ runAbove }; run < cRunsAbove && m_aZeroRuns[run].xBegin <= x; ++run)
+				{
+					const std::uint32_t rootAbove{ findRoot(m_aZeroRuns[run].opening) };
+
+					if (rootAbove != opening)
+					{
+						m_aOpeningParents[rootAbove] = opening;
+						--cOpenings;
+					}
+				}
+
+				m_aZeroRuns.push_back({ xBegin, x, opening });
+			}
+		}
+
+		m_aZeroRuns.erase(m_aZeroRuns.begin(), m_aZeroRuns.begin() + cRunsAbove);
+
+		// With the row below known, the numbered tiles of the row above are checked for bordering an opening.
+		if (y > 0)
+		{
+			const std::uint64_t* aRows[]{ &m_aZeroRows[((y + 1) % 3) * cWords], &m_aZeroRows[((y - 1) % 3) * cWords], pZeros };
+			const std::uint64_t* pNumbersAbove{ &m_aNumberRows[((y - 1) % 2) * cWords] };
+
+			for (std::size_t word{ 0 }; word < cWords; ++word)
+			{
+				std::uint64_t bordered{ 0 };
+
+				for (const std::uint64_t* pRow : aRows)
+				{
+					const std::uint64_t left{ word > 0 ? pRow[word - 1] >> 63 : 0 };
+					const std::uint64_t right{ word + 1 < cWords ? pRow[word + 1] << 63 : 0 };
+					bordered |= pRow[word] | (pRow[word] << 1) | left | (pRow[word] >> 1) | right;
+				}
+
+				cLoneNumbers += static_cast<std::uint32_t>(std::bitset<64>{ pNumbersAbove[word] & ~bordered }.count());
+			}
+		}
+	}
+
+	m_threeBV = cOpenings + cLoneNumbers;
+}
+
+/*
+*	Returns the range of all tiles in a square grid centered
+*	at (x, y) with a given radius. The range is sorted and
+*	is iterated without allocating.
+*/
+TileNeighborhood MinefieldEngine::GetTileGrid(std::uint32_t x, std::uint32_t y, std::uint32_t radius) const
+{
+	return TileNeighborhood(x, y, radius, m_width, m_height);
+}
+
+// Returns if the tile at (x,y) is neither revealed nor flagged.
+bool MinefieldEngine::CanReveal(std::uint32_t x, std::uint32_t y) const
+{
+	return m_board.GetState(x, y) != TileState::REVEALED && m_board.GetMark(x, y) != TileMark::FLAG;
+}
+
+// Returns if revealing the tile at (x,y) also reveals its neighbors.
+bool MinefieldEngine::IsFloodable(std::uint32_t x, std::uint32_t y) const
+{
+	return CanReveal(x, y) && !m_board.IsMine(x, y) && m_board.GetAdjacentCount(x, y) == 0;
+}
+
+/*
+*	Reveals the empty region containing (x,y) with a scanline
+*	fill. Each seed popped from the work stack is grown into
+*	the widest run of floodable tiles on its row, which is
+*	revealed along with the numbers at both of its ends.
+*	The rows above and below are then scanned once over the
+*	run's columns plus one on each side: numbers there are
+*	revealed right away and each run of floodable tiles
+*	pushes a single seed. Every tile is thereby looked at a
+*	bounded number of times instead of once per neighbor.
+*
+*	The work stack belongs to the engine, so after the first
+*	large reveal no fill allocates. The tiles revealed are
+*	appended to m_aRevealedSpans.
+*/
+void MinefieldEngine::FloodReveal(std::uint32_t x, std::uint32_t y)
+{
+	m_aFillStack.clear();
+	m_aFillStack.push_back(x + y * m_width);
+
+	while (!m_aFillStack.empty())
+	{
+		const std::uint32_t seed{ m_aFillStack.back() };
+		m_aFillStack.pop_back();
+
+		const std::uint32_t row{ seed / m_width };
+		std::uint32_t xBegin{ seed % m_width };
+		std::uint32_t xEnd{ xBegin + 1 };
+
+		// Seeds can be pushed by several runs, all but the first find their run already revealed.
+		if (!IsFloodable(xBegin, row))
+		{
+			continue;
+		}
+
+		while (xBegin > 0 && IsFloodable(xBegin - 1, row))
+		{
+			--xBegin;
+		}
+
+		while (xEnd < m_width && IsFloodable(xEnd, row))
+		{
+			++xEnd;
+		}
+
+		const std::uint32_t scanBegin{ xBegin > 0 ? xBegin - 1 : 0 };
+		const std::uint32_t scanEnd{ std::min(xEnd + 1, m_width) };
+
+		RevealSpan(row, scanBegin < xBegin && CanReveal(scanBegin, row) ? scanBegin : xBegin,
+			scanEnd > xEnd && CanReveal(xEnd, row) ? scanEnd : xEnd);
+
+		if (row > 0)
+		{
+			ScanFloodRow(row - 1, scanBegin, scanEnd);
+		}
+
+		if (row + 1 < m_height)
+		{
+			ScanFloodRow(row + 1, scanBegin, scanEnd);
+		}
+	}
+}
+
+/*
+*	Scans the tiles [xBegin, xEnd) of row y, which neighbor
+*	a run of revealed empty tiles. Tiles that can be revealed
+*	are, except for floodable ones which are pushed as one
+*	seed per run for FloodReveal.
+*/
+void MinefieldEngine::ScanFloodRow(std::uint32_t y, std::uint32_t xBegin, std::uint32_t xEnd)
+{
+	const std::uint32_t rowStart{ y * m_width };
+	std::uint32_t x{ xBegin };
+
+	while (x < xEnd)
+	{
+		if (IsFloodable(x, y))
+		{
+			m_aFillStack.push_back(rowStart + x);
+
+			while (x < xEnd && IsFloodable(x, y))
+			{
+				++x;
+			}
+		}
+		else if (CanReveal(x, y))
+		{
+			const std::uint32_t runBegin{ x };
+
+			while (x < xEnd && CanReveal(x, y) && !IsFloodable(x, y))
+			{
+				++x;
+			}
+
+			RevealSpan(y, runBegin, x);
+		}
+		else
+		{
+			++x;
+		}
+	}
+}
+
+/*
+*	Reveals the empty region containing (x,y) like FloodReveal
+*	but on the shared thread pool. The board is split along
+*	its chunks and each chunk is filled by at most one task
+*	at a time, which reads and writes only the tiles of that
+*	chunk. Work that crosses into another chunk, a tile next
+*	to an empty tile at the chunk's edge or part of a row to
+*	scan, is posted to that chunk's inbox and starts a task
+*	for it if it has none.
+*
+*	The revealed tiles are the empty region and its bordering
+*	numbers no matter in which order chunks run, so the result
+*	is the same as the serial fill, only the spans are cut at
+*	chunk edges.
+*/
+void MinefieldEngine::ParallelFloodReveal(std::uint32_t x, std::uint32_t y)
+{
+	const std::size_t cChunks{ static_cast<std::size_t>(m_board.GetChunkColumns()) * m_board.GetChunkRows() };
+
+	if (m_cFloodChunks != cChunks)
+	{
+		m_aFloodChunks = std::make_unique<FloodChunk[]>(cChunks);
+		m_cFloodChunks = cChunks;
+	}
+
+	ThreadPool::TaskGroup group{};
+	DispatchFloodWork(group, UINT32_MAX, { y, x, x + 1 });
+	ThreadPool::Shared().Wait(group);
+
+	for (std::size_t chunk{ 0 }; chunk < m_cFloodChunks; ++chunk)
+	{
+		for (const TileSpan& span : m_aFloodChunks[chunk].revealed)
+		{
+			m_cRevealedTiles += span.xEnd - span.xBegin;
+			m_aRevealedSpans.push_back(span);
+		}
+
+		m_aFloodChunks[chunk].revealed.clear();
+	}
+}
+
+// Adds tiles, which must lie in one chunk, to the inbox of that chunk and starts a task for it if it has none.
+void MinefieldEngine::PostFloodWork(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles)
+{
+	FloodChunk& floodChunk{ m_aFloodChunks[chunk] };
+	bool bStartTask{ false };
+
+	{
+		std::lock_guard<std::mutex> lock{ floodChunk.lock };
+		floodChunk.inbox.push_back(tiles);
+		bStartTask = !floodChunk.bScheduled;
+		floodChunk.bScheduled = true;
+	}
+
+	if (bStartTask)
+	{
+		ThreadPool::Shared().Submit(group, [this, &group, chunk]() { RunFloodChunk(group, chunk); });
+	}
+}
+
+/*
+*	Splits tiles along chunk columns. The part in the chunk
+*	the calling task owns goes straight to its work stack,
+*	the others are posted to their chunks.
+*/
+void MinefieldEngine::DispatchFloodWork(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles)
+{
+	constexpr std::uint32_t CHUNK_SHIFT{ TileBoard::CHUNK_SHIFT };
+
+	std::uint32_t xBegin{ tiles.xBegin };
+
+	while (xBegin < tiles.xEnd)
+	{
+		const std::uint32_t xEnd{ std::min(((xBegin >> CHUNK_SHIFT) + 1) << CHUNK_SHIFT, tiles.xEnd) };
+		const std::uint32_t target{ (xBegin >> CHUNK_SHIFT) + (tiles.y >> CHUNK_SHIFT) * m_board.GetChunkColumns() };
+
+		if (target == chunk)
+		{
+			m_aFloodChunks[chunk].work.push_back({ tiles.y, xBegin, xEnd });
+		}
+		else
+		{
+			PostFloodWork(group, target, { tiles.y, xBegin, xEnd });
+		}
+
+		xBegin = xEnd;
+	}
+}
+
+// Task owning a chunk, runs until the chunk's inbox is empty.
+void MinefieldEngine::RunFloodChunk(ThreadPool::TaskGroup& group, std::uint32_t chunk)
+{
+	FloodChunk& floodChunk{ m_aFloodChunks[chunk] };
+
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ floodChunk.lock };
+
+			if (floodChunk.inbox.empty())
+			{
+				floodChunk.bScheduled = false;
+				return;
+			}
+
+			floodChunk.work.insert(floodChunk.work.end(), floodChunk.inbox.begin(), floodChunk.inbox.end());
+			floodChunk.inbox.clear();
+		}
+
+		while (!floodChunk.work.empty())
+		{
+			const TileSpan tiles{ floodChunk.work.back() };
+			floodChunk.work.pop_back();
+			ScanFloodChunkRow(group, chunk, tiles);
+		}
+	}
+}
+
+/*
+*	Scans tiles next to revealed empty tiles, all within the
+*	chunk, the way ScanFloodRow does. Runs of empty tiles are
+*	filled right away but only up to the chunk's edges, the
+*	tiles past an edge and the rows above and below the run
+*	are dispatched as more work.
+*/
+void MinefieldEngine::ScanFloodChunkRow(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles)
+{
+	const std::uint32_t chunkBegin{ (chunk % m_board.GetChunkColumns()) << TileBoard::CHUNK_SHIFT };
+	const std::uint32_t chunkEnd{ std::min(chunkBegin + TileBoard::CHUNK_SIZE, m_width) };
+	FloodChunk& floodChunk{ m_aFloodChunks[chunk] };
+	std::uint32_t x{ tiles.xBegin };
+
+	while (x < tiles.xEnd)
+	{
+		if (IsFloodable(x, tiles.y))
+		{
+			std::uint32_t xBegin{ x };
+			std::uint32_t xEnd{ x + 1 };
+
+			while (xBegin > chunkBegin && IsFloodable(xBegin - 1, tiles.y))
+			{
+				--xBegin;
+			}
+
+			while (xEnd < chunkEnd && IsFloodable(xEnd, tiles.y))
+			{
+				++xEnd;
+			}
+
+			const std::uint32_t revealBegin{ xBegin > chunkBegin && CanReveal(xBegin - 1, tiles.y) ? xBegin - 1 : xBegin };
+			const std::uint32_t revealEnd{ xEnd < chunkEnd && CanReveal(xEnd, tiles.y) ? xEnd + 1 : xEnd };
+
+			for (std::uint32_t tile{ revealBegin }; tile < revealEnd; ++tile)
+			{
+				m_board.SetState(tile, tiles.y, TileState::REVEALED);
+			}
+
+			floodChunk.revealed.push_back({ tiles.y, revealBegin, revealEnd });
+
+			if (xBegin == chunkBegin && chunkBegin > 0)
+			{
+				DispatchFloodWork(group, chunk, { tiles.y, chunkBegin - 1, chunkBegin });
+			}
+
+			if (xEnd == chunkEnd && chunkEnd < m_width)
+			{
+				DispatchFloodWork(group, chunk, { tiles.y, chunkEnd, chunkEnd + 1 });
+			}
+
+			const std::uint32_t scanBegin{ xBegin > 0 ? xBegin - 1 : 0 };
+			const std::uint32_t scanEnd{ std::min(xEnd + 1, m_width) };
+
+			if (tiles.y > 0)
+			{
+				DispatchFloodWork(group, chunk, { tiles.y - 1, scanBegin, scanEnd });
+			}
+
+			if (tiles.y + 1 < m_height)
+			{
+				DispatchFloodWork(group, chunk, { tiles.y + 1, scanBegin, scanEnd });
+			}
+
+			x = revealEnd;
+		}
+		else if (CanReveal(x, tiles.y))
+		{
+			const std::uint32_t runBegin{ x };
+
+			while (x < tiles.xEnd && CanReveal(x, tiles.y) && !IsFloodable(x, tiles.y))
+			{
+				++x;
+			}
+
+			for (std::uint32_t tile{ runBegin }; tile < x; ++tile)
+			{
+				m_board.SetState(tile, tiles.y, TileState::REVEALED);
+			}
+
+			floodChunk.revealed.push_back({ tiles.y, runBegin, x });
+		}
+		else
+		{
+			++x;
+		}
+	}
+}
+
+// Reveals the tiles [xBegin, xEnd) of row y and records them as one span.
+void MinefieldEngine::RevealSpan(std::uint32_t y, std::uint32_t xBegin, std::uint32_t xEnd)
+{
+	for (std::uint32_t x{ xBegin }; x < xEnd; ++x)
+	{
+		m_board.SetState(x, y, TileState::REVEALED);
+	}
+
+	m_cRevealedTiles += xEnd - xBegin;
+	m_aRevealedSpans.push_back({ y, xBegin, xEnd });
+}
+
+
+// Sets the state of the tile at index and marks it as needing a redraw.
+void MinefieldEngine::SetTileState(std::uint32_t index, TileState state)
+{
+	m_board.SetState(index, state);
+	MarkTileDirty(index);
+}
+
+// Sets the mark of the tile at index and marks it as needing a redraw.
+void MinefieldEngine::SetTileMark(std::uint32_t index, TileMark mark)
+{
+	m_board.SetMark(index, mark);
+	MarkTileDirty(index);
+}
+
+/*
+*	Adds the tile at index to the dirty set. Once a quarter
+*	of the board is dirty, redrawing everything is cheaper
+*	than tracking more tiles so we switch to a full redraw.
+*/
+void MinefieldEngine::MarkTileDirty(std::uint32_t index)
+{
+	if (!m_bRedrawAll)
+	{
+		std::uint64_t& dirtyWord{ m_aDirtyPlane[index >> 6] };
+		const std::uint64_t bit{ std::uint64_t{ 1 } << (index & 63) };
+
+		if (!(dirtyWord & bit))
+		{
+			dirtyWord |= bit;
+			m_aDirtyTiles.push_back(index);
+
+			if (m_aDirtyTiles.size() > m_cTiles / 4)
+			{
+				MarkAllDirty();
+			}
+		}
+	}
+}
+
+/*
+*	Adds the tiles of the spans revealed since firstSpan to
+*	the dirty set. When they would pass the limit of dirty
+*	tiles the board is flagged for a full redraw right away
+*	rather than tracking tiles one by one until then.
+*/
+void MinefieldEngine::MarkSpansDirty(std::size_t firstSpan)
+{
+	if (m_bRedrawAll)
+	{
+		return;
+	}
+
+	std::size_t cTiles{ 0 };
+
+	for (std::size_t span{ firstSpan }; span < m_aRevealedSpans.size(); ++span)
+	{
+		cTiles += m_aRevealedSpans[span].xEnd - m_aRevealedSpans[span].xBegin;
+	}
+
+	if (m_aDirtyTiles.size() + cTiles > m_cTiles / 4)
+	{
+		MarkAllDirty();
+		return;
+	}
+
+	for (std::size_t span{ firstSpan }; span < m_aRevealedSpans.size(); ++span)
+	{
+		const TileSpan& tiles{ m_aRevealedSpans[span] };
+
+		for (std::uint32_t x{ tiles.xBegin }; x < tiles.xEnd; ++x)
+		{
+			MarkTileDirty(x + tiles.y * m_width);
+		}
+	}
+}
+
+// Flags the whole board for redrawing, dropping the individual dirty tiles.
+void MinefieldEngine::MarkAllDirty()
+{
+	m_aDirtyPlane.assign((static_cast<std::size_t>(m_cTiles) + 63) / 64, 0);
+	m_aDirtyTiles.clear();
+	m_bRedrawAll = true;
+}
+
+// Adds the tiles of a chunk of the board to the dirty set.
+void MinefieldEngine::MarkChunkDirty(std::uint32_t chunk)
+{
+	const std::uint32_t xBegin{ (chunk % m_board.GetChunkColumns()) << TileBoard::CHUNK_SHIFT };
+	const std::uint32_t yBegin{ (chunk / m_board.GetChunkColumns()) << TileBoard::CHUNK_SHIFT };
+	const std::uint32_t xEnd{ std::min(xBegin + TileBoard::CHUNK_SIZE, m_width) };
+	const std::uint32_t yEnd{ std::min(yBegin + TileBoard::CHUNK_SIZE, m_height) };
+
+	for (std::uint32_t y{ yBegin }; y < yEnd && !m_bRedrawAll; ++y)
+	{
+		for (std::uint32_t x{ xBegin }; x < xEnd; ++x)
+		{
+			MarkTileDirty(x + y * m_width);
+		}
+	}
+}
+
+// Starts recording the chunks the move about to be made changes, if moves are kept for undo.
+void MinefieldEngine::BeginMove()
+{
+	if (m_historyBudget > 0)
+	{
+		m_move.state = GetGameState();
+		m_board.BeginJournal(m_move.journal);
+	}
+}
+
+/*
+*	Ends recording a move and adds it to the undo history if
+*	bChanged, which drops the moves that were undone before.
+*	Moves that changed nothing but pressed tiles are dropped.
+*/
+void MinefieldEngine::EndMove(bool bChanged)
+{
+	if (m_historyBudget == 0)
+	{
+		return;
+	}
+
+	m_board.EndJournal();
+
+	if (bChanged && !m_move.journal.IsEmpty())
+	{
+		for (const HistoryEntry& entry : m_aRedoHistory)
+		{
+			m_cHistoryBytes -= entry.journal.GetMemoryUsage();
+		}
+
+		m_aRedoHistory.clear();
+		m_cHistoryBytes += m_move.journal.GetMemoryUsage();
+		m_aUndoHistory.push_back(std::move(m_move));
+		TrimHistory();
+	}
+
+	m_move = HistoryEntry{};
+}
+
+/*
+*	Undoes the move at the back of aFrom and moves it to the
+*	back of aTo. Restoring the journal of the move leaves the
+*	chunks it replaced in the journal, so the entry undoes
+*	the undo when it is replayed from aTo.
+*/
+void MinefieldEngine::ReplayHistory(std::deque<HistoryEntry>& aFrom, std::deque<HistoryEntry>& aTo)
+{
+	HistoryEntry entry{ std::move(aFrom.back()) };
+	aFrom.pop_back();
+	m_cHistoryBytes -= entry.journal.GetMemoryUsage();
+
+	m_board.RestoreJournal(entry.journal);
+
+	const GameState state{ GetGameState() };
+	const bool bWasWon{ IsGameWon() };
+	m_cRevealedTiles = entry.state.cRevealedTiles;
+	m_cFlaggedTiles = entry.state.cFlaggedTiles;
+	m_bGameLost = entry.state.bGameLost;
+	m_bMinesPlaced = entry.state.bMinesPlaced;
+	entry.state = state;
+
+	// Question marks may have been turned off since the chunks were recorded.
+	if (!m_bQuestionMarksEnabled)
+	{
+		m_board.ClearQuestionMarks();
+	}
+
+	m_aRevealedSpans.clear();
+
+	// Every hidden mine or flag is drawn by the outcome of the game, so a changed outcome changes the whole board.
+	if (m_bGameLost != state.bGameLost || IsGameWon() != bWasWon)
+	{
+		MarkAllDirty();
+	}
+	else
+	{
+		for (const std::uint32_t chunk : entry.journal.GetChunks())
+		{
+			MarkChunkDirty(chunk);
+		}
+	}
+
+	m_cHistoryBytes += entry.journal.GetMemoryUsage();
+	aTo.push_back(std::move(entry));
+	TrimHistory();
+}
+
+void MinefieldEngine::ClearHistory()
+{
+	m_aUndoHistory.clear();
+	m_aRedoHistory.clear();
+	m_cHistoryBytes = 0;
+}
+
+// Drops the oldest moves, and then the moves farthest from being redone, until the history fits its budget.
+void MinefieldEngine::TrimHistory()
+{
+	while (m_cHistoryBytes > m_historyBudget && !(m_aUndoHistory.empty() && m_aRedoHistory.empty()))
+	{
+		std::deque<HistoryEntry>& aHistory{ !m_aUndoHistory.empty() ? m_aUndoHistory : m_aRedoHistory };
+		m_cHistoryBytes -= aHistory.front().journal.GetMemoryUsage();
+		aHistory.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "enums.h"
+#include "MineTile.h"
+#include "RNG.h"
+#include "ThreadPool.h"
+#include "TileBoard.h"
+#include "TileNeighborhood.h"
+
+// A run of tiles [xBegin, xEnd) on row y of the minefield.
+struct TileSpan
+{
+	std::uint32_t y;
+	std::uint32_t xBegin;
+	std::uint32_t xEnd;
+};
+
+/*
+*	Holds the state of a minesweeper game and implements
+*	its rules. The engine has no dependency on Win32 or
+*	Direct2D so that it can be driven headlessly, e.g. from
+*	worker threads or benchmarks, as well as by the
+*	MinefieldWindow which wraps it.
+*/
+class MinefieldEngine
+{
+public:
+	// Larger boards are generated without reading most of their chunks, so GetThreeBV does not know their 3BV.
+	static constexpr std::uint32_t MAX_THREE_BV_TILES{ 1024 * 1024 };
+
+	// The state of a game besides its tiles, e.g. for saving it.
+	struct GameState
+	{
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+		std::uint32_t cMines{ 0 };
+		std::uint32_t cRevealedTiles{ 0 };
+		std::uint32_t cFlaggedTiles{ 0 };
+		std::uint64_t gameSeed{ 0 };
+		bool bGameLost{ false };
+		bool bQuestionMarksEnabled{ false };
+		bool bMinesPlaced{ false };
+	};
+
+	MinefieldEngine(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+
+	std::uint32_t GetWidth() const;							// Returns the width of the Minefield.
+	std::uint32_t GetHeight() const;						// Returns the height of the Minefield.
+	std::uint32_t GetSize() const;							// Returns the number of tiles in the Minefield.
+	std::uint32_t GetMineCount() const;						// Returns the number of mines in the Minefield.
+	std::uint32_t GetRevealedCount() const;					// Returns the number of revealed tiles.
+	std::uint32_t GetFlaggedCount() const;					// Returns the number of flagged tiles.
+
+	bool IsGameLost() const;								// Returns if the game is lost.
+	bool IsGameWon() const;									// Returns if the game is won.
+	bool IsGameActive() const;								// Returns if game is active or not.
+	bool IsGameStarted() const;								// Returns if a tile has been revealed.
+	bool AreMinesPlaced() const;							// Returns if the mines have been generated or placed.
+	bool AreQuestionMarksEnabled() const;					// Returns if tiles can be marked with question marks.
+	std::uint64_t GetGameSeed() const;						// Returns the seed the mines of the game are drawn from.
+	std::uint32_t GetThreeBV() const;						// Returns the fewest clicks solving the board, 0 if not known.
+	void SetGameSeed(std::uint64_t seed);
+
+	bool Resize(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+	void ResetGame();
+	void ToggleQuestionMarkUsage();
+	GameState GetGameState() const;
+	void RestoreGame(const GameState& state, TileBoard&& board);	// Continues a saved game with the tiles of board.
+	void ReleaseBoardStorage();								// Copies the tiles out of the storage of a restored board.
+
+	void SetHistoryBudget(std::size_t cBytes);				// Sets the memory moves are kept in for undo, 0 disables it.
+	std::size_t GetHistorySize() const;						// Returns the bytes the undo and redo history takes.
+	bool CanUndo() const;
+	bool CanRedo() const;
+	bool Undo();											// Takes back the last move, returns false if there is none.
+	bool Redo();											// Makes the last move taken back again.
+
+	MineTile operator()(std::uint32_t index);				// Get view of tile at a given index.
+	MineTile operator()(std::uint32_t x, std::uint32_t y);	// Get view of tile at given position (x, y)
+	const MineTile operator()(std::uint32_t index) const;
+	const MineTile operator()(std::uint32_t x, std::uint32_t y) const;
+	const TileBoard& GetBoard() const;						// Returns the packed tile storage.
+	std::shared_ptr<const TileBoard> ShareBoard();			// Returns a copy of the tiles for other threads, see TileBoard::Share.
+
+	/*
+	*	The engine records every tile whose appearance changed
+	*	since the dirty set was last cleared so that renderers
+	*	only have to redraw those tiles. If a change affects
+	*	most or all of the board (e.g. the game ending) the
+	*	whole board is flagged for redrawing instead.
+	*/
+	const std::vector<std::uint32_t>& GetDirtyTiles() const;
+	const std::vector<TileSpan>& GetRevealedSpans() const;	// Tiles revealed since the dirty set was cleared.
+	bool IsRedrawAllPending() const;
+	void ClearDirtyTiles();
+	void MarkTileDirty(std::uint32_t index);				// Adds a tile to the dirty set, e.g. when an overlay drawn on it changes.
+
+	// Game actions, all positions are given in tile coordinates.
+	void GenerateMines(std::uint32_t x, std::uint32_t y);
+	void PlaceMines(const std::vector<std::uint32_t>& aMineTiles);	// Uses the given mines for the game instead.
+	void GenerateNumbers();
+	void RevealTile(std::uint32_t x, std::uint32_t y);
+	void SetTileRevealed(std::uint32_t x, std::uint32_t y);
+	void CycleTileMark(std::uint32_t x, std::uint32_t y);
+	void PressTiles(std::uint32_t x, std::uint32_t y, std::uint32_t radius);
+	void ReleaseTiles(std::uint32_t x, std::uint32_t y, std::uint32_t radius);
+	void MovePos(std::uint32_t oldX, std::uint32_t oldY, std::uint32_t newX, std::uint32_t newY, std::uint32_t radius);
+	void BeginChord(std::uint32_t x, std::uint32_t y);
+	bool EndChord(std::uint32_t x, std::uint32_t y);
+
+private:
+	// Boards from this size on reveal large empty regions on every core.
+	static constexpr std::uint32_t PARALLEL_FLOOD_MIN_TILES{ 1024 * 1024 };
+
+	// A move that can be undone: the chunks it changed and the counters of the game, as they were before it.
+	struct HistoryEntry
+	{
+		TileBoard::Journal journal{};
+		GameState state{};
+	};
+
+	// A run of tiles without adjacent mines on one row, in CountThreeBV.
+	struct ZeroRun
+	{
+		std::uint32_t xBegin;
+		std::uint32_t xEnd;
+		std::uint32_t opening;								// Union-find node of the run in m_aOpeningParents.
+	};
+
+	// Work of the parallel flood fill in one chunk of the board, only used by the task owning the chunk.
+	struct FloodChunk
+	{
+		std::mutex lock{};
+		std::vector<TileSpan> inbox{};						// Work posted by other chunks, guarded by lock.
+		bool bScheduled{ false };							// Set while a task owns the chunk, guarded by lock.
+		std::vector<TileSpan> work{};						// Runs of tiles next to revealed empty tiles.
+		std::vector<TileSpan> revealed{};					// Spans revealed in the chunk.
+	};
+
+	std::uint32_t m_width{ 0 };								// Width of Minefield.
+	std::uint32_t m_height{ 0 };							// Height of Minefield.
+	std::uint32_t m_cTiles{ 0 };							// Count of tiles in Minefield.
+	std::uint32_t m_cMines{ 0 };							// Count of mines to generate.
+	std::uint32_t m_cRevealedTiles{ 0 };					// Tracks number of tiles set to revealed.
+	std::uint32_t m_cFlaggedTiles{ 0 };						// Tracks number of tiles marked with flags.
+	bool m_bGameLost{ false };								// Tracks if game is lost, i.e. a mine was revealed.
+	bool m_bQuestionMarksEnabled{ false };					// Tracks if we can mark with question marks.
+	RNG m_rng{};											// Draws the seed of every new game.
+	std::uint64_t m_gameSeed{ 0 };							// Seed the mine positions of the game are drawn from.
+	bool m_bMinesPlaced{ false };							// Tracks if the mines of the game have been placed.
+	std::uint32_t m_threeBV{ 0 };							// 3BV of the board, counted when the numbers are generated.
+	TileBoard m_board{};									// Packed storage of the tiles in the grid.
+	std::vector<std::uint32_t> m_aDirtyTiles{};				// Tiles changed since the dirty set was cleared.
+	std::vector<std::uint64_t> m_aDirtyPlane{};				// 1 bit per tile, set if the tile is in m_aDirtyTiles.
+	bool m_bRedrawAll{ true };								// Tracks if the whole board needs to be redrawn.
+	std::vector<TileSpan> m_aRevealedSpans{};				// Tiles revealed since the dirty set was cleared.
+	std::vector<std::uint32_t> m_aFillStack{};				// Seeds of the flood fill, kept to reuse its storage.
+	std::vector<std::uint32_t> m_aOpeningParents{};			// Storage of CountThreeBV, kept to reuse it.
+	std::vector<ZeroRun> m_aZeroRuns{};
+	std::vector<std::uint64_t> m_aZeroRows{};
+	std::vector<std::uint64_t> m_aNumberRows{};
+	std::unique_ptr<FloodChunk[]> m_aFloodChunks{};			// State of the parallel flood fill per chunk.
+	std::size_t m_cFloodChunks{ 0 };
+	std::size_t m_historyBudget{ 0 };						// Bytes the history may take, 0 if moves are not recorded.
+	std::size_t m_cHistoryBytes{ 0 };						// Bytes taken by the entries of both histories.
+	std::deque<HistoryEntry> m_aUndoHistory{};				// Moves that can be undone, the last move at the back.
+	std::deque<HistoryEntry> m_aRedoHistory{};				// Moves that were undone, the first to redo at the back.
+	HistoryEntry m_move{};									// The move being recorded.
+
+	std::uint32_t GetNumberAdjacentMines(std::uint32_t x, std::uint32_t y) const;
+	void CountThreeBV();
+	TileNeighborhood GetTileGrid(std::uint32_t x, std::uint32_t y, std::uint32_t radius) const;
+	bool CanReveal(std::uint32_t x, std::uint32_t y) const;
+	bool IsFloodable(std::uint32_t x, std::uint32_t y) const;
+	void FloodReveal(std::uint32_t x, std::uint32_t y);
+	void ScanFloodRow(std::uint32_t y, std::uint32_t xBegin, std::uint32_t xEnd);
+	void RevealSpan(std::uint32_t y, std::uint32_t xBegin, std::uint32_t xEnd);
+	void ParallelFloodReveal(std::uint32_t x, std::uint32_t y);
+	void PostFloodWork(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles);
+	void DispatchFloodWork(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles);
+	void RunFloodChunk(ThreadPool::TaskGroup& group, std::uint32_t chunk);
+	void ScanFloodChunkRow(ThreadPool::TaskGroup& group, std::uint32_t chunk, const TileSpan& tiles);
+	void SetTileState(std::uint32_t index, TileState state);
+	void SetTileMark(std::uint32_t index, TileMark mark);
+	void MarkSpansDirty(std::size_t firstSpan);
+	void MarkAllDirty();
+	void MarkChunkDirty(std::uint32_t chunk);
+	void BeginMove();
+	void EndMove(bool bChanged);
+	void ReplayHistory(std::deque<HistoryEntry>& aFrom, std::deque<HistoryEntry>& aTo);
+	void ClearHistory();
+	void TrimHistory();
+};
\ No newline at end of file
@@ -1,10 +1,13 @@
 ﻿#include "MinefieldScene.h"
 
+#include <cmath>
 #include <string>
 
 #include "colors.h"
 #include "constants.h"
 #include "enums.h"
+#include "GraphicsDevice.h"
+#include "MinefieldEngine.h"
 #include "MinefieldWindow.h"
 #include "MineTile.h"
 
@@ -20,8 +23,16 @@ HRESULT MinefieldScene::CreateDeviceIndependentResources()
 {
 	HRESULT hr = S_OK;
 
-	m_pMinefield = reinterpret_cast<MinefieldWindow*>(GetWindowLongPtr(m_hOwnerWnd, GWLP_USERDATA));
-	hr = (m_pMinefield ? S_OK : E_FAIL);
+	if (!m_pEngine)
+	{
+		MinefieldWindow* pMinefield{ reinterpret_cast<MinefieldWindow*>(GetWindowLongPtr(m_hOwnerWnd, GWLP_USERDATA)) };
+		hr = (pMinefield ? S_OK : E_FAIL);
+
+		if (SUCCEEDED(hr))
+		{
+			m_pEngine = &pMinefield->GetEngine();
+		}
+	}
 
 	if (SUCCEEDED(hr))
 	{
@@ -45,471 +56,1038 @@ HRESULT MinefieldScene::CreateDeviceIndependentResources()
 		}
 	}
 
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDWriteFactory->CreateTextFormat(constants::FONT_FRAME_TIMES.data(), nullptr, DWRITE_FONT_WEIGHT_NORMAL,
+			DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, FRAME_TIMES_FONT_SIZE, L"en-US", &m_pFrameTimesTextFormat);
+	}
+
+	// A new board shows nothing but hidden tiles, so a window can show its first frame before any glyph exists.
+	m_bDeferGlyphs = m_hOwnerWnd != nullptr;
+
 	return hr;
 };
 
 void MinefieldScene::DiscardDeviceIndependentResources()
 {
 	m_pTileEdgeGeometry.Release();
+	m_pFrameTimesTextFormat.Release();
+	m_pXMarkImage.Release();
 
 }
 
 HRESULT MinefieldScene::CreateDeviceDependentResources()
 {
-	const D2D1_SIZE_F fSize{ m_pRenderTarget->GetSize() };
-	const FLOAT tileWidth{ fSize.width / m_pMinefield->GetMinefieldWidth() };
-	const FLOAT tileHeight{ fSize.height / m_pMinefield->GetMinefieldHeight() };
+	// The camera works in window pixels, so one DIP of the render target is made to be one pixel.
+	m_pRenderTarget->SetDpi(96.f, 96.f);
 
-	HRESULT	hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLightest)), &m_pTileEdgeLightestColorBrush);
+	HRESULT	hr = GetSolidColorBrush(colors::tileEdgeLightest, &m_pTileEdgeLightestColorBrush);
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLight)), &m_pTileEdgeLightColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeLight, &m_pTileEdgeLightColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDark)), &m_pTileEdgeDarkColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDark, &m_pTileEdgeDarkColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDarkest)), &m_pTileEdgeDarkestColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDarkest, &m_pTileEdgeDarkestColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileOne)), &m_pOneColorBrush);
+		hr = GetSolidColorBrush(colors::tileBackgroundMineReveal, &m_pMineRevealColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileTwo)), &m_pTwoColorBrush);
+		hr = GetSolidColorBrush(colors::tileBackgroundMineGameWin, &m_pMineGameWinColorBrush);
 	}
 
-	if (SUCCEEDED(hr))
+	const unsigned int numberColors[8]{ colors::tileOne, colors::tileTwo, colors::tileThree, colors::tileFour,
+		colors::tileFive, colors::tileSix, colors::tileSeven, colors::tileEight };
+
+	for (int i{ 0 }; i < 8 && SUCCEEDED(hr); ++i)
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileThree)), &m_pThreeColorBrush);
+		hr = GetSolidColorBrush(numberColors[i], &m_apNumberColorBrushes[i]);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileFour)), &m_pFourColorBrush);
+		hr = GetSolidColorBrush(colors::tileQuestionMark, &m_pQuestionMarkColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileFive)), &m_pFiveColorBrush);
+		hr = GetSolidColorBrush(colors::tileMineProbability, &m_pMineProbabilityColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileSix)), &m_pSixColorBrush);
+		hr = GetSolidColorBrush(colors::tileHint, &m_pHintColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileSeven)), &m_pSevenColorBrush);
+		hr = GetSolidColorBrush(colors::frameTimesBackground, &m_pFrameTimesBackgroundBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEight)), &m_pEightColorBrush);
+		hr = GetSolidColorBrush(colors::frameTimesText, &m_pFrameTimesTextBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileQuestionMark)), &m_pQuestionMarkColorBrush);
+		// Sprite batches are optional, without them the atlas is drawn from with DrawBitmap.
+		if (SUCCEEDED(m_pRenderTarget.QueryInterface(&m_pDeviceContext3)))
+		{
+			if (FAILED(m_pDeviceContext3->CreateSpriteBatch(&m_pSpriteBatch)))
+			{
+				m_pDeviceContext3.Release();
+			}
+		}
+	}
+
+	if (SUCCEEDED(hr) && GraphicsDevice::Instance().IsTileShaderEnabled())
+	{
+		// Without the shader the tiles are drawn as sprites, so failing here is not an error.
+		CComPtr<ID3D11Device> pD3DDevice{ nullptr };
+
+		m_bUseTileShader = SUCCEEDED(GraphicsDevice::Instance().GetD3DDevice(&pD3DDevice)) &&
+			SUCCEEDED(m_pRenderTarget.QueryInterface(&m_pDeviceContext)) && SUCCEEDED(m_tileShader.Initialize(pD3DDevice));
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pDWriteFactory->CreateTextFormat(constants::FONT_NUMBER.data(), nullptr, DWRITE_FONT_WEIGHT_NORMAL,
-			DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, min(tileWidth, tileHeight), L"en-US", &m_pTextFormat);
+		hr = BuildTileAtlas(AtlasTileSize());
+	}
 
-		if (SUCCEEDED(hr))
+	return hr;
+}
+
+void MinefieldScene::DiscardDeviceDependentResources()
+{
+	m_pTileEdgeLightestColorBrush.Release();
+	m_pTileEdgeLightColorBrush.Release();
+	m_pTileEdgeDarkColorBrush.Release();
+	m_pTileEdgeDarkestColorBrush.Release();
+	m_pMineRevealColorBrush.Release();
+	m_pMineGameWinColorBrush.Release();
+
+	for (CComPtr<ID2D1SolidColorBrush>& pBrush : m_apNumberColorBrushes)
+	{
+		pBrush.Release();
+	}
+
+	m_pQuestionMarkColorBrush.Release();
+	m_pXMarkBitmap.Release();
+	m_pMineProbabilityColorBrush.Release();
+	m_pHintColorBrush.Release();
+	m_pFrameTimesBackgroundBrush.Release();
+	m_pFrameTimesTextBrush.Release();
+
+	m_pTileAtlas.Release();
+	m_uAtlasTileSize = 0;
+	m_bAtlasHasGlyphs = FALSE;
+
+	m_pSpriteBatch.Release();
+	m_pDeviceContext3.Release();
+
+	m_tileShader.Release();
+	m_pDeviceContext.Release();
+	m_bUseTileShader = FALSE;
+}
+
+void MinefieldScene::CalculateLayout()
+{
+	ClampCamera();
+	UpdateTileShaderTargets();
+	m_bRedrawAll = TRUE;
+}
+
+/*
+*	Draws the tiles of the minefield that intersect the view.
+*	The render target keeps its contents between frames, so
+*	unless the whole view has to be redrawn (e.g. after a
+*	resize, scroll, repaint or the game ending) only the
+*	visible tiles the engine reported as changed are drawn.
+*	Either way every tile is one sprite copied from the tile
+*	atlas and all of them are drawn with a single call.
+*	The solver overlay is translucent, so while it is shown
+*	the whole view is redrawn every frame.
+*/
+void MinefieldScene::RenderScene()
+{
+	// The camera already rebuilt the atlas for the current zoom, unless that failed.
+	if (AtlasTileSize() != m_uAtlasTileSize)
+	{
+		TrackResourceCreation(L"tile atlas");
+		UpdateTileAtlas();
+
+		if (!m_pTileAtlas)
 		{
-			m_pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-			m_pTextFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+			return;
 		}
 	}
+	else if (!m_bAtlasHasGlyphs && !m_bDeferGlyphs)
+	{
+		// The first frame went out without glyphs, they are drawn into the atlas with the second one.
+		BuildTileAtlas(m_uAtlasTileSize);
+		m_bRedrawAll = TRUE;
+		Tracing::MarkStartupPhase("GlyphsReady");
 
-	if (SUCCEEDED(hr))
+		if (!m_pTileAtlas)
+		{
+			return;
+		}
+	}
+
+	if (m_bDeferGlyphs)
 	{
-		if (SUCCEEDED(hr))
+		m_bDeferGlyphs = FALSE;
+
+		if (!m_bAtlasHasGlyphs)
 		{
-			hr = m_pDWriteFactory->CreateTextFormat(constants::FONT_EMOJI.data(), nullptr, DWRITE_FONT_WEIGHT_NORMAL,
-				DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 0.6f * min(tileWidth, tileHeight), L"en-US", &m_pEmojiFormat);
+			RequestRender();
+		}
+	}
+
+	if (m_bUseTileShader)
+	{
+		RenderTileShader();
+		return;
+	}
+
+	const RECT visibleTiles{ VisibleTiles() };
 
-			if (SUCCEEDED(hr))
+	m_aSpriteDestRects.clear();
+	m_aSpriteSourceRects.clear();
+
+	// The probability tint is translucent, it is drawn over freshly drawn faces only.
+	if (m_bRedrawAll || m_pEngine->IsRedrawAllPending() || m_pMineProbabilities)
+	{
+		m_pRenderTarget->Clear(D2D1::ColorF(RGBA(colors::tileBackground)));
+
+		if (visibleTiles.left < visibleTiles.right && visibleTiles.top < visibleTiles.bottom)
+		{
+			for (UINT chunkY{ static_cast<UINT>(visibleTiles.top) >> TileBoard::CHUNK_SHIFT };
+				chunkY <= static_cast<UINT>(visibleTiles.bottom - 1) >> TileBoard::CHUNK_SHIFT; ++chunkY)
 			{
-				m_pEmojiFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-				m_pEmojiFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+				for (UINT chunkX{ static_cast<UINT>(visibleTiles.left) >> TileBoard::CHUNK_SHIFT };
+					chunkX <= static_cast<UINT>(visibleTiles.right - 1) >> TileBoard::CHUNK_SHIFT; ++chunkX)
+				{
+					AddChunkSprites(chunkX, chunkY, visibleTiles);
+				}
 			}
 		}
-	}
 
-	if (SUCCEEDED(hr))
+		m_bRedrawAll = FALSE;
+	}
+	else
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_ONE.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pOneColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pOneBitmap);
+		const UINT width{ m_pEngine->GetWidth() };
+
+		// Faces are opaque, drawing a tile covers whatever was drawn there before.
+		for (const UINT tile : m_pEngine->GetDirtyTiles())
+		{
+			const LONG x{ static_cast<LONG>(tile % width) };
+			const LONG y{ static_cast<LONG>(tile / width) };
+
+			if (x >= visibleTiles.left && x < visibleTiles.right && y >= visibleTiles.top && y < visibleTiles.bottom)
+			{
+				AddTileSprite(x, y);
+			}
+		}
+
+		// The hint outline is drawn again below, its face goes first so the outline doesn't build up on itself.
+		if (m_hintTile >= 0 && static_cast<UINT>(m_hintTile) < m_pEngine->GetSize())
+		{
+			const LONG x{ static_cast<LONG>(m_hintTile % width) };
+			const LONG y{ static_cast<LONG>(m_hintTile / width) };
+
+			if (x >= visibleTiles.left && x < visibleTiles.right && y >= visibleTiles.top && y < visibleTiles.bottom)
+			{
+				AddTileSprite(x, y);
+			}
+		}
 	}
 
-	if (SUCCEEDED(hr))
+	DrawTileSprites();
+	DrawOverlay(visibleTiles);
+	DrawFrameTimes();
+	m_pEngine->ClearDirtyTiles();
+}
+
+/*
+*	Shows the chance of each hidden tile being a mine as a
+*	red tint, or hides it if pProbabilities is nullptr. The
+*	vector has one entry per tile and must outlive its use,
+*	the caller requests a render whenever it changes.
+*/
+void MinefieldScene::SetMineProbabilities(const std::vector<FLOAT>* pProbabilities)
+{
+	if (m_pMineProbabilities != pProbabilities)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_TWO.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pTwoColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pTwoBitmap);
+		m_pMineProbabilities = pProbabilities;
+		m_bRedrawAll = TRUE;
 	}
+}
 
-	if (SUCCEEDED(hr))
+/*
+*	Outlines the tile at the given index, -1 removes the
+*	outline. Only the old and the new hint tile are redrawn.
+*/
+void MinefieldScene::SetHintTile(LONG tile)
+{
+	if (m_hintTile == tile)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_THREE.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pThreeColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pThreeBitmap);
+		return;
 	}
 
-	if (SUCCEEDED(hr))
+	for (const LONG changedTile : { m_hintTile, tile })
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_FOUR.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pFourColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pFourBitmap);
+		if (m_pEngine && changedTile >= 0 && static_cast<UINT>(changedTile) < m_pEngine->GetSize())
+		{
+			m_pEngine->MarkTileDirty(static_cast<std::uint32_t>(changedTile));
+		}
 	}
 
-	if (SUCCEEDED(hr))
+	m_hintTile = tile;
+}
+
+// Shows or hides the p50 and p99 of the last frame times of the scene.
+void MinefieldScene::SetFrameTimesVisible(BOOL bVisible)
+{
+	m_bShowFrameTimes = bVisible;
+	m_bRedrawAll = TRUE;
+}
+
+/*
+*	Draws pEngine instead of the engine of the owning window,
+*	for scenes without one. Must be called before the scene
+*	is initialized.
+*/
+void MinefieldScene::SetEngine(MinefieldEngine* pEngine)
+{
+	m_pEngine = pEngine;
+}
+
+// Forces the next render to redraw every tile.
+void MinefieldScene::InvalidateAll()
+{
+	m_bRedrawAll = TRUE;
+}
+
+/*
+*	Sets the size of a tile at a zoom of 1, this is the tile
+*	size the game window used to lay out the minefield.
+*/
+void MinefieldScene::SetBaseTileSize(FLOAT tileSize)
+{
+	m_fBaseTileSize = tileSize;
+	ClampCamera();
+	UpdateTileAtlas();
+	m_bRedrawAll = TRUE;
+}
+
+// Shows the top left corner of the board without any zoom.
+void MinefieldScene::ResetCamera()
+{
+	m_fZoom = 1;
+	m_fViewX = 0;
+	m_fViewY = 0;
+	ClampCamera();
+	UpdateTileAtlas();
+	UpdateTileShaderTargets();
+	m_bRedrawAll = TRUE;
+}
+
+// Scrolls the view so that board position (viewX, viewY) is at the top left of the window.
+void MinefieldScene::PanTo(FLOAT viewX, FLOAT viewY)
+{
+	m_fViewX = viewX;
+	m_fViewY = viewY;
+	ClampCamera();
+	m_bRedrawAll = TRUE;
+}
+
+void MinefieldScene::PanBy(FLOAT dx, FLOAT dy)
+{
+	PanTo(m_fViewX + dx, m_fViewY + dy);
+}
+
+/*
+*	Multiplies the zoom by factor while keeping the board
+*	position under (anchorX, anchorY), given in window
+*	pixels, in place. Zooming out stops once the whole board
+*	fits or tiles get smaller than MIN_TILE_SIZE and zooming
+*	in stops at MAX_TILE_SIZE.
+*/
+void MinefieldScene::ZoomAt(FLOAT factor, FLOAT anchorX, FLOAT anchorY)
+{
+	const D2D1_SIZE_F viewSize{ GetViewSize() };
+	const FLOAT fitTileSize{ min(viewSize.width / m_pEngine->GetWidth(), viewSize.height / m_pEngine->GetHeight()) };
+	const FLOAT minTileSize{ min(m_fBaseTileSize, max(fitTileSize, constants::MIN_TILE_SIZE)) };
+	const FLOAT maxTileSize{ max(m_fBaseTileSize, constants::MAX_TILE_SIZE) };
+
+	const FLOAT oldTileSize{ GetTileSize() };
+	const FLOAT newTileSize{ min(max(oldTileSize * factor, minTileSize), maxTileSize) };
+
+	if (oldTileSize > 0 && newTileSize != oldTileSize)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_FIVE.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pFiveColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pFiveBitmap);
+		// Board position under the anchor, in tiles.
+		const FLOAT anchorTileX{ (m_fViewX + anchorX) / oldTileSize };
+		const FLOAT anchorTileY{ (m_fViewY + anchorY) / oldTileSize };
+
+		m_fZoom = newTileSize / m_fBaseTileSize;
+		PanTo(anchorTileX * newTileSize - anchorX, anchorTileY * newTileSize - anchorY);
+		UpdateTileAtlas();
 	}
+}
 
-	if (SUCCEEDED(hr))
+FLOAT MinefieldScene::GetTileSize() const
+{
+	return m_fBaseTileSize * m_fZoom;
+}
+
+D2D1_POINT_2F MinefieldScene::GetViewOffset() const
+{
+	return D2D1::Point2F(m_fViewX, m_fViewY);
+}
+
+// Returns the size of the window, or the bitmap of an offscreen scene, the board is shown in.
+D2D1_SIZE_F MinefieldScene::GetViewSize() const
+{
+	if (!m_hOwnerWnd)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_SIX.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pSixColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pSixBitmap);
+		const D2D1_SIZE_U size{ m_pRenderTarget ? m_pRenderTarget->GetPixelSize() : D2D1::SizeU(0, 0) };
+		return D2D1::SizeF(static_cast<FLOAT>(size.width), static_cast<FLOAT>(size.height));
 	}
 
-	if (SUCCEEDED(hr))
+	RECT rc;
+	GetClientRect(m_hOwnerWnd, &rc);
+	return D2D1::SizeF(static_cast<FLOAT>(rc.right - rc.left), static_cast<FLOAT>(rc.bottom - rc.top));
+}
+
+// Returns the size of the whole board at the current zoom.
+D2D1_SIZE_F MinefieldScene::GetBoardSize() const
+{
+	return D2D1::SizeF(m_pEngine->GetWidth() * GetTileSize(), m_pEngine->GetHeight() * GetTileSize());
+}
+
+/*
+*	Returns the (x,y) position in the tile grid of the point
+*	(x, y) given in window pixels, clamped to the board. It
+*	runs for every mouse message, so it only uses the view
+*	as the camera last left it and doesn't divide.
+*/
+POINT MinefieldScene::ViewToTile(FLOAT x, FLOAT y) const
+{
+	const LONG width{ static_cast<LONG>(m_pEngine->GetWidth()) };
+	const LONG height{ static_cast<LONG>(m_pEngine->GetHeight()) };
+
+	POINT pos;
+	pos.x = static_cast<LONG>(floorf((m_fViewX + x) * m_fTilesPerPixel));
+	pos.y = static_cast<LONG>(floorf((m_fViewY + y) * m_fTilesPerPixel));
+	pos.x = min(max(pos.x, 0), width - 1);
+	pos.y = min(max(pos.y, 0), height - 1);
+	return pos;
+}
+
+/*
+*	Returns the rectangle the tile at (x,y) occupies in the
+*	Minefield window. Tiles are square with a side length
+*	of the tile height. Edges are rounded half up to whole
+*	pixels, the same way the tile shader places them, so
+*	neighboring sprites neither overlap nor leave seams.
+*/
+D2D1_RECT_F MinefieldScene::TileDrawRect(UINT x, UINT y) const
+{
+	const FLOAT tileSize{ GetTileSize() };
+
+	return D2D1::RectF(floorf(x * tileSize - m_fViewX + 0.5f), floorf(y * tileSize - m_fViewY + 0.5f),
+		floorf((x + 1) * tileSize - m_fViewX + 0.5f), floorf((y + 1) * tileSize - m_fViewY + 0.5f));
+}
+
+/*
+*	Returns the range of tiles that intersect the view, as
+*	[left, right) x [top, bottom) in tile coordinates.
+*/
+RECT MinefieldScene::VisibleTiles() const
+{
+	const D2D1_SIZE_F viewSize{ GetViewSize() };
+	const FLOAT tileSize{ GetTileSize() };
+	RECT visibleTiles{};
+
+	if (tileSize > 0)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_SEVEN.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pSevenColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pSevenBitmap);
+		visibleTiles.left = static_cast<LONG>(max(floorf(m_fViewX / tileSize), 0.f));
+		visibleTiles.top = static_cast<LONG>(max(floorf(m_fViewY / tileSize), 0.f));
+		visibleTiles.right = static_cast<LONG>(min(ceilf((m_fViewX + viewSize.width) / tileSize), static_cast<FLOAT>(m_pEngine->GetWidth())));
+		visibleTiles.bottom = static_cast<LONG>(min(ceilf((m_fViewY + viewSize.height) / tileSize), static_cast<FLOAT>(m_pEngine->GetHeight())));
 	}
 
-	if (SUCCEEDED(hr))
+	return visibleTiles;
+}
+
+/*
+*	Keeps the view on the board. Along an axis where the
+*	whole board fits into the window the board is centered.
+*	Every change of the camera ends here, so this is also
+*	where the transform used for hit testing is updated.
+*/
+void MinefieldScene::ClampCamera()
+{
+	const D2D1_SIZE_F viewSize{ GetViewSize() };
+	const D2D1_SIZE_F boardSize{ GetBoardSize() };
+
+	m_fViewX = (boardSize.width <= viewSize.width) ? (boardSize.width - viewSize.width) / 2 :
+		min(max(m_fViewX, 0.f), boardSize.width - viewSize.width);
+	m_fViewY = (boardSize.height <= viewSize.height) ? (boardSize.height - viewSize.height) / 2 :
+		min(max(m_fViewY, 0.f), boardSize.height - viewSize.height);
+	m_fTilesPerPixel = 1 / max(GetTileSize(), 1e-3f);
+}
+
+/*
+*	Draws every tile face into one bitmap of ATLAS_COLUMNS
+*	columns, each face being tileSize x tileSize pixels. Faces
+*	are separated by a transparent gutter of one pixel so
+*	that a face never picks up pixels of its neighbors.
+*	Loading the fonts and the X mark takes most of the time,
+*	so until the first frame is drawn only the bevels and
+*	backgrounds of the faces are.
+*/
+HRESULT MinefieldScene::BuildTileAtlas(UINT tileSize)
+{
+	const FLOAT fTileSize{ static_cast<FLOAT>(tileSize) };
+	const UINT atlasRows{ (TILE_FACE_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS };
+	const D2D1_SIZE_U atlasSize{ D2D1::SizeU(ATLAS_COLUMNS * (tileSize + 2), atlasRows * (tileSize + 2)) };
+	const BOOL bGlyphs{ !m_bDeferGlyphs };
+
+	CComPtr<ID2D1BitmapRenderTarget> pAtlasRenderTarget{ nullptr };
+	CComPtr<IDWriteTextFormat> pTextFormat{ nullptr };
+	CComPtr<IDWriteTextFormat> pEmojiFormat{ nullptr };
+
+	m_pTileAtlas.Release();
+	m_uAtlasTileSize = 0;
+	m_bAtlasHasGlyphs = FALSE;
+
+	HRESULT hr = S_OK;
+
+	if (bGlyphs)
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_EIGHT.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pEightColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pEightBitmap);
+		hr = CreateXMarkBitmap();
+
+		if (SUCCEEDED(hr))
+		{
+			hr = m_pDWriteFactory->CreateTextFormat(constants::FONT_NUMBER.data(), nullptr, DWRITE_FONT_WEIGHT_NORMAL,
+				DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, fTileSize, L"en-US", &pTextFormat);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+			pTextFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+
+			hr = m_pDWriteFactory->CreateTextFormat(constants::FONT_EMOJI.data(), nullptr, DWRITE_FONT_WEIGHT_NORMAL,
+				DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 0.6f * fTileSize, L"en-US", &pEmojiFormat);
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			pEmojiFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+			pEmojiFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+		}
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = CreateCharacterBitmap(constants::CHAR_QUESTION_MARK.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pTextFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE, &m_pQuestionMarkBitmap);
+		hr = m_pRenderTarget->CreateCompatibleRenderTarget(D2D1::SizeF(static_cast<FLOAT>(atlasSize.width),
+			static_cast<FLOAT>(atlasSize.height)), atlasSize, &pAtlasRenderTarget);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = CreateCharacterBitmap(constants::EMOJI_BOMB.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pEmojiFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT, &m_pBombBitmap);
+		pAtlasRenderTarget->BeginDraw();
+		pAtlasRenderTarget->Clear();
+
+		for (std::uint32_t face{ 0 }; face < TILE_FACE_COUNT; ++face)
+		{
+			const D2D1_RECT_U cell{ AtlasRect(static_cast<TileFace>(face), tileSize) };
+			const D2D1_RECT_F drawRect{ D2D1::RectF(static_cast<FLOAT>(cell.left), static_cast<FLOAT>(cell.top),
+				static_cast<FLOAT>(cell.right), static_cast<FLOAT>(cell.bottom)) };
+
+			DrawFace(pAtlasRenderTarget, static_cast<TileFace>(face), drawRect, pTextFormat, pEmojiFormat);
+		}
+
+		hr = pAtlasRenderTarget->EndDraw();
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = CreateCharacterBitmap(constants::EMOJI_FLAG.data(), static_cast<UINT>(tileWidth + 1), static_cast<UINT>(tileHeight + 1),
-			m_pEmojiFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT, &m_pFlagBitmap);
+		hr = pAtlasRenderTarget->GetBitmap(&m_pTileAtlas);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = LoadImageFromResource(IDB_X_MARK, TEXT("PNG"), 1024, 1024, &m_pXMarkBitmap);
+		m_uAtlasTileSize = tileSize;
+		m_bAtlasHasGlyphs = bGlyphs;
+
+		if (m_bUseTileShader && FAILED(m_tileShader.SetAtlas(m_pTileAtlas, m_pDeviceContext)))
+		{
+			DisableTileShader();
+		}
 	}
 
 	return hr;
 }
 
-void MinefieldScene::DiscardDeviceDependentResources()
+/*
+*	Returns the size of the faces in the atlas for the current
+*	zoom: the tile size rounded up to the next size bucket.
+*	Buckets are ATLAS_BUCKETS_PER_DOUBLING steps of a power of
+*	two apart, one pixel for small tiles, so faces are drawn
+*	at their exact size up to 16 pixels and never scaled down
+*	by more than 1 / 8 above that.
+*/
+UINT MinefieldScene::AtlasTileSize() const
 {
-	m_pTileEdgeLightestColorBrush.Release();
-	m_pTileEdgeLightColorBrush.Release();
-	m_pTileEdgeDarkColorBrush.Release();
-	m_pTileEdgeDarkestColorBrush.Release();
+	const UINT tileSize{ static_cast<UINT>(max(roundf(GetTileSize()), 1.f)) };
+	UINT step{ 1 };
 
-	m_pOneColorBrush.Release();
-	m_pTwoColorBrush.Release();
-	m_pThreeColorBrush.Release();
-	m_pFourColorBrush.Release();
-	m_pFiveColorBrush.Release();
-	m_pSixColorBrush.Release();
-	m_pSevenColorBrush.Release();
-	m_pEightColorBrush.Release();
-	m_pQuestionMarkColorBrush.Release();
+	while (step * 2 * ATLAS_BUCKETS_PER_DOUBLING <= tileSize)
+	{
+		step *= 2;
+	}
 
-	m_pTextFormat.Release();
-	m_pEmojiFormat.Release();
-
-	m_pOneBitmap.Release();
-	m_pTwoBitmap.Release();
-	m_pThreeBitmap.Release();
-	m_pFourBitmap.Release();
-	m_pFiveBitmap.Release();
-	m_pSixBitmap.Release();
-	m_pSevenBitmap.Release();
-	m_pEightBitmap.Release();
-	m_pQuestionMarkBitmap.Release();
-	m_pBombBitmap.Release();
-	m_pFlagBitmap.Release();
-	m_pXMarkBitmap.Release();
+	return (tileSize + step - 1) & ~(step - 1);
 }
 
-void MinefieldScene::CalculateLayout()
+/*
+*	The atlas is rebuilt when the zoom or a resize moves the
+*	tile size into another bucket, in between the faces are
+*	scaled to the tile size while drawing. Dragging the edge
+*	of the window so only rebuilds it every few size steps.
+*	This happens with the camera change rather than during
+*	the next frame.
+*/
+void MinefieldScene::UpdateTileAtlas()
 {
-	const D2D1_SIZE_F fSize{ m_pRenderTarget->GetSize() };
-	const FLOAT tileWidth{ fSize.width / m_pMinefield->GetMinefieldWidth() };
-	const FLOAT tileHeight{ fSize.height / m_pMinefield->GetMinefieldHeight() };
+	const UINT atlasTileSize{ AtlasTileSize() };
 
-	for (UINT x{ 0 }; x < m_pMinefield->GetMinefieldWidth(); ++x)
+	if (m_pRenderTarget && atlasTileSize != m_uAtlasTileSize)
 	{
-		for (UINT y{ 0 }; y < m_pMinefield->GetMinefieldHeight(); ++y)
-		{
-			(*m_pMinefield)(x, y).SetDrawRect(x * tileWidth, y * tileHeight, tileHeight, tileHeight);
-		}
+		BuildTileAtlas(atlasTileSize);
+		m_bRedrawAll = TRUE;
 	}
 }
 
-void MinefieldScene::RenderScene()
+/*
+*	Loads the X mark drawn over wrongly flagged mines. The PNG
+*	is decoded once, creating the device again only uploads
+*	the decoded pixels.
+*/
+HRESULT MinefieldScene::CreateXMarkBitmap()
 {
-	m_pRenderTarget->Clear(D2D1::ColorF(RGBA(colors::tileBackground)));
+	HRESULT hr = S_OK;
 
-	for (UINT x{ 0 }; x < m_pMinefield->GetMinefieldWidth(); ++x)
+	if (!m_pXMarkImage)
 	{
-		for (UINT y{ 0 }; y < m_pMinefield->GetMinefieldHeight(); ++y)
-		{
-				DrawTile((*m_pMinefield)(x, y));
-				DrawTileContents((*m_pMinefield)(x, y));
-		}
+		hr = DecodeImageFromResource(IDB_X_MARK, TEXT("PNG"), X_MARK_IMAGE_SIZE, X_MARK_IMAGE_SIZE, &m_pXMarkImage);
 	}
+
+	if (SUCCEEDED(hr) && !m_pXMarkBitmap)
+	{
+		hr = m_pRenderTarget->CreateBitmapFromWicBitmap(m_pXMarkImage, nullptr, &m_pXMarkBitmap);
+	}
+
+	return hr;
 }
 
-HRESULT MinefieldScene::CreateCharacterBitmap(const WCHAR* pChar, const UINT width, const UINT height, IDWriteTextFormat* pTextFormat, 
-	ID2D1Brush* pFillBrush, D2D1_DRAW_TEXT_OPTIONS drawTextOptions, ID2D1Bitmap** destBitmap)
+/*
+*	Draws one tile face into drawRect of pTarget, using the
+*	fonts of the atlas being built. Without fonts only the
+*	tile is drawn, not its mark, mine or number.
+*/
+void MinefieldScene::DrawFace(ID2D1RenderTarget* pTarget, TileFace face, const D2D1_RECT_F& drawRect,
+	IDWriteTextFormat* pTextFormat, IDWriteTextFormat* pEmojiFormat)
 {
-	CComPtr<ID2D1BitmapRenderTarget> pCompatibleRenderTarget{ nullptr };
-	CComPtr<ID2D1Bitmap> pSourceBitmap{ nullptr };
-	const D2D1_POINT_2U destPoint{ D2D1::Point2U(0,0) };
-	const D2D1_RECT_U srcRect{ D2D1::RectU(0, 0, width, height) };
-	const D2D1_RECT_F drawRect{ D2D1::RectF(0, 0, width, height) };
-	const D2D1_SIZE_U destSize{ D2D1::SizeU(width, height) };
-	FLOAT dpiX{ 0.0f };
-	FLOAT dpiY{ 0.0f };
+	const auto drawText{ [&](std::wstring_view text, IDWriteTextFormat* pFormat, ID2D1Brush* pBrush, D2D1_DRAW_TEXT_OPTIONS options)
+	{
+		if (pFormat)
+		{
+			pTarget->DrawText(text.data(), static_cast<UINT>(text.size()), pFormat, drawRect, pBrush, options);
+		}
+	} };
 
-	HRESULT hr = m_pRenderTarget->CreateCompatibleRenderTarget(D2D1::SizeF(width, height), &pCompatibleRenderTarget);
+	ID2D1SolidColorBrush* pFillBrush{ nullptr };
+	BOOL bSunken{ TRUE };
 
-	if (SUCCEEDED(hr))
+	switch (face)
 	{
-		pCompatibleRenderTarget->BeginDraw();
-		pCompatibleRenderTarget->Clear();
-		pCompatibleRenderTarget->DrawText(pChar, static_cast<UINT>(sizeof(TCHAR)), pTextFormat, drawRect, pFillBrush, drawTextOptions);
-		pCompatibleRenderTarget->EndDraw();
+	case TileFace::HIDDEN:
+	case TileFace::HIDDEN_FLAG:
+	case TileFace::HIDDEN_QUESTION_MARK:
+		bSunken = FALSE;
+		break;
 
-		hr = pCompatibleRenderTarget->GetBitmap(&pSourceBitmap);
+	case TileFace::MINE_EXPLODED:
+		pFillBrush = m_pMineRevealColorBrush;
+		break;
 
-		if (SUCCEEDED(hr))
-		{
-			pSourceBitmap->GetDpi(&dpiX, &dpiY);
-			hr = m_pRenderTarget->CreateBitmap(destSize, D2D1::BitmapProperties(pSourceBitmap->GetPixelFormat(), dpiX, dpiY), destBitmap);
+	case TileFace::WON_FLAG:
+	case TileFace::WON_QUESTION_MARK:
+		pFillBrush = m_pMineGameWinColorBrush;
+		bSunken = FALSE;
+		break;
 
-			if (SUCCEEDED(hr))
-			{
-				hr = (*destBitmap)->CopyFromBitmap(&destPoint, pSourceBitmap, &srcRect);
-			}
+	default:
+		break;
+	}
 
-			pSourceBitmap.Release();
-		}
+	pTarget->PushAxisAlignedClip(drawRect, D2D1_ANTIALIAS_MODE_ALIASED);
+	pTarget->Clear(D2D1::ColorF(RGBA(colors::tileBackground)));
 
-		pCompatibleRenderTarget.Release();
+	if (pFillBrush)
+	{
+		pTarget->FillRectangle(drawRect, pFillBrush);
 	}
 
-	return hr;
-}
+	DrawBevel(pTarget, drawRect, bSunken);
 
-void MinefieldScene::DrawTile(const MineTile& tile)
-{
-	ID2D1SolidColorBrush* pLeftEdgeColorBrush{ m_pTileEdgeLightColorBrush };
-	ID2D1SolidColorBrush* pTopEdgeColorBrush{ m_pTileEdgeLightestColorBrush };
-	ID2D1SolidColorBrush* pRightEdgeColorBrush{ m_pTileEdgeDarkColorBrush };
-	ID2D1SolidColorBrush* pBottomEdgeColorBrush{ m_pTileEdgeDarkestColorBrush };
-
-	switch (tile.GetTileState())
-	{
-	case TileState::HIDDEN:
+	switch (face)
 	{
-		if (m_pMinefield->IsGameLost())
-		{
-			if (tile.GetTileContent() == TileContent::MINE && tile.GetTileMark() != TileMark::FLAG)
-			{
-				pLeftEdgeColorBrush = m_pTileEdgeDarkColorBrush;
-				pTopEdgeColorBrush = m_pTileEdgeDarkestColorBrush;
-				pRightEdgeColorBrush = m_pTileEdgeLightColorBrush;
-				pBottomEdgeColorBrush = m_pTileEdgeLightestColorBrush;
-			}
-			else if (tile.GetTileContent() != TileContent::MINE && tile.GetTileMark() == TileMark::FLAG)
-			{
-				pLeftEdgeColorBrush = m_pTileEdgeDarkColorBrush;
-				pTopEdgeColorBrush = m_pTileEdgeDarkestColorBrush;
-				pRightEdgeColorBrush = m_pTileEdgeLightColorBrush;
-				pBottomEdgeColorBrush = m_pTileEdgeLightestColorBrush;
-			}
-		}
-		else if (m_pMinefield->IsGameWon())
+	case TileFace::HIDDEN_FLAG:
+	case TileFace::WON_FLAG:
+		drawText(constants::EMOJI_FLAG, pEmojiFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT);
+		break;
+
+	case TileFace::HIDDEN_QUESTION_MARK:
+	case TileFace::WON_QUESTION_MARK:
+		drawText(constants::CHAR_QUESTION_MARK, pTextFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_NONE);
+		break;
+
+	case TileFace::MINE_EXPLODED:
+	case TileFace::MINE:
+		drawText(constants::EMOJI_BOMB, pEmojiFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT);
+		break;
+
+	case TileFace::WRONG_FLAG:
+		drawText(constants::EMOJI_BOMB, pEmojiFormat, m_pQuestionMarkColorBrush, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT);
+		if (pEmojiFormat)
 		{
-			if (tile.GetTileContent() == TileContent::MINE)
-			{
-				CComPtr<ID2D1SolidColorBrush> pFill{ nullptr };
-				HRESULT hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileBackgroundMineGameWin)), &pFill);
-				if (SUCCEEDED(hr))
-				{
-					m_pRenderTarget->FillRectangle(tile.GetDrawRect(), pFill);
-				}
-			}
+			pTarget->DrawBitmap(m_pXMarkBitmap, drawRect);
 		}
-	}
-	break;
+		break;
 
-	case TileState::CLICKED:
-	{
-		pLeftEdgeColorBrush = m_pTileEdgeDarkColorBrush;
-		pTopEdgeColorBrush = m_pTileEdgeDarkestColorBrush;
-		pRightEdgeColorBrush = m_pTileEdgeLightColorBrush;
-		pBottomEdgeColorBrush = m_pTileEdgeLightestColorBrush;
-	}
-	break;
+	case TileFace::HIDDEN:
+	case TileFace::PRESSED:
+	case TileFace::REVEALED_EMPTY:
+		break;
 
-	case TileState::REVEALED:
+	default:
 	{
-		pLeftEdgeColorBrush = m_pTileEdgeDarkColorBrush;
-		pTopEdgeColorBrush = m_pTileEdgeDarkestColorBrush;
-		pRightEdgeColorBrush = m_pTileEdgeLightColorBrush;
-		pBottomEdgeColorBrush = m_pTileEdgeLightestColorBrush;
+		// REVEALED_ONE to REVEALED_EIGHT.
+		const std::uint32_t number{ static_cast<std::uint32_t>(face) - static_cast<std::uint32_t>(TileFace::REVEALED_EMPTY) };
+		const WCHAR digit{ static_cast<WCHAR>(L'0' + number) };
 
-		if (tile.GetTileContent() == TileContent::MINE)
-		{
-			CComPtr<ID2D1SolidColorBrush> pFill{ nullptr };
-			HRESULT hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileBackgroundMineReveal)), &pFill);
-			if (SUCCEEDED(hr))
-			{
-				m_pRenderTarget->FillRectangle(tile.GetDrawRect(), pFill);
-			}
-		}
+		drawText(std::wstring_view{ &digit, 1 }, pTextFormat, m_apNumberColorBrushes[number - 1], D2D1_DRAW_TEXT_OPTIONS_NONE);
 	}
 	break;
 	}
 
-	const D2D1_RECT_F drawRect{ tile.GetDrawRect() };
+	pTarget->PopAxisAlignedClip();
+}
+
+/*
+*	Draws the four beveled edges of a tile. Raised tiles are
+*	lit from the top left, sunken tiles from the bottom right.
+*/
+void MinefieldScene::DrawBevel(ID2D1RenderTarget* pTarget, const D2D1_RECT_F& drawRect, BOOL bSunken)
+{
+	ID2D1SolidColorBrush* pLeftEdgeColorBrush{ bSunken ? m_pTileEdgeDarkColorBrush : m_pTileEdgeLightColorBrush };
+	ID2D1SolidColorBrush* pTopEdgeColorBrush{ bSunken ? m_pTileEdgeDarkestColorBrush : m_pTileEdgeLightestColorBrush };
+	ID2D1SolidColorBrush* pRightEdgeColorBrush{ bSunken ? m_pTileEdgeLightColorBrush : m_pTileEdgeDarkColorBrush };
+	ID2D1SolidColorBrush* pBottomEdgeColorBrush{ bSunken ? m_pTileEdgeLightestColorBrush : m_pTileEdgeDarkestColorBrush };
+
 	const float tileWidth{ drawRect.right - drawRect.left };
 	const float tileHeight{ drawRect.bottom - drawRect.top };
 	const D2D1_MATRIX_3X2_F scaleMatrix{ D2D1::Matrix3x2F::Scale(tileWidth, tileHeight) };
 
 	D2D1_MATRIX_3X2_F translationMatrix{ D2D1::Matrix3x2F::Translation(drawRect.left, drawRect.top) };
-	m_pRenderTarget->SetTransform(scaleMatrix * translationMatrix);
-	m_pRenderTarget->FillGeometry(m_pTileEdgeGeometry, pLeftEdgeColorBrush);
+	pTarget->SetTransform(scaleMatrix * translationMatrix);
+	pTarget->FillGeometry(m_pTileEdgeGeometry, pLeftEdgeColorBrush);
 
 	translationMatrix = D2D1::Matrix3x2F::Translation(drawRect.right, drawRect.top);
-	m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Rotation(90.0f) * scaleMatrix * translationMatrix);
-	m_pRenderTarget->FillGeometry(m_pTileEdgeGeometry, pTopEdgeColorBrush);
+	pTarget->SetTransform(D2D1::Matrix3x2F::Rotation(90.0f) * scaleMatrix * translationMatrix);
+	pTarget->FillGeometry(m_pTileEdgeGeometry, pTopEdgeColorBrush);
 
 	translationMatrix = D2D1::Matrix3x2F::Translation(drawRect.right, drawRect.bottom);
-	m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Rotation(180.0f) * scaleMatrix * translationMatrix);
-	m_pRenderTarget->FillGeometry(m_pTileEdgeGeometry, pRightEdgeColorBrush);
+	pTarget->SetTransform(D2D1::Matrix3x2F::Rotation(180.0f) * scaleMatrix * translationMatrix);
+	pTarget->FillGeometry(m_pTileEdgeGeometry, pRightEdgeColorBrush);
 
 	translationMatrix = D2D1::Matrix3x2F::Translation(drawRect.left, drawRect.bottom);
-	m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Rotation(270.0f) * scaleMatrix * translationMatrix);
-	m_pRenderTarget->FillGeometry(m_pTileEdgeGeometry, pBottomEdgeColorBrush);
+	pTarget->SetTransform(D2D1::Matrix3x2F::Rotation(270.0f) * scaleMatrix * translationMatrix);
+	pTarget->FillGeometry(m_pTileEdgeGeometry, pBottomEdgeColorBrush);
+
+	pTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+}
+
+// Returns the pixels of the atlas holding face, for an atlas of tileSize x tileSize faces.
+D2D1_RECT_U MinefieldScene::AtlasRect(TileFace face, UINT tileSize) const
+{
+	const UINT column{ static_cast<UINT>(face) % ATLAS_COLUMNS };
+	const UINT row{ static_cast<UINT>(face) / ATLAS_COLUMNS };
+	const UINT left{ column * (tileSize + 2) + 1 };
+	const UINT top{ row * (tileSize + 2) + 1 };
 
-	m_pRenderTarget->SetTransform(D2D1::Matrix3x2F::Identity());
+	return D2D1::RectU(left, top, left + tileSize, top + tileSize);
 }
 
-void MinefieldScene::DrawTileContents(const MineTile& tile)
+/*
+*	Queues the sprites of the visible tiles of the board
+*	chunk at (chunkX, chunkY). Going chunk by chunk keeps the
+*	tile data being read within a few kilobytes of memory.
+*/
+void MinefieldScene::AddChunkSprites(UINT chunkX, UINT chunkY, const RECT& visibleTiles)
 {
-	switch (tile.GetTileState())
+	const UINT xBegin{ max(chunkX << TileBoard::CHUNK_SHIFT, static_cast<UINT>(visibleTiles.left)) };
+	const UINT yBegin{ max(chunkY << TileBoard::CHUNK_SHIFT, static_cast<UINT>(visibleTiles.top)) };
+	const UINT xEnd{ min((chunkX + 1) << TileBoard::CHUNK_SHIFT, static_cast<UINT>(visibleTiles.right)) };
+	const UINT yEnd{ min((chunkY + 1) << TileBoard::CHUNK_SHIFT, static_cast<UINT>(visibleTiles.bottom)) };
+
+	for (UINT y{ yBegin }; y < yEnd; ++y)
 	{
-	case TileState::HIDDEN:
-		if (!(m_pMinefield->IsGameLost()))
+		for (UINT x{ xBegin }; x < xEnd; ++x)
 		{
-			switch (tile.GetTileMark())
+			AddTileSprite(x, y);
+		}
+	}
+}
+
+// Queues the sprite of the tile at (x,y), drawn by the next DrawTileSprites.
+void MinefieldScene::AddTileSprite(UINT x, UINT y)
+{
+	const TileFace face{ GetTileFace((*m_pEngine)(x, y), m_pEngine->IsGameLost(), m_pEngine->IsGameWon()) };
+
+	m_aSpriteDestRects.push_back(TileDrawRect(x, y));
+	m_aSpriteSourceRects.push_back(AtlasRect(face, m_uAtlasTileSize));
+}
+
+/*
+*	Draws every queued sprite. With a sprite batch this is a
+*	single draw call, otherwise each sprite is copied from
+*	the atlas with DrawBitmap which still avoids any geometry
+*	or text being rendered per tile.
+*/
+void MinefieldScene::DrawTileSprites()
+{
+	const UINT cSprites{ static_cast<UINT>(m_aSpriteDestRects.size()) };
+
+	if (cSprites == 0)
+	{
+		return;
+	}
+
+	if (m_pSpriteBatch)
+	{
+		m_pSpriteBatch->Clear();
+
+		if (SUCCEEDED(m_pSpriteBatch->AddSprites(cSprites, m_aSpriteDestRects.data(), m_aSpriteSourceRects.data())))
+		{
+			// Sprite batches can only be drawn without antialiasing.
+			m_pDeviceContext3->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+			m_pDeviceContext3->DrawSpriteBatch(m_pSpriteBatch, m_pTileAtlas, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+			m_pDeviceContext3->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
+			return;
+		}
+	}
+
+	for (UINT i{ 0 }; i < cSprites; ++i)
+	{
+		const D2D1_RECT_U& source{ m_aSpriteSourceRects[i] };
+		const D2D1_RECT_F sourceRect{ D2D1::RectF(static_cast<FLOAT>(source.left), static_cast<FLOAT>(source.top),
+			static_cast<FLOAT>(source.right), static_cast<FLOAT>(source.bottom)) };
+
+		m_pRenderTarget->DrawBitmap(m_pTileAtlas, m_aSpriteDestRects[i], 1.f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, sourceRect);
+	}
+}
+
+BOOL MinefieldScene::HasOverlay() const
+{
+	return m_pMineProbabilities || m_hintTile >= 0;
+}
+
+// Tints the visible hidden tiles by their mine probability and outlines the hint tile.
+void MinefieldScene::DrawOverlay(const RECT& visibleTiles)
+{
+	if (!HasOverlay())
+	{
+		return;
+	}
+
+	const UINT width{ m_pEngine->GetWidth() };
+
+	if (m_pMineProbabilities && m_pMineProbabilities->size() == m_pEngine->GetSize())
+	{
+		for (LONG y{ visibleTiles.top }; y < visibleTiles.bottom; ++y)
+		{
+			for (LONG x{ visibleTiles.left }; x < visibleTiles.right; ++x)
 			{
-			case TileMark::NONE:
-				if (m_pMinefield->IsGameWon() && tile.GetTileContent() == TileContent::MINE)
+				const FLOAT probability{ (*m_pMineProbabilities)[x + y * width] };
+
+				if (probability > 0 && (*m_pEngine)(x, y).GetTileState() != TileState::REVEALED)
 				{
-					m_pRenderTarget->DrawBitmap(m_pFlagBitmap, tile.GetDrawRect());
+					m_pMineProbabilityColorBrush->SetOpacity(probability);
+					m_pRenderTarget->FillRectangle(TileDrawRect(x, y), m_pMineProbabilityColorBrush);
 				}
-				break;
-			case::TileMark::FLAG:
-				m_pRenderTarget->DrawBitmap(m_pFlagBitmap, tile.GetDrawRect());
-				break;
-			case TileMark::QUESTION_MARK:
-				m_pRenderTarget->DrawBitmap(m_pQuestionMarkBitmap, tile.GetDrawRect());
-				break;
 			}
 		}
-		else if (tile.GetTileContent() == TileContent::MINE)
+	}
+
+	if (m_hintTile >= 0 && static_cast<UINT>(m_hintTile) < m_pEngine->GetSize())
+	{
+		const D2D1_RECT_F hintRect{ TileDrawRect(m_hintTile % width, m_hintTile / width) };
+		const FLOAT strokeWidth{ max(GetTileSize() / 8, 1.f) };
+
+		m_pRenderTarget->DrawRectangle(D2D1::RectF(hintRect.left + strokeWidth / 2, hintRect.top + strokeWidth / 2,
+			hintRect.right - strokeWidth / 2, hintRect.bottom - strokeWidth / 2), m_pHintColorBrush, strokeWidth);
+	}
+}
+
+/*
+*	Draws the frame time percentiles on an opaque box, which
+*	covers the box of the previous frame when only the dirty
+*	tiles were redrawn. The times are those of the frames
+*	before this one.
+*/
+void MinefieldScene::DrawFrameTimes()
+{
+	if (!m_bShowFrameTimes)
+	{
+		return;
+	}
+
+	const FrameTimes& frameTimes{ GetFrameTimes() };
+	WCHAR szText[64];
+	const int cchText{ swprintf_s(szText, L"p50 %5.2f ms\np99 %5.2f ms", frameTimes.GetPercentile(0.5f),
+		frameTimes.GetPercentile(0.99f)) };
+	const D2D1_RECT_F boxRect{ D2D1::RectF(0, 0, FRAME_TIMES_FONT_SIZE * 8, FRAME_TIMES_FONT_SIZE * 3) };
+
+	m_pRenderTarget->FillRectangle(boxRect, m_pFrameTimesBackgroundBrush);
+	m_pRenderTarget->DrawText(szText, static_cast<UINT32>(max(cchText, 0)), m_pFrameTimesTextFormat,
+		D2D1::RectF(FRAME_TIMES_FONT_SIZE / 2, FRAME_TIMES_FONT_SIZE / 4, boxRect.right, boxRect.bottom), m_pFrameTimesTextBrush);
+}
+
+/*
+*	Makes the face texture of the tile shader match the board
+*	and its output texture match the window. Called whenever
+*	either can change, so frames don't create textures.
+*/
+void MinefieldScene::UpdateTileShaderTargets()
+{
+	if (!m_bUseTileShader)
+	{
+		return;
+	}
+
+	const D2D1_SIZE_F viewSize{ GetViewSize() };
+	const UINT viewWidth{ static_cast<UINT>(viewSize.width) };
+	const UINT viewHeight{ static_cast<UINT>(viewSize.height) };
+	HRESULT hr = S_OK;
+
+	if (m_tileShader.NeedsBoardResize(m_pEngine->GetWidth(), m_pEngine->GetHeight()))
+	{
+		hr = m_tileShader.ResizeBoard(m_pEngine->GetWidth(), m_pEngine->GetHeight());
+	}
+
+	if (SUCCEEDED(hr) && m_tileShader.NeedsViewResize(viewWidth, viewHeight))
+	{
+		hr = m_tileShader.ResizeView(viewWidth, viewHeight, m_pDeviceContext);
+	}
+
+	if (FAILED(hr))
+	{
+		DisableTileShader();
+	}
+}
+
+// Goes back to drawing sprites after the tile shader failed.
+void MinefieldScene::DisableTileShader()
+{
+	m_tileShader.Release();
+	m_bUseTileShader = FALSE;
+	m_bRedrawAll = TRUE;
+}
+
+/*
+*	Draws the view with the tile shader. Only changed tiles
+*	are sent to it, the whole board only when the engine asks
+*	for every tile to be redrawn or the board was recreated.
+*	Camera changes only change the shader's constants.
+*/
+void MinefieldScene::RenderTileShader()
+{
+	const D2D1_SIZE_F viewSize{ GetViewSize() };
+	const UINT width{ m_pEngine->GetWidth() };
+	const UINT height{ m_pEngine->GetHeight() };
+
+	if (m_tileShader.NeedsBoardResize(width, height) ||
+		m_tileShader.NeedsViewResize(static_cast<UINT>(viewSize.width), static_cast<UINT>(viewSize.height)))
+	{
+		TrackResourceCreation(L"tile shader texture");
+		UpdateTileShaderTargets();
+
+		if (!m_bUseTileShader)
 		{
-			switch (tile.GetTileMark())
-			{
-			case TileMark::NONE:
-				m_pRenderTarget->DrawBitmap(m_pBombBitmap, tile.GetDrawRect());
-				break;
-			case::TileMark::FLAG:
-				m_pRenderTarget->DrawBitmap(m_pFlagBitmap, tile.GetDrawRect());
-				break;
-			case TileMark::QUESTION_MARK:
-				m_pRenderTarget->DrawBitmap(m_pBombBitmap, tile.GetDrawRect());
-				break;
-			}
+			RenderScene();
+			return;
 		}
-		else
+	}
+
+	const bool bGameLost{ m_pEngine->IsGameLost() };
+	const bool bGameWon{ m_pEngine->IsGameWon() };
+
+	if (m_pEngine->IsRedrawAllPending() || m_tileShader.AreFacesStale())
+	{
+		for (UINT y{ 0 }; y < height; ++y)
 		{
-			switch (tile.GetTileMark())
+			for (UINT x{ 0 }; x < width; ++x)
 			{
-			case TileMark::NONE:
-				break;
-			case::TileMark::FLAG:
-				m_pRenderTarget->DrawBitmap(m_pBombBitmap, tile.GetDrawRect());
-				m_pRenderTarget->DrawBitmap(m_pXMarkBitmap, tile.GetDrawRect());
-				break;
-			case TileMark::QUESTION_MARK:
-				break;
+				m_tileShader.SetFace(x, y, GetTileFace((*m_pEngine)(x, y), bGameLost, bGameWon));
 			}
 		}
-		break;
-	case TileState::CLICKED:
-		break;
-	case TileState::REVEALED:
-		switch (tile.GetTileContent())
+
+		m_tileShader.SetAllFacesUploaded();
+	}
+	else
+	{
+		for (const UINT tile : m_pEngine->GetDirtyTiles())
 		{
-		case TileContent::ONE:
-			m_pRenderTarget->DrawBitmap(m_pOneBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::TWO:
-			m_pRenderTarget->DrawBitmap(m_pTwoBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::THREE:
-			m_pRenderTarget->DrawBitmap(m_pThreeBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::FOUR:
-			m_pRenderTarget->DrawBitmap(m_pFourBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::FIVE:
-			m_pRenderTarget->DrawBitmap(m_pFiveBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::SIX:
-			m_pRenderTarget->DrawBitmap(m_pSixBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::SEVEN:
-			m_pRenderTarget->DrawBitmap(m_pSevenBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::EIGHT:
-			m_pRenderTarget->DrawBitmap(m_pEightBitmap, tile.GetDrawRect());
-			break;
-		case TileContent::MINE:
-			m_pRenderTarget->DrawBitmap(m_pBombBitmap, tile.GetDrawRect());
-			break;
+			const UINT x{ tile % width };
+			const UINT y{ tile / width };
+			m_tileShader.SetFace(x, y, GetTileFace((*m_pEngine)(x, y), bGameLost, bGameWon));
 		}
-		break;
 	}
+
+	m_pEngine->ClearDirtyTiles();
+
+	const TileShaderRenderer::View view{ m_fViewX, m_fViewY, GetTileSize(), m_uAtlasTileSize, ATLAS_COLUMNS,
+		{ RGBA(colors::tileBackground) } };
+
+	// D2D and the shader share the device's immediate context, anything D2D queued has to go first.
+	m_pRenderTarget->Flush();
+	m_tileShader.Draw(view);
+
+	m_pRenderTarget->DrawBitmap(m_tileShader.GetOutput(), D2D1::RectF(0, 0, viewSize.width, viewSize.height), 1.f,
+		D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+	DrawOverlay(VisibleTiles());
+	DrawFrameTimes();
+
+	m_bRedrawAll = FALSE;
 }
\ No newline at end of file
@@ -3,8 +3,13 @@
 
 #include <vector>
 
+#include <d2d1_3.h>
+
+#include "TileFace.h"
+#include "TileShaderRenderer.h"
+
 class MineTile;
-class MinefieldWindow;
+class MinefieldEngine;
 
 class MinefieldScene : public BaseScene
 {
@@ -16,44 +21,98 @@ public:
     void    DiscardDeviceDependentResources();
     void    CalculateLayout();
     void    RenderScene();
+    void    InvalidateAll();
+    void    SetEngine(MinefieldEngine* pEngine);
+
+    // Camera, all values are in pixels of the owning window.
+    void    SetBaseTileSize(FLOAT tileSize);
+    void    ResetCamera();
+    void    PanTo(FLOAT viewX, FLOAT viewY);
+    void    PanBy(FLOAT dx, FLOAT dy);
+    void    ZoomAt(FLOAT factor, FLOAT anchorX, FLOAT anchorY);
+    FLOAT   GetTileSize() const;
+    D2D1_POINT_2F GetViewOffset() const;
+    D2D1_SIZE_F GetViewSize() const;
+    D2D1_SIZE_F GetBoardSize() const;
+    POINT   ViewToTile(FLOAT x, FLOAT y) const;
+
+    // Solver overlay, drawn on top of the hidden tiles.
+    void    SetMineProbabilities(const std::vector<FLOAT>* pProbabilities);
+    void    SetHintTile(LONG tile);
+
+    // Percentiles of the last frame times, drawn in the top left corner of the view.
+    void    SetFrameTimesVisible(BOOL bVisible);
 
 private:
-    MinefieldWindow* m_pMinefield{ nullptr };
+    MinefieldEngine* m_pEngine{ nullptr };
+    BOOL m_bRedrawAll{ TRUE };
+
+    FLOAT m_fBaseTileSize{ 0 };                             // Tile size chosen by the game window layout.
+    FLOAT m_fZoom{ 1 };                                     // Zoom relative to the base tile size.
+    FLOAT m_fViewX{ 0 };                                    // Board position shown at the left edge of the window.
+    FLOAT m_fViewY{ 0 };                                    // Board position shown at the top edge of the window.
+    FLOAT m_fTilesPerPixel{ 0 };                            // 1 / tile size, updated by ClampCamera for hit testing.
+
+    const std::vector<FLOAT>* m_pMineProbabilities{ nullptr }; // Chance of each tile being a mine, owned by the window.
+    LONG m_hintTile{ -1 };                                  // Tile suggested by the last hint, or -1.
+    BOOL m_bShowFrameTimes{ FALSE };
+    static constexpr FLOAT FRAME_TIMES_FONT_SIZE{ 13 };
 
     CComPtr<ID2D1PathGeometry> m_pTileEdgeGeometry{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeLightestColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeLightColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeDarkColorBrush{ nullptr };
     CComPtr<ID2D1SolidColorBrush> m_pTileEdgeDarkestColorBrush{ nullptr };
-
-    CComPtr<ID2D1SolidColorBrush> m_pOneColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pTwoColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pThreeColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pFourColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pFiveColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pSixColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pSevenColorBrush{ nullptr };
-    CComPtr<ID2D1SolidColorBrush> m_pEightColorBrush{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_pMineRevealColorBrush{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_pMineGameWinColorBrush{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_apNumberColorBrushes[8]{};
     CComPtr<ID2D1SolidColorBrush> m_pQuestionMarkColorBrush{ nullptr };
-
-    CComPtr<IDWriteTextFormat> m_pTextFormat{ nullptr };
-    CComPtr<IDWriteTextFormat> m_pEmojiFormat{ nullptr };
-
-    CComPtr<ID2D1Bitmap> m_pOneBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pTwoBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pThreeBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pFourBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pFiveBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pSixBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pSevenBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pEightBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pQuestionMarkBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pBombBitmap{ nullptr };
-    CComPtr<ID2D1Bitmap> m_pFlagBitmap{ nullptr };
     CComPtr<ID2D1Bitmap> m_pXMarkBitmap{ nullptr };
+    CComPtr<IWICBitmap> m_pXMarkImage{ nullptr };           // Decoded once, m_pXMarkBitmap is uploaded from it.
+    static constexpr UINT X_MARK_IMAGE_SIZE{ 512 };         // Enough for the largest tiles, a quarter of the PNG's pixels.
+    CComPtr<ID2D1SolidColorBrush> m_pMineProbabilityColorBrush{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_pHintColorBrush{ nullptr };
+    CComPtr<IDWriteTextFormat> m_pFrameTimesTextFormat{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_pFrameTimesBackgroundBrush{ nullptr };
+    CComPtr<ID2D1SolidColorBrush> m_pFrameTimesTextBrush{ nullptr };
+
+    // Every tile face pre-rendered into one bitmap, see BuildTileAtlas.
+    static constexpr UINT ATLAS_COLUMNS{ 6 };
+    static constexpr UINT ATLAS_BUCKETS_PER_DOUBLING{ 8 };  // Faces are scaled down by at most 1 / 8, see AtlasTileSize.
+    CComPtr<ID2D1Bitmap> m_pTileAtlas{ nullptr };
+    UINT m_uAtlasTileSize{ 0 };
+    BOOL m_bAtlasHasGlyphs{ FALSE };                        // FALSE while the faces are only tiles without marks or numbers.
+    BOOL m_bDeferGlyphs{ FALSE };                           // Set until the first frame of a window is drawn.
+
+    // Sprite batches need Windows 10 1703, otherwise faces are copied with DrawBitmap.
+    CComPtr<ID2D1DeviceContext3> m_pDeviceContext3{ nullptr };
+    CComPtr<ID2D1SpriteBatch> m_pSpriteBatch{ nullptr };
+    std::vector<D2D1_RECT_F> m_aSpriteDestRects{};
+    std::vector<D2D1_RECT_U> m_aSpriteSourceRects{};
+
+    // Draws the tiles with a pixel shader instead of sprites when the flip model backend asks for it.
+    TileShaderRenderer m_tileShader{};
+    CComPtr<ID2D1DeviceContext> m_pDeviceContext{ nullptr };
+    BOOL m_bUseTileShader{ FALSE };
 
-    HRESULT  CreateCharacterBitmap(const WCHAR* pChar, const UINT width, const UINT height, IDWriteTextFormat* pTextFormat, 
-        ID2D1Brush* pFillBrush, D2D1_DRAW_TEXT_OPTIONS drawTextOptions, ID2D1Bitmap** destBitmap);
-    void    DrawTile(const MineTile& tile);
-    void    DrawTileContents(const MineTile& tile);
+    UINT    AtlasTileSize() const;
+    void    UpdateTileAtlas();
+    HRESULT BuildTileAtlas(UINT tileSize);
+    HRESULT CreateXMarkBitmap();
+    void    DrawFace(ID2D1RenderTarget* pTarget, TileFace face, const D2D1_RECT_F& drawRect, IDWriteTextFormat* pTextFormat,
+        IDWriteTextFormat* pEmojiFormat);
+    void    DrawBevel(ID2D1RenderTarget* pTarget, const D2D1_RECT_F& drawRect, BOOL bSunken);
+    D2D1_RECT_U AtlasRect(TileFace face, UINT tileSize) const;
+    D2D1_RECT_F TileDrawRect(UINT x, UINT y) const;
+    RECT    VisibleTiles() const;
+    void    ClampCamera();
+    void    AddChunkSprites(UINT chunkX, UINT chunkY, const RECT& visibleTiles);
+    void    AddTileSprite(UINT x, UINT y);
+    void    DrawTileSprites();
+    BOOL    HasOverlay() const;
+    void    DrawOverlay(const RECT& visibleTiles);
+    void    DrawFrameTimes();
+    void    UpdateTileShaderTargets();
+    void    DisableTileShader();
+    void    RenderTileShader();
 };
\ No newline at end of file
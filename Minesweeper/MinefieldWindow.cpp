@@ -1,12 +1,42 @@
 #include "MinefieldWindow.h"
 
-#include <algorithm>
-#include <queue>
-#include <vector>
+#include <cmath>
+
+#include <windowsx.h>
 
 #include "constants.h"
 #include "enums.h"
+#include "GameSave.h"
 #include "GameWindow.h"
+#include "NoGuessBoardPool.h"
+#include "PresetBoard.h"
+#include "Tracing.h"
+
+// The solver and the no guessing generator walk the standard difficulties through the tables of their preset boards.
+static_assert(BeginnerBoard::WIDTH == constants::BEGINNER_WIDTH && BeginnerBoard::HEIGHT == constants::BEGINNER_HEIGHT);
+static_assert(IntermediateBoard::WIDTH == constants::INTERMEDIATE_WIDTH && IntermediateBoard::HEIGHT == constants::INTERMEDIATE_HEIGHT);
+static_assert(ExpertBoard::WIDTH == constants::EXPERT_WIDTH && ExpertBoard::HEIGHT == constants::EXPERT_HEIGHT);
+
+namespace
+{
+	// Writes a Reveal event for the tiles revealed since the engine had firstSpan revealed spans.
+	void TraceReveal(const MinefieldEngine& engine, std::size_t firstSpan, LONGLONG microseconds, BOOL bChord)
+	{
+		const std::vector<TileSpan>& aSpans{ engine.GetRevealedSpans() };
+		UINT cTiles{ 0 };
+
+		for (std::size_t span{ firstSpan }; span < aSpans.size(); ++span)
+		{
+			cTiles += aSpans[span].xEnd - aSpans[span].xBegin;
+		}
+
+		TraceLoggingWrite(g_hMinesweeperTraceProvider, "Reveal",
+			TraceLoggingUInt32(cTiles, "Tiles"),
+			TraceLoggingBoolean(bChord, "Chord"),
+			TraceLoggingInt64(microseconds, "Microseconds"),
+			TraceLoggingUInt32(GetMessageTime(), "MessageTime"));
+	}
+}
 
 /*
 *	==========================
@@ -16,79 +46,55 @@
 
 /*
 *	Constructs a minefield with a given width, height, and
-*	number of mines. Also by default we set question mark
-*	usage as disabled.
+*	number of mines. The game state itself lives in the
+*	MinefieldEngine, this window only handles input and
+*	rendering.
 */
 MinefieldWindow::MinefieldWindow(UINT width, UINT height, UINT cMines) :
-	BaseWindow<MinefieldWindow>{}, m_width{ width }, m_height{ height }, m_cTiles{ width * height }, m_cMines{ cMines },
-	m_cRevealedTiles{ 0 }, m_cFlaggedTiles{ 0 }, m_bMouseTracking{ FALSE }, m_bGameLost{ FALSE },
-	m_bQuestionMarksEnabled{ FALSE }, m_rng{}, m_scene{}
+	BaseWindow<MinefieldWindow>{}, m_engine{ width, height, cMines }, m_bMouseTracking{ FALSE }, m_scene{}
 {
 	m_lpszClassName = std::make_unique<WCHAR[]>(constants::MAX_LOADSTRING);
 	LoadString(GetModuleHandle(nullptr), IDS_MINEFIELD_CLASS, m_lpszClassName.get(), constants::MAX_LOADSTRING);
-
-	if (m_cMines > m_cTiles)
-	{
-		m_cMines = m_cTiles;
-	}
-
-	m_aMineTiles = std::vector<MineTile>(m_cTiles, MineTile());
+	m_engine.SetHistoryBudget(constants::UNDO_HISTORY_BUDGET);
 }
 
 UINT MinefieldWindow::GetMinefieldWidth() const
 {
-	return m_width;
+	return m_engine.GetWidth();
 }
 
 UINT MinefieldWindow::GetMinefieldHeight() const
 {
-	return m_height;
+	return m_engine.GetHeight();
 }
 
 UINT MinefieldWindow::GetMinefieldSize() const
 {
-	return m_cTiles;
+	return m_engine.GetSize();
 }
 
 BOOL MinefieldWindow::IsGameLost() const
 {
-	return m_bGameLost;
+	return m_engine.IsGameLost();
 }
 
-/*
-*	Returns whether the minesweeper game has been won.
-*	In particular, a game is won if:
-*	a) the game is not currently lost
-*	b) we have clicked a tile, and
-*	c) all tiles not containing a mine are clicked.
-*
-*	Normally condition (b) would be writted as
-*	m_cTiles - m_cMines <= m_cRevealedTiles,
-*	but since each variable is a UINT we move m_cMines to
-*	the other side of the inequality.
-*/
 BOOL MinefieldWindow::IsGameWon() const
 {
-	return !m_bGameLost && ((m_cTiles <= m_cMines + m_cRevealedTiles) && (m_cRevealedTiles > 0));
+	return m_engine.IsGameWon();
 }
 
 BOOL MinefieldWindow::IsGameActive() const
 {
-	return !(IsGameLost() || IsGameWon());
+	return m_engine.IsGameActive();
 }
 
 BOOL MinefieldWindow::Resize(UINT width, UINT height, UINT cMines)
 {
-	if (m_width != width || m_height != height || m_cMines != cMines)
+	if (m_engine.Resize(width, height, cMines))
 	{
-		m_width = width;
-		m_height = height;
-		m_cTiles = m_width * m_height;
-		m_cMines = cMines;
-
-		if (m_cMines > m_cTiles)
+		if (m_bNoGuessing)
 		{
-			m_cMines = m_cTiles;
+			NoGuessBoardPool::Instance().Prefetch(m_engine.GetWidth(), m_engine.GetHeight(), m_engine.GetMineCount());
 		}
 
 		ResetGame();
@@ -100,15 +106,20 @@ BOOL MinefieldWindow::Resize(UINT width, UINT height, UINT cMines)
 }
 
 // Provides access to Mine tile at index in tile array.
-MineTile& MinefieldWindow::operator()(UINT index)
+MineTile MinefieldWindow::operator()(UINT index)
 {
-	return m_aMineTiles[index];
+	return m_engine(index);
 }
 
 // Provides access to Mine tile at position (x,y) in minefield.
-MineTile& MinefieldWindow::operator()(UINT x, UINT y)
+MineTile MinefieldWindow::operator()(UINT x, UINT y)
+{
+	return m_engine(x, y);
+}
+
+MinefieldEngine& MinefieldWindow::GetEngine()
 {
-	return (*this)(x + static_cast<std::size_t>(y) * m_width);
+	return m_engine;
 }
 
 /*
@@ -117,37 +128,252 @@ MineTile& MinefieldWindow::operator()(UINT x, UINT y)
 */
 void MinefieldWindow::ToggleQuestionMarkUsage()
 {
-	m_bQuestionMarksEnabled = !m_bQuestionMarksEnabled;
+	m_engine.ToggleQuestionMarkUsage();
+	RecordAction(Replay::Action::TOGGLE_QUESTION_MARKS, 0, 0);
 
-	if (!m_bQuestionMarksEnabled)
+	if (!m_engine.AreQuestionMarksEnabled())
 	{
-		for (UINT x{ 0 }; x < m_width; ++x)
+		if (IsHostingSpectators())
 		{
-			for (UINT y{ 0 }; y < m_height; ++y)
-			{
-				if ((*this)(x, y).GetTileMark() == TileMark::QUESTION_MARK)
-				{
-					(*this)(x, y).SetTileMark(TileMark::NONE);
-				}
-			}
+			SpectatorServer::Update update{ GetSpectatorStatus() };
+			update.status |= SpectatorServer::STATUS_QUESTION_MARKS_CLEARED;
+			m_spectators.Publish(std::move(update));
 		}
 
-		m_scene.Render();
+		m_scene.RequestRender();
+	}
+}
+
+/*
+*	Sets whether new games are generated so that they can be
+*	solved from the first click without guessing. Boards
+*	for the current size and the standard difficulties are
+*	generated in the background from then on, the current
+*	game is left as it is.
+*/
+void MinefieldWindow::SetNoGuessing(BOOL bNoGuessing)
+{
+	m_bNoGuessing = bNoGuessing;
+
+	if (m_bNoGuessing)
+	{
+		NoGuessBoardPool& pool{ NoGuessBoardPool::Instance() };
+		pool.Prefetch(m_engine.GetWidth(), m_engine.GetHeight(), m_engine.GetMineCount());
+		pool.Prefetch(constants::BEGINNER_WIDTH, constants::BEGINNER_HEIGHT, constants::BEGINNER_CMINES);
+		pool.Prefetch(constants::INTERMEDIATE_WIDTH, constants::INTERMEDIATE_HEIGHT, constants::INTERMEDIATE_CMINES);
+		pool.Prefetch(constants::EXPERT_WIDTH, constants::EXPERT_HEIGHT, constants::EXPERT_CMINES);
 	}
 }
 
 void MinefieldWindow::ResetGame()
 {
-	m_bGameLost = FALSE;
-	m_cRevealedTiles = 0;
-	m_cFlaggedTiles = 0;
-	m_aMineTiles = std::vector<MineTile>(m_cTiles, MineTile());
-	m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_cMines));
+	StopReplay();
+	m_engine.ResetGame();
+	m_replay.Begin(m_engine);
+	m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_engine.GetMineCount()));
 	m_pGameWindow->StopTimer();
 	m_pGameWindow->ResetTimer();
 	m_pGameWindow->SetSmileState(SmileState::SMILE);
-	m_scene.CalculateLayout();
-	m_scene.Render();
+	m_scene.ResetCamera();
+	m_cEffectiveClicks = 0;
+	m_cWastedClicks = 0;
+	m_bRecordingStats = TRUE;
+	m_bNoGuessBoard = FALSE;
+	m_bAwaitingBoard = FALSE;
+	ResetSolver();
+	UpdateScrollBars();
+	PublishBoard(TRUE);
+	m_scene.RequestRender();
+}
+
+/*
+*	Outlines a tile the player can reveal next. It is a tile
+*	proven to be safe if there is one, otherwise the tile
+*	least likely to be a mine.
+*/
+void MinefieldWindow::ShowHint()
+{
+	if (!IsSolverEnabled() || !m_engine.IsGameStarted() || !IsGameActive())
+	{
+		return;
+	}
+
+	std::uint32_t tile{ 0 };
+	m_solver.GetHint(tile);
+	m_scene.SetHintTile(tile != UINT32_MAX ? static_cast<LONG>(tile) : -1);
+	m_scene.RequestRender();
+}
+
+BOOL MinefieldWindow::ToggleMineProbabilities()
+{
+	m_bShowProbabilities = !m_bShowProbabilities;
+	UpdateSolver();
+	m_scene.RequestRender();
+
+	return m_bShowProbabilities;
+}
+
+BOOL MinefieldWindow::ToggleFrameTimes()
+{
+	m_bShowFrameTimes = !m_bShowFrameTimes;
+	m_scene.SetFrameTimesVisible(m_bShowFrameTimes);
+	m_scene.RequestRender();
+
+	return m_bShowFrameTimes;
+}
+
+/*
+*	Toggles following every position the mouse was sampled
+*	at. Windows merges the samples of a fast mouse into one
+*	WM_MOUSEMOVE, so without this a drag can jump over tiles.
+*/
+BOOL MinefieldWindow::TogglePreciseMouse()
+{
+	m_bPreciseMouse = !m_bPreciseMouse;
+	m_lastMovePoint = {};
+
+	return m_bPreciseMouse;
+}
+
+const Replay& MinefieldWindow::GetReplay() const
+{
+	return m_replay;
+}
+
+/*
+*	Starts a new game on the board of replay, which must have
+*	the size of the minefield, and plays its events back at
+*	the recorded speed. The player's clicks are ignored until
+*	all events were played or the game is reset. Afterwards
+*	the replay is the recording of the game, so a game that
+*	was left unfinished can be continued.
+*/
+void MinefieldWindow::PlayReplay(const Replay& replay)
+{
+	ResetGame();
+
+	m_bRecordingStats = FALSE;
+	m_bQuestionMarksBeforeReplay = m_engine.AreQuestionMarksEnabled();
+	m_replay = replay;
+	m_replay.Setup(m_engine);
+	m_replayReader.emplace(m_replay);
+
+	if (m_replayReader->Next(m_nextReplayEvent))
+	{
+		SetTimer(m_hWnd, constants::REPLAY_TIMER_ID, max(m_nextReplayEvent.delay, USER_TIMER_MINIMUM), nullptr);
+	}
+	else
+	{
+		StopReplay();
+	}
+
+	m_scene.RequestRender();
+}
+
+/*
+*	Saves the game, replacing szPath. A board loaded from a
+*	save copies its tiles out of the mapped file first, so
+*	the game can be saved over the file it was loaded from.
+*/
+BOOL MinefieldWindow::SaveGame(LPCWSTR szPath, LONGLONG elapsedMilliseconds)
+{
+	m_engine.ReleaseBoardStorage();
+	return GameSave::Save(szPath, m_engine, elapsedMilliseconds);
+}
+
+/*
+*	Continues the game saved in szPath. Its tiles are only
+*	read from the file once they are drawn, but a board small
+*	enough for the solver is read as a whole to tell the
+*	solver what was revealed. A continued game has no replay
+*	and isn't added to the statistics.
+*/
+BOOL MinefieldWindow::LoadGame(LPCWSTR szPath, LONGLONG& elapsedMilliseconds)
+{
+	StopReplay();
+
+	if (!GameSave::Load(szPath, m_engine, elapsedMilliseconds))
+	{
+		return FALSE;
+	}
+
+	m_replay = Replay{};
+	m_bRecordingStats = FALSE;
+	m_bNoGuessBoard = FALSE;
+	m_bAwaitingBoard = FALSE;
+	m_pGameWindow->StopTimer();
+	m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_engine.GetMineCount()) - static_cast<INT32>(m_engine.GetFlaggedCount()));
+	m_pGameWindow->SetSmileState(SmileState::SMILE);
+	m_scene.ResetCamera();
+	RebuildSolver();
+
+	if (m_engine.IsGameStarted() && IsGameActive())
+	{
+		m_pGameWindow->StartTimer();
+	}
+
+	UpdateGameOutcome();
+	UpdateScrollBars();
+	PublishBoard(FALSE);
+	m_scene.RequestRender();
+
+	return TRUE;
+}
+
+/*
+*	Takes back the last move, e.g. a click on a mine. The
+*	engine restores only the chunks of the board the move
+*	changed. A game with moves taken back has no replay, as
+*	the replay could not reach the same board, and isn't added
+*	to the statistics.
+*/
+BOOL MinefieldWindow::Undo()
+{
+	if (IsReplaying() || !m_engine.Undo())
+	{
+		return FALSE;
+	}
+
+	ShowRestoredGame();
+	return TRUE;
+}
+
+BOOL MinefieldWindow::Redo()
+{
+	if (IsReplaying() || !m_engine.Redo())
+	{
+		return FALSE;
+	}
+
+	ShowRestoredGame();
+	return TRUE;
+}
+
+/*
+*	Starts streaming the game to spectators connecting to
+*	constants::SPECTATOR_PORT, or stops it and disconnects
+*	them. Returns FALSE if the port can't be listened on.
+*/
+BOOL MinefieldWindow::HostSpectators(BOOL bHost)
+{
+	if (!bHost)
+	{
+		m_spectators.Stop();
+		return TRUE;
+	}
+
+	if (IsHostingSpectators() || !m_spectators.Start(constants::SPECTATOR_PORT))
+	{
+		return IsHostingSpectators();
+	}
+
+	PublishBoard(FALSE);
+	return TRUE;
+}
+
+BOOL MinefieldWindow::IsHostingSpectators() const
+{
+	return m_spectators.IsRunning();
 }
 
 /*
@@ -157,308 +383,687 @@ void MinefieldWindow::ResetGame()
 */
 
 /*
-*	Returns the number of mines that are adjacent to the
-*	that are adjacent to the tile at position (x,y)
+*	Returns the (x,y) position in the tile grid given an
+*	lParam that represents the mouse position (From WinProc)
 */
-UINT MinefieldWindow::GetNumberAdjacentMines(UINT x, UINT y)
+POINT MinefieldWindow::MouseToTilePos(LPARAM lParam)
 {
-	UINT cAdjacentMines{ 0 };
+	const POINTS mousePosition{ MAKEPOINTS(lParam) };
+	return m_scene.ViewToTile(mousePosition.x, mousePosition.y);
+}
+
+/*
+*	Fills m_aMovePoints with the positions, in window pixels,
+*	the mouse was sampled at since the last sample followed,
+*	oldest first and ending at the position of lParam. The
+*	system only keeps the last 64 samples, if the last one
+*	followed is older than that they are all new.
+*/
+void MinefieldWindow::CollectMovePoints(LPARAM lParam)
+{
+	constexpr int MAX_MOVE_POINTS{ 64 };
+
+	POINT cursor{ GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+	ClientToScreen(m_hWnd, &cursor);
+
+	// Display points are passed and returned as 16 bit values, negative on monitors left of or above the primary one.
+	MOUSEMOVEPOINT current{};
+	current.x = cursor.x & 0xFFFF;
+	current.y = cursor.y & 0xFFFF;
+	current.time = GetMessageTime();
+
+	MOUSEMOVEPOINT aHistory[MAX_MOVE_POINTS];
+	int cHistory{ GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current, aHistory, MAX_MOVE_POINTS, GMMP_USE_DISPLAY_POINTS) };
+
+	if (cHistory <= 0)
+	{
+		aHistory[0] = current;
+		cHistory = 1;
+	}
+
+	// The history is newest first, the samples before the last one followed are new.
+	int cNew{ 0 };
+
+	while (cNew < cHistory && (aHistory[cNew].x != m_lastMovePoint.x || aHistory[cNew].y != m_lastMovePoint.y ||
+		aHistory[cNew].time != m_lastMovePoint.time))
+	{
+		++cNew;
+	}
+
+	m_aMovePoints.clear();
+
+	for (int i{ max(cNew, 1) - 1 }; i >= 0; --i)
+	{
+		POINT point{ aHistory[i].x > 0x7FFF ? aHistory[i].x - 0x10000 : aHistory[i].x,
+			aHistory[i].y > 0x7FFF ? aHistory[i].y - 0x10000 : aHistory[i].y };
+		ScreenToClient(m_hWnd, &point);
+		m_aMovePoints.push_back(point);
+	}
+
+	m_lastMovePoint = aHistory[0];
+}
 
-	for (const auto tile : GetTileGrid(x, y, 1))
+/*
+*	Moves the pressed tiles to the mouse position of lParam.
+*	With precise mouse input they first go through every
+*	sample of the move, so each tile the mouse crossed is
+*	pressed and released again. The engine only collects the
+*	tiles that changed, so however many samples there are the
+*	move still costs one frame.
+*/
+void MinefieldWindow::MoveAlongMouse(LPARAM lParam, UINT tileUpdateRadius)
+{
+	if (m_bPreciseMouse)
 	{
-		if ((*this)(tile).GetTileContent() == TileContent::MINE)
+		for (const POINT& point : m_aMovePoints)
 		{
-			++cAdjacentMines;
+			const POINT gridPos{ m_scene.ViewToTile(static_cast<FLOAT>(point.x), static_cast<FLOAT>(point.y)) };
+			MovePos(m_lastGridPos, gridPos, tileUpdateRadius, FALSE);
+			m_lastGridPos = gridPos;
 		}
 	}
+	else
+	{
+		MovePos(m_lastGridPos, MouseToTilePos(lParam), tileUpdateRadius, FALSE);
+	}
+}
 
-	return cAdjacentMines;
+// Handles beginning to chord at a position (x,y) on the minefield.
+void MinefieldWindow::BeginChord(UINT x, UINT y)
+{
+	m_pGameWindow->SetSmileState(SmileState::SMILE_OPEN_MOUTH);
+	m_engine.BeginChord(x, y);
+	m_bChording = true;
 }
 
 /*
-*	Returns a vector containing all tiles in a square grid
-*	centered at (x, y) with a given radius.
-*	Guaranteed to be sorted, can excludeCenter
+*	Handles the end of a chording move. The engine reveals
+*	the surrounding tiles if the number of the tile matches
+*	the number of surrounding flags.
 */
-std::vector<UINT> MinefieldWindow::GetTileGrid(UINT x, UINT y, INT radius)
+void MinefieldWindow::EndChord(UINT x, UINT y)
 {
-	std::vector<UINT> aAdjacentTiles{};
+	m_pGameWindow->SetSmileState(SmileState::SMILE);
+
+	const Tracing::Stopwatch stopwatch{};
+	const std::size_t firstSpan{ m_engine.GetRevealedSpans().size() };
 
-	if (radius < 0)
+	if (m_engine.EndChord(x, y))
 	{
-		return aAdjacentTiles;
+		TraceReveal(m_engine, firstSpan, stopwatch.GetElapsed(), TRUE);
+		RecordAction(Replay::Action::CHORD, x, y);
+		CountClick(TRUE);
+		PublishMove(firstSpan);
+		UpdateSolver();
+		UpdateGameOutcome();
+	}
+	else
+	{
+		CountClick(FALSE);
+	}
+
+	m_bChording = false;
+}
+
+/*
+*	Places the mines of a new game before its first click at
+*	(x,y) is revealed, and writes a GenerateMines event of
+*	how long it took. Returns FALSE if a no guessing board
+*	is searched for the click in the background instead, the
+*	click is then revealed once it arrives.
+*/
+BOOL MinefieldWindow::GenerateMines(UINT x, UINT y)
+{
+	const Tracing::Stopwatch stopwatch{};
+
+	if (!m_bNoGuessing || !PlaceNoGuessMines(x, y))
+	{
+		if (m_bNoGuessing && RequestNoGuessBoard(x, y))
+		{
+			return FALSE;
+		}
+
+		m_engine.GenerateMines(x, y);
+	}
+
+	TraceGenerateMines(stopwatch.GetElapsed());
+	return TRUE;
+}
+
+// Places a ready no guessing board from the pool whose first click can be (x,y), returns FALSE if there is none.
+BOOL MinefieldWindow::PlaceNoGuessMines(UINT x, UINT y)
+{
+	std::vector<std::uint32_t> aMineTiles{};
+
+	if (NoGuessBoardPool::Instance().TakeBoard(m_engine.GetWidth(), m_engine.GetHeight(), m_engine.GetMineCount(), x, y, aMineTiles))
+	{
+		m_engine.PlaceMines(aMineTiles);
+		m_replay.SetMines(aMineTiles);
+		m_bNoGuessBoard = TRUE;
+		return TRUE;
 	}
 
-	aAdjacentTiles.reserve((1 + 2 * static_cast<std::size_t>(radius)) * (1 + 2 * static_cast<std::size_t>(radius)));
+	return FALSE;
+}
 
-	for (INT yOffset{ -radius }; yOffset <= radius; ++yOffset)
+/*
+*	Searches a no guessing board solvable from (x,y) on the
+*	thread pool, where it is posted back to the window with
+*	WM_NO_GUESS_BOARD. Until then the clicks of the player
+*	are ignored and the timer doesn't run. Returns FALSE if
+*	the board is too large to verify.
+*/
+BOOL MinefieldWindow::RequestNoGuessBoard(UINT x, UINT y)
+{
+	const HWND hWnd{ m_hWnd };
+	const UINT request{ ++m_boardRequest };
+
+	const auto onDone{ [hWnd, request](bool bFound, std::vector<std::uint32_t>&& aMineTiles)
 	{
-		if (0 <= y + yOffset && y + yOffset < m_height)
+		std::unique_ptr<NoGuessBoard> pBoard{ new NoGuessBoard{ request, bFound, std::move(aMineTiles) } };
+
+		if (PostMessage(hWnd, WM_NO_GUESS_BOARD, 0, reinterpret_cast<LPARAM>(pBoard.get())))
 		{
-			for (INT xOffset{ -radius }; xOffset <= radius; ++xOffset)
+			pBoard.release();
+		}
+	} };
+
+	if (!NoGuessBoardPool::Instance().GenerateBoardAsync(m_engine.GetWidth(), m_engine.GetHeight(), m_engine.GetMineCount(), x, y,
+		m_engine.GetGameSeed(), constants::NO_GUESS_ATTEMPTS, onDone))
+	{
+		return FALSE;
+	}
+
+	m_bAwaitingBoard = TRUE;
+	m_awaitedClick = { static_cast<LONG>(x), static_cast<LONG>(y) };
+	m_boardRequestTime = GetMessageTime();
+	return TRUE;
+}
+
+/*
+*	Places the board a search posted and reveals the first
+*	click it was searched for. A board of a game that was
+*	reset in the meantime is dropped. If the search found
+*	none the mines are generated normally.
+*/
+void MinefieldWindow::OnNoGuessBoard(WPARAM, LPARAM lParam)
+{
+	const std::unique_ptr<NoGuessBoard> pBoard{ reinterpret_cast<NoGuessBoard*>(lParam) };
+
+	if (!m_bAwaitingBoard || pBoard->request != m_boardRequest)
+	{
+		return;
+	}
+
+	const UINT x{ static_cast<UINT>(m_awaitedClick.x) };
+	const UINT y{ static_cast<UINT>(m_awaitedClick.y) };
+	m_bAwaitingBoard = FALSE;
+
+	if (pBoard->bFound)
+	{
+		m_engine.PlaceMines(pBoard->aMineTiles);
+		m_replay.SetMines(pBoard->aMineTiles);
+		m_bNoGuessBoard = TRUE;
+	}
+	else
+	{
+		m_engine.GenerateMines(x, y);
+	}
+
+	TraceGenerateMines(static_cast<LONGLONG>(Tracing::GetMessageAge(m_boardRequestTime)) * 1000);
+	RevealClickedTile(x, y);
+
+	if (IsGameActive())
+	{
+		m_pGameWindow->SetSmileState(SmileState::SMILE);
+	}
+}
+
+// Writes a GenerateMines event for the mines placed for the game.
+void MinefieldWindow::TraceGenerateMines(LONGLONG microseconds) const
+{
+	TraceLoggingWrite(g_hMinesweeperTraceProvider, "GenerateMines",
+		TraceLoggingUInt32(m_engine.GetWidth(), "Width"),
+		TraceLoggingUInt32(m_engine.GetHeight(), "Height"),
+		TraceLoggingUInt32(m_engine.GetMineCount(), "Mines"),
+		TraceLoggingBoolean(m_bNoGuessBoard, "NoGuessing"),
+		TraceLoggingInt64(microseconds, "Microseconds"),
+		TraceLoggingUInt32(GetMessageTime(), "MessageTime"));
+}
+
+// Reveals the tile at (x,y) the player clicked, starting the timer on the first click of a game.
+void MinefieldWindow::RevealClickedTile(UINT x, UINT y)
+{
+	if (!m_engine.IsGameStarted())
+	{
+		m_pGameWindow->StartTimer();
+	}
+
+	RevealTile(x, y);
+	CountClick(TRUE);
+	UpdateSolver();
+	m_scene.RequestRender();
+	UpdateGameOutcome();
+}
+
+// Reveals the tile at (x,y) and writes a Reveal event of how many tiles it revealed and how long that took.
+void MinefieldWindow::RevealTile(UINT x, UINT y)
+{
+	const Tracing::Stopwatch stopwatch{};
+	const std::size_t firstSpan{ m_engine.GetRevealedSpans().size() };
+
+	m_engine.RevealTile(x, y);
+	TraceReveal(m_engine, firstSpan, stopwatch.GetElapsed(), FALSE);
+	RecordAction(Replay::Action::REVEAL, x, y);
+	PublishMove(firstSpan);
+}
+
+// Cycles the mark of the tile at (x,y) and updates the flag counter.
+void MinefieldWindow::CycleTileMark(UINT x, UINT y)
+{
+	m_engine.CycleTileMark(x, y);
+	m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_engine.GetMineCount()) - static_cast<INT32>(m_engine.GetFlaggedCount()));
+	RecordAction(Replay::Action::CYCLE_MARK, x, y);
+	PublishMark(x, y);
+}
+
+// Appends an action of the player to the recording of the game, actions played back from a replay are not recorded.
+void MinefieldWindow::RecordAction(Replay::Action action, UINT x, UINT y)
+{
+	if (!IsReplaying())
+	{
+		m_replay.Add(action, x + y * m_engine.GetWidth(), GetMessageTime());
+	}
+}
+
+BOOL MinefieldWindow::IsReplaying() const
+{
+	return m_replayReader.has_value();
+}
+
+// Plays back one event of the replay the way the input handlers play the action of the player.
+void MinefieldWindow::PlayReplayEvent(const Replay::Event& event)
+{
+	const UINT x{ event.tile % m_engine.GetWidth() };
+	const UINT y{ event.tile / m_engine.GetWidth() };
+
+	if (event.action == Replay::Action::TOGGLE_QUESTION_MARKS)
+	{
+		ToggleQuestionMarkUsage();
+		return;
+	}
+
+	if (event.tile >= m_engine.GetSize() || !IsGameActive())
+	{
+		return;
+	}
+
+	switch (event.action)
+	{
+	case Replay::Action::REVEAL:
+		if (!m_engine.IsGameStarted())
+		{
+			m_pGameWindow->StartTimer();
+		}
+
+		RevealTile(x, y);
+		UpdateSolver();
+		UpdateGameOutcome();
+		break;
+
+	case Replay::Action::CYCLE_MARK:
+		CycleTileMark(x, y);
+		break;
+
+	case Replay::Action::CHORD:
+		BeginChord(x, y);
+		EndChord(x, y);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/*
+*	Plays the events of the replay that are due and waits for
+*	the next one with the replay timer. Events that follow
+*	sooner than the timer can fire are played right away.
+*/
+void MinefieldWindow::PlayNextReplayEvents()
+{
+	for (;;)
+	{
+		PlayReplayEvent(m_nextReplayEvent);
+
+		if (!m_replayReader->Next(m_nextReplayEvent))
+		{
+			StopReplay();
+			break;
+		}
+
+		if (m_nextReplayEvent.delay >= USER_TIMER_MINIMUM)
+		{
+			SetTimer(m_hWnd, constants::REPLAY_TIMER_ID, m_nextReplayEvent.delay, nullptr);
+			break;
+		}
+	}
+
+	m_scene.RequestRender();
+}
+
+/*
+*	Ends the playback of a replay, if one is played back, and
+*	gives the player back the question mark usage they had
+*	chosen before it.
+*/
+void MinefieldWindow::StopReplay()
+{
+	if (!IsReplaying())
+	{
+		return;
+	}
+
+	KillTimer(m_hWnd, constants::REPLAY_TIMER_ID);
+	m_replayReader.reset();
+	m_replay.SetTime(GetMessageTime());
+
+	if (m_engine.AreQuestionMarksEnabled() != m_bQuestionMarksBeforeReplay)
+	{
+		ToggleQuestionMarkUsage();
+	}
+}
+
+/*
+*	Handles the process of updating tiles when mouse moves
+*	from oldPos to newPos on the field. tileUpdateRadius
+*	sets the radius of tiles to update. forceUpdate causes
+*	an update to field even if oldPos and newPos are equal.
+*/
+void MinefieldWindow::MovePos(POINT oldPos, POINT newPos, UINT tileUpdateRadius, BOOL forceUpdate)
+{
+	if (oldPos.x != newPos.x || oldPos.y != newPos.y || forceUpdate)
+	{
+		m_engine.MovePos(oldPos.x, oldPos.y, newPos.x, newPos.y, tileUpdateRadius);
+		m_scene.RequestRender();
+	}
+}
+
+// The solver is kept for boards up to MineSolver::MAX_TILES only.
+BOOL MinefieldWindow::IsSolverEnabled() const
+{
+	return m_engine.GetSize() <= MineSolver::MAX_TILES;
+}
+
+void MinefieldWindow::ResetSolver()
+{
+	if (IsSolverEnabled())
+	{
+		m_solver.Reset(m_engine.GetWidth(), m_engine.GetHeight(), m_engine.GetMineCount());
+	}
+
+	UpdateSolver();
+}
+
+/*
+*	Starts the solver over from every revealed tile, for
+*	boards that changed other than by revealing tiles. Reads
+*	the whole board, which the solver keeps small enough.
+*/
+void MinefieldWindow::RebuildSolver()
+{
+	ResetSolver();
+
+	if (IsSolverEnabled() && IsGameActive())
+	{
+		const TileBoard& board{ m_engine.GetBoard() };
+
+		for (std::uint32_t y{ 0 }, tile{ 0 }; y < board.GetHeight(); ++y)
+		{
+			for (std::uint32_t x{ 0 }; x < board.GetWidth(); ++x, ++tile)
 			{
-				if (0 <= x + xOffset && x + xOffset < m_width)
+				if (board.GetState(x, y) == TileState::REVEALED)
 				{
-					aAdjacentTiles.push_back((x + xOffset) + (y + yOffset) * m_width);
+					m_solver.SetRevealed(tile, board.GetAdjacentCount(x, y));
 				}
 			}
 		}
-	}
 
-	return aAdjacentTiles;
+		UpdateSolver();
+	}
 }
 
-/*
-*	Returns the (x,y) position in the tile grid given an
-*	lParam that represents the mouse position (From WinProc)
-*/
+// Matches the counters, the smile, the timer and the solver to a game the engine undid or redid a move of.
+void MinefieldWindow::ShowRestoredGame()
+{
+	m_bChording = FALSE;
+	m_bLRHeldAfterChord = FALSE;
+	m_replay = Replay{};
+	m_bRecordingStats = FALSE;
+	m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_engine.GetMineCount()) - static_cast<INT32>(m_engine.GetFlaggedCount()));
+	m_pGameWindow->SetSmileState(SmileState::SMILE);
+
+	if (!m_engine.IsGameStarted())
+	{
+		m_pGameWindow->StopTimer();
+		m_pGameWindow->ResetTimer();
+	}
+	else if (IsGameActive())
+	{
+		m_pGameWindow->StartTimer();
+	}
 
-POINT MinefieldWindow::MouseToTilePos(LPARAM lParam)
-{
-	POINTS mousePosition = MAKEPOINTS(lParam);
-	RECT rc;
-	GetClientRect(m_hWnd, &rc);
-	POINT pos;
-	pos.x = static_cast<LONG>((static_cast<DOUBLE>(mousePosition.x) - rc.left) / ((static_cast<DOUBLE>(rc.right) - rc.left) / m_width));
-	pos.y = static_cast<LONG>((static_cast<DOUBLE>(mousePosition.y) - rc.top) / ((static_cast<DOUBLE>(rc.bottom) - rc.top) / m_height));
-	pos.x = min(max(pos.x, 0), m_width - 1);
-	pos.y = min(max(pos.y, 0), m_height - 1);
-	return pos;
+	RebuildSolver();
+	UpdateGameOutcome();
+	PublishBoard(FALSE);
+	m_scene.RequestRender();
 }
 
 /*
-*	Generate the Mine positions given that the the first
-*	clicked tile is at positon (x,y) in the minefield grid.
+*	Tells the solver about the tiles the last move revealed
+*	and updates the overlay. Flags are the player's guesses,
+*	so the solver doesn't trust them and finds mines itself.
 */
-void MinefieldWindow::GenerateMines(UINT x, UINT y)
+void MinefieldWindow::UpdateSolver()
 {
-	std::vector<UINT> excludedTiles{ GetTileGrid(x, y, (m_cTiles - m_cMines < 9 ? 0 : 1)) };
+	m_scene.SetHintTile(-1);
 
-	std::vector<MineTile*> tilesToToggle{};
-	tilesToToggle.reserve(m_aMineTiles.size());
-	auto itLeft = excludedTiles.begin();
-	auto itRight = excludedTiles.end();
-	for (UINT tile{ 0 }; tile < m_aMineTiles.size(); ++tile)
+	if (!IsSolverEnabled() || !IsGameActive())
 	{
-		if (itLeft == itRight || tile < *itLeft)
-		{
-			tilesToToggle.push_back(&m_aMineTiles[tile]);
-		}
-		else
+		m_scene.SetMineProbabilities(nullptr);
+		return;
+	}
+
+	const UINT width{ m_engine.GetWidth() };
+
+	for (const TileSpan& span : m_engine.GetRevealedSpans())
+	{
+		for (std::uint32_t x{ span.xBegin }; x < span.xEnd; ++x)
 		{
-			++itLeft;
+			m_solver.SetRevealed(x + span.y * width, m_engine.GetBoard().GetAdjacentCount(x, span.y));
 		}
 	}
 
-	tilesToToggle = m_rng.SampleVector(tilesToToggle, m_cMines);
-	for (auto tile : tilesToToggle)
+	if (m_bShowProbabilities)
+	{
+		m_solver.GetMineProbabilities(m_aMineProbabilities);
+		m_scene.SetMineProbabilities(&m_aMineProbabilities);
+	}
+	else
+	{
+		m_scene.SetMineProbabilities(nullptr);
+	}
+}
+
+// Informs the game window if the last action won or lost the game.
+void MinefieldWindow::UpdateGameOutcome()
+{
+	if (!IsGameActive() && !IsReplaying())
 	{
-		tile->SetTileContent(TileContent::MINE);
+		m_replay.Finish(m_engine);
 	}
 
-	GenerateNumbers();
+	if (m_engine.IsGameLost())
+	{
+		m_pGameWindow->StopTimer();
+		m_pGameWindow->SetSmileState(SmileState::SMILE_DEAD);
+		RecordStats();
+	}
+	else if (m_engine.IsGameWon())
+	{
+		m_pGameWindow->StopTimer();
+		m_pGameWindow->SetFlagCounter(0);
+		m_pGameWindow->SetSmileState(SmileState::SMILE_SUNGLASSES);
+		RecordStats();
+	}
 }
 
 /*
-*	Given a minefield with filled in mines, generates the
-*	numbers that each tile should have.
+*	Counts a click of the player, effective if it revealed
+*	or marked a tile. Only the tally is updated here, so the
+*	efficiency of a game is known when it ends without looking
+*	at the board again.
 */
-void MinefieldWindow::GenerateNumbers()
+void MinefieldWindow::CountClick(BOOL bEffective)
 {
-	for (UINT x{ 0 }; x < m_width; ++x)
+	if (bEffective)
 	{
-		for (UINT y{ 0 }; y < m_height; ++y)
-		{
-			if ((*this)(x, y).GetTileContent() != TileContent::MINE)
-			{
-				switch (GetNumberAdjacentMines(x, y))
-				{
-				case 1:
-					(*this)(x, y).SetTileContent(TileContent::ONE);
-					break;
-				case 2:
-					(*this)(x, y).SetTileContent(TileContent::TWO);
-					break;
-				case 3:
-					(*this)(x, y).SetTileContent(TileContent::THREE);
-					break;
-				case 4:
-					(*this)(x, y).SetTileContent(TileContent::FOUR);
-					break;
-				case 5:
-					(*this)(x, y).SetTileContent(TileContent::FIVE);
-					break;
-				case 6:
-					(*this)(x, y).SetTileContent(TileContent::SIX);
-					break;
-				case 7:
-					(*this)(x, y).SetTileContent(TileContent::SEVEN);
-					break;
-				case 8:
-					(*this)(x, y).SetTileContent(TileContent::EIGHT);
-					break;
-				case 0:
-				default:
-					(*this)(x, y).SetTileContent(TileContent::EMPTY);
-					break;
-				}
-			}
-		}
+		++m_cEffectiveClicks;
+	}
+	else
+	{
+		++m_cWastedClicks;
 	}
 }
 
 /*
-*	Sets the Tile at (x,y) as revealed and if reveals the
-*	adjacent tile if said tile is empty.
+*	Adds the game that just ended to the statistics. The 3BV
+*	was counted when the mines were placed, so nothing here
+*	depends on the size of the board.
 */
-void MinefieldWindow::SetTileRevealed(UINT x, UINT y)
+void MinefieldWindow::RecordStats()
 {
-	if ((*this)(x, y).GetTileState() != TileState::REVEALED
-		&& (*this)(x, y).GetTileMark() != TileMark::FLAG)
+	if (!m_bRecordingStats)
 	{
-		(*this)(x, y).SetTileState(TileState::REVEALED);
-		++m_cRevealedTiles;
+		return;
+	}
 
-		if ((*this)(x, y).GetTileContent() == TileContent::MINE)
-		{
-			m_bGameLost = TRUE;
-		}
-		else if ((*this)(x, y).GetTileContent() == TileContent::EMPTY)
-		{
-			std::queue<UINT> tilesToProcess{};
-			tilesToProcess.push(x + y * m_width);
+	m_bRecordingStats = FALSE;
 
-			while (tilesToProcess.size() != 0)
-			{
-				for (const UINT tile : GetTileGrid(tilesToProcess.front() % m_width, tilesToProcess.front() / m_width, 1))
-				{
-					if ((*this)(tile).GetTileState() != TileState::REVEALED && (*this)(tile).GetTileMark() != TileMark::FLAG)
-					{
-						(*this)(tile).SetTileState(TileState::REVEALED);
-						++m_cRevealedTiles;
-
-						if ((*this)(tile).GetTileContent() == TileContent::EMPTY)
-						{
-							tilesToProcess.push(tile);
-						}
-					}
-				}
+	GameStats::Record record{};
+	record.width = m_engine.GetWidth();
+	record.height = m_engine.GetHeight();
+	record.cMines = m_engine.GetMineCount();
+	record.flags = (m_engine.IsGameWon() ? GameStats::FLAG_WON : 0) | (m_bNoGuessBoard ? GameStats::FLAG_NO_GUESSING : 0);
+	record.threeBV = m_engine.GetThreeBV();
+	record.milliseconds = static_cast<std::uint32_t>(min(m_pGameWindow->GetElapsedMilliseconds(), static_cast<LONGLONG>(UINT32_MAX)));
+	record.cEffectiveClicks = m_cEffectiveClicks;
+	record.cWastedClicks = m_cWastedClicks;
 
-				tilesToProcess.pop();
-			}
-		}
-	}
+	m_pGameWindow->GetStats().Add(record);
 }
 
-// Handles beginning to chord at a position (x,y) on the minefield.
-void MinefieldWindow::BeginChord(UINT x, UINT y)
+/*
+*	Matches the scroll bars to the part of the board shown
+*	by the scene. A scroll bar hides itself when the board
+*	fits into the window along its axis.
+*/
+void MinefieldWindow::UpdateScrollBars()
 {
-	m_pGameWindow->SetSmileState(SmileState::SMILE_OPEN_MOUTH);
+	const D2D1_SIZE_F viewSize{ m_scene.GetViewSize() };
+	const D2D1_SIZE_F boardSize{ m_scene.GetBoardSize() };
+	const D2D1_POINT_2F viewOffset{ m_scene.GetViewOffset() };
+
+	SCROLLINFO si{};
+	si.cbSize = sizeof(SCROLLINFO);
+	si.fMask = SIF_PAGE | SIF_POS | SIF_RANGE;
+
+	si.nMax = static_cast<int>(ceilf(boardSize.width)) - 1;
+	si.nPage = static_cast<UINT>(viewSize.width);
+	si.nPos = static_cast<int>(max(viewOffset.x, 0.f));
+	SetScrollInfo(m_hWnd, SB_HORZ, &si, TRUE);
+
+	si.nMax = static_cast<int>(ceilf(boardSize.height)) - 1;
+	si.nPage = static_cast<UINT>(viewSize.height);
+	si.nPos = static_cast<int>(max(viewOffset.y, 0.f));
+	SetScrollInfo(m_hWnd, SB_VERT, &si, TRUE);
+}
 
-	for (UINT tile : GetTileGrid(x, y, 1))
-	{
-		if ((*this)(tile).GetTileState() == TileState::HIDDEN && (*this)(tile).GetTileMark() != TileMark::FLAG)
-		{
-			(*this)(tile).SetTileState(TileState::CLICKED);
-		}
-	}
+// Returns an update holding nothing but the counters and the outcome of the game, as they are shown to the player.
+SpectatorServer::Update MinefieldWindow::GetSpectatorStatus() const
+{
+	SpectatorServer::Update update{};
+	update.flagCounter = m_engine.IsGameWon() ? 0 : static_cast<INT32>(m_engine.GetMineCount()) - static_cast<INT32>(m_engine.GetFlaggedCount());
+	update.elapsedSeconds = static_cast<std::uint32_t>(m_pGameWindow->GetElapsedTime());
+	update.status = static_cast<std::uint8_t>((m_engine.IsGameStarted() && IsGameActive() ? SpectatorServer::STATUS_TIMER_RUNNING : 0) |
+		(m_engine.IsGameWon() ? SpectatorServer::STATUS_GAME_WON : 0) | (m_engine.IsGameLost() ? SpectatorServer::STATUS_GAME_LOST : 0));
 
-	m_bChording = true;
+	return update;
 }
 
 /*
-*	Handles the end of a chording move. Reveals tiles if the 
-*	number of the tiles matches the number of surrounding flags
-*	when chord ends by lifting mouse button.
+*	Sends spectators the whole board, for a new game or one
+*	that changed other than by a move. The server thread reads
+*	the tiles from a shared copy of the board, except after a
+*	reset: every tile is hidden then, and sharing would make
+*	the first move copy the planes kept for the new game.
 */
-void MinefieldWindow::EndChord(UINT x, UINT y)
+void MinefieldWindow::PublishBoard(BOOL bReset)
 {
-	m_pGameWindow->SetSmileState(SmileState::SMILE);
-
-	if ((*this)(x,y).GetTileState() == TileState::REVEALED)
+	if (!IsHostingSpectators())
 	{
-		UINT cFlags{ 0 };
+		return;
+	}
 
-		for (UINT tile : GetTileGrid(x, y, 1))
-		{
-			if ((*this)(tile).GetTileMark() == TileMark::FLAG)
-			{
-				++cFlags;
-			}
-		}
+	SpectatorServer::Update update{ GetSpectatorStatus() };
+	update.bNewGame = true;
+	update.width = m_engine.GetWidth();
+	update.height = m_engine.GetHeight();
+	update.cMines = m_engine.GetMineCount();
+	update.pBoard = bReset ? nullptr : m_engine.ShareBoard();
+	m_spectators.Publish(std::move(update));
+}
 
-		if (cFlags == GetNumberAdjacentMines(x, y))
-		{
-			for (UINT tile : GetTileGrid(x, y, 1))
-			{
-				SetTileRevealed(tile % m_width, tile / m_width);
-			}
+// Sends spectators the tiles the move revealed, from span firstSpan of the engine on, and the mines if it ended the game.
+void MinefieldWindow::PublishMove(std::size_t firstSpan)
+{
+	if (!IsHostingSpectators())
+	{
+		return;
+	}
 
-			if (IsGameLost())
-			{
-				m_pGameWindow->StopTimer();
-				m_pGameWindow->SetSmileState(SmileState::SMILE_DEAD);
-			}
-			else if (IsGameWon())
-			{
-				m_pGameWindow->StopTimer();
-				m_pGameWindow->SetFlagCounter(0);
-				m_pGameWindow->SetSmileState(SmileState::SMILE_SUNGLASSES);
-			}
-		}
-		else
+	SpectatorServer::Update update{ GetSpectatorStatus() };
+	const std::vector<TileSpan>& aSpans{ m_engine.GetRevealedSpans() };
+	update.aRevealedSpans.assign(aSpans.begin() + static_cast<std::ptrdiff_t>(firstSpan), aSpans.end());
+
+	for (const TileSpan& span : update.aRevealedSpans)
+	{
+		for (std::uint32_t x{ span.xBegin }; x < span.xEnd; ++x)
 		{
-			for (UINT tile : GetTileGrid(x, y, 1))
-			{
-				if ((*this)(tile).GetTileState() == TileState::CLICKED)
-				{
-					(*this)(tile).SetTileState(TileState::HIDDEN);
-				}
-			}
+			update.aRevealedContents.push_back(static_cast<std::uint8_t>(m_engine(x, span.y).GetTileContent()));
 		}
 	}
-	else
+
+	if (!IsGameActive())
 	{
-		for (UINT tile : GetTileGrid(x, y, 1))
-		{
-			if ((*this)(tile).GetTileState() == TileState::CLICKED)
-			{
-				(*this)(tile).SetTileState(TileState::HIDDEN);
-			}
-		}
+		update.pBoard = m_engine.ShareBoard();
 	}
 
-	m_bChording = false;
+	m_spectators.Publish(std::move(update));
 }
 
-/*
-*	Handles the process of updating tiles when mouse moves
-*	from oldPos to newPos on the field. tileUpdateRadius
-*	sets the radius of tiles to update. forceUpdate causes
-*	an update to field even if oldPos and newPos are equal.
-*/
-void MinefieldWindow::MovePos(POINT oldPos, POINT newPos, UINT tileUpdateRadius, BOOL forceUpdate)
+void MinefieldWindow::PublishMark(UINT x, UINT y)
 {
-	if (oldPos.x != newPos.x || oldPos.y != newPos.y || forceUpdate)
+	if (!IsHostingSpectators())
 	{
-		for (UINT tile : GetTileGrid(oldPos.x, oldPos.y, tileUpdateRadius))
-		{
-			if ((*this)(tile).GetTileState() == TileState::CLICKED)
-			{
-				(*this)(tile).SetTileState(TileState::HIDDEN);
-			}
-		}
-
-		for (UINT tile : GetTileGrid(newPos.x, newPos.y, tileUpdateRadius))
-		{
-			if ((*this)(tile).GetTileState() == TileState::HIDDEN && (*this)(tile).GetTileMark() != TileMark::FLAG)
-			{
-				(*this)(tile).SetTileState(TileState::CLICKED);
-			}
-		}
-			
-		m_scene.Render();
+		return;
 	}
+
+	const TileBoard& board{ m_engine.GetBoard() };
+	const std::uint32_t tile{ x + y * m_engine.GetWidth() };
+	SpectatorServer::Update update{ GetSpectatorStatus() };
+	update.aTileChanges.push_back({ tile, SpectatorServer::PackTile(board.GetState(tile), board.GetMark(tile), TileContent::EMPTY) });
+	m_spectators.Publish(std::move(update));
 }
 
 /*
@@ -469,21 +1074,27 @@ void MinefieldWindow::MovePos(POINT oldPos, POINT newPos, UINT tileUpdateRadius,
 
 LRESULT MinefieldWindow::OnLButtonDown(WPARAM wParam, LPARAM lParam)
 {
-	if (IsGameActive() && !(wParam & MK_MBUTTON) && !m_bLRHeldAfterChord)
+	if ((wParam & MK_CONTROL) && !(wParam & (MK_RBUTTON | MK_MBUTTON)))
+	{
+		m_bPanning = TRUE;
+		m_lastPanPos = MAKEPOINTS(lParam);
+		SetCapture(m_hWnd);
+	}
+	else if (IsGameActive() && !(wParam & MK_MBUTTON) && !m_bLRHeldAfterChord)
 	{
 		m_pGameWindow->SetSmileState(SmileState::SMILE_OPEN_MOUTH);
 		POINT gridPos{ MouseToTilePos(lParam) };
-		MineTile* tile = &(*this)(gridPos.x, gridPos.y);
+		const MineTile tile{ m_engine(gridPos.x, gridPos.y) };
 
 		if (wParam & MK_RBUTTON)
 		{
 			BeginChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 		}
-		else if (tile->GetTileState() == TileState::HIDDEN && tile->GetTileMark() != TileMark::FLAG)
+		else if (tile.GetTileState() == TileState::HIDDEN && tile.GetTileMark() != TileMark::FLAG)
 		{
-			tile->SetTileState(TileState::CLICKED);
-			m_scene.Render();
+			m_engine.PressTiles(gridPos.x, gridPos.y, 0);
+			m_scene.RequestRender();
 		}
 	}
 
@@ -492,40 +1103,32 @@ LRESULT MinefieldWindow::OnLButtonDown(WPARAM wParam, LPARAM lParam)
 
 LRESULT MinefieldWindow::OnLButtonUp(WPARAM wParam, LPARAM lParam)
 {
-	if (IsGameActive() && !(wParam & MK_MBUTTON) && !m_bLRHeldAfterChord)
+	if (m_bPanning)
+	{
+		ReleaseCapture();
+	}
+	else if (IsGameActive() && !(wParam & MK_MBUTTON) && !m_bLRHeldAfterChord)
 	{
 		POINT gridPos{ MouseToTilePos(lParam) };
-		MineTile* tile = &(*this)(gridPos.x, gridPos.y);
+		const MineTile tile{ m_engine(gridPos.x, gridPos.y) };
 		
 		if (m_bChording) 
 		{
 			EndChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 			m_bLRHeldAfterChord = TRUE;
 		}
-		else if (tile->GetTileState() == TileState::CLICKED)
+		else if (tile.GetTileState() == TileState::CLICKED)
 		{
-			if (m_cRevealedTiles == 0)
-			{
-				GenerateMines(gridPos.x, gridPos.y);
-				m_pGameWindow->StartTimer();
-			}
-
-			SetTileRevealed(gridPos.x, gridPos.y);
-			m_scene.Render();
-
-			if (IsGameLost())
-			{
-				m_pGameWindow->StopTimer();
-				m_pGameWindow->SetSmileState(SmileState::SMILE_DEAD);
-			}
-			else if (IsGameWon())
+			if (m_engine.AreMinesPlaced() || GenerateMines(gridPos.x, gridPos.y))
 			{
-				m_pGameWindow->StopTimer();
-				m_pGameWindow->SetFlagCounter(0);
-				m_pGameWindow->SetSmileState(SmileState::SMILE_SUNGLASSES);
+				RevealClickedTile(gridPos.x, gridPos.y);
 			}
 		}
+		else
+		{
+			CountClick(FALSE);
+		}
 
 		if (IsGameActive())
 		{
@@ -545,39 +1148,22 @@ LRESULT MinefieldWindow::OnRButtonDown(WPARAM wParam, LPARAM lParam)
 	if (IsGameActive() && !(wParam & MK_MBUTTON) && !m_bLRHeldAfterChord)
 	{
 		POINT gridPos{ MouseToTilePos(lParam) };
-		MineTile* tile = &(*this)(gridPos.x, gridPos.y);
+		const MineTile tile{ m_engine(gridPos.x, gridPos.y) };
 
 		if (wParam & MK_LBUTTON)
 		{
 			BeginChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 		}
-		else if (tile->GetTileState() == TileState::HIDDEN)
+		else if (tile.GetTileState() == TileState::HIDDEN)
 		{
-			switch (tile->GetTileMark())
-			{
-			case TileMark::NONE:
-				++m_cFlaggedTiles;
-				tile->SetTileMark(TileMark::FLAG);
-				break;
-			case TileMark::FLAG:
-				--m_cFlaggedTiles;
-				if (m_bQuestionMarksEnabled)
-				{
-					tile->SetTileMark(TileMark::QUESTION_MARK);
-				}
-				else
-				{
-					tile->SetTileMark(TileMark::NONE);
-				}
-				break;
-			case TileMark::QUESTION_MARK:
-				tile->SetTileMark(TileMark::NONE);
-				break;
-			}
-
-			m_pGameWindow->SetFlagCounter(static_cast<INT32>(m_cMines) - m_cFlaggedTiles);
-			m_scene.Render();
+			CycleTileMark(gridPos.x, gridPos.y);
+			CountClick(TRUE);
+			m_scene.RequestRender();
+		}
+		else
+		{
+			CountClick(FALSE);
 		}
 	}
 
@@ -593,7 +1179,7 @@ LRESULT MinefieldWindow::OnRButtonUp(WPARAM wParam, LPARAM lParam)
 		if (m_bChording)
 		{
 			EndChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 			m_bLRHeldAfterChord = TRUE;
 		}
 	}
@@ -613,7 +1199,7 @@ LRESULT MinefieldWindow::OnMButtonDown(WPARAM wParam, LPARAM lParam)
 		{
 			POINT gridPos{ MouseToTilePos(lParam) };
 			BeginChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 		}
 	}
 
@@ -633,7 +1219,7 @@ LRESULT MinefieldWindow::OnMButtonUp(WPARAM wParam, LPARAM lParam)
 
 			POINT gridPos{ MouseToTilePos(lParam) };
 			EndChord(gridPos.x, gridPos.y);
-			m_scene.Render();
+			m_scene.RequestRender();
 		}
 	}
 
@@ -642,8 +1228,24 @@ LRESULT MinefieldWindow::OnMButtonUp(WPARAM wParam, LPARAM lParam)
 
 LRESULT MinefieldWindow::OnMouseMove(WPARAM wParam, LPARAM lParam)
 {
+	if (m_bPanning)
+	{
+		const POINTS mousePosition{ MAKEPOINTS(lParam) };
+		m_scene.PanBy(static_cast<FLOAT>(m_lastPanPos.x - mousePosition.x), static_cast<FLOAT>(m_lastPanPos.y - mousePosition.y));
+		m_lastPanPos = mousePosition;
+		UpdateScrollBars();
+		m_scene.RequestRender();
+		return 0;
+	}
+
 	POINT gridPos{ MouseToTilePos(lParam) };
 
+	// Samples are collected on every move, so the next move starts from the last one even if no button was held.
+	if (m_bPreciseMouse)
+	{
+		CollectMovePoints(lParam);
+	}
+
 	if (!m_bMouseTracking)
 	{
 		TRACKMOUSEEVENT tme;
@@ -686,11 +1288,11 @@ LRESULT MinefieldWindow::OnMouseMove(WPARAM wParam, LPARAM lParam)
 			{
 				if (m_bChording)
 				{
-					MovePos(m_lastGridPos, gridPos, 1, FALSE);
+					MoveAlongMouse(lParam, 1);
 				}
 				else if(!m_bLRHeldAfterChord)
 				{
-					MovePos(m_lastGridPos, gridPos, 0, FALSE);
+					MoveAlongMouse(lParam, 0);
 				}
 			}
 
@@ -698,7 +1300,7 @@ LRESULT MinefieldWindow::OnMouseMove(WPARAM wParam, LPARAM lParam)
 		}
 	}
 
-	m_pGameWindow->SetCurrentTileContents((*this)(gridPos.x, gridPos.y).GetTileContent());
+	m_pGameWindow->SetCurrentTileContents(m_engine(gridPos.x, gridPos.y).GetTileContent());
 
 	return 0;
 }
@@ -708,17 +1310,8 @@ LRESULT MinefieldWindow::OnMouseLeave(WPARAM wParam, LPARAM lParam)
 	if (IsGameActive())
 	{
 		m_pGameWindow->SetSmileState(SmileState::SMILE);
-		MineTile* tile = &(*this)(m_lastGridPos.x, m_lastGridPos.y);
-
-		for (UINT tile : GetTileGrid(m_lastGridPos.x, m_lastGridPos.y, m_bChording ? 1 : 0))
-		{
-			if ((*this)(tile).GetTileState() == TileState::CLICKED)
-			{
-				(*this)(tile).SetTileState(TileState::HIDDEN);
-			}
-		}
-
-		m_scene.Render();
+		m_engine.ReleaseTiles(m_lastGridPos.x, m_lastGridPos.y, m_bChording ? 1 : 0);
+		m_scene.RequestRender();
 	}
 
 	m_bLRHeldAfterChord = FALSE;
@@ -728,6 +1321,147 @@ LRESULT MinefieldWindow::OnMouseLeave(WPARAM wParam, LPARAM lParam)
 	return 0;
 }
 
+/*
+*	The wheel zooms the view around the cursor, holding
+*	Shift scrolls the view instead. The horizontal wheel
+*	always scrolls sideways.
+*/
+LRESULT MinefieldWindow::OnMouseWheel(WPARAM wParam, LPARAM lParam, BOOL bHorizontal)
+{
+	const FLOAT notches{ static_cast<FLOAT>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA };
+
+	if (bHorizontal)
+	{
+		m_scene.PanBy(notches * m_scene.GetTileSize(), 0);
+	}
+	else if (GET_KEYSTATE_WPARAM(wParam) & MK_SHIFT)
+	{
+		m_scene.PanBy(0, -notches * m_scene.GetTileSize());
+	}
+	else
+	{
+		// Wheel messages carry the cursor position in screen coordinates.
+		POINT anchor{ GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+		ScreenToClient(m_hWnd, &anchor);
+		m_scene.ZoomAt(powf(constants::ZOOM_STEP, notches), static_cast<FLOAT>(anchor.x), static_cast<FLOAT>(anchor.y));
+	}
+
+	UpdateScrollBars();
+	m_scene.RequestRender();
+
+	return 0;
+}
+
+// Handles WM_HSCROLL and WM_VSCROLL for the scroll bar scrollBar.
+LRESULT MinefieldWindow::OnScroll(int scrollBar, WPARAM wParam)
+{
+	SCROLLINFO si{};
+	si.cbSize = sizeof(SCROLLINFO);
+	si.fMask = SIF_ALL;
+	GetScrollInfo(m_hWnd, scrollBar, &si);
+
+	const int line{ max(static_cast<int>(m_scene.GetTileSize()), 1) };
+	int pos{ si.nPos };
+
+	switch (LOWORD(wParam))
+	{
+	case SB_LINEUP:
+		pos -= line;
+		break;
+	case SB_LINEDOWN:
+		pos += line;
+		break;
+	case SB_PAGEUP:
+		pos -= static_cast<int>(si.nPage);
+		break;
+	case SB_PAGEDOWN:
+		pos += static_cast<int>(si.nPage);
+		break;
+	case SB_THUMBTRACK:
+		[[fallthrough]];
+	case SB_THUMBPOSITION:
+		pos = si.nTrackPos;
+		break;
+	case SB_TOP:
+		pos = si.nMin;
+		break;
+	case SB_BOTTOM:
+		pos = si.nMax;
+		break;
+	default:
+		return 0;
+	}
+
+	const D2D1_POINT_2F viewOffset{ m_scene.GetViewOffset() };
+
+	if (scrollBar == SB_HORZ)
+	{
+		m_scene.PanTo(static_cast<FLOAT>(pos), viewOffset.y);
+	}
+	else
+	{
+		m_scene.PanTo(viewOffset.x, static_cast<FLOAT>(pos));
+	}
+
+	UpdateScrollBars();
+	m_scene.RequestRender();
+
+	return 0;
+}
+
+// Dispatches the mouse and scroll bar messages to their handlers.
+LRESULT MinefieldWindow::HandleInput(UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	// While a replay is played back the clicks are its own, the view can still be zoomed and scrolled.
+	// The same holds while the first click waits for its no guessing board.
+	if ((IsReplaying() || m_bAwaitingBoard) && uMsg >= WM_MOUSEMOVE && uMsg <= WM_MBUTTONDBLCLK)
+	{
+		return 0;
+	}
+
+	switch (uMsg)
+	{
+	case WM_LBUTTONDOWN:
+		return OnLButtonDown(wParam, lParam);
+
+	case WM_LBUTTONUP:
+		return OnLButtonUp(wParam, lParam);
+
+	case WM_RBUTTONDOWN:
+		return OnRButtonDown(wParam, lParam);
+
+	case WM_RBUTTONUP:
+		return OnRButtonUp(wParam, lParam);
+
+	case WM_MBUTTONDOWN:
+		return OnMButtonDown(wParam, lParam);
+
+	case WM_MBUTTONUP:
+		return OnMButtonUp(wParam, lParam);
+
+	case WM_MOUSEMOVE:
+		return OnMouseMove(wParam, lParam);
+
+	case WM_MOUSELEAVE:
+		return OnMouseLeave(wParam, lParam);
+
+	case WM_MOUSEWHEEL:
+		return OnMouseWheel(wParam, lParam, FALSE);
+
+	case WM_MOUSEHWHEEL:
+		return OnMouseWheel(wParam, lParam, TRUE);
+
+	case WM_HSCROLL:
+		return OnScroll(SB_HORZ, wParam);
+
+	case WM_VSCROLL:
+		return OnScroll(SB_VERT, wParam);
+
+	default:
+		return DefWindowProc(m_hWnd, uMsg, wParam, lParam);
+	}
+}
+
 /*
 *	============================
 *	===== Window Procedure =====
@@ -736,6 +1470,20 @@ LRESULT MinefieldWindow::OnMouseLeave(WPARAM wParam, LPARAM lParam)
 
 LRESULT MinefieldWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
+	// Input handlers are timed for the Input event, see Tracing.h.
+	if ((uMsg >= WM_MOUSEFIRST && uMsg <= WM_MOUSELAST) || uMsg == WM_MOUSELEAVE || uMsg == WM_HSCROLL || uMsg == WM_VSCROLL)
+	{
+		const Tracing::Stopwatch stopwatch{};
+		const LRESULT result{ HandleInput(uMsg, wParam, lParam) };
+
+		TraceLoggingWrite(g_hMinesweeperTraceProvider, "Input",
+			TraceLoggingHexUInt32(uMsg, "Message"),
+			TraceLoggingInt64(stopwatch.GetElapsed(), "Microseconds"),
+			TraceLoggingUInt32(GetMessageTime(), "MessageTime"));
+
+		return result;
+	}
+
 	switch (uMsg)
 	{
 	case WM_CREATE:
@@ -750,6 +1498,10 @@ LRESULT MinefieldWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 			return -1;
 		}
 
+		m_scene.SetBaseTileSize(static_cast<FLOAT>(m_pGameWindow->GetTileSize()));
+		ResetSolver();
+		UpdateScrollBars();
+
 		return 0;
 
 	case WM_DESTROY:
@@ -763,6 +1515,7 @@ LRESULT MinefieldWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	{
 		PAINTSTRUCT ps;
 		BeginPaint(m_hWnd, &ps);
+		m_scene.InvalidateAll();
 		m_scene.Render();
 		EndPaint(m_hWnd, &ps);
 	}
@@ -773,6 +1526,8 @@ LRESULT MinefieldWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 		int x = (int)(short)LOWORD(lParam);
 		int y = (int)(short)HIWORD(lParam);
 		m_scene.Resize(x, y);
+		m_scene.SetBaseTileSize(static_cast<FLOAT>(m_pGameWindow->GetTileSize()));
+		UpdateScrollBars();
 		InvalidateRect(m_hWnd, nullptr, FALSE);
 	}
 	return 0;
@@ -780,29 +1535,20 @@ LRESULT MinefieldWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	case WM_ERASEBKGND:
 		return 1;
 
-	case WM_LBUTTONDOWN:
-		return OnLButtonDown(wParam, lParam);
-
-	case WM_LBUTTONUP:
-		return OnLButtonUp(wParam, lParam);
-
-	case WM_RBUTTONDOWN:
-		return OnRButtonDown(wParam, lParam);
-
-	case WM_RBUTTONUP:
-		return OnRButtonUp(wParam, lParam);
-
-	case WM_MBUTTONDOWN:
-		return OnMButtonDown(wParam, lParam);
-
-	case WM_MBUTTONUP:
-		return OnMButtonUp(wParam, lParam);
+	case WM_CAPTURECHANGED:
+		m_bPanning = FALSE;
+		return 0;
 
-	case WM_MOUSEMOVE:
-		return OnMouseMove(wParam, lParam);
+	case WM_TIMER:
+		if (wParam == constants::REPLAY_TIMER_ID && IsReplaying())
+		{
+			PlayNextReplayEvents();
+		}
+		return 0;
 
-	case WM_MOUSELEAVE:
-		return OnMouseLeave(wParam, lParam);
+	case WM_NO_GUESS_BOARD:
+		OnNoGuessBoard(wParam, lParam);
+		return 0;
 
 	default:
 		return DefWindowProc(m_hWnd, uMsg, wParam, lParam);
@@ -3,13 +3,17 @@
 #include "MinefieldScene.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <windef.h>
 
+#include "MinefieldEngine.h"
+#include "MineSolver.h"
 #include "MineTile.h"
-#include "RNG.h"
+#include "Replay.h"
+#include "SpectatorServer.h"
 
 class GameWindow;
 
@@ -27,40 +31,101 @@ public:
 	BOOL IsGameActive() const;								// Returns if game is active or not.
 	BOOL Resize(UINT width, UINT height, UINT cMines);		// Resizes the Minefield to width x height with cMines mines.
 
-	MineTile& operator()(UINT index);						// Get tile from tile array at a given index.
-	MineTile& operator()(UINT x, UINT y);					// Get tile from tile matrix at given position (x, y)
+	MineTile operator()(UINT index);						// Get view of tile at a given index.
+	MineTile operator()(UINT x, UINT y);					// Get view of tile at given position (x, y)
+	MinefieldEngine& GetEngine();							// Returns the engine holding the game state.
 
 	void ToggleQuestionMarkUsage();							// Toggles whether question marks are enabled or disabled.
+	void SetNoGuessing(BOOL bNoGuessing);					// Sets if new games can be solved without guessing.
 	void ResetGame();										// Resets the game.
+	void ShowHint();										// Outlines the hidden tile least likely to be a mine.
+	BOOL ToggleMineProbabilities();							// Toggles the mine probability overlay, returns if it is shown.
+	BOOL ToggleFrameTimes();								// Toggles the frame time overlay, returns if it is shown.
+	BOOL TogglePreciseMouse();								// Toggles following every mouse sample, returns if it is on.
+	const Replay& GetReplay() const;						// Returns the recording of the current game.
+	void PlayReplay(const Replay& replay);					// Plays replay back at its recorded speed.
+	BOOL SaveGame(LPCWSTR szPath, LONGLONG elapsedMilliseconds);	// Saves the game to szPath, see GameSave.h.
+	BOOL LoadGame(LPCWSTR szPath, LONGLONG& elapsedMilliseconds);	// Continues the game saved in szPath.
+	BOOL Undo();											// Takes back the last move, returns if there was one.
+	BOOL Redo();											// Makes the last move taken back again.
+	BOOL HostSpectators(BOOL bHost);						// Starts or stops streaming the game, returns FALSE if it can't start.
+	BOOL IsHostingSpectators() const;
 
 private:
+	static constexpr UINT WM_NO_GUESS_BOARD{ WM_APP };		// Brings a board searched in the background, see RequestNoGuessBoard.
+
+	// The result of a search for a no guessing board, posted with WM_NO_GUESS_BOARD.
+	struct NoGuessBoard
+	{
+		UINT request{ 0 };
+		bool bFound{ false };
+		std::vector<std::uint32_t> aMineTiles{};
+	};
+
 	std::unique_ptr<WCHAR[]> m_lpszClassName{ nullptr };	// Pointer to string holding window class name.
 	GameWindow* m_pGameWindow{ nullptr };					// Pointer to owning Minesweeper game window.
-	UINT m_width{ 0 };										// Width of Minefield.
-	UINT m_height{ 0 };										// Height of Minefield.
-	UINT m_cTiles{ 0 };										// Count of tiles in Minefield.
-	UINT m_cMines{ 0 };										// Count of mines to generate.
-	UINT m_cRevealedTiles{ 0 };								// Tracks number of tiles set to revealed.
-	UINT m_cFlaggedTiles{ 0 };								// Tracks number of tiles marked with flags.
+	MinefieldEngine m_engine;								// Headless engine holding the game state and rules.
 	POINT m_lastGridPos{};									// Tracks the previous position of the mouse on tile grid.
 	BOOL m_bMouseTracking{ FALSE };							// Tracks if mouse is being tracked.
 	BOOL m_bChording{ FALSE };								// Tracks if player is currently chording.
 	BOOL m_bLRHeldAfterChord{ FALSE };						// Tracks if player is still holding L or R mouse button after chord
-	BOOL m_bGameLost{ FALSE };								// Tracks if game is lost, i.e. a mine was revealed.
-	BOOL m_bQuestionMarksEnabled{ FALSE };					// Tracks if we can mark with question marks.
-	RNG m_rng{};											// The RNG used for generating mine positions.
+	BOOL m_bPanning{ FALSE };								// Tracks if the view is being dragged with Ctrl + left mouse button.
+	BOOL m_bNoGuessing{ FALSE };							// Tracks if new games are generated to need no guessing.
+	BOOL m_bNoGuessBoard{ FALSE };							// Tracks if the mines of the game were verified to need no guessing.
+	BOOL m_bAwaitingBoard{ FALSE };							// Tracks if the first click waits for a board searched in the background.
+	POINT m_awaitedClick{};									// The first click revealed once the board arrives.
+	UINT m_boardRequest{ 0 };								// Counts the searches, a board of an older one is dropped.
+	DWORD m_boardRequestTime{ 0 };							// Message time of the first click that started the search.
+	POINTS m_lastPanPos{};									// Mouse position of the last drag update while panning.
+	BOOL m_bPreciseMouse{ FALSE };							// Tracks if pressed tiles follow every mouse sample between moves.
+	MOUSEMOVEPOINT m_lastMovePoint{};						// The last mouse sample followed, as GetMouseMovePointsEx returns it.
+	std::vector<POINT> m_aMovePoints{};						// Samples of the current mouse move, kept to reuse its storage.
 	MinefieldScene m_scene{};								// Object responsible for rendering graphics.
-	std::vector<MineTile> m_aMineTiles{};					// Vector holding tiles in the grid.
+	MineSolver m_solver{};									// Follows what the player knows, for hints and the overlay.
+	BOOL m_bShowProbabilities{ FALSE };						// Tracks if the mine probability overlay is shown.
+	std::vector<FLOAT> m_aMineProbabilities{};				// Chance of each tile being a mine, shown by the overlay.
+	BOOL m_bShowFrameTimes{ FALSE };						// Tracks if the frame time overlay is shown.
+	Replay m_replay{};										// Recording of the current game, or the replay played back.
+	std::optional<ReplayReader> m_replayReader{};			// Reads the events of m_replay while it is played back.
+	Replay::Event m_nextReplayEvent{};						// The event played back when the replay timer fires.
+	BOOL m_bQuestionMarksBeforeReplay{ FALSE };				// Question mark usage restored when playback stops.
+	SpectatorServer m_spectators{};							// Streams the game to spectators while it is hosted.
+	UINT m_cEffectiveClicks{ 0 };							// Clicks of the current game that changed the board.
+	UINT m_cWastedClicks{ 0 };								// Clicks of the current game that changed nothing.
+	BOOL m_bRecordingStats{ FALSE };						// Tracks if the current game is added to the statistics when it ends.
 
-	UINT GetNumberAdjacentMines(UINT x, UINT y);
-	std::vector<UINT> GetTileGrid(UINT x, UINT y, INT radius);
 	POINT MouseToTilePos(LPARAM lParam);
-	void GenerateMines(UINT x, UINT y);
-	void GenerateNumbers();
-	void SetTileRevealed(UINT x, UINT y);
+	void CollectMovePoints(LPARAM lParam);
+	void MoveAlongMouse(LPARAM lParam, UINT tileUpdateRadius);
 	void BeginChord(UINT x, UINT y);
 	void EndChord(UINT x, UINT y);
+	BOOL GenerateMines(UINT x, UINT y);
+	BOOL PlaceNoGuessMines(UINT x, UINT y);
+	BOOL RequestNoGuessBoard(UINT x, UINT y);
+	void OnNoGuessBoard(WPARAM wParam, LPARAM lParam);
+	void TraceGenerateMines(LONGLONG microseconds) const;
+	void RevealClickedTile(UINT x, UINT y);
+	void RevealTile(UINT x, UINT y);
+	void CycleTileMark(UINT x, UINT y);
+	void RecordAction(Replay::Action action, UINT x, UINT y);
+	void CountClick(BOOL bEffective);
+	void RecordStats();
+	BOOL IsReplaying() const;
+	void PlayReplayEvent(const Replay::Event& event);
+	void PlayNextReplayEvents();
+	void StopReplay();
 	void MovePos(POINT oldPos, POINT newPos, UINT tileUpdateRadius, BOOL forceUpdate);
+	void UpdateGameOutcome();
+	BOOL IsSolverEnabled() const;
+	void ResetSolver();
+	void RebuildSolver();
+	void ShowRestoredGame();
+	void UpdateSolver();
+	void UpdateScrollBars();
+	SpectatorServer::Update GetSpectatorStatus() const;
+	void PublishBoard(BOOL bReset);
+	void PublishMove(std::size_t firstSpan);
+	void PublishMark(UINT x, UINT y);
 
 	// Functions that handle different user inputs.
 	LRESULT OnLButtonDown(WPARAM wParam, LPARAM lParam);
@@ -71,6 +136,9 @@ private:
 	LRESULT OnMButtonUp(WPARAM wParam, LPARAM lParam);
 	LRESULT OnMouseMove(WPARAM wParam, LPARAM lParam);
 	LRESULT OnMouseLeave(WPARAM wParam, LPARAM lParam);
+	LRESULT OnMouseWheel(WPARAM wParam, LPARAM lParam, BOOL bHorizontal);
+	LRESULT OnScroll(int scrollBar, WPARAM wParam);
+	LRESULT HandleInput(UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 public:
 	// Returns Window class name to satisfy BaseWindow
@@ -1,13 +1,47 @@
 #include <Windows.h>
+#include <shellapi.h>
 
 #include "constants.h"
+#include "FrameScheduler.h"
 #include "GameWindow.h"
+#include "GraphicsDevice.h"
 #include "resource.h"
+#include "Tracing.h"
+
+/*
+*	Picks the render backend. Starting with /flipmodel uses
+*	flip model swap chains instead of window render targets,
+*	/tileshader also draws the minefield with a pixel shader.
+*/
+static void SelectRenderBackend(PCWSTR pCmdLine)
+{
+	int cArgs{ 0 };
+	LPWSTR* ppArgs{ (pCmdLine && *pCmdLine) ? CommandLineToArgvW(pCmdLine, &cArgs) : nullptr };
+
+	for (int i{ 0 }; i < cArgs; ++i)
+	{
+		if (_wcsicmp(ppArgs[i], constants::SWITCH_FLIP_MODEL.data()) == 0)
+		{
+			GraphicsDevice::Instance().SetBackend(RenderBackend::FLIP_SWAP_CHAIN);
+		}
+		else if (_wcsicmp(ppArgs[i], constants::SWITCH_TILE_SHADER.data()) == 0)
+		{
+			GraphicsDevice::Instance().SetBackend(RenderBackend::FLIP_SWAP_CHAIN);
+			GraphicsDevice::Instance().SetTileShaderEnabled(TRUE);
+		}
+	}
+
+	LocalFree(ppArgs);
+}
 
 int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ PWSTR pCmdLine, _In_ int nCmdShow)
 {
+	Tracing::Register();
+
 	if (SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE)))
 	{
+		SelectRenderBackend(pCmdLine);
+
 		WCHAR gameName[constants::MAX_LOADSTRING];
 		LoadString(hInstance, IDS_GAME_NAME, gameName, sizeof(gameName) / sizeof(WCHAR));
 		HMENU gameMenu{ LoadMenu(hInstance, MAKEINTRESOURCE(IDR_GAMEMENU)) };
@@ -20,19 +54,47 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ PWSTR pCm
 			return 0;
 		}
 
+		Tracing::MarkStartupPhase("WindowCreated");
 		ShowWindow(gameWindow.Window(), nCmdShow);
 
+		/*
+		*	Drain every queued message before presenting, so that
+		*	a burst of input produces a single frame. While nothing
+		*	needs to be drawn the loop sleeps until a message or
+		*	the next frame of the FrameScheduler is due.
+		*/
+		FrameScheduler& scheduler{ FrameScheduler::Instance() };
+		HANDLE hFrameTimer{ scheduler.GetWaitHandle() };
 		MSG msg{};
-		while (GetMessage(&msg, nullptr, 0, 0))
+		BOOL bRunning{ TRUE };
+
+		while (bRunning)
 		{
-			if (!TranslateAccelerator(gameWindow.Window(), hAccel, &msg))
+			while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+			{
+				if (msg.message == WM_QUIT)
+				{
+					bRunning = FALSE;
+					break;
+				}
+
+				if (!TranslateAccelerator(gameWindow.Window(), hAccel, &msg))
+				{
+					TranslateMessage(&msg);
+					DispatchMessage(&msg);
+				}
+			}
+
+			if (bRunning)
 			{
-				TranslateMessage(&msg);
-				DispatchMessage(&msg);
+				scheduler.PresentIfDue();
+				MsgWaitForMultipleObjectsEx(hFrameTimer ? 1 : 0, &hFrameTimer, (hFrameTimer || !scheduler.HasPendingFrames()) ? INFINITE : 1,
+					QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 			}
 		}
 	}
 
 	CoUninitialize();
+	Tracing::Unregister();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,460 @@
+#include "NoGuessBoardPool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "PresetBoard.h"
+#include "TileNeighborhood.h"
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+NoGuessBoardPool& NoGuessBoardPool::Instance()
+{
+	// The thread pool is created first so that it is destroyed last, once no more tasks of ours can run.
+	ThreadPool::Shared();
+
+	static NoGuessBoardPool pool{};
+	return pool;
+}
+
+// Stops the tasks after their current candidate and waits for them.
+NoGuessBoardPool::~NoGuessBoardPool()
+{
+	m_bStopping = true;
+	ThreadPool::Shared().Wait(m_tasks);
+}
+
+void NoGuessBoardPool::Prefetch(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	if (!IsVerifiable(width, height, cMines))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_lock };
+	Pool* pPool{ FindPool(width, height, cMines) };
+	StartTasks(pPool ? pPool : AddPool(width, height, cMines));
+}
+
+/*
+*	Takes a ready board whose first click can be (x,y). A
+*	size that has no pool yet, e.g. a custom one, gets one
+*	here, so its next games find boards ready.
+*/
+bool NoGuessBoardPool::TakeBoard(std::uint32_t width, std::uint32_t height, std::uint32_t cMines, std::uint32_t x,
+	std::uint32_t y, std::vector<std::uint32_t>& aMineTiles)
+{
+	if (!IsVerifiable(width, height, cMines))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_lock };
+	Pool* pPool{ FindPool(width, height, cMines) };
+
+	if (!pPool)
+	{
+		StartTasks(AddPool(width, height, cMines));
+		return false;
+	}
+
+	const std::uint32_t start{ x + y * width };
+	const std::uint32_t cSymmetries{ width == height ? 8u : 4u };
+
+	for (auto board{ pPool->aBoards.begin() }; board != pPool->aBoards.end(); ++board)
+	{
+		for (std::uint32_t symmetry{ 0 }; symmetry < cSymmetries; ++symmetry)
+		{
+			const std::uint32_t boardStart{ Transform(start, symmetry, width, height, true) };
+
+			if ((board->aSafeStarts[boardStart >> 6] >> (boardStart & 63)) & 1)
+			{
+				aMineTiles.clear();
+
+				for (const std::uint32_t tile : board->aMineTiles)
+				{
+					aMineTiles.push_back(Transform(tile, symmetry, width, height, false));
+				}
+
+				pPool->aBoards.erase(board);
+				StartTasks(pPool);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/*
+*	Searches a board solvable from (x,y) on the thread pool,
+*	trying up to cAttempts candidates and giving up early
+*	when the pool is destroyed. onDone is called on the
+*	thread that searched.
+*/
+bool NoGuessBoardPool::GenerateBoardAsync(std::uint32_t width, std::uint32_t height, std::uint32_t cMines, std::uint32_t x,
+	std::uint32_t y, std::uint64_t seed, std::uint32_t cAttempts, BoardCallback onDone)
+{
+	if (!IsVerifiable(width, height, cMines))
+	{
+		return false;
+	}
+
+	ThreadPool::Shared().Submit(m_tasks, [this, width, height, cMines, x, y, seed, cAttempts, onDone{ std::move(onDone) }]()
+	{
+		static thread_local Candidate candidate{};
+
+		candidate.width = width;
+		candidate.height = height;
+		candidate.cMines = cMines;
+		RNG rng{ seed };
+		bool bFound{ false };
+
+		for (std::uint32_t attempt{ 0 }; attempt < cAttempts && !bFound && !m_bStopping; ++attempt)
+		{
+			bFound = TryCandidate(candidate, x + y * width, rng);
+		}
+
+		onDone(bFound, bFound ? std::vector<std::uint32_t>{ candidate.aMineTiles } : std::vector<std::uint32_t>{});
+	});
+
+	return true;
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+NoGuessBoardPool::Pool* NoGuessBoardPool::FindPool(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	for (const std::unique_ptr<Pool>& pPool : m_apPools)
+	{
+		if (pPool->width == width && pPool->height == height && pPool->cMines == cMines)
+		{
+			return pPool.get();
+		}
+	}
+
+	return nullptr;
+}
+
+// Adds an empty pool for boards of the given size. Called with m_lock held.
+NoGuessBoardPool::Pool* NoGuessBoardPool::AddPool(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	m_apPools.push_back(std::make_unique<Pool>());
+	Pool* pPool{ m_apPools.back().get() };
+	pPool->width = width;
+	pPool->height = height;
+	pPool->cMines = cMines;
+
+	return pPool;
+}
+
+// Returns if boards of the given size are small enough to verify and leave room for a first click.
+bool NoGuessBoardPool::IsVerifiable(std::uint32_t width, std::uint32_t height, std::uint32_t cMines)
+{
+	return width * height <= MAX_TILES && cMines < width * height;
+}
+
+/*
+*	Starts tasks for pools that are not full, leaving one
+*	core to the game. pFirst gets tasks before the others,
+*	which go to the pool with the fewest boards to be.
+*	Called with m_lock held.
+*/
+void NoGuessBoardPool::StartTasks(Pool* pFirst)
+{
+	const std::uint32_t cMaxTasks{ std::max(ThreadPool::Shared().GetThreadCount(), 2u) - 1 };
+
+	while (m_cTasks < cMaxTasks && !m_bStopping)
+	{
+		Pool* pPool{ nullptr };
+		std::size_t cUpcoming{ POOL_SIZE };
+
+		if (pFirst && pFirst->aBoards.size() + pFirst->cTasks < POOL_SIZE)
+		{
+			pPool = pFirst;
+		}
+		else
+		{
+			for (const std::unique_ptr<Pool>& pCandidatePool : m_apPools)
+			{
+				if (pCandidatePool->aBoards.size() + pCandidatePool->cTasks < cUpcoming)
+				{
+					pPool = pCandidatePool.get();
+					cUpcoming = pPool->aBoards.size() + pPool->cTasks;
+				}
+			}
+		}
+
+		if (!pPool)
+		{
+			return;
+		}
+
+		++pPool->cTasks;
+		++m_cTasks;
+
+		const std::uint64_t seed{ m_rng.Next() };
+		ThreadPool::Shared().Submit(m_tasks, [this, pPool, seed]() { RunTask(pPool, seed); });
+	}
+}
+
+/*
+*	Tries up to ATTEMPTS_PER_TASK candidates for pPool. A
+*	board that is found is verified from a few more of its
+*	openings, so more first clicks can be served with it.
+*/
+void NoGuessBoardPool::RunTask(Pool* pPool, std::uint64_t seed)
+{
+	static thread_local Candidate candidate{};
+
+	candidate.width = pPool->width;
+	candidate.height = pPool->height;
+	candidate.cMines = pPool->cMines;
+
+	const std::uint32_t cTiles{ candidate.width * candidate.height };
+	RNG rng{ seed };
+	Board board{};
+	bool bFound{ false };
+
+	for (std::uint32_t attempt{ 0 }; attempt < ATTEMPTS_PER_TASK && !bFound && !m_bStopping; ++attempt)
+	{
+		const std::uint32_t start{ rng.GetInt<std::uint32_t>(0, cTiles - 1) };
+
+		if (TryCandidate(candidate, start, rng))
+		{
+			bFound = true;
+			board.aMineTiles = candidate.aMineTiles;
+			board.aSafeStarts.assign((cTiles + 63) / 64, 0);
+			candidate.aOpenings.assign(cTiles, 0);
+			AddOpening(candidate, start, &board.aSafeStarts);
+
+			std::uint32_t cOpenings{ 1 };
+
+			for (std::uint32_t tile{ 0 }; tile < cTiles && cOpenings < MAX_OPENINGS; ++tile)
+			{
+				if (candidate.aCounts[tile] == 0 && !candidate.aOpenings[tile])
+				{
+					AddOpening(candidate, tile, IsSolvableFrom(candidate, tile) ? &board.aSafeStarts : nullptr);
+					++cOpenings;
+				}
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock{ m_lock };
+	--pPool->cTasks;
+	--m_cTasks;
+
+	if (bFound && pPool->aBoards.size() < POOL_SIZE)
+	{
+		pPool->aBoards.push_back(std::move(board));
+	}
+
+	StartTasks(nullptr);
+}
+
+/*
+*	Places the candidate's mines at random, keeping the tiles
+*	around start free like a normal first click does, and
+*	returns if the board can be solved from start. Mines are
+*	drawn with Floyd's algorithm like MinefieldEngine does.
+*/
+bool NoGuessBoardPool::TryCandidate(Candidate& candidate, std::uint32_t start, RNG& rng)
+{
+	const std::uint32_t width{ candidate.width };
+	const std::uint32_t height{ candidate.height };
+	const std::uint32_t cTiles{ width * height };
+	const std::uint32_t radius{ cTiles - candidate.cMines < 9 ? 0u : 1u };
+	const TileNeighborhood excludedTiles{ start % width, start / width, radius, width, height };
+	const std::uint32_t cCandidates{ cTiles - excludedTiles.size() };
+	const std::uint32_t cMinesToPlace{ std::min(candidate.cMines, cCandidates) };
+	const TileNeighbors* pNeighbors{ GetPresetNeighbors(width, height) };
+
+	auto getCandidateTile = [&](std::uint32_t candidateTile)
+	{
+		std::uint32_t tile{ candidateTile };
+
+		for (const std::uint32_t excludedTile : excludedTiles)
+		{
+			if (excludedTile <= tile)
+			{
+				++tile;
+			}
+		}
+
+		return tile;
+	};
+
+	candidate.aCounts.assign(cTiles, 0);
+	candidate.aMineTiles.clear();
+
+	for (std::uint32_t candidateTile{ cCandidates - cMinesToPlace }; candidateTile < cCandidates; ++candidateTile)
+	{
+		std::uint32_t tile{ getCandidateTile(rng.GetInt<std::uint32_t>(0, candidateTile)) };
+
+		if (candidate.aCounts[tile] == MINE)
+		{
+			tile = getCandidateTile(candidateTile);
+		}
+
+		candidate.aCounts[tile] = MINE;
+		candidate.aMineTiles.push_back(tile);
+	}
+
+	for (const std::uint32_t mine : candidate.aMineTiles)
+	{
+		ForEachNeighbor(pNeighbors, mine, width, height, [&candidate](std::uint32_t tile)
+		{
+			if (candidate.aCounts[tile] != MINE)
+			{
+				++candidate.aCounts[tile];
+			}
+		});
+	}
+
+	return IsSolvableFrom(candidate, start);
+}
+
+/*
+*	Plays the candidate from start the way a player who never
+*	guesses would: reveal every tile the solver proves safe,
+*	flag every tile it proves to be a mine, until the board
+*	is cleared or nothing more can be deduced.
+*/
+bool NoGuessBoardPool::IsSolvableFrom(Candidate& candidate, std::uint32_t start)
+{
+	const std::uint32_t width{ candidate.width };
+	const std::uint32_t height{ candidate.height };
+	const std::uint32_t cMines{ static_cast<std::uint32_t>(candidate.aMineTiles.size()) };
+	std::uint32_t cSafeLeft{ width * height - cMines };
+	MineSolver& solver{ candidate.solver };
+	const TileNeighbors* pNeighbors{ GetPresetNeighbors(width, height) };
+
+	// Reveals a tile and, if it is empty, its neighbors the way the engine's flood fill does.
+	auto reveal = [&](std::uint32_t tile)
+	{
+		candidate.aStack.clear();
+		candidate.aStack.push_back(tile);
+
+		while (!candidate.aStack.empty())
+		{
+			const std::uint32_t current{ candidate.aStack.back() };
+			candidate.aStack.pop_back();
+
+			if (solver.IsUnknown(current))
+			{
+				solver.SetRevealed(current, candidate.aCounts[current]);
+				--cSafeLeft;
+
+				if (candidate.aCounts[current] == 0)
+				{
+					ForEachNeighbor(pNeighbors, current, width, height, [&candidate](std::uint32_t neighbor)
+					{
+						candidate.aStack.push_back(neighbor);
+					});
+				}
+			}
+		}
+	};
+
+	solver.Reset(width, height, cMines);
+	reveal(start);
+
+	while (cSafeLeft > 0)
+	{
+		candidate.aSafeTiles.clear();
+		candidate.aMines.clear();
+
+		if (!solver.Deduce(candidate.aSafeTiles, candidate.aMines))
+		{
+			return false;
+		}
+
+		for (const std::uint32_t mine : candidate.aMines)
+		{
+			solver.SetMine(mine);
+		}
+
+		for (const std::uint32_t tile : candidate.aSafeTiles)
+		{
+			reveal(tile);
+		}
+	}
+
+	return true;
+}
+
+/*
+*	Marks the empty tiles of the opening containing start as
+*	tried and, if pSafeStarts is given, as first clicks the
+*	board can be solved from. A start that isn't empty is an
+*	opening of its own.
+*/
+void NoGuessBoardPool::AddOpening(Candidate& candidate, std::uint32_t start, std::vector<std::uint64_t>* pSafeStarts)
+{
+	candidate.aStack.clear();
+	candidate.aStack.push_back(start);
+	candidate.aOpenings[start] = 1;
+
+	while (!candidate.aStack.empty())
+	{
+		const std::uint32_t tile{ candidate.aStack.back() };
+		candidate.aStack.pop_back();
+
+		if (pSafeStarts)
+		{
+			(*pSafeStarts)[tile >> 6] |= std::uint64_t{ 1 } << (tile & 63);
+		}
+
+		if (candidate.aCounts[tile] != 0)
+		{
+			continue;
+		}
+
+		for (const std::uint32_t neighbor : TileNeighborhood(tile % candidate.width, tile / candidate.width, 1,
+			candidate.width, candidate.height))
+		{
+			if (candidate.aCounts[neighbor] == 0 && !candidate.aOpenings[neighbor])
+			{
+				candidate.aOpenings[neighbor] = 1;
+				candidate.aStack.push_back(neighbor);
+			}
+		}
+	}
+}
+
+/*
+*	Maps a tile through one of the symmetries of the board:
+*	bit 0 mirrors it horizontally, bit 1 vertically and bit
+*	2 swaps its coordinates, which only square boards allow.
+*	bInverse maps it back.
+*/
+std::uint32_t NoGuessBoardPool::Transform(std::uint32_t tile, std::uint32_t symmetry, std::uint32_t width,
+	std::uint32_t height, bool bInverse)
+{
+	std::uint32_t x{ tile % width };
+	std::uint32_t y{ tile / width };
+
+	if (bInverse && (symmetry & 4))
+	{
+		std::swap(x, y);
+	}
+
+	x = (symmetry & 1) ? width - 1 - x : x;
+	y = (symmetry & 2) ? height - 1 - y : y;
+
+	if (!bInverse && (symmetry & 4))
+	{
+		std::swap(x, y);
+	}
+
+	return x + y * width;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MineSolver.h"
+#include "RNG.h"
+#include "ThreadPool.h"
+
+/*
+*	Generates boards that can be solved by logic alone from
+*	the first click, for the "no guessing" mode. Candidates
+*	are random boards with an opening around a random tile,
+*	kept if the MineSolver can solve them from there. Most
+*	candidates fail on dense boards, so they are generated
+*	on the shared thread pool ahead of time and a few
+*	finished boards are kept per board size.
+*
+*	Each board remembers every tile a first click can be
+*	made on: the empty tiles of each opening it was verified
+*	from. TakeBoard also tries the board mirrored along its
+*	axes (and transposed if it is square), so a board that
+*	fits the player's first click is usually ready. When none
+*	does, GenerateBoardAsync searches one for that click on
+*	the thread pool, so the caller never waits for it.
+*/
+class NoGuessBoardPool
+{
+public:
+	// Boards larger than this are too slow to verify and are generated normally.
+	static constexpr std::uint32_t MAX_TILES{ 100 * 100 };
+
+	static NoGuessBoardPool& Instance();
+	~NoGuessBoardPool();
+
+	// Starts generating boards of the given size in the background, this size is served first.
+	void Prefetch(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+
+	// Called on a thread of the pool with the mines of the board found, bFound is false if there was none.
+	using BoardCallback = std::function<void(bool bFound, std::vector<std::uint32_t>&& aMineTiles)>;
+
+	// Takes a ready board whose first click can be (x,y), returns false if there is none.
+	bool TakeBoard(std::uint32_t width, std::uint32_t height, std::uint32_t cMines, std::uint32_t x, std::uint32_t y,
+		std::vector<std::uint32_t>& aMineTiles);
+
+	// Generates a board solvable from (x,y) in the background, returns false if boards of this size aren't verified.
+	bool GenerateBoardAsync(std::uint32_t width, std::uint32_t height, std::uint32_t cMines, std::uint32_t x,
+		std::uint32_t y, std::uint64_t seed, std::uint32_t cAttempts, BoardCallback onDone);
+
+private:
+	static constexpr std::size_t POOL_SIZE{ 8 };					// Boards kept ready per board size.
+	static constexpr std::uint32_t ATTEMPTS_PER_TASK{ 64 };			// Candidates tried by one task before it yields.
+	static constexpr std::uint32_t MAX_OPENINGS{ 4 };				// Openings of a board verified as first clicks.
+
+	struct Board
+	{
+		std::vector<std::uint32_t> aMineTiles{};
+		std::vector<std::uint64_t> aSafeStarts{};					// 1 bit per tile, set if it can be the first click.
+	};
+
+	struct Pool
+	{
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+		std::uint32_t cMines{ 0 };
+		std::uint32_t cTasks{ 0 };									// Tasks generating boards for this pool.
+		std::vector<Board> aBoards{};
+	};
+
+	// Storage of the candidates of one thread, reused between attempts.
+	struct Candidate
+	{
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+		std::uint32_t cMines{ 0 };
+		std::vector<std::uint8_t> aCounts{};						// Adjacent mines of every tile, MINE for mines.
+		std::vector<std::uint32_t> aMineTiles{};
+		std::vector<std::uint8_t> aOpenings{};						// Set for empty tiles of openings already tried.
+		std::vector<std::uint32_t> aStack{};
+		std::vector<std::uint32_t> aSafeTiles{};
+		std::vector<std::uint32_t> aMines{};
+		MineSolver solver{};
+	};
+
+	static constexpr std::uint8_t MINE{ 0xFF };
+
+	NoGuessBoardPool() {}
+	NoGuessBoardPool(const NoGuessBoardPool&) = delete;
+	NoGuessBoardPool& operator=(const NoGuessBoardPool&) = delete;
+
+	Pool*	FindPool(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+	Pool*	AddPool(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+	static bool	IsVerifiable(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+	void	StartTasks(Pool* pFirst);
+	void	RunTask(Pool* pPool, std::uint64_t seed);
+
+	static bool	TryCandidate(Candidate& candidate, std::uint32_t start, RNG& rng);
+	static bool	IsSolvableFrom(Candidate& candidate, std::uint32_t start);
+	static void	AddOpening(Candidate& candidate, std::uint32_t start, std::vector<std::uint64_t>* pSafeStarts);
+	static std::uint32_t Transform(std::uint32_t tile, std::uint32_t symmetry, std::uint32_t width, std::uint32_t height,
+		bool bInverse);
+
+	std::mutex m_lock{};
+	std::vector<std::unique_ptr<Pool>> m_apPools{};					// Guarded by m_lock, a pool is never removed.
+	RNG m_rng{};													// Seeds the tasks, guarded by m_lock.
+	std::uint32_t m_cTasks{ 0 };									// Tasks running, guarded by m_lock.
+	std::atomic<bool> m_bStopping{ false };
+	ThreadPool::TaskGroup m_tasks{};
+};
\ No newline at end of file
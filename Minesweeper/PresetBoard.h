@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "TileNeighborhood.h"
+
+// The neighbors of one tile, sorted like the tiles of a TileNeighborhood but without the tile itself.
+struct TileNeighbors
+{
+	std::uint16_t aTiles[8]{};
+	std::uint8_t cTiles{ 0 };
+};
+
+/*
+*	The geometry of a W x H board, known at compile time: the
+*	neighbors of every tile are one constexpr table, so
+*	walking them is a short loop over a fixed number of
+*	entries instead of dividing by the width and clipping
+*	to the edges on every step, like a TileNeighborhood has
+*	to. The Beginner, Intermediate and Expert presets, on
+*	which the bot and the no guessing generator spend nearly
+*	all their time, get one board each; GetPresetNeighbors
+*	picks the table at runtime and other sizes fall back to
+*	a TileNeighborhood.
+*/
+template <std::uint32_t W, std::uint32_t H>
+class PresetBoard
+{
+public:
+	static constexpr std::uint32_t WIDTH{ W };
+	static constexpr std::uint32_t HEIGHT{ H };
+	static constexpr std::uint32_t TILES{ W * H };
+
+	static_assert(W > 0 && H > 0 && TILES <= UINT16_MAX + 1, "The tiles of a preset board must fit into 16 bits.");
+
+	static constexpr std::array<TileNeighbors, TILES> NEIGHBORS{ []
+	{
+		std::array<TileNeighbors, TILES> aNeighbors{};
+
+		for (std::uint32_t tile{ 0 }; tile < TILES; ++tile)
+		{
+			const std::uint32_t x{ tile % W };
+			const std::uint32_t y{ tile / W };
+			TileNeighbors& neighbors{ aNeighbors[tile] };
+
+			for (std::uint32_t ny{ y > 0 ? y - 1 : 0 }; ny <= y + 1 && ny < H; ++ny)
+			{
+				for (std::uint32_t nx{ x > 0 ? x - 1 : 0 }; nx <= x + 1 && nx < W; ++nx)
+				{
+					if (nx != x || ny != y)
+					{
+						neighbors.aTiles[neighbors.cTiles++] = static_cast<std::uint16_t>(nx + ny * W);
+					}
+				}
+			}
+		}
+
+		return aNeighbors;
+	}() };
+};
+
+using BeginnerBoard = PresetBoard<9, 9>;
+using IntermediateBoard = PresetBoard<16, 16>;
+using ExpertBoard = PresetBoard<30, 16>;
+
+// Returns the neighbor table of the preset board of this size, nullptr if there is none.
+inline const TileNeighbors* GetPresetNeighbors(std::uint32_t width, std::uint32_t height)
+{
+	if (width == BeginnerBoard::WIDTH && height == BeginnerBoard::HEIGHT)
+	{
+		return BeginnerBoard::NEIGHBORS.data();
+	}
+	else if (width == IntermediateBoard::WIDTH && height == IntermediateBoard::HEIGHT)
+	{
+		return IntermediateBoard::NEIGHBORS.data();
+	}
+	else if (width == ExpertBoard::WIDTH && height == ExpertBoard::HEIGHT)
+	{
+		return ExpertBoard::NEIGHBORS.data();
+	}
+
+	return nullptr;
+}
+
+/*
+*	Calls function with every neighbor of tile, from the
+*	table of a preset board if pNeighbors is one, otherwise
+*	from a TileNeighborhood of the width x height board.
+*/
+template <typename Function>
+inline void ForEachNeighbor(const TileNeighbors* pNeighbors, std::uint32_t tile, std::uint32_t width, std::uint32_t height,
+	Function&& function)
+{
+	if (pNeighbors)
+	{
+		const TileNeighbors& neighbors{ pNeighbors[tile] };
+
+		for (std::uint32_t i{ 0 }; i < neighbors.cTiles; ++i)
+		{
+			function(static_cast<std::uint32_t>(neighbors.aTiles[i]));
+		}
+	}
+	else
+	{
+		for (const std::uint32_t neighbor : TileNeighborhood(tile % width, tile / width, 1, width, height))
+		{
+			if (neighbor != tile)
+			{
+				function(neighbor);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -1,28 +1,115 @@
 #pragma once
-#include <algorithm>
-#include <iterator>
+#include <cstdint>
 #include <random>
-#include <vector>
+#include <type_traits>
 
-class RNG
+/*
+*	The xoshiro256** generator by Blackman and Vigna. It is
+*	a few shifts and rotations per number over 256 bits of
+*	state, much faster and smaller than std::mt19937, and its
+*	sequence is fully defined by its 64 bit seed, which is
+*	expanded into the state with SplitMix64.
+*/
+class Xoshiro256StarStar
 {
+public:
+	using result_type = std::uint64_t;
+
+	explicit Xoshiro256StarStar(std::uint64_t seed) { Seed(seed); }
+
+	void Seed(std::uint64_t seed)
+	{
+		for (std::uint64_t& word : m_state)
+		{
+			seed += 0x9E3779B97F4A7C15;
+			std::uint64_t z{ seed };
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+			word = z ^ (z >> 31);
+		}
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	result_type operator()()
+	{
+		const std::uint64_t result{ RotateLeft(m_state[1] * 5, 7) * 9 };
+		const std::uint64_t t{ m_state[1] << 17 };
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3] = RotateLeft(m_state[3], 45);
+
+		return result;
+	}
+
 private:
-	std::random_device m_rd{};
-	std::mt19937 m_mt{};
+	static std::uint64_t RotateLeft(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+	std::uint64_t m_state[4]{};
+};
+
+/*
+*	Random numbers from a GENERATOR constructed from a 64 bit
+*	seed and returning 64 bit numbers. The same seed always
+*	gives the same numbers: ranges are mapped without
+*	std::uniform_int_distribution, whose results differ
+*	between standard libraries.
+*/
+template <class GENERATOR>
+class BasicRNG
+{
+private:
+	std::uint64_t m_seed{ 0 };
+	GENERATOR m_generator;
 
 public:
-	RNG() : m_rd{}, m_mt { m_rd() } {}
+	BasicRNG() : BasicRNG{ RandomSeed() } {}
+	explicit BasicRNG(std::uint64_t seed) : m_seed{ seed }, m_generator{ seed } {}
 
-	template <class INT_TYPE>
-	INT_TYPE GetInt(INT_TYPE min, INT_TYPE max) { return std::uniform_int_distribution<INT_TYPE>{ min, max }(m_mt); }
+	// Returns a seed from the operating system's entropy.
+	static std::uint64_t RandomSeed()
+	{
+		std::random_device rd{};
+		return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+	}
+
+	void Seed(std::uint64_t seed)
+	{
+		m_seed = seed;
+		m_generator.Seed(seed);
+	}
 
-	template <class T>
-	std::vector<T> SampleVector(std::vector<T>& vp, std::size_t numElements)
+	std::uint64_t GetSeed() const { return m_seed; }
+	std::uint64_t Next() { return m_generator(); }
+
+	// Returns a uniformly distributed integer in [min, max], numbers below 2^64 mod range are redrawn to avoid bias.
+	template <class INT_TYPE>
+	INT_TYPE GetInt(INT_TYPE min, INT_TYPE max)
 	{
-		std::vector<T> sample{};
-		sample.reserve(numElements);
-		std::sample(vp.begin(), vp.end(), std::back_inserter(sample), numElements, m_mt);
+		using UINT_TYPE = std::make_unsigned_t<INT_TYPE>;
+
+		const std::uint64_t range{ static_cast<std::uint64_t>(static_cast<UINT_TYPE>(max) - static_cast<UINT_TYPE>(min)) + 1 };
+		std::uint64_t x{ Next() };
+
+		if (range == 0)
+		{
+			return static_cast<INT_TYPE>(x);
+		}
 
-		return sample;
+		const std::uint64_t threshold{ (0 - range) % range };
+
+		while (x < threshold)
+		{
+			x = Next();
+		}
+
+		return static_cast<INT_TYPE>(static_cast<UINT_TYPE>(min) + static_cast<UINT_TYPE>(x % range));
 	}
-};
\ No newline at end of file
+};
+
+using RNG = BasicRNG<Xoshiro256StarStar>;
\ No newline at end of file
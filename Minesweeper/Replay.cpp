@@ -0,0 +1,327 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "MinefieldEngine.h"
+#include "Varint.h"
+
+namespace
+{
+	constexpr std::uint8_t MAGIC[4]{ 'M', 'S', 'R', 'P' };
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+void Replay::Begin(const MinefieldEngine& engine)
+{
+	m_width = engine.GetWidth();
+	m_height = engine.GetHeight();
+	m_cMines = engine.GetMineCount();
+	m_seed = engine.GetGameSeed();
+	m_bQuestionMarks = engine.AreQuestionMarksEnabled();
+	m_aMineTiles.clear();
+	m_outcome = Outcome::UNFINISHED;
+	m_cRevealed = 0;
+	m_aEvents.clear();
+	m_cEvents = 0;
+	m_lastTime = 0;
+}
+
+// Records that the mines of the game were placed at aMineTiles instead of being drawn from the seed.
+void Replay::SetMines(const std::vector<std::uint32_t>& aMineTiles)
+{
+	m_aMineTiles = aMineTiles;
+	std::sort(m_aMineTiles.begin(), m_aMineTiles.end());
+}
+
+void Replay::Add(Action action, std::uint32_t tile, std::uint32_t time)
+{
+	// Unsigned subtraction, so clocks that wrap around like GetTickCount still give the right delay.
+	const std::uint32_t delay{ m_cEvents > 0 ? time - m_lastTime : 0 };
+
+	WriteVarint(m_aEvents, (static_cast<std::uint64_t>(delay) << 2) | static_cast<std::uint64_t>(action));
+
+	if (action != Action::TOGGLE_QUESTION_MARKS)
+	{
+		WriteVarint(m_aEvents, tile);
+	}
+
+	m_lastTime = time;
+	++m_cEvents;
+}
+
+// Records how the game ended, so playing the replay can check it ends the same way.
+void Replay::Finish(const MinefieldEngine& engine)
+{
+	m_outcome = engine.IsGameWon() ? Outcome::WON : engine.IsGameLost() ? Outcome::LOST : Outcome::UNFINISHED;
+	m_cRevealed = engine.GetRevealedCount();
+}
+
+/*
+*	Writes the replay as:
+*		"MSRP", version
+*		varint	width, height, mines
+*		byte	flags
+*		seed as 8 little endian bytes, or
+*		varint	mine count, then each mine as the varint
+*				difference to the mine before it
+*		byte	Outcome, varint revealed tiles at the end
+*		varint	event count, byte count of the events
+*		the events
+*/
+void Replay::Serialize(std::vector<std::uint8_t>& aBytes) const
+{
+	aBytes.assign(std::begin(MAGIC), std::end(MAGIC));
+	aBytes.push_back(FORMAT_VERSION);
+	WriteVarint(aBytes, m_width);
+	WriteVarint(aBytes, m_height);
+	WriteVarint(aBytes, m_cMines);
+	aBytes.push_back(static_cast<std::uint8_t>((m_bQuestionMarks ? FLAG_QUESTION_MARKS : 0) |
+		(!m_aMineTiles.empty() ? FLAG_MINE_LAYOUT : 0)));
+
+	if (m_aMineTiles.empty())
+	{
+		for (std::uint32_t byte{ 0 }; byte < 8; ++byte)
+		{
+			aBytes.push_back(static_cast<std::uint8_t>(m_seed >> (byte * 8)));
+		}
+	}
+	else
+	{
+		std::uint32_t previous{ 0 };
+		WriteVarint(aBytes, m_aMineTiles.size());
+
+		for (const std::uint32_t tile : m_aMineTiles)
+		{
+			WriteVarint(aBytes, tile - previous);
+			previous = tile;
+		}
+	}
+
+	aBytes.push_back(static_cast<std::uint8_t>(m_outcome));
+	WriteVarint(aBytes, m_cRevealed);
+	WriteVarint(aBytes, m_cEvents);
+	WriteVarint(aBytes, m_aEvents.size());
+	aBytes.insert(aBytes.end(), m_aEvents.begin(), m_aEvents.end());
+}
+
+// Reads a replay written by Serialize, returns false if it is not one or is corrupt.
+bool Replay::Deserialize(const std::uint8_t* pBytes, std::size_t cBytes)
+{
+	const std::uint8_t* pNext{ pBytes };
+	const std::uint8_t* pEnd{ pBytes + cBytes };
+	Replay replay{};
+	std::uint32_t cEventBytes{ 0 };
+	std::uint8_t flags{ 0 };
+
+	if (cBytes < sizeof(MAGIC) + 1 || !std::equal(std::begin(MAGIC), std::end(MAGIC), pNext) || pNext[sizeof(MAGIC)] != FORMAT_VERSION)
+	{
+		return false;
+	}
+
+	pNext += sizeof(MAGIC) + 1;
+
+	if (!ReadVarint32(pNext, pEnd, replay.m_width) || !ReadVarint32(pNext, pEnd, replay.m_height) ||
+		!ReadVarint32(pNext, pEnd, replay.m_cMines) || pNext == pEnd)
+	{
+		return false;
+	}
+
+	if (replay.m_width == 0 || replay.m_height == 0 || replay.m_width > MAX_DIMENSION || replay.m_height > MAX_DIMENSION ||
+		replay.m_cMines > static_cast<std::uint64_t>(replay.m_width) * replay.m_height)
+	{
+		return false;
+	}
+
+	const std::uint64_t cTiles{ static_cast<std::uint64_t>(replay.m_width) * replay.m_height };
+	flags = *pNext++;
+	replay.m_bQuestionMarks = (flags & FLAG_QUESTION_MARKS) != 0;
+
+	if (flags & FLAG_MINE_LAYOUT)
+	{
+		std::uint32_t cMineTiles{ 0 };
+		std::uint64_t tile{ 0 };
+
+		if (!ReadVarint32(pNext, pEnd, cMineTiles) || cMineTiles == 0 || cMineTiles > replay.m_cMines)
+		{
+			return false;
+		}
+
+		replay.m_aMineTiles.reserve(cMineTiles);
+
+		for (std::uint32_t mine{ 0 }; mine < cMineTiles; ++mine)
+		{
+			std::uint32_t difference{ 0 };
+
+			// Mines are sorted and distinct, only the first one can have a difference of 0.
+			if (!ReadVarint32(pNext, pEnd, difference) || (difference == 0 && mine > 0) || (tile += difference) >= cTiles)
+			{
+				return false;
+			}
+
+			replay.m_aMineTiles.push_back(static_cast<std::uint32_t>(tile));
+		}
+	}
+	else
+	{
+		if (pEnd - pNext < 8)
+		{
+			return false;
+		}
+
+		for (std::uint32_t byte{ 0 }; byte < 8; ++byte)
+		{
+			replay.m_seed |= static_cast<std::uint64_t>(*pNext++) << (byte * 8);
+		}
+	}
+
+	if (pNext == pEnd || *pNext > static_cast<std::uint8_t>(Outcome::LOST))
+	{
+		return false;
+	}
+
+	replay.m_outcome = static_cast<Outcome>(*pNext++);
+
+	if (!ReadVarint32(pNext, pEnd, replay.m_cRevealed) || !ReadVarint32(pNext, pEnd, replay.m_cEvents) ||
+		!ReadVarint32(pNext, pEnd, cEventBytes) || static_cast<std::size_t>(pEnd - pNext) != cEventBytes)
+	{
+		return false;
+	}
+
+	replay.m_aEvents.assign(pNext, pEnd);
+	*this = std::move(replay);
+
+	return true;
+}
+
+bool Replay::Save(const std::filesystem::path& path) const
+{
+	std::vector<std::uint8_t> aBytes{};
+	Serialize(aBytes);
+
+	std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+	file.write(reinterpret_cast<const char*>(aBytes.data()), static_cast<std::streamsize>(aBytes.size()));
+
+	return static_cast<bool>(file);
+}
+
+bool Replay::Load(const std::filesystem::path& path)
+{
+	std::ifstream file{ path, std::ios::binary };
+	const std::vector<std::uint8_t> aBytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+	return !file.bad() && Deserialize(aBytes.data(), aBytes.size());
+}
+
+void Replay::Setup(MinefieldEngine& engine) const
+{
+	if (!engine.Resize(m_width, m_height, m_cMines))
+	{
+		engine.ResetGame();
+	}
+
+	engine.SetGameSeed(m_seed);
+
+	if (engine.AreQuestionMarksEnabled() != m_bQuestionMarks)
+	{
+		engine.ToggleQuestionMarkUsage();
+	}
+
+	if (!m_aMineTiles.empty())
+	{
+		engine.PlaceMines(m_aMineTiles);
+	}
+}
+
+/*
+*	Applies one action the way the MinefieldWindow does for
+*	the player's input. Tiles outside of the board and
+*	actions after the game ended are ignored.
+*/
+void Replay::Apply(MinefieldEngine& engine, const Event& event)
+{
+	if (event.action == Action::TOGGLE_QUESTION_MARKS)
+	{
+		engine.ToggleQuestionMarkUsage();
+		return;
+	}
+
+	if (event.tile >= engine.GetSize() || !engine.IsGameActive())
+	{
+		return;
+	}
+
+	const std::uint32_t x{ event.tile % engine.GetWidth() };
+	const std::uint32_t y{ event.tile / engine.GetWidth() };
+
+	switch (event.action)
+	{
+	case Action::REVEAL:
+		engine.RevealTile(x, y);
+		break;
+
+	case Action::CYCLE_MARK:
+		engine.CycleTileMark(x, y);
+		break;
+
+	case Action::CHORD:
+		engine.BeginChord(x, y);
+		engine.EndChord(x, y);
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool Replay::Play(MinefieldEngine& engine) const
+{
+	ReplayReader reader{ *this };
+	Event event{};
+	std::uint32_t cEvents{ 0 };
+
+	Setup(engine);
+
+	while (reader.Next(event))
+	{
+		Apply(engine, event);
+		++cEvents;
+
+		// Nothing draws the changes, so they are dropped before they add up.
+		engine.ClearDirtyTiles();
+	}
+
+	Replay result{};
+	result.Finish(engine);
+
+	return cEvents == m_cEvents && result.m_outcome == m_outcome && result.m_cRevealed == m_cRevealed;
+}
+
+bool ReplayReader::Next(Replay::Event& event)
+{
+	std::uint64_t key{ 0 };
+
+	if (m_pNext >= m_pEnd || !ReadVarint(m_pNext, m_pEnd, key) || (key >> 2) > UINT32_MAX)
+	{
+		m_pNext = m_pEnd;
+		return false;
+	}
+
+	event.action = static_cast<Replay::Action>(key & 3);
+	event.delay = static_cast<std::uint32_t>(key >> 2);
+	event.tile = 0;
+
+	if (event.action != Replay::Action::TOGGLE_QUESTION_MARKS && !ReadVarint32(m_pNext, m_pEnd, event.tile))
+	{
+		m_pNext = m_pEnd;
+		return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+class MinefieldEngine;
+
+/*
+*	A recording of one game: the board it was played on and
+*	every tile-level action of the player, with the time
+*	since the action before it. A board is stored as its
+*	seed, from which the engine draws the same mines for the
+*	same first click, or as its mine layout if the mines did
+*	not come from the seed (e.g. no guessing boards).
+*
+*	Actions are appended as they happen and are kept encoded
+*	as varints, an action usually takes 2 to 4 bytes:
+*		varint	delay in milliseconds << 2 | Action
+*		varint	tile index, for every action but TOGGLE_QUESTION_MARKS
+*
+*	Play applies a replay to an engine as fast as it can,
+*	e.g. to check that the rules still give the recorded
+*	outcome. A ReplayReader steps through the actions one at
+*	a time, e.g. to show them at the recorded speed.
+*/
+class Replay
+{
+public:
+	// Same as constants::MAX_FIELD_DIMENSION, larger boards are rejected as corrupt so every tile index fits 32 bits.
+	static constexpr std::uint32_t MAX_DIMENSION{ 4096 };
+
+	enum class Action : std::uint8_t
+	{
+		REVEAL,
+		CYCLE_MARK,
+		CHORD,
+		TOGGLE_QUESTION_MARKS,
+	};
+
+	enum class Outcome : std::uint8_t
+	{
+		UNFINISHED,
+		WON,
+		LOST,
+	};
+
+	struct Event
+	{
+		Action action{ Action::REVEAL };
+		std::uint32_t tile{ 0 };
+		std::uint32_t delay{ 0 };							// Milliseconds since the event before, 0 for the first.
+	};
+
+	// Starts recording the game engine was just reset to, dropping any earlier recording.
+	void Begin(const MinefieldEngine& engine);
+	void SetMines(const std::vector<std::uint32_t>& aMineTiles);
+	// Appends an action at time, in milliseconds of any clock that is used for the whole game.
+	void Add(Action action, std::uint32_t tile, std::uint32_t time);
+	void Finish(const MinefieldEngine& engine);
+	// Continues recording at time, e.g. after the replay was loaded and played back.
+	void SetTime(std::uint32_t time) { m_lastTime = time; }
+
+	std::uint32_t GetWidth() const { return m_width; }
+	std::uint32_t GetHeight() const { return m_height; }
+	std::uint32_t GetMineCount() const { return m_cMines; }
+	std::uint32_t GetEventCount() const { return m_cEvents; }
+	Outcome GetOutcome() const { return m_outcome; }
+	std::uint32_t GetRevealedCount() const { return m_cRevealed; }
+
+	void	Serialize(std::vector<std::uint8_t>& aBytes) const;
+	bool	Deserialize(const std::uint8_t* pBytes, std::size_t cBytes);
+	bool	Save(const std::filesystem::path& path) const;
+	bool	Load(const std::filesystem::path& path);
+
+	// Resets engine to the start of the recorded game.
+	void	Setup(MinefieldEngine& engine) const;
+	static void Apply(MinefieldEngine& engine, const Event& event);
+	// Sets up engine and applies every event, returns if the game ended the way it was recorded.
+	bool	Play(MinefieldEngine& engine) const;
+
+private:
+	friend class ReplayReader;
+
+	static constexpr std::uint8_t FORMAT_VERSION{ 1 };
+	static constexpr std::uint8_t FLAG_QUESTION_MARKS{ 1 << 0 };	// Question marks were enabled at the start.
+	static constexpr std::uint8_t FLAG_MINE_LAYOUT{ 1 << 1 };		// The mines are stored instead of the seed.
+
+	std::uint32_t m_width{ 0 };
+	std::uint32_t m_height{ 0 };
+	std::uint32_t m_cMines{ 0 };
+	std::uint64_t m_seed{ 0 };
+	bool m_bQuestionMarks{ false };
+	std::vector<std::uint32_t> m_aMineTiles{};				// Sorted, empty if the mines come from the seed.
+	Outcome m_outcome{ Outcome::UNFINISHED };
+	std::uint32_t m_cRevealed{ 0 };							// Revealed tiles at the end of the game.
+
+	std::vector<std::uint8_t> m_aEvents{};					// The encoded events.
+	std::uint32_t m_cEvents{ 0 };
+	std::uint32_t m_lastTime{ 0 };
+};
+
+// Decodes the events of a replay in order. The replay must outlive its readers and not change.
+class ReplayReader
+{
+public:
+	explicit ReplayReader(const Replay& replay) : m_pNext{ replay.m_aEvents.data() },
+		m_pEnd{ replay.m_aEvents.data() + replay.m_aEvents.size() } {}
+
+	// Returns the next event, false once all were read or the events are corrupt.
+	bool Next(Replay::Event& event);
+
+private:
+	const std::uint8_t* m_pNext{ nullptr };
+	const std::uint8_t* m_pEnd{ nullptr };
+};
\ No newline at end of file
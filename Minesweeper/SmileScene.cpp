@@ -44,26 +44,26 @@ void SmileScene::DiscardDeviceIndependentResources()
 
 HRESULT SmileScene::CreateDeviceDependentResources()
 {
-	HRESULT	hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLightest)), &m_pTileEdgeLightestColorBrush);
+	HRESULT	hr = GetSolidColorBrush(colors::tileEdgeLightest, &m_pTileEdgeLightestColorBrush);
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeLight)), &m_pTileEdgeLightColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeLight, &m_pTileEdgeLightColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDark)), &m_pTileEdgeDarkColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDark, &m_pTileEdgeDarkColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileEdgeDarkest)), &m_pTileEdgeDarkestColorBrush);
+		hr = GetSolidColorBrush(colors::tileEdgeDarkest, &m_pTileEdgeDarkestColorBrush);
 	}
 
 	if (SUCCEEDED(hr))
 	{
-		hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(RGBA(colors::tileBackground)), &m_pTextColorBrush);
+		hr = GetSolidColorBrush(colors::tileBackground, &m_pTextColorBrush);
 	}
 
 	return hr;
@@ -18,7 +18,7 @@ SmileWindow::SmileWindow()
 void SmileWindow::SetSmileState(SmileState state)
 {
 	m_scene.SetSmileState(state);
-	m_scene.Render();
+	m_scene.RequestRender();
 }
 
 void SmileWindow::SetCurrentTileContent(TileContent content)
@@ -27,14 +27,14 @@ void SmileWindow::SetCurrentTileContent(TileContent content)
 
 	if (IsDebugEnabled())
 	{
-		m_scene.Render();
+		m_scene.RequestRender();
 	}
 }
 
 void SmileWindow::ToggleDebug()
 {
 	m_scene.ToggleDebug();
-	m_scene.Render();
+	m_scene.RequestRender();
 }
 
 void SmileWindow::ResetGame()
@@ -61,7 +61,7 @@ BOOL SmileWindow::IsDebugEnabled()
 LRESULT SmileWindow::OnLButtonDown(WPARAM wParam, LPARAM lParam)
 {
 	m_scene.SetClicked();
-	m_scene.Render();
+	m_scene.RequestRender();
 	return 0;
 }
 
@@ -71,7 +71,7 @@ LRESULT SmileWindow::OnLButtonUp(WPARAM wParam, LPARAM lParam)
 	{
 		m_pGameInfoBarWindow->ResetGame();
 		m_scene.UnsetClicked();
-		m_scene.Render();
+		m_scene.RequestRender();
 	}
 
 	return 0;
@@ -98,7 +98,7 @@ LRESULT SmileWindow::OnMouseMove(WPARAM wParam, LPARAM lParam)
 			if (!m_scene.IsClicked())
 			{
 				m_scene.SetClicked();
-				m_scene.Render();
+				m_scene.RequestRender();
 			}
 		}
 	}
@@ -111,7 +111,7 @@ LRESULT SmileWindow::OnMouseLeave(WPARAM wParam, LPARAM lParam)
 	if (m_scene.IsClicked())
 	{
 		m_scene.UnsetClicked();
-		m_scene.Render();
+		m_scene.RequestRender();
 	}
 
 	m_bMouseTracking = FALSE;
@@ -0,0 +1,430 @@
+// WinSock2.h must come before the Windows.h of the header, which would pull in the older winsock.h.
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+
+#include "SpectatorServer.h"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+#include "Varint.h"
+
+#pragma comment(lib, "ws2_32")
+
+namespace
+{
+	// A connected spectator and what it was sent that its socket didn't take yet.
+	struct Client
+	{
+		SOCKET socket{ INVALID_SOCKET };
+		std::vector<std::uint8_t> aBacklog{};
+		std::size_t cSent{ 0 };									// Bytes at the front of the backlog already sent.
+	};
+
+	// Sends as much of the backlog as the socket takes without blocking, returns false if the spectator is gone.
+	bool Flush(Client& client)
+	{
+		while (client.cSent < client.aBacklog.size())
+		{
+			const int cBytes{ static_cast<int>(std::min<std::size_t>(client.aBacklog.size() - client.cSent, INT_MAX)) };
+			const int cSent{ send(client.socket, reinterpret_cast<const char*>(client.aBacklog.data() + client.cSent), cBytes, 0) };
+
+			if (cSent == SOCKET_ERROR)
+			{
+				return WSAGetLastError() == WSAEWOULDBLOCK;
+			}
+
+			client.cSent += static_cast<std::size_t>(cSent);
+		}
+
+		client.aBacklog.clear();
+		client.cSent = 0;
+
+		return true;
+	}
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+SpectatorServer::~SpectatorServer()
+{
+	Stop();
+}
+
+BOOL SpectatorServer::Start(USHORT port)
+{
+	if (IsRunning())
+	{
+		return TRUE;
+	}
+
+	m_hWakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	if (!m_hWakeEvent)
+	{
+		return FALSE;
+	}
+
+	m_bStopping = false;
+
+	std::promise<bool> listening{};
+	std::future<bool> bListening{ listening.get_future() };
+	m_thread = std::thread{ &SpectatorServer::Run, this, port, std::move(listening) };
+
+	if (!bListening.get())
+	{
+		m_thread.join();
+		CloseHandle(m_hWakeEvent);
+		m_hWakeEvent = nullptr;
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+void SpectatorServer::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock{ m_lock };
+		m_bStopping = true;
+	}
+
+	SetEvent(m_hWakeEvent);
+	m_thread.join();
+	CloseHandle(m_hWakeEvent);
+	m_hWakeEvent = nullptr;
+	m_aUpdates.clear();
+}
+
+BOOL SpectatorServer::IsRunning() const
+{
+	return m_thread.joinable();
+}
+
+void SpectatorServer::Publish(Update&& update)
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock{ m_lock };
+		m_aUpdates.push_back(std::move(update));
+	}
+
+	SetEvent(m_hWakeEvent);
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+/*
+*	The server thread. Every time it wakes up it applies the
+*	queued updates to its board, encodes them once and adds
+*	them to the backlog of every spectator, then accepts new
+*	spectators with a keyframe of the board and sends what
+*	each socket takes without blocking.
+*/
+void SpectatorServer::Run(USHORT port, std::promise<bool> listening)
+{
+	WSADATA wsaData{};
+
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		listening.set_value(false);
+		return;
+	}
+
+	// One IPv6 socket that also accepts IPv4 connections, on every address as the zeroed sin6_addr is in6addr_any.
+	const SOCKET listener{ socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP) };
+	const WSAEVENT hAcceptEvent{ WSACreateEvent() };
+	const DWORD bV6Only{ FALSE };
+	sockaddr_in6 address{};
+	address.sin6_family = AF_INET6;
+	address.sin6_port = htons(port);
+
+	const bool bListening{ listener != INVALID_SOCKET && hAcceptEvent != WSA_INVALID_EVENT &&
+		setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&bV6Only), sizeof(bV6Only)) != SOCKET_ERROR &&
+		bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != SOCKET_ERROR &&
+		listen(listener, SOMAXCONN) != SOCKET_ERROR &&
+		WSAEventSelect(listener, hAcceptEvent, FD_ACCEPT) != SOCKET_ERROR };
+
+	listening.set_value(bListening);
+
+	std::vector<Client> aClients{};
+	std::vector<Update> aUpdates{};
+	std::vector<std::uint8_t> aMessages{};
+	bool bStopping{ !bListening };
+
+	while (!bStopping)
+	{
+		const bool bBacklog{ std::any_of(aClients.begin(), aClients.end(), [](const Client& client) { return !client.aBacklog.empty(); }) };
+		const HANDLE aEvents[]{ m_hWakeEvent, hAcceptEvent };
+		WaitForMultipleObjects(ARRAYSIZE(aEvents), aEvents, FALSE, bBacklog ? SEND_RETRY_INTERVAL : INFINITE);
+
+		{
+			const std::lock_guard<std::mutex> lock{ m_lock };
+			std::swap(aUpdates, m_aUpdates);
+			bStopping = m_bStopping;
+		}
+
+		aMessages.clear();
+
+		for (Update& update : aUpdates)
+		{
+			Apply(update);
+
+			if (update.bNewGame)
+			{
+				EncodeKeyframe(aMessages);
+			}
+			else
+			{
+				EncodeDelta(aMessages, update);
+			}
+		}
+
+		aUpdates.clear();
+
+		for (Client& client : aClients)
+		{
+			client.aBacklog.insert(client.aBacklog.end(), aMessages.begin(), aMessages.end());
+		}
+
+		WSANETWORKEVENTS networkEvents{};
+		WSAEnumNetworkEvents(listener, hAcceptEvent, &networkEvents);
+
+		for (SOCKET connection{ accept(listener, nullptr, nullptr) }; connection != INVALID_SOCKET; connection = accept(listener, nullptr, nullptr))
+		{
+			// Accepted sockets share the event of the listener, dropping it leaves them non-blocking.
+			const DWORD bNoDelay{ TRUE };
+			WSAEventSelect(connection, nullptr, 0);
+			setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&bNoDelay), sizeof(bNoDelay));
+
+			Client client{};
+			client.socket = connection;
+			EncodeKeyframe(client.aBacklog);
+			aClients.push_back(std::move(client));
+		}
+
+		aClients.erase(std::remove_if(aClients.begin(), aClients.end(), [](Client& client)
+		{
+			if (Flush(client) && client.aBacklog.size() <= MAX_CLIENT_BACKLOG)
+			{
+				return false;
+			}
+
+			closesocket(client.socket);
+			return true;
+		}), aClients.end());
+	}
+
+	for (const Client& client : aClients)
+	{
+		closesocket(client.socket);
+	}
+
+	if (listener != INVALID_SOCKET)
+	{
+		closesocket(listener);
+	}
+
+	if (hAcceptEvent != WSA_INVALID_EVENT)
+	{
+		WSACloseEvent(hAcceptEvent);
+	}
+
+	WSACleanup();
+}
+
+/*
+*	Calls function with the index and packed tile of every
+*	tile of board that isn't hidden and unmarked, including
+*	the mines shown once the game is over, or with
+*	bShownMinesOnly just those mines. Chunks no one touched
+*	are skipped by their planes.
+*/
+template <typename Function>
+void SpectatorServer::ForEachShownTile(const TileBoard& board, bool bShowMines, bool bShownMinesOnly, Function&& function)
+{
+	for (std::uint32_t chunk{ 0 }; chunk < board.GetChunkCount(); ++chunk)
+	{
+		const TileBoard::ChunkPlanes planes{ board.GetChunkPlanes(chunk) };
+		const bool bUntouched{ !planes.pStates && planes.uniformState == TileState::HIDDEN && !planes.pMarks };
+		const bool bShownMines{ bShowMines && planes.pMines };
+
+		if (bShownMinesOnly ? !bShownMines : bUntouched && !bShownMines)
+		{
+			continue;
+		}
+
+		const std::uint32_t xBegin{ (chunk % board.GetChunkColumns()) << TileBoard::CHUNK_SHIFT };
+		const std::uint32_t yBegin{ (chunk / board.GetChunkColumns()) << TileBoard::CHUNK_SHIFT };
+		const std::uint32_t xEnd{ std::min<std::uint32_t>(xBegin + TileBoard::CHUNK_SIZE, board.GetWidth()) };
+		const std::uint32_t yEnd{ std::min<std::uint32_t>(yBegin + TileBoard::CHUNK_SIZE, board.GetHeight()) };
+
+		for (std::uint32_t y{ yBegin }; y < yEnd; ++y)
+		{
+			for (std::uint32_t x{ xBegin }; x < xEnd; ++x)
+			{
+				const TileState state{ board.GetState(x, y) };
+				const bool bMine{ board.IsMine(x, y) };
+				const TileContent content{ state == TileState::REVEALED ?
+					(bMine ? TileContent::MINE : static_cast<TileContent>(board.GetAdjacentCount(x, y))) :
+					bShowMines && bMine ? TileContent::MINE : TileContent::EMPTY };
+				const std::uint8_t packed{ PackTile(state, board.GetMark(x, y), content) };
+
+				if (bShownMinesOnly ? bMine && bShowMines && state != TileState::REVEALED : packed != 0)
+				{
+					function(x + y * board.GetWidth(), packed);
+				}
+			}
+		}
+	}
+}
+
+/*
+*	Brings the board of the server thread up to date with
+*	update. A new game takes every tile from the board of
+*	update, otherwise the mines it shows are added to the
+*	tile changes, so they are encoded with the delta.
+*/
+void SpectatorServer::Apply(Update& update)
+{
+	if (update.bNewGame)
+	{
+		m_width = update.width;
+		m_height = update.height;
+		m_cMines = update.cMines;
+		m_aBoard.assign(static_cast<std::size_t>(m_width) * m_height, PackTile(TileState::HIDDEN, TileMark::NONE, TileContent::EMPTY));
+	}
+
+	if (update.status & STATUS_QUESTION_MARKS_CLEARED)
+	{
+		constexpr std::uint8_t MARK_BITS{ 3 << 2 };
+		constexpr std::uint8_t QUESTION_MARK{ static_cast<std::uint8_t>(TileMark::QUESTION_MARK) << 2 };
+
+		for (std::uint8_t& packed : m_aBoard)
+		{
+			packed = (packed & MARK_BITS) == QUESTION_MARK ? static_cast<std::uint8_t>(packed & ~MARK_BITS) : packed;
+		}
+	}
+
+	std::size_t content{ 0 };
+
+	for (const TileSpan& span : update.aRevealedSpans)
+	{
+		for (std::uint32_t x{ span.xBegin }; x < span.xEnd; ++x)
+		{
+			m_aBoard[x + static_cast<std::size_t>(span.y) * m_width] = PackTile(TileState::REVEALED, TileMark::NONE,
+				static_cast<TileContent>(update.aRevealedContents[content++]));
+		}
+	}
+
+	if (update.pBoard)
+	{
+		const bool bShowMines{ (update.status & (STATUS_GAME_WON | STATUS_GAME_LOST)) != 0 };
+
+		if (update.bNewGame)
+		{
+			ForEachShownTile(*update.pBoard, bShowMines, false, [this](std::uint32_t tile, std::uint8_t packed) { m_aBoard[tile] = packed; });
+		}
+		else
+		{
+			ForEachShownTile(*update.pBoard, bShowMines, true, [&update](std::uint32_t tile, std::uint8_t packed)
+			{
+				update.aTileChanges.push_back({ tile, packed });
+			});
+		}
+
+		update.pBoard.reset();
+	}
+
+	for (const TileChange& change : update.aTileChanges)
+	{
+		m_aBoard[change.tile] = change.packed;
+	}
+
+	m_flagCounter = update.flagCounter;
+	m_elapsedSeconds = update.elapsedSeconds;
+	m_status = static_cast<std::uint8_t>(update.status & ~STATUS_QUESTION_MARKS_CLEARED);
+}
+
+void SpectatorServer::EncodeStatus(std::vector<std::uint8_t>& aPayload, std::uint8_t status) const
+{
+	WriteVarint(aPayload, ZigZagEncode(m_flagCounter));
+	WriteVarint(aPayload, m_elapsedSeconds);
+	aPayload.push_back(status);
+}
+
+// Appends a keyframe of the board of the server thread to aMessages.
+void SpectatorServer::EncodeKeyframe(std::vector<std::uint8_t>& aMessages) const
+{
+	std::vector<std::uint8_t> aPayload{ static_cast<std::uint8_t>(MessageType::KEYFRAME) };
+	EncodeStatus(aPayload, m_status);
+	WriteVarint(aPayload, m_width);
+	WriteVarint(aPayload, m_height);
+	WriteVarint(aPayload, m_cMines);
+
+	for (std::size_t tile{ 0 }; tile < m_aBoard.size();)
+	{
+		const std::size_t runBegin{ tile };
+
+		while (tile < m_aBoard.size() && m_aBoard[tile] == m_aBoard[runBegin])
+		{
+			++tile;
+		}
+
+		WriteVarint(aPayload, tile - runBegin);
+		aPayload.push_back(m_aBoard[runBegin]);
+	}
+
+	AppendMessage(aMessages, aPayload);
+}
+
+// Appends a delta of the changes of update to aMessages.
+void SpectatorServer::EncodeDelta(std::vector<std::uint8_t>& aMessages, const Update& update) const
+{
+	std::vector<std::uint8_t> aPayload{ static_cast<std::uint8_t>(MessageType::DELTA) };
+	EncodeStatus(aPayload, update.status);
+	WriteVarint(aPayload, update.aRevealedSpans.size());
+
+	for (const TileSpan& span : update.aRevealedSpans)
+	{
+		WriteVarint(aPayload, span.y);
+		WriteVarint(aPayload, span.xBegin);
+		WriteVarint(aPayload, span.xEnd - span.xBegin);
+	}
+
+	aPayload.insert(aPayload.end(), update.aRevealedContents.begin(), update.aRevealedContents.end());
+	WriteVarint(aPayload, update.aTileChanges.size());
+
+	for (const TileChange& change : update.aTileChanges)
+	{
+		WriteVarint(aPayload, change.tile);
+		aPayload.push_back(change.packed);
+	}
+
+	AppendMessage(aMessages, aPayload);
+}
+
+void SpectatorServer::AppendMessage(std::vector<std::uint8_t>& aMessages, const std::vector<std::uint8_t>& aPayload)
+{
+	WriteVarint(aMessages, aPayload.size());
+	aMessages.insert(aMessages.end(), aPayload.begin(), aPayload.end());
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+#include <Windows.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "enums.h"
+#include "MinefieldEngine.h"
+
+/*
+*	Streams the game being played to spectators over TCP.
+*	The window publishes an Update of what each move changed:
+*	the spans a move revealed, a changed mark, or a board
+*	shared with TileBoard::Share when the whole board is sent
+*	or a game ends, which costs a pointer per chunk rather
+*	than a pass over the tiles. A server thread does the
+*	rest: it keeps its own copy of the board, reads every
+*	tile of a new game and the mines shown at the end of one
+*	from the shared board, encodes the updates and sends them
+*	to every spectator, so the player's input is never held
+*	up by the size of the board, the network or slow viewers.
+*
+*	The stream is a sequence of messages, each a varint of
+*	its length in bytes followed by:
+*		byte	MessageType
+*		varint	flag counter as ZigZag, elapsed seconds
+*		byte	STATUS_ flags
+*	A KEYFRAME, sent to a spectator when it connects and to
+*	everyone when a new game starts, continues with:
+*		varint	width, height, mines
+*		the board in tile order as runs of equal tiles:
+*		varint	run length, byte packed tile
+*	A DELTA, sent for every other update, continues with:
+*		varint	revealed span count
+*		varint	y, xBegin, xEnd - xBegin of each span
+*		byte	TileContent of every tile of the spans
+*		varint	changed tile count
+*		varint	tile index, byte packed tile of each
+*	A packed tile is its TileState | TileMark << 2 |
+*	TileContent << 4, the content being EMPTY unless the tile
+*	is revealed or shown as a mine at the end of the game.
+*	Bandwidth follows what the player does: a revealed region
+*	costs a few bytes per row and a byte per tile, a flag a
+*	few bytes, however large the board is.
+*/
+class SpectatorServer
+{
+public:
+	enum class MessageType : std::uint8_t
+	{
+		KEYFRAME,
+		DELTA,
+	};
+
+	static constexpr std::uint8_t STATUS_TIMER_RUNNING{ 1 << 0 };
+	static constexpr std::uint8_t STATUS_GAME_WON{ 1 << 1 };
+	static constexpr std::uint8_t STATUS_GAME_LOST{ 1 << 2 };
+	static constexpr std::uint8_t STATUS_QUESTION_MARKS_CLEARED{ 1 << 3 };	// Every question mark was removed.
+
+	struct TileChange
+	{
+		std::uint32_t tile{ 0 };
+		std::uint8_t packed{ 0 };
+	};
+
+	// What changed in the game, filled on the UI thread and encoded by the server thread.
+	struct Update
+	{
+		bool bNewGame{ false };									// Starts over on a hidden board of width x height.
+		std::uint32_t width{ 0 };
+		std::uint32_t height{ 0 };
+		std::uint32_t cMines{ 0 };
+		std::int32_t flagCounter{ 0 };
+		std::uint32_t elapsedSeconds{ 0 };
+		std::uint8_t status{ 0 };
+		std::vector<TileSpan> aRevealedSpans{};
+		std::vector<std::uint8_t> aRevealedContents{};			// TileContent of every tile of the spans, in order.
+		std::vector<TileChange> aTileChanges{};					// Applied after the spans.
+		std::shared_ptr<const TileBoard> pBoard{};				// Every tile of a new game, or the mines shown once it is over.
+	};
+
+	SpectatorServer() = default;
+	~SpectatorServer();
+	SpectatorServer(const SpectatorServer&) = delete;
+	SpectatorServer& operator=(const SpectatorServer&) = delete;
+
+	static std::uint8_t PackTile(TileState state, TileMark mark, TileContent content)
+	{
+		return static_cast<std::uint8_t>(static_cast<std::uint8_t>(state) | static_cast<std::uint8_t>(mark) << 2 |
+			static_cast<std::uint8_t>(content) << 4);
+	}
+
+	BOOL Start(USHORT port);									// Listens for spectators on port, returns FALSE if it can't.
+	void Stop();												// Disconnects every spectator.
+	BOOL IsRunning() const;
+	void Publish(Update&& update);								// Queues an update for the server thread.
+
+private:
+	// Spectators with more bytes than this sent to them but not taken by their socket yet are disconnected.
+	static constexpr std::size_t MAX_CLIENT_BACKLOG{ 16 << 20 };
+	// How often, in milliseconds, sending to spectators with a backlog is retried.
+	static constexpr DWORD SEND_RETRY_INTERVAL{ 50 };
+
+	std::thread m_thread{};
+	HANDLE m_hWakeEvent{ nullptr };								// Set when updates are queued or the server stops.
+	std::mutex m_lock{};										// Guards the updates and m_bStopping.
+	std::vector<Update> m_aUpdates{};
+	bool m_bStopping{ false };
+
+	// Only used by the server thread.
+	std::uint32_t m_width{ 0 };
+	std::uint32_t m_height{ 0 };
+	std::uint32_t m_cMines{ 0 };
+	std::int32_t m_flagCounter{ 0 };
+	std::uint32_t m_elapsedSeconds{ 0 };
+	std::uint8_t m_status{ 0 };
+	std::vector<std::uint8_t> m_aBoard{};						// Packed tile of every tile, as the spectators see it.
+
+	void Run(USHORT port, std::promise<bool> listening);
+	void Apply(Update& update);
+	template <typename Function>
+	static void ForEachShownTile(const TileBoard& board, bool bShowMines, bool bShownMinesOnly, Function&& function);
+	void EncodeStatus(std::vector<std::uint8_t>& aPayload, std::uint8_t status) const;
+	void EncodeKeyframe(std::vector<std::uint8_t>& aMessages) const;
+	void EncodeDelta(std::vector<std::uint8_t>& aMessages, const Update& update) const;
+	static void AppendMessage(std::vector<std::uint8_t>& aMessages, const std::vector<std::uint8_t>& aPayload);
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "StatsDialog.h"
+
+#include <cwchar>
+#include <Windows.h>
+
+#include "constants.h"
+#include "GameStats.h"
+#include "GameWindow.h"
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+StatsDialog::StatsDialog() {}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+/*
+*	Adds a line per board size to the list, the columns are
+*	separated by tabs. The 3BV per second and efficiency are
+*	of won games, efficiency being the 3BV of the boards per
+*	click it took to solve them.
+*/
+void StatsDialog::FillStatsList()
+{
+	// Tab stops of the columns, in dialog units.
+	constexpr INT TAB_STOPS[]{ 76, 108, 156, 194, 230 };
+
+	const HWND hWndStatsList{ GetDlgItem(m_hDlg, IDC_LIST_STATS) };
+	SendMessage(hWndStatsList, LB_SETTABSTOPS, ARRAYSIZE(TAB_STOPS), reinterpret_cast<LPARAM>(TAB_STOPS));
+	SendMessage(hWndStatsList, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(L"Board\tPlayed\tWon\tBest\t3BV/s\tEfficiency"));
+
+	for (const GameStats::Summary& summary : m_pGameWindow->GetStats().GetSummaries())
+	{
+		WCHAR szBest[16]{ L"-" };
+		WCHAR szSpeed[16]{ L"-" };
+		WCHAR szEfficiency[16]{ L"-" };
+
+		if (summary.cWon > 0)
+		{
+			swprintf_s(szBest, L"%.3f", summary.bestMilliseconds / 1000.);
+		}
+
+		if (summary.milliseconds > 0)
+		{
+			swprintf_s(szSpeed, L"%.2f", summary.threeBV * 1000. / summary.milliseconds);
+		}
+
+		if (summary.cClicks > 0)
+		{
+			swprintf_s(szEfficiency, L"%.0f%%", summary.threeBV * 100. / summary.cClicks);
+		}
+
+		WCHAR szLine[constants::MAX_LOADSTRING];
+		swprintf_s(szLine, L"%ux%u, %u mines\t%u\t%u (%.0f%%)\t%s\t%s\t%s", summary.width, summary.height, summary.cMines,
+			summary.cGames, summary.cWon, summary.cWon * 100. / summary.cGames, szBest, szSpeed, szEfficiency);
+		SendMessage(hWndStatsList, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(szLine));
+	}
+}
+
+/*
+*	============================
+*	===== Dialog Procedure =====
+*	============================
+*/
+
+INT_PTR CALLBACK StatsDialog::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	switch (uMsg)
+	{
+	case WM_INITDIALOG:
+		if (!m_pGameWindow)
+		{
+			m_pGameWindow = reinterpret_cast<GameWindow*>(GetWindowLongPtr(GetParent(m_hDlg), GWLP_USERDATA));
+		}
+
+		FillStatsList();
+		return static_cast<INT_PTR>(TRUE);
+
+	case WM_COMMAND:
+		switch (LOWORD(wParam))
+		{
+		case IDOK:
+			[[fallthrough]];
+		case IDCANCEL:
+			EndDialog(m_hDlg, LOWORD(wParam));
+			return static_cast<INT_PTR>(TRUE);
+		}
+		return static_cast<INT_PTR>(FALSE);
+
+	default:
+		return static_cast<INT_PTR>(FALSE);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include "BaseDialog.h"
+
+#include <Windows.h>
+
+#include "constants.h"
+
+class GameWindow;
+
+// Shows how many games were played and won on every board size, with the best time, 3BV per second and efficiency.
+class StatsDialog : public BaseDialog<StatsDialog>
+{
+public:
+	StatsDialog();
+
+private:
+	GameWindow* m_pGameWindow{ nullptr };
+
+	void FillStatsList();
+
+public:
+	UINT DialogID() { return IDD_STATS; }
+	INT_PTR HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam);
+};
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+	// The pool and queue of the worker running on this thread, if any.
+	thread_local const ThreadPool* s_pWorkerPool{ nullptr };
+	thread_local unsigned s_workerIndex{ 0 };
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+ThreadPool::ThreadPool(unsigned cThreads)
+{
+	cThreads = std::max(cThreads, 1u);
+
+	for (unsigned i{ 0 }; i < cThreads; ++i)
+	{
+		m_apQueues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	for (unsigned i{ 0 }; i < cThreads; ++i)
+	{
+		m_aThreads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+// Lets the workers finish every queued task, then joins them.
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_sleepLock };
+		m_bStopping = true;
+	}
+
+	m_wake.notify_all();
+
+	for (std::thread& thread : m_aThreads)
+	{
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool{ std::thread::hardware_concurrency() };
+	return pool;
+}
+
+unsigned ThreadPool::GetThreadCount() const
+{
+	return static_cast<unsigned>(m_apQueues.size());
+}
+
+void ThreadPool::Submit(TaskGroup& group, std::function<void()> task)
+{
+	const unsigned queue{ s_pWorkerPool == this ? s_workerIndex :
+		m_nextQueue.fetch_add(1, std::memory_order_relaxed) % GetThreadCount() };
+
+	group.m_cPending.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock{ m_apQueues[queue]->lock };
+		m_apQueues[queue]->tasks.push_back({ std::move(task), &group });
+	}
+
+	m_cQueued.fetch_add(1);
+
+	// Taking the lock orders this with a worker checking m_cQueued before it sleeps, so the wake up isn't lost.
+	{
+		std::lock_guard<std::mutex> lock{ m_sleepLock };
+	}
+
+	m_wake.notify_one();
+}
+
+// Runs queued tasks on the calling thread until every task of group has finished.
+void ThreadPool::Wait(TaskGroup& group)
+{
+	const unsigned home{ s_pWorkerPool == this ? s_workerIndex : 0 };
+
+	while (!group.IsDone())
+	{
+		if (!TryRunTask(home))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+void ThreadPool::WorkerLoop(unsigned index)
+{
+	s_pWorkerPool = this;
+	s_workerIndex = index;
+
+	while (true)
+	{
+		if (TryRunTask(index))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock{ m_sleepLock };
+		m_wake.wait(lock, [this]() { return m_bStopping || m_cQueued.load() > 0; });
+
+		if (m_bStopping && m_cQueued.load() == 0)
+		{
+			return;
+		}
+	}
+}
+
+// Runs the newest task of the home queue or, if it is empty, steals the oldest task of another queue.
+bool ThreadPool::TryRunTask(unsigned home)
+{
+	Task task{};
+	bool bFound{ TryTakeTask(home, true, task) };
+
+	for (unsigned i{ 1 }; i < GetThreadCount() && !bFound; ++i)
+	{
+		bFound = TryTakeTask((home + i) % GetThreadCount(), false, task);
+	}
+
+	if (bFound)
+	{
+		m_cQueued.fetch_sub(1);
+		task.function();
+		task.pGroup->m_cPending.fetch_sub(1, std::memory_order_release);
+	}
+
+	return bFound;
+}
+
+bool ThreadPool::TryTakeTask(unsigned queue, bool bNewest, Task& task)
+{
+	WorkerQueue& workerQueue{ *m_apQueues[queue] };
+	std::lock_guard<std::mutex> lock{ workerQueue.lock };
+
+	if (workerQueue.tasks.empty())
+	{
+		return false;
+	}
+
+	if (bNewest)
+	{
+		task = std::move(workerQueue.tasks.back());
+		workerQueue.tasks.pop_back();
+	}
+	else
+	{
+		task = std::move(workerQueue.tasks.front());
+		workerQueue.tasks.pop_front();
+	}
+
+	return true;
+}
\ No newline at end of file
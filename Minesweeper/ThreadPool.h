@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+*	A pool of worker threads that share work by stealing.
+*	Every worker has its own queue: tasks submitted from a
+*	worker go to the back of its queue and it takes its next
+*	task from there, so work spawned by a task stays on the
+*	thread whose caches hold its data. Idle workers steal
+*	from the front of the other queues, where the oldest and
+*	usually largest pieces of work are.
+*
+*	Tasks are counted by the TaskGroup they are submitted
+*	with. Waiting on a group runs queued tasks on the waiting
+*	thread until all of the group's tasks have finished, so
+*	waiting from inside a task can't deadlock the pool.
+*/
+class ThreadPool
+{
+public:
+	class TaskGroup
+	{
+	public:
+		bool IsDone() const { return m_cPending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class ThreadPool;
+		std::atomic<std::size_t> m_cPending{ 0 };
+	};
+
+	explicit ThreadPool(unsigned cThreads);
+	~ThreadPool();
+
+	static ThreadPool& Shared();	// Returns a pool with a thread per core, created on first use.
+
+	unsigned	GetThreadCount() const;
+	void		Submit(TaskGroup& group, std::function<void()> task);
+	void		Wait(TaskGroup& group);
+
+private:
+	struct Task
+	{
+		std::function<void()> function{};
+		TaskGroup* pGroup{ nullptr };
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex lock{};
+		std::deque<Task> tasks{};
+	};
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void	WorkerLoop(unsigned index);
+	bool	TryRunTask(unsigned home);
+	bool	TryTakeTask(unsigned queue, bool bNewest, Task& task);
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_apQueues{};	// One per worker.
+	std::vector<std::thread> m_aThreads{};
+	std::atomic<std::size_t> m_cQueued{ 0 };				// Tasks waiting in any queue.
+	std::atomic<unsigned> m_nextQueue{ 0 };					// Spreads tasks submitted from outside the pool.
+	std::mutex m_sleepLock{};
+	std::condition_variable m_wake{};
+	bool m_bStopping{ false };
+};
\ No newline at end of file
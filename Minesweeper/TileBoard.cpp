@@ -0,0 +1,453 @@
+#include "TileBoard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+/*
+*	Resizes the board to width x height and sets every tile
+*	to be hidden, unmarked and empty. If the board keeps its
+*	number of chunks the planes it owns are zeroed and kept
+*	for the new tiles, otherwise all planes are freed and
+*	allocated again as tiles of a chunk change.
+*/
+void TileBoard::Reset(std::uint32_t width, std::uint32_t height)
+{
+	const std::uint32_t cChunkColumns{ (width + CHUNK_MASK) >> CHUNK_SHIFT };
+	const std::uint32_t cChunkRows{ (height + CHUNK_MASK) >> CHUNK_SHIFT };
+
+	if (cChunkColumns == m_cChunkColumns && cChunkRows == m_cChunkRows)
+	{
+		for (Chunk& chunk : m_aChunks)
+		{
+			ClearChunk(chunk);
+		}
+	}
+	else
+	{
+		m_aChunks.clear();
+		m_aChunks.resize(static_cast<std::size_t>(cChunkColumns) * cChunkRows);
+	}
+
+	m_width = width;
+	m_height = height;
+	m_cTiles = width * height;
+	m_cChunkColumns = cChunkColumns;
+	m_cChunkRows = cChunkRows;
+	m_pStorage.reset();
+	m_aMarkedTiles.clear();
+	m_cIndexedMarks = 0;
+	m_bMarksIndexed = true;
+
+	for (std::uint32_t chunkY{ 0 }; chunkY < m_cChunkRows; ++chunkY)
+	{
+		const std::uint32_t chunkHeight{ std::min(CHUNK_SIZE, height - (chunkY << CHUNK_SHIFT)) };
+
+		for (std::uint32_t chunkX{ 0 }; chunkX < m_cChunkColumns; ++chunkX)
+		{
+			const std::uint32_t chunkWidth{ std::min(CHUNK_SIZE, width - (chunkX << CHUNK_SHIFT)) };
+			m_aChunks[chunkX + chunkY * m_cChunkColumns].cTiles = chunkWidth * chunkHeight;
+		}
+	}
+}
+
+// Removes every question mark from the board, only the marked tiles are visited.
+void TileBoard::ClearQuestionMarks()
+{
+	ForEachMarkedTile([this](std::uint32_t tile, TileMark mark)
+	{
+		if (mark == TileMark::QUESTION_MARK)
+		{
+			SetMark(tile, TileMark::NONE);
+		}
+	});
+}
+
+// Returns the number of bytes allocated for the planes of all chunks.
+std::size_t TileBoard::GetMemoryUsage() const
+{
+	std::size_t cBytes{ m_aChunks.size() * sizeof(Chunk) };
+
+	for (const Chunk& chunk : m_aChunks)
+	{
+		cBytes += GetPlaneBytes(chunk);
+	}
+
+	return cBytes;
+}
+
+TileBoard::ChunkPlanes TileBoard::GetChunkPlanes(std::uint32_t chunk) const
+{
+	const Chunk& source{ m_aChunks[chunk] };
+	return { source.pMines.get(), source.pCounts.get(), source.pStates.get(), source.pMarks.get(), source.uniformState, source.cRevealed };
+}
+
+/*
+*	Makes the chunk use the given planes, which stay owned by
+*	the storage of the board and must be valid and writable
+*	until the board is reset or the storage is released. The
+*	chunk's old planes are freed.
+*/
+void TileBoard::AdoptChunkPlanes(std::uint32_t chunk, const ChunkPlanes& planes)
+{
+	constexpr PlaneDeleter ADOPTED{ false };
+	Chunk& target{ m_aChunks[chunk] };
+
+	target.pMines = Plane<std::uint64_t>{ planes.pMines, ADOPTED };
+	target.pCounts = Plane<std::uint8_t>{ planes.pCounts, ADOPTED };
+	target.pStates = Plane<std::uint8_t>{ planes.pStates, ADOPTED };
+	target.pMarks = Plane<std::uint8_t>{ planes.pMarks, ADOPTED };
+	target.uniformState = planes.uniformState;
+	target.cRevealed = planes.cRevealed;
+
+	// Reading the marks now would read the planes, they are indexed once they are first needed.
+	m_bMarksIndexed = m_bMarksIndexed && !planes.pMarks;
+}
+
+// Keeps pStorage, the memory of the adopted planes, alive until the board is reset or the storage is released.
+void TileBoard::SetStorage(std::shared_ptr<void> pStorage)
+{
+	m_pStorage = std::move(pStorage);
+}
+
+/*
+*	Copies the adopted planes into planes of the board and
+*	releases the storage, e.g. so the file it maps can be
+*	overwritten. Reads every page of the storage.
+*/
+void TileBoard::ReleaseStorage()
+{
+	for (Chunk& chunk : m_aChunks)
+	{
+		OwnPlanes(chunk);
+	}
+
+	m_pStorage.reset();
+}
+
+/*
+*	Returns a board holding the same tiles that shares the
+*	planes of this one instead of copying them. The planes of
+*	a chunk move into a block both boards keep alive and the
+*	chunk copies them before its next change, so sharing only
+*	allocates a block per chunk changed since it was last
+*	shared. The returned board has no mark index.
+*/
+std::shared_ptr<const TileBoard> TileBoard::Share()
+{
+	const std::shared_ptr<TileBoard> pBoard{ std::make_shared<TileBoard>() };
+
+	const auto share{ [](auto& pPlane, auto& pOwner)
+	{
+		pOwner = std::move(pPlane);
+		pPlane = std::decay_t<decltype(pPlane)>{ pOwner.get(), PlaneDeleter{ false } };
+	} };
+
+	const auto view{ [](const auto& pPlane)
+	{
+		return std::decay_t<decltype(pPlane)>{ pPlane.get(), PlaneDeleter{ false } };
+	} };
+
+	pBoard->m_width = m_width;
+	pBoard->m_height = m_height;
+	pBoard->m_cTiles = m_cTiles;
+	pBoard->m_cChunkColumns = m_cChunkColumns;
+	pBoard->m_cChunkRows = m_cChunkRows;
+	pBoard->m_pStorage = m_pStorage;
+	pBoard->m_aChunks.resize(m_aChunks.size());
+	pBoard->m_bMarksIndexed = false;
+
+	for (std::size_t i{ 0 }; i < m_aChunks.size(); ++i)
+	{
+		Chunk& chunk{ m_aChunks[i] };
+		Chunk& shared{ pBoard->m_aChunks[i] };
+
+		if (!chunk.pShared && (chunk.pMines || chunk.pCounts || chunk.pStates || chunk.pMarks))
+		{
+			chunk.pShared = std::make_shared<Chunk>();
+			share(chunk.pMines, chunk.pShared->pMines);
+			share(chunk.pCounts, chunk.pShared->pCounts);
+			share(chunk.pStates, chunk.pShared->pStates);
+			share(chunk.pMarks, chunk.pShared->pMarks);
+		}
+
+		shared.pMines = view(chunk.pMines);
+		shared.pCounts = view(chunk.pCounts);
+		shared.pStates = view(chunk.pStates);
+		shared.pMarks = view(chunk.pMarks);
+		shared.uniformState = chunk.uniformState;
+		shared.cTiles = chunk.cTiles;
+		shared.cRevealed = chunk.cRevealed;
+		shared.pShared = chunk.pShared;
+	}
+
+	return pBoard;
+}
+
+// Makes the board copy every chunk into journal before changing it, until EndJournal is called.
+void TileBoard::BeginJournal(Journal& journal)
+{
+	m_pJournal = &journal;
+	++m_journalEpoch;
+}
+
+void TileBoard::EndJournal()
+{
+	m_pJournal = nullptr;
+}
+
+/*
+*	Puts the chunks of journal back into the board, and the
+*	chunks they replace into journal, so restoring it again
+*	redoes the change. Pressed tiles of the restored chunks
+*	are released, they only show a mouse button being held.
+*/
+void TileBoard::RestoreJournal(Journal& journal)
+{
+	journal.m_cBytes = 0;
+
+	for (std::size_t i{ 0 }; i < journal.m_aChunks.size(); ++i)
+	{
+		Chunk& chunk{ m_aChunks[journal.m_aChunkIndices[i]] };
+		Chunk& saved{ journal.m_aChunks[i] };
+
+		// A journal may outlive the storage, so it only gets planes of the board's own.
+		OwnPlanes(chunk);
+		std::swap(chunk, saved);
+		ReleasePressedTiles(chunk);
+		IndexChunkMarks(journal.m_aChunkIndices[i]);
+		journal.m_cBytes += sizeof(Chunk) + sizeof(std::uint32_t) + GetPlaneBytes(saved);
+	}
+}
+
+/*
+*	Sets the state of the tile at (x, y). A chunk whose tiles
+*	all share one state stores no state plane, it is filled
+*	in on the first change. When the last tile of a chunk is
+*	revealed the chunk is compacted by freeing its state and
+*	mark planes, marks are never drawn on revealed tiles.
+*/
+void TileBoard::SetState(std::uint32_t x, std::uint32_t y, TileState state)
+{
+	std::uint32_t local;
+	Chunk& chunk{ Locate(x, y, local) };
+	const TileState oldState{ GetState(chunk, local) };
+
+	if (oldState == state)
+	{
+		return;
+	}
+
+	JournalChunk(chunk);
+
+	if (!chunk.pStates)
+	{
+		chunk.pStates = AllocatePlane<std::uint8_t>(STATE_PLANE_BYTES);
+		std::memset(chunk.pStates.get(), static_cast<int>(chunk.uniformState) * 0x55, STATE_PLANE_BYTES);
+	}
+
+	SetCrumb(chunk.pStates.get(), local, static_cast<std::uint32_t>(state));
+
+	if (oldState == TileState::REVEALED)
+	{
+		--chunk.cRevealed;
+	}
+	else if (state == TileState::REVEALED && ++chunk.cRevealed == chunk.cTiles)
+	{
+		chunk.pStates.reset();
+		chunk.pMarks.reset();
+		chunk.uniformState = TileState::REVEALED;
+	}
+}
+
+/*
+*	Copies chunk into the recording journal. Tasks of the
+*	parallel flood fill change different chunks at the same
+*	time, so adding to the journal is locked.
+*/
+void TileBoard::RecordChunk(Chunk& chunk)
+{
+	const auto copy{ [](const auto& pPlane, std::size_t count)
+	{
+		using T = std::remove_reference_t<decltype(pPlane[0])>;
+		Plane<T> pCopy{};
+
+		if (pPlane)
+		{
+			pCopy = AllocatePlane<T>(count);
+			std::memcpy(pCopy.get(), pPlane.get(), count * sizeof(T));
+		}
+
+		return pCopy;
+	} };
+
+	Chunk saved{ copy(chunk.pMines, CHUNK_SIZE), copy(chunk.pCounts, COUNT_PLANE_BYTES), copy(chunk.pStates, STATE_PLANE_BYTES),
+		copy(chunk.pMarks, MARK_PLANE_BYTES), chunk.uniformState, chunk.cTiles, chunk.cRevealed };
+	const std::size_t cBytes{ sizeof(Chunk) + sizeof(std::uint32_t) + GetPlaneBytes(saved) };
+
+	chunk.journalEpoch = m_journalEpoch;
+
+	const std::lock_guard<std::mutex> lock{ *m_pJournalLock };
+	m_pJournal->m_aChunkIndices.push_back(static_cast<std::uint32_t>(&chunk - m_aChunks.data()));
+	m_pJournal->m_aChunks.push_back(std::move(saved));
+	m_pJournal->m_cBytes += cBytes;
+}
+
+/*
+*	Sets every tile of chunk to be hidden, unmarked and empty.
+*	The planes the board owns are zeroed to be used again,
+*	adopted and shared planes are dropped.
+*/
+void TileBoard::ClearChunk(Chunk& chunk)
+{
+	const auto clear{ [](auto& pPlane, std::size_t cBytes)
+	{
+		if (pPlane && pPlane.get_deleter().bOwned)
+		{
+			std::memset(pPlane.get(), 0, cBytes);
+		}
+		else
+		{
+			pPlane.reset();
+		}
+	} };
+
+	clear(chunk.pMines, MINE_PLANE_BYTES);
+	clear(chunk.pCounts, COUNT_PLANE_BYTES);
+	clear(chunk.pStates, STATE_PLANE_BYTES);
+	clear(chunk.pMarks, MARK_PLANE_BYTES);
+	chunk.pShared.reset();
+	chunk.uniformState = TileState::HIDDEN;
+	chunk.cRevealed = 0;
+}
+
+/*
+*	Adds a tile that was just marked to the mark index. The
+*	index isn't searched for the tile, so it is compacted
+*	once it has doubled in size since it last was, which
+*	keeps marking a tile O(1) amortized.
+*/
+void TileBoard::IndexMark(std::uint32_t index)
+{
+	constexpr std::size_t MIN_COMPACT_SIZE{ 64 };
+
+	if (m_bMarksIndexed)
+	{
+		m_aMarkedTiles.push_back(index);
+
+		if (m_aMarkedTiles.size() > 2 * m_cIndexedMarks + MIN_COMPACT_SIZE)
+		{
+			CompactMarkIndex();
+		}
+	}
+}
+
+/*
+*	Adds the marked tiles of a chunk to the mark index, e.g.
+*	after the chunk was restored from a journal. Each byte of
+*	the mark plane holds four marks, so bytes without marks
+*	are skipped at once.
+*/
+void TileBoard::IndexChunkMarks(std::uint32_t chunk)
+{
+	const std::uint8_t* pMarks{ m_aChunks[chunk].pMarks.get() };
+
+	if (!m_bMarksIndexed || !pMarks)
+	{
+		return;
+	}
+
+	const std::uint32_t xBegin{ (chunk % m_cChunkColumns) << CHUNK_SHIFT };
+	const std::uint32_t yBegin{ (chunk / m_cChunkColumns) << CHUNK_SHIFT };
+
+	for (std::uint32_t i{ 0 }; i < MARK_PLANE_BYTES; ++i)
+	{
+		if (pMarks[i])
+		{
+			for (std::uint32_t local{ i << 2 }; local < (i + 1) << 2; ++local)
+			{
+				if (GetCrumb(pMarks, local) != 0)
+				{
+					m_aMarkedTiles.push_back(xBegin + (local & CHUNK_MASK) + (yBegin + (local >> CHUNK_SHIFT)) * m_width);
+				}
+			}
+		}
+	}
+}
+
+/*
+*	Drops the tiles that lost their mark and the duplicates
+*	from the mark index and sorts it. An index left out of
+*	date by adopted planes is built again from the planes.
+*/
+void TileBoard::CompactMarkIndex()
+{
+	if (!m_bMarksIndexed)
+	{
+		m_bMarksIndexed = true;
+		m_aMarkedTiles.clear();
+
+		for (std::uint32_t chunk{ 0 }; chunk < GetChunkCount(); ++chunk)
+		{
+			IndexChunkMarks(chunk);
+		}
+	}
+
+	m_aMarkedTiles.erase(std::remove_if(m_aMarkedTiles.begin(), m_aMarkedTiles.end(),
+		[this](std::uint32_t tile) { return GetMark(tile) == TileMark::NONE; }), m_aMarkedTiles.end());
+	std::sort(m_aMarkedTiles.begin(), m_aMarkedTiles.end());
+	m_aMarkedTiles.erase(std::unique(m_aMarkedTiles.begin(), m_aMarkedTiles.end()), m_aMarkedTiles.end());
+	m_cIndexedMarks = m_aMarkedTiles.size();
+}
+
+// Returns the bytes allocated for the planes of chunk.
+std::size_t TileBoard::GetPlaneBytes(const Chunk& chunk)
+{
+	return (chunk.pMines ? MINE_PLANE_BYTES : 0) + (chunk.pCounts ? COUNT_PLANE_BYTES : 0) +
+		(chunk.pStates ? STATE_PLANE_BYTES : 0) + (chunk.pMarks ? MARK_PLANE_BYTES : 0);
+}
+
+// Replaces the planes of chunk that point into the storage, or are shared, with copies the board owns.
+void TileBoard::OwnPlanes(Chunk& chunk)
+{
+	const auto own{ [](auto& pPlane, std::size_t count)
+	{
+		using T = std::remove_reference_t<decltype(pPlane[0])>;
+
+		if (pPlane && !pPlane.get_deleter().bOwned)
+		{
+			Plane<T> pCopy{ AllocatePlane<T>(count) };
+			std::memcpy(pCopy.get(), pPlane.get(), count * sizeof(T));
+			pPlane = std::move(pCopy);
+		}
+	} };
+
+	own(chunk.pMines, CHUNK_SIZE);
+	own(chunk.pCounts, COUNT_PLANE_BYTES);
+	own(chunk.pStates, STATE_PLANE_BYTES);
+	own(chunk.pMarks, MARK_PLANE_BYTES);
+	chunk.pShared.reset();
+}
+
+/*
+*	Sets the pressed tiles of chunk back to hidden. A tile is
+*	pressed when the low bit of its state is set and its high
+*	bit is not, so a byte of the state plane is done at once.
+*/
+void TileBoard::ReleasePressedTiles(Chunk& chunk)
+{
+	static_assert(static_cast<int>(TileState::CLICKED) == 0b01 && static_cast<int>(TileState::REVEALED) == 0b10);
+
+	if (chunk.pStates)
+	{
+		for (std::uint32_t i{ 0 }; i < STATE_PLANE_BYTES; ++i)
+		{
+			std::uint8_t& packed{ chunk.pStates[i] };
+			packed = static_cast<std::uint8_t>(packed & ~(packed & 0x55 & ~((packed & 0xAA) >> 1)));
+		}
+	}
+	else if (chunk.uniformState == TileState::CLICKED)
+	{
+		chunk.uniformState = TileState::HIDDEN;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,463 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "enums.h"
+
+/*
+*	Stores the tiles of a minefield in square chunks of
+*	CHUNK_SIZE x CHUNK_SIZE tiles. Each chunk holds packed,
+*	row-major planes instead of an array of tile objects:
+*		- a mine bitplane (1 bit per tile, one word per row)
+*		- adjacent mine counts (4 bits per tile)
+*		- tile states (2 bits per tile)
+*		- tile marks (2 bits per tile)
+*	so that scans over a single property only touch the
+*	memory holding that property.
+*
+*	Planes are only allocated once a tile of the chunk gets
+*	a non zero value, so hidden chunks far away from any
+*	mine cost almost nothing. Once every tile of a chunk is
+*	revealed its state and mark planes are freed again.
+*	Resetting a board to the same number of chunks keeps the
+*	planes and zeroes them instead, so games played back to
+*	back on one board don't allocate anything.
+*
+*	The tiles that have a mark are kept in an index, so
+*	that going over every mark, e.g. to clear the question
+*	marks, takes as long as there are marks and not tiles.
+*
+*	Tiles are still addressed by their row-major index in
+*	the whole board, or by their (x, y) position, which finds
+*	their chunk without dividing by the width. Loops going
+*	over the board row by row use the latter.
+*
+*	A board can also use planes in memory it doesn't own,
+*	e.g. a copy-on-write view of a saved game, so that the
+*	planes of a chunk are only read from disk once a tile of
+*	the chunk is accessed.
+*
+*	While a Journal records, the board copies every chunk
+*	before its first change, so that the change can be
+*	undone by putting the copies back. Only the chunks a
+*	change touches are copied.
+*
+*	Share hands out a read-only copy of the board that shares
+*	the planes with it, e.g. for another thread to read while
+*	the game goes on. A shared chunk copies its planes before
+*	its next change, the same way a journal does.
+*/
+class TileBoard
+{
+public:
+	static constexpr std::uint32_t CHUNK_SHIFT{ 6 };
+	static constexpr std::uint32_t CHUNK_SIZE{ 1 << CHUNK_SHIFT };
+	static constexpr std::uint32_t CHUNK_MASK{ CHUNK_SIZE - 1 };
+	static constexpr std::uint32_t CHUNK_TILES{ CHUNK_SIZE * CHUNK_SIZE };
+
+	static constexpr std::size_t MINE_PLANE_BYTES{ CHUNK_SIZE * sizeof(std::uint64_t) };
+	static constexpr std::size_t COUNT_PLANE_BYTES{ CHUNK_TILES / 2 };
+	static constexpr std::size_t STATE_PLANE_BYTES{ CHUNK_TILES / 4 };
+	static constexpr std::size_t MARK_PLANE_BYTES{ CHUNK_TILES / 4 };
+
+	// The planes of one chunk, a plane that is not allocated is null.
+	struct ChunkPlanes
+	{
+		std::uint64_t* pMines{ nullptr };
+		std::uint8_t* pCounts{ nullptr };
+		std::uint8_t* pStates{ nullptr };
+		std::uint8_t* pMarks{ nullptr };
+		TileState uniformState{ TileState::HIDDEN };		// State of every tile while pStates is null.
+		std::uint32_t cRevealed{ 0 };
+	};
+
+	class Journal;
+
+	TileBoard() {}
+	TileBoard(std::uint32_t width, std::uint32_t height) { Reset(width, height); }
+
+	void Reset(std::uint32_t width, std::uint32_t height);
+	void ClearQuestionMarks();
+
+	/*
+	*	Calls function with every tile that has a mark and its
+	*	mark, in row-major order. function may change the marks
+	*	of the tiles it is called with.
+	*/
+	template <typename Function>
+	void ForEachMarkedTile(Function&& function)
+	{
+		CompactMarkIndex();
+
+		for (std::size_t i{ 0 }, cMarked{ m_aMarkedTiles.size() }; i < cMarked; ++i)
+		{
+			const std::uint32_t tile{ m_aMarkedTiles[i] };
+			function(tile, GetMark(tile));
+		}
+	}
+
+	std::uint32_t GetWidth() const { return m_width; }
+	std::uint32_t GetHeight() const { return m_height; }
+	std::uint32_t GetSize() const { return m_cTiles; }
+	std::uint32_t GetChunkColumns() const { return m_cChunkColumns; }
+	std::uint32_t GetChunkRows() const { return m_cChunkRows; }
+	std::size_t GetMemoryUsage() const;
+
+	std::uint32_t GetChunkCount() const { return static_cast<std::uint32_t>(m_aChunks.size()); }
+	ChunkPlanes GetChunkPlanes(std::uint32_t chunk) const;
+	void AdoptChunkPlanes(std::uint32_t chunk, const ChunkPlanes& planes);
+	void SetStorage(std::shared_ptr<void> pStorage);
+	void ReleaseStorage();
+	std::shared_ptr<const TileBoard> Share();
+
+	void BeginJournal(Journal& journal);
+	void EndJournal();
+	void RestoreJournal(Journal& journal);
+
+	bool IsMine(std::uint32_t index) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(index, local) };
+		return IsMine(chunk, local);
+	}
+
+	bool IsMine(std::uint32_t x, std::uint32_t y) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(x, y, local) };
+		return IsMine(chunk, local);
+	}
+
+	void SetMine(std::uint32_t index, bool bMine)
+	{
+		std::uint32_t local;
+		Chunk& chunk{ Locate(index, local) };
+
+		if (!chunk.pMines && !bMine)
+		{
+			return;
+		}
+
+		JournalChunk(chunk);
+
+		if (!chunk.pMines)
+		{
+			chunk.pMines = AllocatePlane<std::uint64_t>(CHUNK_SIZE);
+		}
+
+		const std::uint64_t bit{ std::uint64_t{ 1 } << (local & CHUNK_MASK) };
+		std::uint64_t& row{ chunk.pMines[local >> CHUNK_SHIFT] };
+		row = bMine ? (row | bit) : (row & ~bit);
+	}
+
+	std::uint32_t GetAdjacentCount(std::uint32_t index) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(index, local) };
+		return GetAdjacentCount(chunk, local);
+	}
+
+	std::uint32_t GetAdjacentCount(std::uint32_t x, std::uint32_t y) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(x, y, local) };
+		return GetAdjacentCount(chunk, local);
+	}
+
+	void SetAdjacentCount(std::uint32_t index, std::uint32_t count)
+	{
+		std::uint32_t local;
+		Chunk& chunk{ Locate(index, local) };
+
+		if (!chunk.pCounts && count == 0)
+		{
+			return;
+		}
+
+		JournalChunk(chunk);
+
+		if (!chunk.pCounts)
+		{
+			chunk.pCounts = AllocatePlane<std::uint8_t>(COUNT_PLANE_BYTES);
+		}
+
+		const std::uint32_t shift{ (local & 1) << 2 };
+		std::uint8_t& packed{ chunk.pCounts[local >> 1] };
+		packed = static_cast<std::uint8_t>((packed & ~(0xF << shift)) | ((count & 0xF) << shift));
+	}
+
+	TileState GetState(std::uint32_t index) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(index, local) };
+		return GetState(chunk, local);
+	}
+
+	TileState GetState(std::uint32_t x, std::uint32_t y) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(x, y, local) };
+		return GetState(chunk, local);
+	}
+
+	void SetState(std::uint32_t index, TileState state) { SetState(index % m_width, index / m_width, state); }
+	void SetState(std::uint32_t x, std::uint32_t y, TileState state);
+
+	TileMark GetMark(std::uint32_t index) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(index, local) };
+		return GetMark(chunk, local);
+	}
+
+	TileMark GetMark(std::uint32_t x, std::uint32_t y) const
+	{
+		std::uint32_t local;
+		const Chunk& chunk{ Locate(x, y, local) };
+		return GetMark(chunk, local);
+	}
+
+	void SetMark(std::uint32_t index, TileMark mark)
+	{
+		std::uint32_t local;
+		Chunk& chunk{ Locate(index, local) };
+
+		if (!chunk.pMarks && mark == TileMark::NONE)
+		{
+			return;
+		}
+
+		JournalChunk(chunk);
+
+		if (!chunk.pMarks)
+		{
+			chunk.pMarks = AllocatePlane<std::uint8_t>(MARK_PLANE_BYTES);
+		}
+
+		const bool bWasMarked{ GetCrumb(chunk.pMarks.get(), local) != 0 };
+		SetCrumb(chunk.pMarks.get(), local, static_cast<std::uint32_t>(mark));
+
+		if (!bWasMarked && mark != TileMark::NONE)
+		{
+			IndexMark(index);
+		}
+	}
+
+	/*
+	*	Sets the adjacent mine counts of one row of a chunk from
+	*	CHUNK_SIZE / 2 bytes of packed 4 bit counts, laid out
+	*	like the rows of the count plane.
+	*/
+	void SetAdjacentCountRow(std::uint32_t chunkX, std::uint32_t chunkY, std::uint32_t row, const std::uint8_t* pPacked)
+	{
+		constexpr std::uint32_t ROW_BYTES{ CHUNK_SIZE / 2 };
+		Chunk& chunk{ m_aChunks[chunkX + chunkY * m_cChunkColumns] };
+
+		if (!chunk.pCounts && std::all_of(pPacked, pPacked + ROW_BYTES, [](std::uint8_t packed) { return packed == 0; }))
+		{
+			return;
+		}
+
+		JournalChunk(chunk);
+
+		if (!chunk.pCounts)
+		{
+			chunk.pCounts = AllocatePlane<std::uint8_t>(COUNT_PLANE_BYTES);
+		}
+
+		std::memcpy(&chunk.pCounts[row * ROW_BYTES], pPacked, ROW_BYTES);
+	}
+
+	/*
+	*	Returns the mines of one row of a chunk as a bitmask,
+	*	bit i being the tile in column i of the chunk. Chunks
+	*	outside of the board or without mines return 0.
+	*/
+	std::uint64_t GetMineRow(std::uint32_t chunkX, std::uint32_t chunkY, std::uint32_t row) const
+	{
+		if (chunkX >= m_cChunkColumns || chunkY >= m_cChunkRows)
+		{
+			return 0;
+		}
+
+		const Chunk& chunk{ m_aChunks[chunkX + chunkY * m_cChunkColumns] };
+		return chunk.pMines ? chunk.pMines[row] : 0;
+	}
+
+	// Returns if the chunk at (chunkX, chunkY) has any mines.
+	bool HasMines(std::uint32_t chunkX, std::uint32_t chunkY) const
+	{
+		return static_cast<bool>(m_aChunks[chunkX + chunkY * m_cChunkColumns].pMines);
+	}
+
+	// Returns if every tile of the chunk at (chunkX, chunkY) is revealed.
+	bool IsChunkRevealed(std::uint32_t chunkX, std::uint32_t chunkY) const
+	{
+		const Chunk& chunk{ m_aChunks[chunkX + chunkY * m_cChunkColumns] };
+		return !chunk.pStates && chunk.uniformState == TileState::REVEALED;
+	}
+
+private:
+	// Frees the planes the board allocated itself, adopted planes belong to the storage of the board.
+	struct PlaneDeleter
+	{
+		bool bOwned;
+
+		constexpr PlaneDeleter() : bOwned{ true } {}
+		constexpr explicit PlaneDeleter(bool bOwnedPlane) : bOwned{ bOwnedPlane } {}
+
+		template <typename T>
+		void operator()(T* pPlane) const
+		{
+			if (bOwned)
+			{
+				delete[] pPlane;
+			}
+		}
+	};
+
+	template <typename T>
+	using Plane = std::unique_ptr<T[], PlaneDeleter>;
+
+	struct Chunk
+	{
+		Plane<std::uint64_t> pMines{};						// 1 bit per tile, set if the tile holds a mine.
+		Plane<std::uint8_t> pCounts{};						// 4 bits per tile, number of adjacent mines.
+		Plane<std::uint8_t> pStates{};						// 2 bits per tile, holds a TileState.
+		Plane<std::uint8_t> pMarks{};						// 2 bits per tile, holds a TileMark.
+		TileState uniformState{ TileState::HIDDEN };		// State of every tile while pStates is not allocated.
+		std::uint32_t cTiles{ 0 };							// Number of tiles of the chunk inside the board.
+		std::uint32_t cRevealed{ 0 };						// Number of revealed tiles in the chunk.
+		std::uint32_t journalEpoch{ 0 };					// m_journalEpoch of the journal that last copied the chunk.
+		std::shared_ptr<Chunk> pShared{};					// Owns the planes while they are shared with a board from Share.
+	};
+
+public:
+	// The chunks a change of the board touched, as they were before it.
+	class Journal
+	{
+	public:
+		bool IsEmpty() const { return m_aChunkIndices.empty(); }
+		const std::vector<std::uint32_t>& GetChunks() const { return m_aChunkIndices; }
+		std::size_t GetMemoryUsage() const { return m_cBytes; }
+
+	private:
+		friend class TileBoard;
+
+		std::vector<std::uint32_t> m_aChunkIndices{};
+		std::vector<Chunk> m_aChunks{};
+		std::size_t m_cBytes{ 0 };
+	};
+
+private:
+
+	std::uint32_t m_width{ 0 };
+	std::uint32_t m_height{ 0 };
+	std::uint32_t m_cTiles{ 0 };
+	std::uint32_t m_cChunkColumns{ 0 };
+	std::uint32_t m_cChunkRows{ 0 };
+
+	std::shared_ptr<void> m_pStorage{};						// Memory of the adopted planes, outlives the chunks.
+	std::vector<Chunk> m_aChunks{};							// Chunks in row-major order.
+	std::vector<std::uint32_t> m_aMarkedTiles{};			// Every marked tile, may also hold duplicates and tiles unmarked since.
+	std::size_t m_cIndexedMarks{ 0 };						// Size of m_aMarkedTiles when it was last compacted.
+	bool m_bMarksIndexed{ true };							// Cleared when adopted planes bring marks that are not indexed.
+	Journal* m_pJournal{ nullptr };							// Journal recording the changes, if any.
+	std::uint32_t m_journalEpoch{ 0 };						// Counts the journals, tells if a chunk was copied by this one.
+	std::unique_ptr<std::mutex> m_pJournalLock{ std::make_unique<std::mutex>() };	// Guards m_pJournal against flood tasks.
+
+	template <typename T>
+	static Plane<T> AllocatePlane(std::size_t count)
+	{
+		return Plane<T>{ new T[count]{} };
+	}
+
+	// Finds the chunk holding the tile at (x, y) and the tile's index within that chunk.
+	const Chunk& Locate(std::uint32_t x, std::uint32_t y, std::uint32_t& local) const
+	{
+		local = (x & CHUNK_MASK) | ((y & CHUNK_MASK) << CHUNK_SHIFT);
+		return m_aChunks[(x >> CHUNK_SHIFT) + (y >> CHUNK_SHIFT) * m_cChunkColumns];
+	}
+
+	Chunk& Locate(std::uint32_t x, std::uint32_t y, std::uint32_t& local)
+	{
+		return const_cast<Chunk&>(static_cast<const TileBoard&>(*this).Locate(x, y, local));
+	}
+
+	// Like Locate(x, y, local) for the tile at index, which costs a division by the width.
+	const Chunk& Locate(std::uint32_t index, std::uint32_t& local) const
+	{
+		return Locate(index % m_width, index / m_width, local);
+	}
+
+	Chunk& Locate(std::uint32_t index, std::uint32_t& local)
+	{
+		return Locate(index % m_width, index / m_width, local);
+	}
+
+	// Read the planes of chunk for its tile local.
+	static bool IsMine(const Chunk& chunk, std::uint32_t local)
+	{
+		return chunk.pMines && ((chunk.pMines[local >> CHUNK_SHIFT] >> (local & CHUNK_MASK)) & 1);
+	}
+
+	static std::uint32_t GetAdjacentCount(const Chunk& chunk, std::uint32_t local)
+	{
+		return chunk.pCounts ? (chunk.pCounts[local >> 1] >> ((local & 1) << 2)) & 0xF : 0;
+	}
+
+	static TileState GetState(const Chunk& chunk, std::uint32_t local)
+	{
+		return chunk.pStates ? static_cast<TileState>(GetCrumb(chunk.pStates.get(), local)) : chunk.uniformState;
+	}
+
+	static TileMark GetMark(const Chunk& chunk, std::uint32_t local)
+	{
+		return chunk.pMarks ? static_cast<TileMark>(GetCrumb(chunk.pMarks.get(), local)) : TileMark::NONE;
+	}
+
+	/*
+	*	Called before chunk is changed, copies the planes it
+	*	shares with a board from Share, and copies it into the
+	*	recording journal unless it already holds it.
+	*/
+	void JournalChunk(Chunk& chunk)
+	{
+		if (chunk.pShared)
+		{
+			OwnPlanes(chunk);
+		}
+
+		if (m_pJournal && chunk.journalEpoch != m_journalEpoch)
+		{
+			RecordChunk(chunk);
+		}
+	}
+
+	void RecordChunk(Chunk& chunk);
+	void ClearChunk(Chunk& chunk);
+	void IndexMark(std::uint32_t index);
+	void IndexChunkMarks(std::uint32_t chunk);
+	void CompactMarkIndex();
+	static std::size_t GetPlaneBytes(const Chunk& chunk);
+	static void OwnPlanes(Chunk& chunk);
+	static void ReleasePressedTiles(Chunk& chunk);
+
+	// Helpers to access the 2 bit fields of the state and mark planes.
+	static std::uint32_t GetCrumb(const std::uint8_t* pPlane, std::uint32_t index)
+	{
+		return (pPlane[index >> 2] >> ((index & 3) << 1)) & 0x3;
+	}
+
+	static void SetCrumb(std::uint8_t* pPlane, std::uint32_t index, std::uint32_t value)
+	{
+		const std::uint32_t shift{ (index & 3) << 1 };
+		std::uint8_t& packed{ pPlane[index >> 2] };
+		packed = static_cast<std::uint8_t>((packed & ~(0x3 << shift)) | ((value & 0x3) << shift));
+	}
+};
\ No newline at end of file
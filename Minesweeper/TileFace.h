@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+
+#include "enums.h"
+#include "MineTile.h"
+
+/*
+*	Every distinct way a tile can look. A tile's face only
+*	depends on the tile itself and on whether the game was
+*	lost or won, so renderers can draw each face once and
+*	copy it for every tile showing it.
+*/
+enum class TileFace : std::uint8_t
+{
+	HIDDEN,
+	HIDDEN_FLAG,
+	HIDDEN_QUESTION_MARK,
+	PRESSED,
+	REVEALED_EMPTY,			// REVEALED_EMPTY + n shows the number n.
+	REVEALED_ONE,
+	REVEALED_TWO,
+	REVEALED_THREE,
+	REVEALED_FOUR,
+	REVEALED_FIVE,
+	REVEALED_SIX,
+	REVEALED_SEVEN,
+	REVEALED_EIGHT,
+	MINE_EXPLODED,			// A revealed mine.
+	MINE,					// A hidden mine once the game is lost.
+	WRONG_FLAG,				// A flag on a tile without a mine once the game is lost.
+	WON_FLAG,				// A mine once the game is won.
+	WON_QUESTION_MARK,		// A question marked mine once the game is won.
+	COUNT,
+};
+
+inline constexpr std::uint32_t TILE_FACE_COUNT{ static_cast<std::uint32_t>(TileFace::COUNT) };
+
+// Returns the face of a tile, given if the game is lost or won.
+inline TileFace GetTileFace(const MineTile& tile, bool bGameLost, bool bGameWon)
+{
+	const bool bMine{ tile.GetTileContent() == TileContent::MINE };
+
+	switch (tile.GetTileState())
+	{
+	case TileState::CLICKED:
+		return TileFace::PRESSED;
+
+	case TileState::REVEALED:
+		return bMine ? TileFace::MINE_EXPLODED :
+			static_cast<TileFace>(static_cast<std::uint32_t>(TileFace::REVEALED_EMPTY) + static_cast<std::uint32_t>(tile.GetTileContent()));
+
+	default:
+		break;
+	}
+
+	const TileMark mark{ tile.GetTileMark() };
+
+	if (bGameLost)
+	{
+		if (bMine)
+		{
+			return (mark == TileMark::FLAG) ? TileFace::HIDDEN_FLAG : TileFace::MINE;
+		}
+
+		return (mark == TileMark::FLAG) ? TileFace::WRONG_FLAG : TileFace::HIDDEN;
+	}
+
+	if (bGameWon && bMine)
+	{
+		return (mark == TileMark::QUESTION_MARK) ? TileFace::WON_QUESTION_MARK : TileFace::WON_FLAG;
+	}
+
+	switch (mark)
+	{
+	case TileMark::FLAG:
+		return TileFace::HIDDEN_FLAG;
+	case TileMark::QUESTION_MARK:
+		return TileFace::HIDDEN_QUESTION_MARK;
+	default:
+		return TileFace::HIDDEN;
+	}
+}
\ No newline at end of file
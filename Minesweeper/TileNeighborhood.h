@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+/*
+*	A range over the indices of all tiles in a square grid
+*	centered at (x, y) with a given radius, clipped to the
+*	edges of a width x height minefield. Tiles are visited
+*	in row-major order, so the indices are sorted.
+*
+*	The range only stores its clipped bounds, so iterating
+*	it never allocates, e.g.
+*		for (std::uint32_t tile : TileNeighborhood(x, y, 1, width, height))
+*/
+class TileNeighborhood
+{
+public:
+	class Iterator
+	{
+	public:
+		Iterator(const TileNeighborhood& range, std::uint32_t x, std::uint32_t y) : m_pRange{ &range }, m_x{ x }, m_y{ y } {}
+
+		std::uint32_t operator*() const { return m_x + m_y * m_pRange->m_width; }
+
+		Iterator& operator++()
+		{
+			if (++m_x > m_pRange->m_xMax)
+			{
+				m_x = m_pRange->m_xMin;
+				++m_y;
+			}
+
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const { return m_x == other.m_x && m_y == other.m_y; }
+		bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+	private:
+		const TileNeighborhood* m_pRange{ nullptr };
+		std::uint32_t m_x{ 0 };
+		std::uint32_t m_y{ 0 };
+	};
+
+	TileNeighborhood(std::uint32_t x, std::uint32_t y, std::uint32_t radius, std::uint32_t width, std::uint32_t height) :
+		m_width{ width },
+		m_xMin{ x > radius ? x - radius : 0 },
+		m_yMin{ y > radius ? y - radius : 0 },
+		m_xMax{ (width - x > radius) ? x + radius : width - 1 },
+		m_yMax{ (height - y > radius) ? y + radius : height - 1 } {}
+
+	Iterator begin() const { return Iterator(*this, m_xMin, m_yMin); }
+	Iterator end() const { return Iterator(*this, m_xMin, m_yMax + 1); }
+
+	std::uint32_t size() const { return (m_xMax - m_xMin + 1) * (m_yMax - m_yMin + 1); }
+
+private:
+	std::uint32_t m_width{ 0 };
+	std::uint32_t m_xMin{ 0 };
+	std::uint32_t m_yMin{ 0 };
+	std::uint32_t m_xMax{ 0 };
+	std::uint32_t m_yMax{ 0 };
+};
\ No newline at end of file
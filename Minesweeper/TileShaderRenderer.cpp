@@ -0,0 +1,405 @@
+#include "TileShaderRenderer.h"
+
+#include <algorithm>
+
+#include <d3dcompiler.h>
+
+#pragma comment(lib, "d3dcompiler")
+
+namespace
+{
+	/*
+	*	Tile edges are placed exactly like MinefieldScene's
+	*	TileDrawRect places sprites, floor(v + 0.5) of the
+	*	unrounded edge, and faces are sampled the way sprites
+	*	are scaled with nearest neighbor interpolation, so both
+	*	renderers put the same atlas pixel on every pixel.
+	*/
+	constexpr char TILE_SHADER[]{ R"(
+cbuffer View : register(b0)
+{
+	float2 viewOffset;
+	float tileSize;
+	uint atlasTileSize;
+	uint atlasColumns;
+	float4 background;
+};
+
+Texture2D<uint> faces : register(t0);
+Texture2D<float4> atlas : register(t1);
+
+float4 VSMain(uint id : SV_VertexID) : SV_Position
+{
+	float2 uv = float2((id << 1) & 2, id & 2);
+	return float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+}
+
+int2 TileEdge(int2 tile)
+{
+	return int2(floor(tile * tileSize - viewOffset + 0.5));
+}
+
+float4 PSMain(float4 position : SV_Position) : SV_Target
+{
+	uint width, height;
+	faces.GetDimensions(width, height);
+
+	int2 pixel = int2(position.xy);
+	int2 tile = int2(ceil((pixel + 0.5 + viewOffset) / tileSize)) - 1;
+
+	// Guard against rounding errors of the division.
+	tile -= int2(pixel < TileEdge(tile));
+	tile += int2(pixel >= TileEdge(tile + 1));
+
+	if (any(tile < 0) || any(tile >= int2(width, height)))
+	{
+		return background;
+	}
+
+	uint face = faces.Load(int3(tile, 0));
+	int2 tileMin = TileEdge(tile);
+	int2 extent = max(TileEdge(tile + 1) - tileMin, 1);
+	int2 texel = min(int2((pixel - tileMin + 0.5) * atlasTileSize / extent), int(atlasTileSize) - 1);
+	int2 cell = int2(face % atlasColumns, face / atlasColumns) * (atlasTileSize + 2) + 1;
+
+	return atlas.Load(int3(cell + texel, 0));
+}
+)" };
+
+	// Layout of the View constant buffer, float4 values start on a 16 byte boundary.
+	struct ViewConstants
+	{
+		FLOAT viewOffset[2];
+		FLOAT tileSize;
+		UINT atlasTileSize;
+		UINT atlasColumns;
+		UINT padding[3];
+		FLOAT background[4];
+	};
+
+	static_assert(sizeof(ViewConstants) % 16 == 0);
+
+	HRESULT CompileShader(const char* pszEntryPoint, const char* pszTarget, ID3DBlob** ppCode)
+	{
+		CComPtr<ID3DBlob> pErrors{ nullptr };
+
+		return D3DCompile(TILE_SHADER, sizeof(TILE_SHADER) - 1, "TileShader", nullptr, nullptr, pszEntryPoint, pszTarget,
+			D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, ppCode, &pErrors);
+	}
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+// Compiles the shaders, fails on devices without Texture2D<uint> support (feature level 10 and up).
+HRESULT TileShaderRenderer::Initialize(ID3D11Device* pDevice)
+{
+	CComPtr<ID3DBlob> pVertexCode{ nullptr };
+	CComPtr<ID3DBlob> pPixelCode{ nullptr };
+
+	Release();
+
+	HRESULT hr = (pDevice->GetFeatureLevel() >= D3D_FEATURE_LEVEL_10_0) ? S_OK : E_NOTIMPL;
+
+	if (SUCCEEDED(hr))
+	{
+		m_pDevice = pDevice;
+		m_pDevice->GetImmediateContext(&m_pContext);
+
+		hr = CompileShader("VSMain", "vs_4_0", &pVertexCode);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = CompileShader("PSMain", "ps_4_0", &pPixelCode);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDevice->CreateVertexShader(pVertexCode->GetBufferPointer(), pVertexCode->GetBufferSize(), nullptr, &m_pVertexShader);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDevice->CreatePixelShader(pPixelCode->GetBufferPointer(), pPixelCode->GetBufferSize(), nullptr, &m_pPixelShader);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		const D3D11_BUFFER_DESC desc{ sizeof(ViewConstants), D3D11_USAGE_DEFAULT, D3D11_BIND_CONSTANT_BUFFER, 0, 0, 0 };
+		hr = m_pDevice->CreateBuffer(&desc, nullptr, &m_pViewBuffer);
+	}
+
+	if (FAILED(hr))
+	{
+		Release();
+	}
+
+	return hr;
+}
+
+void TileShaderRenderer::Release()
+{
+	m_pOutputBitmap.Release();
+	m_pOutputView.Release();
+	m_pOutput.Release();
+	m_pAtlasView.Release();
+	m_pAtlas.Release();
+	m_pFacesView.Release();
+	m_pFaces.Release();
+	m_pViewBuffer.Release();
+	m_pPixelShader.Release();
+	m_pVertexShader.Release();
+	m_pContext.Release();
+	m_pDevice.Release();
+
+	m_boardWidth = m_boardHeight = 0;
+	m_viewWidth = m_viewHeight = 0;
+	m_bFacesStale = TRUE;
+}
+
+/*
+*	Creates the face texture for a board of width x height
+*	tiles. Every face has to be set again afterwards, until
+*	then AreFacesStale returns TRUE.
+*/
+HRESULT TileShaderRenderer::ResizeBoard(UINT width, UINT height)
+{
+	m_pFacesView.Release();
+	m_pFaces.Release();
+
+	D3D11_TEXTURE2D_DESC desc{};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_R8_UINT;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	// Starts out with every tile HIDDEN on both sides.
+	m_aFaces.assign(static_cast<std::size_t>(width) * height, static_cast<std::uint8_t>(TileFace::HIDDEN));
+	m_aRowDirty.assign(height, 0);
+	m_aDirtyRows.clear();
+	m_bFacesStale = TRUE;
+
+	const D3D11_SUBRESOURCE_DATA initialData{ m_aFaces.data(), width, 0 };
+
+	HRESULT hr = m_pDevice->CreateTexture2D(&desc, &initialData, &m_pFaces);
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDevice->CreateShaderResourceView(m_pFaces, nullptr, &m_pFacesView);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		m_boardWidth = width;
+		m_boardHeight = height;
+	}
+	else
+	{
+		m_pFaces.Release();
+		m_boardWidth = m_boardHeight = 0;
+	}
+
+	return hr;
+}
+
+// Creates the texture the shader draws into, wrapped as a bitmap of pContext for GetOutput.
+HRESULT TileShaderRenderer::ResizeView(UINT width, UINT height, ID2D1DeviceContext* pContext)
+{
+	CComPtr<IDXGISurface> pSurface{ nullptr };
+
+	m_pOutputBitmap.Release();
+	m_pOutputView.Release();
+	m_pOutput.Release();
+
+	D3D11_TEXTURE2D_DESC desc{};
+	desc.Width = max(width, 1u);
+	desc.Height = max(height, 1u);
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+	HRESULT hr = m_pDevice->CreateTexture2D(&desc, nullptr, &m_pOutput);
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDevice->CreateRenderTargetView(m_pOutput, nullptr, &m_pOutputView);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pOutput.QueryInterface(&pSurface);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pContext->CreateBitmapFromDxgiSurface(pSurface, D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE,
+			D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE), 96.f, 96.f), &m_pOutputBitmap);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		m_viewWidth = width;
+		m_viewHeight = height;
+	}
+	else
+	{
+		m_pOutputBitmap.Release();
+		m_pOutputView.Release();
+		m_pOutput.Release();
+	}
+
+	return hr;
+}
+
+// Copies the tile atlas MinefieldScene built into a texture the shader can read.
+HRESULT TileShaderRenderer::SetAtlas(ID2D1Bitmap* pAtlas, ID2D1DeviceContext* pContext)
+{
+	CComPtr<IDXGISurface> pSurface{ nullptr };
+	CComPtr<ID2D1Bitmap1> pAtlasCopy{ nullptr };
+	const D2D1_SIZE_U size{ pAtlas->GetPixelSize() };
+
+	m_pAtlasView.Release();
+	m_pAtlas.Release();
+
+	D3D11_TEXTURE2D_DESC desc{};
+	desc.Width = size.width;
+	desc.Height = size.height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	HRESULT hr = m_pDevice->CreateTexture2D(&desc, nullptr, &m_pAtlas);
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pDevice->CreateShaderResourceView(m_pAtlas, nullptr, &m_pAtlasView);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = m_pAtlas.QueryInterface(&pSurface);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pContext->CreateBitmapFromDxgiSurface(pSurface, D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE,
+			pAtlas->GetPixelFormat(), 96.f, 96.f), &pAtlasCopy);
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		hr = pAtlasCopy->CopyFromBitmap(nullptr, pAtlas, nullptr);
+	}
+
+	if (FAILED(hr))
+	{
+		m_pAtlasView.Release();
+		m_pAtlas.Release();
+	}
+
+	return hr;
+}
+
+void TileShaderRenderer::SetFace(UINT x, UINT y, TileFace face)
+{
+	std::uint8_t& current{ m_aFaces[x + static_cast<std::size_t>(y) * m_boardWidth] };
+
+	if (current != static_cast<std::uint8_t>(face))
+	{
+		current = static_cast<std::uint8_t>(face);
+
+		if (!m_aRowDirty[y])
+		{
+			m_aRowDirty[y] = 1;
+			m_aDirtyRows.push_back(y);
+		}
+	}
+}
+
+/*
+*	Uploads the rows of the face texture that changed and
+*	draws the whole view. The D2D device context sharing the
+*	device has to be flushed before, D2D keeps its own state
+*	so nothing has to be restored afterwards other than the
+*	bindings of the output texture.
+*/
+void TileShaderRenderer::Draw(const View& view)
+{
+	if (!m_pFaces || !m_pAtlas || !m_pOutput)
+	{
+		return;
+	}
+
+	UploadDirtyRows();
+
+	const ViewConstants constants{ { view.viewX, view.viewY }, view.tileSize, view.atlasTileSize, view.atlasColumns, {},
+		{ view.background[0], view.background[1], view.background[2], view.background[3] } };
+	m_pContext->UpdateSubresource(m_pViewBuffer, 0, nullptr, &constants, 0, 0);
+
+	const D3D11_VIEWPORT viewport{ 0.f, 0.f, static_cast<FLOAT>(m_viewWidth), static_cast<FLOAT>(m_viewHeight), 0.f, 1.f };
+	ID3D11RenderTargetView* const apOutputs[]{ m_pOutputView };
+	ID3D11ShaderResourceView* const apResources[]{ m_pFacesView, m_pAtlasView };
+	ID3D11Buffer* const apBuffers[]{ m_pViewBuffer };
+
+	m_pContext->OMSetRenderTargets(1, apOutputs, nullptr);
+	m_pContext->RSSetViewports(1, &viewport);
+	m_pContext->IASetInputLayout(nullptr);
+	m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	m_pContext->VSSetShader(m_pVertexShader, nullptr, 0);
+	m_pContext->PSSetShader(m_pPixelShader, nullptr, 0);
+	m_pContext->PSSetShaderResources(0, 2, apResources);
+	m_pContext->PSSetConstantBuffers(0, 1, apBuffers);
+	m_pContext->Draw(3, 0);
+
+	// D2D reads the output next, it can't stay bound as a render target.
+	ID3D11ShaderResourceView* const apNoResources[]{ nullptr, nullptr };
+	m_pContext->PSSetShaderResources(0, 2, apNoResources);
+	m_pContext->OMSetRenderTargets(0, nullptr, nullptr);
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+// Uploads every run of consecutive dirty rows with one copy.
+void TileShaderRenderer::UploadDirtyRows()
+{
+	std::sort(m_aDirtyRows.begin(), m_aDirtyRows.end());
+
+	for (std::size_t i{ 0 }; i < m_aDirtyRows.size();)
+	{
+		const UINT top{ m_aDirtyRows[i] };
+		UINT bottom{ top + 1 };
+
+		while (++i < m_aDirtyRows.size() && m_aDirtyRows[i] == bottom)
+		{
+			++bottom;
+		}
+
+		const D3D11_BOX box{ 0, top, 0, m_boardWidth, bottom, 1 };
+		m_pContext->UpdateSubresource(m_pFaces, 0, &box, &m_aFaces[static_cast<std::size_t>(top) * m_boardWidth], m_boardWidth, 0);
+	}
+
+	for (const UINT row : m_aDirtyRows)
+	{
+		m_aRowDirty[row] = 0;
+	}
+
+	m_aDirtyRows.clear();
+}
\ No newline at end of file
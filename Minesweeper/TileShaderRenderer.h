@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <atlbase.h>
+#include <d2d1_1.h>
+#include <d3d11.h>
+#include <Windows.h>
+
+#include "TileFace.h"
+
+/*
+*	Draws the minefield on the GPU. The face of every tile is
+*	kept in an R8 texture of the board's size and a single
+*	full screen pixel shader looks up, for each pixel of the
+*	window, the tile under it and copies the matching pixel
+*	of the tile atlas. Only rows holding changed tiles are
+*	uploaded, so the CPU cost of a frame doesn't depend on
+*	the size of the board or how much of it is visible.
+*
+*	The result goes to a texture the size of the window that
+*	is shown through a D2D bitmap, which needs the D3D11 device
+*	of the flip model backend.
+*/
+class TileShaderRenderer
+{
+public:
+	// Placement of the board in the window, in window pixels, matching MinefieldScene's camera.
+	struct View
+	{
+		FLOAT viewX;
+		FLOAT viewY;
+		FLOAT tileSize;
+		UINT atlasTileSize;
+		UINT atlasColumns;
+		FLOAT background[4];
+	};
+
+	HRESULT	Initialize(ID3D11Device* pDevice);
+	void	Release();
+
+	HRESULT	ResizeBoard(UINT width, UINT height);
+	HRESULT	ResizeView(UINT width, UINT height, ID2D1DeviceContext* pContext);
+	HRESULT	SetAtlas(ID2D1Bitmap* pAtlas, ID2D1DeviceContext* pContext);
+
+	BOOL	IsInitialized() const { return m_pPixelShader != nullptr; }
+	BOOL	NeedsBoardResize(UINT width, UINT height) const { return !m_pFaces || width != m_boardWidth || height != m_boardHeight; }
+	BOOL	NeedsViewResize(UINT width, UINT height) const { return !m_pOutput || width != m_viewWidth || height != m_viewHeight; }
+	BOOL	AreFacesStale() const { return m_bFacesStale; }
+
+	void	SetFace(UINT x, UINT y, TileFace face);
+	void	SetAllFacesUploaded() { m_bFacesStale = FALSE; }
+	void	Draw(const View& view);
+
+	ID2D1Bitmap1*	GetOutput() const { return m_pOutputBitmap; }
+
+private:
+	void	UploadDirtyRows();
+
+	CComPtr<ID3D11Device> m_pDevice{ nullptr };
+	CComPtr<ID3D11DeviceContext> m_pContext{ nullptr };
+	CComPtr<ID3D11VertexShader> m_pVertexShader{ nullptr };
+	CComPtr<ID3D11PixelShader> m_pPixelShader{ nullptr };
+	CComPtr<ID3D11Buffer> m_pViewBuffer{ nullptr };
+
+	// One byte per tile holding its TileFace, mirrored on the CPU.
+	CComPtr<ID3D11Texture2D> m_pFaces{ nullptr };
+	CComPtr<ID3D11ShaderResourceView> m_pFacesView{ nullptr };
+	std::vector<std::uint8_t> m_aFaces{};
+	std::vector<std::uint8_t> m_aRowDirty{};
+	std::vector<UINT> m_aDirtyRows{};
+	UINT m_boardWidth{ 0 };
+	UINT m_boardHeight{ 0 };
+	BOOL m_bFacesStale{ TRUE };
+
+	CComPtr<ID3D11Texture2D> m_pAtlas{ nullptr };
+	CComPtr<ID3D11ShaderResourceView> m_pAtlasView{ nullptr };
+
+	CComPtr<ID3D11Texture2D> m_pOutput{ nullptr };
+	CComPtr<ID3D11RenderTargetView> m_pOutputView{ nullptr };
+	CComPtr<ID2D1Bitmap1> m_pOutputBitmap{ nullptr };
+	UINT m_viewWidth{ 0 };
+	UINT m_viewHeight{ 0 };
+};
\ No newline at end of file
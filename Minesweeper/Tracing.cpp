@@ -0,0 +1,99 @@
+#include "Tracing.h"
+
+#include <cstdio>
+
+// {2D9C3468-F59D-54DD-66C7-C10EC8045F83}, derived from the provider name like EventSource does.
+TRACELOGGING_DEFINE_PROVIDER(g_hMinesweeperTraceProvider, "Minesweeper",
+	(0x2d9c3468, 0xf59d, 0x54dd, 0x66, 0xc7, 0xc1, 0x0e, 0xc8, 0x04, 0x5f, 0x83));
+
+namespace
+{
+	LONGLONG QpcFrequency()
+	{
+		static const LONGLONG frequency{ []()
+		{
+			LARGE_INTEGER qpcFrequency;
+			QueryPerformanceFrequency(&qpcFrequency);
+			return qpcFrequency.QuadPart;
+		}() };
+
+		return frequency;
+	}
+
+	LONGLONG QpcNow()
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		return now.QuadPart;
+	}
+
+	Tracing::Stopwatch& StartupStopwatch()
+	{
+		static Tracing::Stopwatch stopwatch{};
+		return stopwatch;
+	}
+}
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+void Tracing::Register()
+{
+	StartupStopwatch();
+	TraceLoggingRegister(g_hMinesweeperTraceProvider);
+}
+
+void Tracing::Unregister()
+{
+	TraceLoggingUnregister(g_hMinesweeperTraceProvider);
+}
+
+Tracing::Stopwatch::Stopwatch() :
+	m_qpcStart{ QpcNow() }
+{
+}
+
+LONGLONG Tracing::Stopwatch::Restart()
+{
+	const LONGLONG now{ QpcNow() };
+	const LONGLONG elapsed{ (now - m_qpcStart) * 1000000 / QpcFrequency() };
+
+	m_qpcStart = now;
+	return elapsed;
+}
+
+LONGLONG Tracing::Stopwatch::GetElapsed() const
+{
+	return (QpcNow() - m_qpcStart) * 1000000 / QpcFrequency();
+}
+
+/*
+*	Writes a Startup event of pszPhase, optionally of the
+*	scene pszScene, with the microseconds since Register.
+*	Debug builds also report it to the debugger, so startup
+*	can be timed without a trace session.
+*/
+void Tracing::MarkStartupPhase(PCSTR pszPhase, PCSTR pszScene)
+{
+	const LONGLONG microseconds{ StartupStopwatch().GetElapsed() };
+
+	TraceLoggingWrite(g_hMinesweeperTraceProvider, "Startup",
+		TraceLoggingString(pszPhase, "Phase"),
+		TraceLoggingString(pszScene, "Scene"),
+		TraceLoggingInt64(microseconds, "Microseconds"));
+
+#ifdef _DEBUG
+	CHAR szMessage[256];
+	sprintf_s(szMessage, "Startup: %s %s after %lld us\n", pszPhase, pszScene, microseconds);
+	OutputDebugStringA(szMessage);
+#endif
+}
+
+// GetMessageTime wraps around like GetTickCount, so the difference is taken in 32 bits.
+DWORD Tracing::GetMessageAge(DWORD messageTime)
+{
+	return GetTickCount() - messageTime;
+}
\ No newline at end of file
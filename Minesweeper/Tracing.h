@@ -0,0 +1,51 @@
+#pragma once
+#include <Windows.h>
+#include <TraceLoggingProvider.h>
+
+/*
+*	ETW events of the game, for finding out where the time of
+*	a slow frame went with WPR and WPA. The provider is named
+*	"Minesweeper", its GUID is given in Tracing.cpp.
+*
+*	Events:
+*		- Render: one frame of one scene, split into the time
+*		  RenderScene recorded commands, EndDraw executed them
+*		  and the swap chain presented them
+*		- RenderTargetLost: EndDraw returned D2DERR_RECREATE_TARGET
+*		- Input: a mouse or scroll message of the minefield
+*		- GenerateMines and Reveal: the engine work of a click
+*		- Startup: a phase of starting the game reached, with
+*		  the time since wWinMain began. The FirstFrame phase
+*		  of the last scene to present is the time to the first
+*		  frame, which should stay below 100 milliseconds
+*
+*	Every event carries the GetMessageTime of the message it
+*	originates from, and Render also the time from then until
+*	the frame was presented, to chart input latency.
+*	Writing an event costs next to nothing while no trace
+*	session listens to the provider.
+*/
+TRACELOGGING_DECLARE_PROVIDER(g_hMinesweeperTraceProvider);
+
+namespace Tracing
+{
+	void Register();								// Also starts the clock of the Startup events.
+	void Unregister();
+	void MarkStartupPhase(PCSTR pszPhase, PCSTR pszScene = "");
+
+	// Measures the time from its construction, e.g. of a handler, in microseconds.
+	class Stopwatch
+	{
+	public:
+		Stopwatch();
+
+		LONGLONG	Restart();						// Returns the time elapsed and starts measuring again.
+		LONGLONG	GetElapsed() const;
+
+	private:
+		LONGLONG m_qpcStart{ 0 };
+	};
+
+	// Returns the milliseconds from the message time messageTime until now, the way GetMessageTime counts.
+	DWORD GetMessageAge(DWORD messageTime);
+}
\ No newline at end of file
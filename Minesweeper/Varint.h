@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+*	Little endian base 128 varints, the integers of replays
+*	and of the spectator stream. Small values, like most
+*	delays, tile differences and counts, take a byte or two.
+*/
+
+// Appends value as a little endian base 128 varint, 7 bits per byte with the top bit set on all but the last.
+inline void WriteVarint(std::vector<std::uint8_t>& aBytes, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		aBytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+
+	aBytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Reads a varint written by WriteVarint, returns false if it runs past pEnd or is longer than 64 bits.
+inline bool ReadVarint(const std::uint8_t*& pNext, const std::uint8_t* pEnd, std::uint64_t& value)
+{
+	value = 0;
+
+	for (std::uint32_t shift{ 0 }; shift < 64 && pNext < pEnd; shift += 7)
+	{
+		const std::uint8_t byte{ *pNext++ };
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline bool ReadVarint32(const std::uint8_t*& pNext, const std::uint8_t* pEnd, std::uint32_t& value)
+{
+	std::uint64_t value64{ 0 };
+
+	if (!ReadVarint(pNext, pEnd, value64) || value64 > UINT32_MAX)
+	{
+		return false;
+	}
+
+	value = static_cast<std::uint32_t>(value64);
+	return true;
+}
+
+// Maps signed values to unsigned ones small in magnitude, 0, -1, 1, -2, ... to 0, 1, 2, 3, ..., to write them as varints.
+inline std::uint64_t ZigZagEncode(std::int64_t value)
+{
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
\ No newline at end of file
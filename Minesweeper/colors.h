@@ -21,6 +21,14 @@ namespace colors
 	inline constexpr unsigned int tileBackgroundMineGameWin{ 0x008000FF };
 	inline constexpr unsigned int tileBackgroundCheatsUsed{ 0x000080FF };
 
+	// Colors of the solver overlay, a mine probability of 1 is drawn at the full alpha
+	inline constexpr unsigned int tileMineProbability{ 0xFF0000A0 };
+	inline constexpr unsigned int tileHint{ 0x00FF00FF };
+
+	// Colors of the frame time overlay
+	inline constexpr unsigned int frameTimesBackground{ 0x000000FF };
+	inline constexpr unsigned int frameTimesText{ 0xFFFFFFFF };
+
 	// Alpha masks for tile edge colors
 	inline constexpr unsigned int tileEdgeLightest{ 0xFFFFFF87 };
 	inline constexpr unsigned int tileEdgeLight{ 0xFFFFFF5D };
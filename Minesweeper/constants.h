@@ -22,15 +22,40 @@ namespace constants
 	inline constexpr UINT EXPERT_HEIGHT{ 16 };
 	inline constexpr UINT EXPERT_CMINES{ 99 };;
 
-	inline constexpr UINT MAX_FIELD_DIMENSION{ 99 };
+	inline constexpr UINT MAX_FIELD_DIMENSION{ 4096 };
+	inline constexpr UINT MAX_FIELD_DIMENSION_DIGITS{ 4 };
+	inline constexpr UINT MAX_MINES_DIGITS{ 8 };
+
+	// Candidates searched in the background for the first click of a no guessing game when no ready board fits it.
+	inline constexpr UINT NO_GUESS_ATTEMPTS{ 2000 };
+
+	inline constexpr double MIN_LAYOUT_TILE_SIZE{ 16. };
+	inline constexpr FLOAT MIN_TILE_SIZE{ 4.f };
+	inline constexpr FLOAT MAX_TILE_SIZE{ 128.f };
+	inline constexpr FLOAT ZOOM_STEP{ 1.25f };
 
 	inline constexpr UINT COUNTER_SIZE{ 5 };
 
+	// SetTimer ID of the minefield window playing back a replay.
+	inline constexpr UINT REPLAY_TIMER_ID{ 1 };
+
+	// Bytes the moves kept for undo and redo may take before the oldest ones are dropped.
+	inline constexpr size_t UNDO_HISTORY_BUDGET{ 64 << 20 };
+
+	// TCP port spectators connect to when the game is hosted for them, see SpectatorServer.h.
+	inline constexpr USHORT SPECTATOR_PORT{ 27182 };
+
 	inline constexpr UINT DIGIT_STATES[]{ 0b01110111, 0b00100100, 0b01011101, 0b01101101, 0b00101110, 0b01101011, 
 											0b01111011, 0b00100101, 0b01111111, 0b01101111, 0b00001000 };
 
+	// Command line switch selecting RenderBackend::FLIP_SWAP_CHAIN.
+	inline constexpr std::wstring_view SWITCH_FLIP_MODEL{ L"/flipmodel" };
+	// Command line switch drawing the minefield with a pixel shader, implies SWITCH_FLIP_MODEL.
+	inline constexpr std::wstring_view SWITCH_TILE_SHADER{ L"/tileshader" };
+
 	inline constexpr std::wstring_view FONT_NUMBER{ L"Cambria Math" };
 	inline constexpr std::wstring_view FONT_EMOJI{ L"Segoe UI Emoji" };
+	inline constexpr std::wstring_view FONT_FRAME_TIMES{ L"Consolas" };
 
 	inline constexpr std::wstring_view CHAR_QUESTION_MARK{ L"?" };
 	inline constexpr std::wstring_view CHAR_ONE{ L"1" };
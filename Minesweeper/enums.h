@@ -38,4 +38,11 @@ enum class SmileState
 	SMILE_OPEN_MOUTH,
 	SMILE_SUNGLASSES,
 	SMILE_DEAD
+};
+
+// Ways scenes can present their frames, chosen at startup
+enum class RenderBackend
+{
+	HWND_RENDER_TARGET,		// One ID2D1HwndRenderTarget, and device, per window.
+	FLIP_SWAP_CHAIN,		// A flip model swap chain per window, all on one shared device.
 };
\ No newline at end of file
@@ -18,6 +18,7 @@
 #define IDD_OPTIONS                     113
 #define IDI_ICON1                       115
 #define IDI_MINESWEEPER                 115
+#define IDD_STATS                       118
 #define IDC_DROPLIST_GAME_DIFFICULTY    1001
 #define IDC_STATIC_GAMEDIFFICULTY       1002
 #define IDC_STATIC_WIDTH                1005
@@ -27,19 +28,33 @@
 #define IDC_EDIT_MINES                  1013
 #define IDC_EDIT_HEIGHT                 1015
 #define IDC_EDIT_WIDTH                  1016
+#define IDC_CHECK_NOGUESS               1017
+#define IDC_LIST_STATS                  1018
 #define ID_FILE_EXIT                    40001
 #define ID_GAME_RESET                   40002
 #define ID_GAME_OPTIONS                 40003
 #define ID_ACCELERATOR_RESET            40004
 #define ID_ACCELERATOR_DEBUG            40005
+#define ID_GAME_HINT                    40007
+#define ID_GAME_PROBABILITIES           40008
+#define ID_GAME_FRAMETIMES              40009
+#define ID_FILE_SAVEREPLAY              40010
+#define ID_FILE_OPENREPLAY              40011
+#define ID_FILE_SAVEGAME                40012
+#define ID_FILE_OPENGAME                40013
+#define ID_GAME_UNDO                    40014
+#define ID_GAME_REDO                    40015
+#define ID_GAME_SPECTATORS              40016
+#define ID_GAME_PRECISEMOUSE            40017
+#define ID_GAME_STATISTICS              40018
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        118
-#define _APS_NEXT_COMMAND_VALUE         40007
-#define _APS_NEXT_CONTROL_VALUE         1016
+#define _APS_NEXT_RESOURCE_VALUE        119
+#define _APS_NEXT_COMMAND_VALUE         40019
+#define _APS_NEXT_CONTROL_VALUE         1019
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,41 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::uint64_t> g_cAllocations{ 0 };
+}
+
+std::uint64_t AllocationCounter::GetCount()
+{
+	return g_cAllocations.load(std::memory_order_relaxed);
+}
+
+/*
+*	The replaced operator new. The array and nothrow forms of
+*	the standard library call it, so they are counted too.
+*/
+void* operator new(std::size_t cBytes)
+{
+	g_cAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* p{ std::malloc(cBytes > 0 ? cBytes : 1) })
+	{
+		return p;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
\ No newline at end of file
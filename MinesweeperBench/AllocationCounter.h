@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+/*
+*	Counts the heap allocations of the benchmark process. The
+*	benchmark replaces the global operator new, so every
+*	allocation made through new, std::vector or any other
+*	standard container is counted, whichever thread makes it.
+*/
+namespace AllocationCounter
+{
+	std::uint64_t GetCount();								// Returns the number of allocations made so far.
+}
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AdjacencyKernel.h"
+#include "AllocationCounter.h"
+#include "MinefieldEngine.h"
+#include "RNG.h"
+#include "TileNeighborhood.h"
+
+/*
+*	Benchmarks of the headless engine. Board sizes are given
+*	as width, height and mines, covering the three presets
+*	and large custom boards at Expert's mine density.
+*/
+namespace
+{
+	constexpr std::uint64_t SEED{ 0x5EED };
+
+	void PresetAndLargeBoards(benchmark::internal::Benchmark* pBenchmark)
+	{
+		pBenchmark->ArgNames({ "width", "height", "mines" });
+		pBenchmark->Args({ 9, 9, 10 })->Args({ 16, 16, 40 })->Args({ 30, 16, 99 });
+		pBenchmark->Args({ 1024, 1024, 216268 })->Args({ 4096, 4096, 3460300 });
+	}
+
+	void LargeBoards(benchmark::internal::Benchmark* pBenchmark)
+	{
+		pBenchmark->ArgNames({ "width", "height" });
+		pBenchmark->Args({ 256, 256 })->Args({ 1024, 1024 })->Args({ 4096, 4096 });
+	}
+
+	// Expert, a large square custom board and the largest board, all at Expert's mine density.
+	void CountingBoards(benchmark::internal::Benchmark* pBenchmark)
+	{
+		pBenchmark->ArgNames({ "width", "height", "mines" });
+		pBenchmark->Args({ 30, 16, 99 })->Args({ 99, 99, 2021 })->Args({ 4096, 4096, 3460300 });
+	}
+
+	std::uint32_t Width(const benchmark::State& state) { return static_cast<std::uint32_t>(state.range(0)); }
+	std::uint32_t Height(const benchmark::State& state) { return static_cast<std::uint32_t>(state.range(1)); }
+	std::uint32_t Mines(const benchmark::State& state) { return static_cast<std::uint32_t>(state.range(2)); }
+
+	// Fills board, which must have the size of the benchmark, with the mines of a game the engine generated.
+	void PlaceGeneratedMines(const benchmark::State& state, TileBoard& board)
+	{
+		MinefieldEngine engine{ Width(state), Height(state), Mines(state) };
+		engine.SetGameSeed(SEED);
+		engine.GenerateMines(Width(state) / 2, Height(state) / 2);
+
+		for (std::uint32_t y{ 0 }; y < Height(state); ++y)
+		{
+			for (std::uint32_t x{ 0 }; x < Width(state); ++x)
+			{
+				if (engine.GetBoard().IsMine(x, y))
+				{
+					board.SetMine(x + y * Width(state), true);
+				}
+			}
+		}
+	}
+}
+
+static void BM_GenerateMines(benchmark::State& state)
+{
+	MinefieldEngine engine{ Width(state), Height(state), Mines(state) };
+	std::uint64_t seed{ SEED };
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		engine.ResetGame();
+		engine.SetGameSeed(seed++);
+		state.ResumeTiming();
+
+		engine.GenerateMines(Width(state) / 2, Height(state) / 2);
+	}
+
+	state.SetItemsProcessed(state.iterations() * Mines(state));
+}
+BENCHMARK(BM_GenerateMines)->Apply(PresetAndLargeBoards);
+
+static void BM_GenerateNumbers(benchmark::State& state)
+{
+	MinefieldEngine engine{ Width(state), Height(state), Mines(state) };
+	engine.SetGameSeed(SEED);
+	engine.GenerateMines(Width(state) / 2, Height(state) / 2);
+
+	for (auto _ : state)
+	{
+		engine.GenerateNumbers();
+	}
+
+	state.SetItemsProcessed(state.iterations() * engine.GetSize());
+}
+BENCHMARK(BM_GenerateNumbers)->Apply(PresetAndLargeBoards);
+
+/*
+*	Counts the adjacent mines of a board the way numbers were
+*	generated before the AdjacencyKernel: tile by tile,
+*	reading the eight neighbors of every tile. The tiles are
+*	walked row by row, which is the order the board is
+*	stored in, so the kernels are compared with the per tile
+*	count at its fastest.
+*/
+static void BM_CountBoardPerTile(benchmark::State& state)
+{
+	const std::uint32_t width{ Width(state) };
+	const std::uint32_t height{ Height(state) };
+	TileBoard board{ width, height };
+	PlaceGeneratedMines(state, board);
+
+	for (auto _ : state)
+	{
+		for (std::uint32_t y{ 0 }; y < height; ++y)
+		{
+			for (std::uint32_t x{ 0 }; x < width; ++x)
+			{
+				std::uint32_t cAdjacentMines{ 0 };
+
+				if (!board.IsMine(x, y))
+				{
+					for (const std::uint32_t tile : TileNeighborhood(x, y, 1, width, height))
+					{
+						cAdjacentMines += board.IsMine(tile) ? 1 : 0;
+					}
+				}
+
+				board.SetAdjacentCount(x + y * width, cAdjacentMines);
+			}
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * board.GetSize());
+}
+BENCHMARK(BM_CountBoardPerTile)->Apply(CountingBoards);
+
+// Counts the adjacent mines of a board chunk by chunk with one AdjacencyKernel, skipped if the CPU lacks it.
+static void BM_CountBoardWithKernel(benchmark::State& state, AdjacencyKernel::Kernel kernel)
+{
+	if (!AdjacencyKernel::IsSupported(kernel))
+	{
+		state.SkipWithError("The CPU does not support this kernel.");
+		return;
+	}
+
+	TileBoard board{ Width(state), Height(state) };
+	PlaceGeneratedMines(state, board);
+
+	for (auto _ : state)
+	{
+		for (std::uint32_t chunkY{ 0 }; chunkY < board.GetChunkRows(); ++chunkY)
+		{
+			for (std::uint32_t chunkX{ 0 }; chunkX < board.GetChunkColumns(); ++chunkX)
+			{
+				AdjacencyKernel::CountChunk(board, chunkX, chunkY, kernel);
+			}
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * board.GetSize());
+}
+BENCHMARK_CAPTURE(BM_CountBoardWithKernel, scalar, AdjacencyKernel::Kernel::SCALAR)->Apply(CountingBoards);
+BENCHMARK_CAPTURE(BM_CountBoardWithKernel, sse2, AdjacencyKernel::Kernel::SSE2)->Apply(CountingBoards);
+BENCHMARK_CAPTURE(BM_CountBoardWithKernel, avx2, AdjacencyKernel::Kernel::AVX2)->Apply(CountingBoards);
+
+// The adjacent mine counts of one full chunk.
+static void BM_CountAdjacentMines(benchmark::State& state)
+{
+	RNG rng{ SEED };
+	std::uint64_t aWest[TileBoard::CHUNK_SIZE + 2]{};
+	std::uint64_t aMid[TileBoard::CHUNK_SIZE + 2]{};
+	std::uint64_t aEast[TileBoard::CHUNK_SIZE + 2]{};
+	std::uint8_t aCounts[TileBoard::CHUNK_SIZE][AdjacencyKernel::ROW_BYTES]{};
+
+	for (std::uint32_t row{ 0 }; row < TileBoard::CHUNK_SIZE + 2; ++row)
+	{
+		// About one mine in five, like Expert.
+		aMid[row] = rng.Next() & rng.Next() & (rng.Next() | rng.Next());
+		aWest[row] = aMid[row] << 1;
+		aEast[row] = aMid[row] >> 1;
+	}
+
+	for (auto _ : state)
+	{
+		AdjacencyKernel::CountAdjacentMines(aWest, aMid, aEast, TileBoard::CHUNK_SIZE, ~std::uint64_t{ 0 }, aCounts);
+		benchmark::DoNotOptimize(aCounts);
+	}
+
+	state.SetItemsProcessed(state.iterations() * TileBoard::CHUNK_SIZE * TileBoard::CHUNK_SIZE);
+}
+BENCHMARK(BM_CountAdjacentMines);
+
+/*
+*	Reveals a whole board with a single mine in its corner
+*	from the opposite corner, the worst case of the flood
+*	fill. From 1024x1024 on the fill runs on every core.
+*/
+static void BM_FloodReveal(benchmark::State& state)
+{
+	MinefieldEngine engine{ Width(state), Height(state), 1 };
+	const std::vector<std::uint32_t> aMineTiles{ 0 };
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		engine.ResetGame();
+		engine.PlaceMines(aMineTiles);
+		engine.ClearDirtyTiles();
+		state.ResumeTiming();
+
+		engine.RevealTile(Width(state) - 1, Height(state) - 1);
+	}
+
+	state.SetItemsProcessed(state.iterations() * (engine.GetSize() - 1));
+}
+BENCHMARK(BM_FloodReveal)->Apply(LargeBoards)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/*
+*	Chords next to a wall of mines in column 1, revealing
+*	the empty rest of the board to its right.
+*/
+static void BM_ChordFlood(benchmark::State& state)
+{
+	const std::uint32_t width{ Width(state) };
+	const std::uint32_t height{ Height(state) };
+	const std::uint32_t y{ height / 2 };
+	MinefieldEngine engine{ width, height, height };
+	std::vector<std::uint32_t> aMineTiles{};
+
+	for (std::uint32_t row{ 0 }; row < height; ++row)
+	{
+		aMineTiles.push_back(1 + row * width);
+	}
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		engine.ResetGame();
+		engine.PlaceMines(aMineTiles);
+		engine.RevealTile(2, y);
+
+		for (std::uint32_t row{ y - 1 }; row <= y + 1; ++row)
+		{
+			engine.CycleTileMark(1, row);
+		}
+
+		engine.BeginChord(2, y);
+		engine.ClearDirtyTiles();
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(engine.EndChord(2, y));
+	}
+
+	state.SetItemsProcessed(state.iterations() * (width - 3) * height);
+}
+BENCHMARK(BM_ChordFlood)->ArgNames({ "width", "height" })->Args({ 30, 16 })->Args({ 1024, 1024 })->UseRealTime();
+
+/*
+*	Plays a whole game with every mine flagged up front: row
+*	by row, every revealed number is chorded and every hidden
+*	safe tile revealed. Reports the heap allocations made per
+*	RevealTile and EndChord, which settle at zero once the
+*	engine's buffers have grown to the size of the board.
+*/
+static void BM_RevealAllocations(benchmark::State& state)
+{
+	const std::uint32_t width{ Width(state) };
+	MinefieldEngine engine{ width, Height(state), Mines(state) };
+	std::uint64_t seed{ SEED };
+	std::uint64_t cAllocations{ 0 };
+	std::uint64_t cReveals{ 0 };
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		engine.ResetGame();
+		engine.SetGameSeed(seed++);
+		engine.GenerateMines(width / 2, Height(state) / 2);
+
+		for (std::uint32_t tile{ 0 }; tile < engine.GetSize(); ++tile)
+		{
+			if (engine.GetBoard().IsMine(tile))
+			{
+				engine.CycleTileMark(tile % width, tile / width);
+			}
+		}
+
+		engine.ClearDirtyTiles();
+		state.ResumeTiming();
+
+		const std::uint64_t cAllocationsBefore{ AllocationCounter::GetCount() };
+
+		for (std::uint32_t tile{ 0 }; tile < engine.GetSize() && engine.IsGameActive(); ++tile)
+		{
+			const TileBoard& board{ engine.GetBoard() };
+
+			if (board.GetState(tile) == TileState::REVEALED && board.GetAdjacentCount(tile) > 0)
+			{
+				engine.BeginChord(tile % width, tile / width);
+				engine.EndChord(tile % width, tile / width);
+				++cReveals;
+			}
+			else if (board.GetState(tile) == TileState::HIDDEN && !board.IsMine(tile))
+			{
+				engine.RevealTile(tile % width, tile / width);
+				++cReveals;
+			}
+		}
+
+		cAllocations += AllocationCounter::GetCount() - cAllocationsBefore;
+	}
+
+	state.counters["reveals"] = benchmark::Counter(static_cast<double>(cReveals), benchmark::Counter::kAvgIterations);
+	state.counters["allocs_per_reveal"] = cReveals > 0 ? static_cast<double>(cAllocations) / cReveals : 0.0;
+}
+BENCHMARK(BM_RevealAllocations)->ArgNames({ "width", "height", "mines" })->Args({ 9, 9, 10 })->Args({ 16, 16, 40 })->Args({ 30, 16, 99 });
+
+// Visits every tile's eight neighbors the way the engine's rules do.
+static void BM_TileNeighborhood(benchmark::State& state)
+{
+	const std::uint32_t width{ Width(state) };
+	const std::uint32_t height{ Height(state) };
+
+	for (auto _ : state)
+	{
+		std::uint64_t sum{ 0 };
+
+		for (std::uint32_t y{ 0 }; y < height; ++y)
+		{
+			for (std::uint32_t x{ 0 }; x < width; ++x)
+			{
+				for (const std::uint32_t tile : TileNeighborhood(x, y, 1, width, height))
+				{
+					sum += tile;
+				}
+			}
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_TileNeighborhood)->ArgNames({ "width", "height" })->Args({ 30, 16 })->Args({ 1024, 1024 });
+
+// Disables question marks on a board where every fourth tile has one, which clears them.
+static void BM_ToggleQuestionMarkUsage(benchmark::State& state)
+{
+	const std::uint32_t width{ Width(state) };
+	const std::uint32_t height{ Height(state) };
+	MinefieldEngine engine{ width, height, 0 };
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		engine.ResetGame();
+		engine.ToggleQuestionMarkUsage();
+
+		for (std::uint32_t tile{ 0 }; tile < engine.GetSize(); tile += 4)
+		{
+			engine.CycleTileMark(tile % width, tile / width);
+			engine.CycleTileMark(tile % width, tile / width);
+		}
+
+		engine.ClearDirtyTiles();
+		state.ResumeTiming();
+
+		engine.ToggleQuestionMarkUsage();
+	}
+
+	state.SetItemsProcessed(state.iterations() * engine.GetSize());
+}
+BENCHMARK(BM_ToggleQuestionMarkUsage)->ArgNames({ "width", "height" })->Args({ 30, 16 })->Args({ 1024, 1024 });
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <Windows.h>
+#include <objbase.h>
+
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/*
+*	Runs the engine and render benchmarks. Unless the command
+*	line names another output file, the results are also
+*	written to MinesweeperBench.json, so runs can be compared
+*	with Google Benchmark's compare.py, e.g.
+*		MinesweeperBench --benchmark_filter=BM_FloodReveal
+*/
+int main(int argc, char* argv[])
+{
+	std::vector<char*> aArgs(argv, argv + argc);
+	char szOut[]{ "--benchmark_out=MinesweeperBench.json" };
+	char szOutFormat[]{ "--benchmark_out_format=json" };
+	bool bHasOut{ false };
+
+	for (int arg{ 1 }; arg < argc; ++arg)
+	{
+		bHasOut |= std::strncmp(argv[arg], "--benchmark_out=", std::strlen("--benchmark_out=")) == 0;
+	}
+
+	if (!bHasOut)
+	{
+		aArgs.push_back(szOut);
+		aArgs.push_back(szOutFormat);
+	}
+
+	// The render benchmarks create WIC bitmaps.
+	if (FAILED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE)))
+	{
+		return 1;
+	}
+
+	int cArgs{ static_cast<int>(aArgs.size()) };
+	benchmark::Initialize(&cArgs, aArgs.data());
+
+	if (benchmark::ReportUnrecognizedArguments(cArgs, aArgs.data()))
+	{
+		CoUninitialize();
+		return 1;
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	CoUninitialize();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <atlbase.h>
+#include <wincodec.h>
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "MinefieldEngine.h"
+#include "MinefieldScene.h"
+
+/*
+*	Benchmarks of MinefieldScene::RenderScene, drawn into a
+*	WIC bitmap of a typical window size instead of a window.
+*	A WIC bitmap render target draws in software, so these
+*	measure the scene's own work rather than the GPU.
+*/
+namespace
+{
+	constexpr UINT VIEW_WIDTH{ 1600 };
+	constexpr UINT VIEW_HEIGHT{ 900 };
+	constexpr FLOAT TILE_SIZE{ 24 };
+
+	// A scene drawing a started game of the benchmark's board size into its own bitmap.
+	class OffscreenMinefield
+	{
+	public:
+		OffscreenMinefield(std::uint32_t width, std::uint32_t height, std::uint32_t cMines) :
+			m_engine{ width, height, cMines }
+		{
+			m_engine.SetGameSeed(0x5EED);
+			m_engine.RevealTile(width / 2, height / 2);
+			m_engine.ClearDirtyTiles();
+			m_scene.SetEngine(&m_engine);
+		}
+
+		~OffscreenMinefield()
+		{
+			m_scene.CleanUp();
+		}
+
+		HRESULT Initialize()
+		{
+			CComPtr<IWICImagingFactory> pWICFactory{ nullptr };
+			HRESULT hr = pWICFactory.CoCreateInstance(CLSID_WICImagingFactory);
+
+			if (SUCCEEDED(hr))
+			{
+				hr = pWICFactory->CreateBitmap(VIEW_WIDTH, VIEW_HEIGHT, GUID_WICPixelFormat32bppPBGRA,
+					WICBitmapCacheOnDemand, &m_pBitmap);
+			}
+
+			if (SUCCEEDED(hr))
+			{
+				hr = m_scene.InitializeOffscreen(m_pBitmap);
+			}
+
+			if (SUCCEEDED(hr))
+			{
+				m_scene.SetBaseTileSize(TILE_SIZE);
+				m_scene.ResetCamera();
+				m_scene.Render();
+			}
+
+			return hr;
+		}
+
+		MinefieldEngine& GetEngine() { return m_engine; }
+		MinefieldScene& GetScene() { return m_scene; }
+
+	private:
+		MinefieldEngine m_engine;
+		MinefieldScene m_scene{};
+		CComPtr<IWICBitmap> m_pBitmap{ nullptr };
+	};
+
+	void RenderBoards(benchmark::internal::Benchmark* pBenchmark)
+	{
+		pBenchmark->ArgNames({ "width", "height", "mines" });
+		pBenchmark->Args({ 9, 9, 10 })->Args({ 30, 16, 99 })->Args({ 1024, 1024, 216268 });
+	}
+}
+
+// Redraws every visible tile, as after a resize, zoom or pan.
+static void BM_RenderSceneFull(benchmark::State& state)
+{
+	OffscreenMinefield minefield{ static_cast<std::uint32_t>(state.range(0)), static_cast<std::uint32_t>(state.range(1)),
+		static_cast<std::uint32_t>(state.range(2)) };
+
+	if (FAILED(minefield.Initialize()))
+	{
+		state.SkipWithError("Could not create the offscreen scene");
+		return;
+	}
+
+	for (auto _ : state)
+	{
+		minefield.GetScene().InvalidateAll();
+		minefield.GetScene().Render();
+	}
+}
+BENCHMARK(BM_RenderSceneFull)->Apply(RenderBoards)->Unit(benchmark::kMicrosecond);
+
+// Redraws the single tile a flag was placed on or taken off, the common frame while playing.
+static void BM_RenderSceneDirtyTile(benchmark::State& state)
+{
+	OffscreenMinefield minefield{ static_cast<std::uint32_t>(state.range(0)), static_cast<std::uint32_t>(state.range(1)),
+		static_cast<std::uint32_t>(state.range(2)) };
+
+	if (FAILED(minefield.Initialize()))
+	{
+		state.SkipWithError("Could not create the offscreen scene");
+		return;
+	}
+
+	MinefieldEngine& engine{ minefield.GetEngine() };
+	std::uint32_t tile{ 0 };
+
+	while (tile < engine.GetSize() - 1 && engine.GetBoard().GetState(tile) != TileState::HIDDEN)
+	{
+		++tile;
+	}
+
+	// Every iteration flags the tile or takes its flag off again.
+	for (auto _ : state)
+	{
+		engine.CycleTileMark(tile % engine.GetWidth(), tile / engine.GetWidth());
+		minefield.GetScene().Render();
+	}
+}
+BENCHMARK(BM_RenderSceneDirtyTile)->Apply(RenderBoards)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "MinefieldEngine.h"
+#include "Replay.h"
+#include "RNG.h"
+#include "SelfPlayer.h"
+#include "ThreadPool.h"
+
+/*
+*	Plays games of one board size on every core and reports
+*	how often the SelfPlayer wins, e.g.
+*		MinesweeperBot 30 16 99 100000 12345
+*	plays 100000 Expert games from master seed 12345. Every
+*	game's seed is derived from the master seed and its
+*	number, so a run gives the same games and results no
+*	matter which thread plays which game.
+*
+*	With --replay it plays a replay saved by the game
+*	instead, as fast as the engine can, e.g.
+*		MinesweeperBot --replay game.msreplay 1000
+*	plays it 1000 times and fails if it doesn't end the way
+*	it was recorded.
+*/
+namespace
+{
+	// Games played by one task, enough to make a task's overhead negligible.
+	constexpr std::uint64_t BATCH_GAMES{ 64 };
+
+	struct BatchResult
+	{
+		std::uint64_t cWins{ 0 };
+		std::uint64_t cGuesses{ 0 };
+		double total3BV{ 0 };
+		double total3BVPerSecond{ 0 };		// Of the games won.
+		double totalSolveSeconds{ 0 };
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: MinesweeperBot <width> <height> <mines> [games] [seed]\n");
+		std::printf("       MinesweeperBot --replay <file> [repeats]\n");
+	}
+
+	int PlayReplay(const char* szPath, std::uint64_t cRepeats)
+	{
+		Replay replay{};
+
+		if (!replay.Load(szPath))
+		{
+			std::printf("%s is not a replay\n", szPath);
+			return 1;
+		}
+
+		std::printf("Playing %u events on %ux%u with %u mines %llu times\n", replay.GetEventCount(),
+			replay.GetWidth(), replay.GetHeight(), replay.GetMineCount(), static_cast<unsigned long long>(cRepeats));
+
+		MinefieldEngine engine{ replay.GetWidth(), replay.GetHeight(), replay.GetMineCount() };
+		const auto start{ std::chrono::steady_clock::now() };
+
+		for (std::uint64_t repeat{ 0 }; repeat < cRepeats; ++repeat)
+		{
+			if (!replay.Play(engine))
+			{
+				std::printf("The replay did not end the way it was recorded\n");
+				return 1;
+			}
+		}
+
+		const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+		std::printf("Outcome:          %s, %u tiles revealed\n", replay.GetOutcome() == Replay::Outcome::WON ? "won" :
+			replay.GetOutcome() == Replay::Outcome::LOST ? "lost" : "unfinished", replay.GetRevealedCount());
+		std::printf("Throughput:       %.0f events/s (%.2f s)\n", replay.GetEventCount() * cRepeats / seconds, seconds);
+
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 3 && std::strcmp(argv[1], "--replay") == 0)
+	{
+		return PlayReplay(argv[2], argc > 3 ? std::max<std::uint64_t>(std::strtoull(argv[3], nullptr, 10), 1) : 1);
+	}
+
+	if (argc < 4)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const std::uint32_t width{ static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10)) };
+	const std::uint32_t height{ static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10)) };
+	const std::uint32_t cMines{ static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10)) };
+	const std::uint64_t cGames{ argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 10000 };
+	const std::uint64_t masterSeed{ argc > 5 ? std::strtoull(argv[5], nullptr, 10) : RNG::RandomSeed() };
+
+	if (width == 0 || height == 0 || cMines >= width * height || cGames == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	ThreadPool& pool{ ThreadPool::Shared() };
+	std::printf("Playing %llu games of %ux%u with %u mines on %u threads, seed %llu\n",
+		static_cast<unsigned long long>(cGames), width, height, cMines, pool.GetThreadCount(),
+		static_cast<unsigned long long>(masterSeed));
+
+	const std::uint64_t cBatches{ (cGames + BATCH_GAMES - 1) / BATCH_GAMES };
+	std::vector<BatchResult> aResults(cBatches);
+	ThreadPool::TaskGroup games{};
+	const auto start{ std::chrono::steady_clock::now() };
+
+	for (std::uint64_t batch{ 0 }; batch < cBatches; ++batch)
+	{
+		pool.Submit(games, [&, batch]()
+		{
+			SelfPlayer player{ width, height, cMines };
+			BatchResult& result{ aResults[batch] };
+
+			for (std::uint64_t game{ batch * BATCH_GAMES }; game < std::min(cGames, (batch + 1) * BATCH_GAMES); ++game)
+			{
+				const SelfPlayer::GameResult gameResult{ player.Play(SelfPlayer::GetGameSeed(masterSeed, game)) };
+
+				result.cGuesses += gameResult.cGuesses;
+				result.total3BV += gameResult.c3BV;
+				result.totalSolveSeconds += gameResult.solveSeconds;
+
+				if (gameResult.bWon)
+				{
+					++result.cWins;
+					result.total3BVPerSecond += gameResult.c3BV / std::max(gameResult.solveSeconds, 1e-9);
+				}
+			}
+		});
+	}
+
+	pool.Wait(games);
+
+	const double wallSeconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+	// Summed in batch order so the totals don't depend on the order the batches finished in.
+	BatchResult total{};
+
+	for (const BatchResult& result : aResults)
+	{
+		total.cWins += result.cWins;
+		total.cGuesses += result.cGuesses;
+		total.total3BV += result.total3BV;
+		total.total3BVPerSecond += result.total3BVPerSecond;
+		total.totalSolveSeconds += result.totalSolveSeconds;
+	}
+
+	const double winRate{ static_cast<double>(total.cWins) / cGames };
+	const double winRateError{ 1.96 * std::sqrt(winRate * (1 - winRate) / cGames) };
+
+	std::printf("Win rate:         %.2f%% +- %.2f%% (%llu of %llu)\n", winRate * 100, winRateError * 100,
+		static_cast<unsigned long long>(total.cWins), static_cast<unsigned long long>(cGames));
+	std::printf("Guesses per game: %.3f\n", static_cast<double>(total.cGuesses) / cGames);
+	std::printf("Mean 3BV:         %.2f\n", total.total3BV / cGames);
+	std::printf("Mean 3BV/s:       %.0f (games won)\n", total.cWins > 0 ? total.total3BVPerSecond / total.cWins : 0.);
+	std::printf("Mean solve time:  %.3f ms\n", total.totalSolveSeconds / cGames * 1000);
+	std::printf("Throughput:       %.0f games/s (%.2f s)\n", cGames / wallSeconds, wallSeconds);
+
+	return 0;
+}
\ No newline at end of file
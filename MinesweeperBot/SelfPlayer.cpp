@@ -0,0 +1,165 @@
+#include "SelfPlayer.h"
+
+#include <chrono>
+
+#include "PresetBoard.h"
+
+/*
+*	==========================
+*	===== Public Methods =====
+*	==========================
+*/
+
+SelfPlayer::SelfPlayer(std::uint32_t width, std::uint32_t height, std::uint32_t cMines) :
+	m_engine{ width, height, cMines }
+{
+}
+
+SelfPlayer::GameResult SelfPlayer::Play(std::uint64_t gameSeed)
+{
+	const std::uint32_t width{ m_engine.GetWidth() };
+	const auto start{ std::chrono::steady_clock::now() };
+	GameResult result{};
+
+	m_engine.ResetGame();
+	m_engine.SetGameSeed(gameSeed);
+	m_solver.Reset(width, m_engine.GetHeight(), m_engine.GetMineCount());
+
+	Reveal(width / 2 + m_engine.GetHeight() / 2 * width);
+	++result.cGuesses;
+
+	while (m_engine.IsGameActive())
+	{
+		m_aSafeTiles.clear();
+		m_aMines.clear();
+
+		if (m_solver.Deduce(m_aSafeTiles, m_aMines))
+		{
+			for (const std::uint32_t mine : m_aMines)
+			{
+				m_solver.SetMine(mine);
+			}
+
+			for (const std::uint32_t tile : m_aSafeTiles)
+			{
+				Reveal(tile);
+			}
+		}
+		else
+		{
+			std::uint32_t tile{ 0 };
+
+			if (!m_solver.GetHint(tile))
+			{
+				++result.cGuesses;
+			}
+
+			Reveal(tile);
+		}
+	}
+
+	result.solveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.bWon = m_engine.IsGameWon();
+	result.c3BV = m_engine.GetSize() <= MinefieldEngine::MAX_THREE_BV_TILES ? m_engine.GetThreeBV() : Compute3BV();
+
+	return result;
+}
+
+// Mixes game into masterSeed with SplitMix64, neighboring games get unrelated seeds.
+std::uint64_t SelfPlayer::GetGameSeed(std::uint64_t masterSeed, std::uint64_t game)
+{
+	std::uint64_t z{ masterSeed + (game + 1) * 0x9E3779B97F4A7C15 };
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+	return z ^ (z >> 31);
+}
+
+/*
+*	===========================
+*	===== Private Methods =====
+*	===========================
+*/
+
+// Reveals a tile and tells the solver about every tile that got revealed.
+void SelfPlayer::Reveal(std::uint32_t tile)
+{
+	const std::uint32_t width{ m_engine.GetWidth() };
+
+	if (!m_solver.IsUnknown(tile))
+	{
+		return;
+	}
+
+	m_engine.RevealTile(tile % width, tile / width);
+
+	if (m_engine.IsGameActive() || m_engine.IsGameWon())
+	{
+		for (const TileSpan& span : m_engine.GetRevealedSpans())
+		{
+			for (std::uint32_t x{ span.xBegin }; x < span.xEnd; ++x)
+			{
+				m_solver.SetRevealed(x + span.y * width, m_engine.GetBoard().GetAdjacentCount(x, span.y));
+			}
+		}
+	}
+
+	m_engine.ClearDirtyTiles();
+}
+
+/*
+*	Returns the 3BV of the board: one click per opening, the
+*	empty region revealing itself and its border, plus one
+*	per number that borders no opening. Only used on boards
+*	too large for the engine to count it while generating.
+*/
+std::uint32_t SelfPlayer::Compute3BV()
+{
+	const TileBoard& board{ m_engine.GetBoard() };
+	const std::uint32_t width{ m_engine.GetWidth() };
+	const std::uint32_t height{ m_engine.GetHeight() };
+	const TileNeighbors* pNeighbors{ GetPresetNeighbors(width, height) };
+	std::uint32_t c3BV{ 0 };
+
+	m_aCounted.assign(m_engine.GetSize(), 0);
+
+	for (std::uint32_t tile{ 0 }; tile < m_engine.GetSize(); ++tile)
+	{
+		if (m_aCounted[tile] || board.IsMine(tile) || board.GetAdjacentCount(tile) != 0)
+		{
+			continue;
+		}
+
+		++c3BV;
+		m_aCounted[tile] = 1;
+		m_aStack.assign(1, tile);
+
+		while (!m_aStack.empty())
+		{
+			const std::uint32_t current{ m_aStack.back() };
+			m_aStack.pop_back();
+
+			ForEachNeighbor(pNeighbors, current, width, height, [&](std::uint32_t neighbor)
+			{
+				if (!m_aCounted[neighbor])
+				{
+					m_aCounted[neighbor] = 1;
+
+					if (board.GetAdjacentCount(neighbor) == 0)
+					{
+						m_aStack.push_back(neighbor);
+					}
+				}
+			});
+		}
+	}
+
+	for (std::uint32_t tile{ 0 }; tile < m_engine.GetSize(); ++tile)
+	{
+		if (!m_aCounted[tile] && !board.IsMine(tile))
+		{
+			++c3BV;
+		}
+	}
+
+	return c3BV;
+}
\ No newline at end of file
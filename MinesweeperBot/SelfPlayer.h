@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "MinefieldEngine.h"
+#include "MineSolver.h"
+
+/*
+*	Plays games on a headless MinefieldEngine the way a
+*	careful player would: it opens in the center, reveals
+*	every tile the MineSolver proves safe and, when nothing
+*	can be deduced, guesses the tile least likely to be a
+*	mine. A player is used by one thread at a time and keeps
+*	its engine and solver between games.
+*/
+class SelfPlayer
+{
+public:
+	struct GameResult
+	{
+		bool bWon{ false };
+		std::uint32_t c3BV{ 0 };					// Clicks the board needs at least, see MinefieldEngine::GetThreeBV.
+		std::uint32_t cGuesses{ 0 };				// Tiles revealed without being proven safe, the first click included.
+		double solveSeconds{ 0 };
+	};
+
+	SelfPlayer(std::uint32_t width, std::uint32_t height, std::uint32_t cMines);
+
+	GameResult Play(std::uint64_t gameSeed);
+
+	// Returns the seed of game number game of a run, so every game of a run is reproducible on its own.
+	static std::uint64_t GetGameSeed(std::uint64_t masterSeed, std::uint64_t game);
+
+private:
+	MinefieldEngine m_engine;
+	MineSolver m_solver{};
+	std::vector<std::uint32_t> m_aSafeTiles{};
+	std::vector<std::uint32_t> m_aMines{};
+	std::vector<std::uint32_t> m_aStack{};
+	std::vector<std::uint8_t> m_aCounted{};
+
+	void			Reveal(std::uint32_t tile);
+	std::uint32_t	Compute3BV();
+};
\ No newline at end of file